@@ -0,0 +1,363 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+#include <engine/group/Polytope.h>
+#include <engine/shapes/Sphere.h>
+#include <engine/model/Model.h>
+#include <engine/opengl/buffer/VertexBuffer.h>
+#include <engine/renderer/Renderer.h>
+#include <engine/renderer/MouseRayCasting.h>
+#include <engine/lighting/LightClusters.h>
+#include <engine/lighting/ShadowCascades.h>
+#include <engine/lighting/ShadowAtlas.h>
+
+#define MICROBENCH_SAMPLES 9
+
+struct Options {
+    double minTimeMs = 20.0;
+    double threshold = 10.0;
+    std::string filter, output, baseline;
+};
+
+struct Result {
+    std::string name;
+    double medianNs, minNs;
+    double itemsPerSecond;
+};
+
+// Keeps the compiler from removing the measured work
+static volatile float sink;
+
+/**
+ * @brief Runs f enough times for a sample to last minTimeMs, then takes MICROBENCH_SAMPLES samples.
+ * Times are per call of f, items is what a call processes (vertices, triangles...)
+ */
+template<typename F>
+Result measure(const std::string& name, double items, const Options& options, F f) {
+
+    using clock = std::chrono::high_resolution_clock;
+
+    auto sample = [&](size_t iterations) {
+        auto start = clock::now();
+        for(size_t i = 0; i < iterations; i ++) f();
+        return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    };
+
+    // Calibration, also warms the caches up
+    size_t iterations = 1;
+    while(sample(iterations) < options.minTimeMs * 1e6 && iterations < (1ull << 30)) iterations *= 2;
+
+    std::vector<double> samples;
+    for(int i = 0; i < MICROBENCH_SAMPLES; i ++) samples.push_back(sample(iterations) / iterations);
+    std::sort(samples.begin(), samples.end());
+
+    Result result;
+    result.name = name;
+    result.medianNs = samples[MICROBENCH_SAMPLES / 2];
+    result.minNs = samples.front();
+    result.itemsPerSecond = items * 1e9 / result.medianNs;
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Inputs
+
+std::vector<Vec3f> sphereVertices(std::vector<unsigned int>& indices, int latitudes, int longitudes) {
+    std::vector<Vec3f> vertices;
+    Sphere::createSphereGeometry(1.0f, latitudes, longitudes, vertices, indices);
+    return vertices;
+}
+
+// Same triangles without index buffer, like the cube
+std::vector<Vec3f> unindexed(const std::vector<Vec3f>& vertices, const std::vector<unsigned int>& indices) {
+    std::vector<Vec3f> triangles;
+    triangles.reserve(indices.size());
+    for(unsigned int index : indices) triangles.push_back(vertices[index]);
+    return triangles;
+}
+
+// The same data assimp gives after aiProcess_Triangulate | aiProcess_CalcTangentSpace
+struct SyntheticMesh {
+    std::vector<aiVector3D> positions, normals, uvs, tangents, bitangents;
+    std::vector<unsigned int> indices;
+    std::vector<aiFace> faces;
+    aiMesh mesh;
+
+    SyntheticMesh(const std::vector<Vec3f>& vertices, const std::vector<unsigned int>& _indices) : indices(_indices) {
+        for(const Vec3f& v : vertices) {
+            positions.push_back({ v.x, v.y, v.z });
+            normals.push_back({ v.nx, v.ny, v.nz });
+            uvs.push_back({ v.tx, v.ty, 0.0f });
+            tangents.push_back({ v.tanx, v.tany, v.tanz });
+            bitangents.push_back({ v.bitanx, v.bitany, v.bitanz });
+        }
+
+        faces.resize(indices.size() / 3);
+        for(size_t i = 0; i < faces.size(); i ++) {
+            faces[i].mNumIndices = 3;
+            faces[i].mIndices = &indices[i * 3];
+        }
+
+        mesh.mNumVertices = vertices.size();
+        mesh.mNumFaces = faces.size();
+        mesh.mVertices = positions.data();
+        mesh.mNormals = normals.data();
+        mesh.mTextureCoords[0] = uvs.data();
+        mesh.mTangents = tangents.data();
+        mesh.mBitangents = bitangents.data();
+        mesh.mFaces = faces.data();
+    }
+
+    // The arrays belong to the vectors, not to assimp
+    ~SyntheticMesh() {
+        for(aiFace& face : faces) face.mIndices = nullptr;
+        mesh.mNumFaces = 0;
+        mesh.mVertices = mesh.mNormals = mesh.mTangents = mesh.mBitangents = nullptr;
+        mesh.mTextureCoords[0] = nullptr;
+        mesh.mFaces = nullptr;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks
+
+std::vector<Result> runBenchmarks(const Options& options) {
+
+    std::vector<Result> results;
+    auto run = [&](const std::string& name, double items, auto f) {
+        if(!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+        results.push_back(measure(name, items, options, f));
+        std::cerr << name << std::endl;
+    };
+
+    std::vector<unsigned int> indices;
+    std::vector<Vec3f> vertices = sphereVertices(indices, 128, 128);
+    std::vector<Vec3f> triangles = unindexed(vertices, indices);
+
+    // Polytope tangents
+    run("polytope/tangents_indexed", indices.size() / 3, [&]() {
+        Polytope::calculateTangentsAndBitangents(vertices, indices);
+        sink = vertices[0].tanx;
+    });
+    run("polytope/tangents_non_indexed", triangles.size() / 3, [&]() {
+        Polytope::calculateTangentsAndBitangents(triangles);
+        sink = triangles[0].tanx;
+    });
+
+    // Sphere
+    {
+        std::vector<Vec3f> sphere;
+        std::vector<unsigned int> sphereIndices;
+        run("sphere/geometry_128x128", vertices.size(), [&]() {
+            Sphere::createSphereGeometry(1.0f, 128, 128, sphere, sphereIndices);
+            sink = sphere.back().z;
+        });
+    }
+
+    // Model
+    {
+        SyntheticMesh synthetic(vertices, indices);
+        std::vector<Vec3f> meshVertices;
+        std::vector<unsigned int> meshIndices;
+        run("model/convert_mesh", vertices.size(), [&]() {
+            Model::convertMesh(&synthetic.mesh, meshVertices, meshIndices);
+            sink = meshVertices.back().x;
+        });
+    }
+
+    // Vertex buffer layout
+    {
+        std::vector<float> data(vertices.size() * 17);
+        std::vector<Vec3f> readBack;
+        run("vertex_buffer/interleave", vertices.size(), [&]() {
+            VertexBuffer::interleave(vertices, data.data());
+            sink = data.back();
+        });
+        run("vertex_buffer/deinterleave", vertices.size(), [&]() {
+            VertexBuffer::deinterleave(data.data(), vertices.size(), readBack);
+            sink = readBack.back().bitanz;
+        });
+    }
+
+    // Shadow mapping
+    {
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.f / 9.f, 0.1f, 1000.f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0, 2, 10), glm::vec3(0), glm::vec3(0, 1, 0));
+        glm::vec3 lightPos(-2.0f, 4.0f, -1.0f);
+        ShadowCascades::Ptr shadowCascades = ShadowCascades::New();
+        run("shadow_cascades/update", SHADOW_MAX_CASCADES, [&]() {
+            shadowCascades->update(projection, view, lightPos, 0.1f, 100.f);
+            sink = shadowCascades->getCascade(SHADOW_MAX_CASCADES - 1).lightSpaceMatrix[0][0];
+        });
+
+        // Tiles of 128 to 1024 pixels, freed in a different order than allocated
+        ShadowAtlas::Ptr shadowAtlas = ShadowAtlas::New();
+        std::vector<ShadowAtlas::Tile> tiles(32);
+        run("shadow_atlas/allocate_free", tiles.size(), [&]() {
+            for(size_t i = 0; i < tiles.size(); i ++) tiles[i] = shadowAtlas->allocateTile(128u << (i % 4));
+            for(size_t i = 0; i < tiles.size(); i ++) shadowAtlas->freeTile(tiles[(i * 7) % tiles.size()]);
+            sink = shadowAtlas->getUsedArea();
+        });
+    }
+
+    // Clustered lighting
+    {
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.f / 9.f, 0.1f, 100.f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0, 10, 40), glm::vec3(0), glm::vec3(0, 1, 0));
+        std::vector<PointLight::Ptr> pointLights;
+        std::vector<Light*> lights;
+        for(int i = 0; i < 512; i ++) {
+            glm::vec3 position((i % 8) * 5.f - 17.5f, ((i / 8) % 8) * 2.f - 7.f, (i / 64) * 5.f - 17.5f);
+            pointLights.push_back(PointLight::New(position, glm::vec3(1), 1.f, 0.25f, 0.75f));
+            lights.push_back(pointLights.back().get());
+        }
+        LightClusters::Ptr clusters = LightClusters::New();
+        run("light_clusters/build_512", lights.size(), [&]() {
+            clusters->build(lights, projection, view, false);
+            sink = clusters->getIndexCount();
+        });
+    }
+
+    // Picking
+    {
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.f / 9.f, 0.1f, 1000.f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0, 0, 5), glm::vec3(0), glm::vec3(0, 1, 0));
+        glm::mat4 inverseProjection = glm::inverse(projection), inverseView = glm::inverse(view);
+        glm::vec3 eye(0, 0, 5);
+
+        int x = 0;
+        run("mouse_ray/get_ray", 1, [&]() {
+            x = (x + 7) % 1280;
+            sink = MouseRayCasting::getRay(inverseProjection, inverseView, eye, 1280, 720, x, 360).rayDirection.x;
+        });
+
+        MouseRayCasting::Ray ray = MouseRayCasting::getRay(inverseProjection, inverseView, eye, 1280, 720, 640, 360);
+        glm::mat4 model = glm::rotate(glm::mat4(1.0f), 0.5f, glm::vec3(0, 1, 0));
+        run("mouse_ray/pick_triangles", indices.size() / 3, [&]() {
+            float distance = 0.0f;
+            MouseRayCasting::intersect(ray, vertices, indices, model, distance);
+            sink = distance;
+        });
+    }
+
+    return results;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Results
+
+std::string toJSON(const std::vector<Result>& results) {
+
+    // A benchmark per line, so a baseline can be read back without a JSON library
+    std::ostringstream json;
+    json << "{" << std::endl << "  \"benchmarks\": [" << std::endl;
+    for(size_t i = 0; i < results.size(); i ++) {
+        json << "    { \"name\": \"" << results[i].name << "\", \"median_ns\": " << results[i].medianNs
+            << ", \"min_ns\": " << results[i].minNs << ", \"items_per_second\": " << results[i].itemsPerSecond << " }"
+            << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+    json << "  ]" << std::endl << "}" << std::endl;
+    return json.str();
+}
+
+bool readBaseline(const std::string& path, std::map<std::string, double>& baseline) {
+
+    std::ifstream file(path);
+    if(!file.is_open()) {
+        std::cout << "Couldn't read " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while(std::getline(file, line)) {
+        size_t name = line.find("\"name\": \"");
+        size_t median = line.find("\"median_ns\": ");
+        if(name == std::string::npos || median == std::string::npos) continue;
+
+        name += 9;
+        baseline[line.substr(name, line.find('"', name) - name)] = std::atof(line.c_str() + median + 13);
+    }
+    return true;
+}
+
+// Number of benchmarks slower than the baseline by more than the threshold
+int compare(const std::vector<Result>& results, const std::map<std::string, double>& baseline, double threshold) {
+
+    int regressions = 0;
+    for(const Result& result : results) {
+        auto it = baseline.find(result.name);
+        if(it == baseline.end() || it->second <= 0.0) {
+            std::cerr << result.name << ": not in the baseline" << std::endl;
+            continue;
+        }
+
+        double change = (result.medianNs / it->second - 1.0) * 100.0;
+        bool regression = change > threshold;
+        if(regression) regressions ++;
+
+        std::cerr << result.name << ": " << it->second << " ns -> " << result.medianNs << " ns ("
+            << (change >= 0 ? "+" : "") << change << "%)" << (regression ? " REGRESSION" : "") << std::endl;
+    }
+    return regressions;
+}
+
+void printUsage() {
+    std::cout << "renderergl_microbench [options]" << std::endl
+        << "  --filter TEXT            only the benchmarks which name contains TEXT" << std::endl
+        << "  --min-time MS            minimum time of a sample (20)" << std::endl
+        << "  --output FILE            write the JSON results to FILE instead of stdout" << std::endl
+        << "  --baseline FILE          compare against the results in FILE" << std::endl
+        << "  --threshold PERCENT      slowdown over the baseline counted as a regression (10)" << std::endl;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for(int i = 1; i < argc; i ++) {
+        std::string arg = argv[i];
+        if(i + 1 >= argc) return false;
+
+        if(arg == "--filter") options.filter = argv[++ i];
+        else if(arg == "--output") options.output = argv[++ i];
+        else if(arg == "--baseline") options.baseline = argv[++ i];
+        else if(arg == "--min-time") options.minTimeMs = std::max(0.1, std::atof(argv[++ i]));
+        else if(arg == "--threshold") options.threshold = std::max(0.0, std::atof(argv[++ i]));
+        else return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+
+    Options options;
+    if(!parseOptions(argc, argv, options)) {
+        printUsage();
+        return -1;
+    }
+
+    std::map<std::string, double> baseline;
+    if(!options.baseline.empty() && !readBaseline(options.baseline, baseline)) return -1;
+
+    std::vector<Result> results = runBenchmarks(options);
+    std::string json = toJSON(results);
+
+    if(options.output.empty()) std::cout << json;
+    else {
+        std::ofstream file(options.output);
+        if(!file.is_open()) {
+            std::cout << "Couldn't write " << options.output << std::endl;
+            return -1;
+        }
+        file << json;
+    }
+
+    // Non zero exit code for CI when something got slower
+    if(!options.baseline.empty() && compare(results, baseline, options.threshold) > 0) return 1;
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "HeadlessContext.h"
+
+#include <cstring>
+
+static bool hasExtension(const char* extensions, const char* extension) {
+    return extensions != nullptr && std::strstr(extensions, extension) != nullptr;
+}
+
+HeadlessContext::HeadlessContext()
+    : display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT), surface(EGL_NO_SURFACE) {
+}
+
+HeadlessContext::~HeadlessContext() {
+    destroy();
+}
+
+EGLDisplay HeadlessContext::getDisplay() {
+
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    if(getPlatformDisplay != nullptr && hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        EGLDisplay surfaceless = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if(surfaceless != EGL_NO_DISPLAY) return surfaceless;
+    }
+
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+bool HeadlessContext::create() {
+
+    display = getDisplay();
+
+    EGLint major, minor;
+    if(display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        std::cout << "Couldn't initialize EGL" << std::endl;
+        return false;
+    }
+
+    if(!eglBindAPI(EGL_OPENGL_API)) {
+        std::cout << "EGL doesn't support desktop OpenGL" << std::endl;
+        return false;
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+
+    EGLConfig config = nullptr;
+    EGLint configs = 0;
+    eglChooseConfig(display, configAttributes, &config, 1, &configs);
+
+    // The surfaceless platform may have no pbuffer configs, a context without config is fine there
+    if(configs == 0 && !hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_no_config_context")) {
+        std::cout << "No EGL config for OpenGL" << std::endl;
+        return false;
+    }
+
+    // Same as a default GLFW window: highest version the driver has
+    context = eglCreateContext(display, configs > 0 ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, nullptr);
+    if(context == EGL_NO_CONTEXT) {
+        std::cout << "Couldn't create the EGL context" << std::endl;
+        return false;
+    }
+
+    if(!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        if(configs == 0) {
+            std::cout << "Couldn't make the EGL context current" << std::endl;
+            destroy();
+            return false;
+        }
+
+        const EGLint pbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, pbufferAttributes);
+        if(surface == EGL_NO_SURFACE || !eglMakeCurrent(display, surface, surface, context)) {
+            std::cout << "Couldn't make the EGL context current" << std::endl;
+            destroy();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void HeadlessContext::destroy() {
+
+    if(display == EGL_NO_DISPLAY) return;
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if(surface != EGL_NO_SURFACE) eglDestroySurface(display, surface);
+    if(context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+    eglTerminate(display);
+
+    display = EGL_NO_DISPLAY;
+    context = EGL_NO_CONTEXT;
+    surface = EGL_NO_SURFACE;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <iostream>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+/**
+ * @brief OpenGL context without window nor display, made with EGL.
+ *
+ * The Mesa surfaceless platform is used when available, so it runs on llvmpipe without
+ * a GPU. Otherwise the default display is used, with a 1x1 pbuffer if the context can't be
+ * made current without a surface. The renderer draws into its own framebuffers anyway.
+ */
+class HeadlessContext {
+private:
+    EGLDisplay display;
+    EGLContext context;
+    EGLSurface surface;
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+private:
+    EGLDisplay getDisplay();
+public:
+    bool create();
+    void destroy();
+public:
+    inline bool isValid() const { return context != EGL_NO_CONTEXT; }
+};
\ No newline at end of file
@@ -0,0 +1,454 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include <engine/renderer/Renderer.h>
+#include <engine/renderer/TrackballCamera.h>
+#include <engine/opengl/device/NullRenderDevice.h>
+#include <engine/opengl/device/GLRenderDevice.h>
+#include <engine/opengl/device/CaptureRenderDevice.h>
+#include "HeadlessContext.h"
+#include "SceneGenerator.h"
+
+struct Options {
+    unsigned int width = 1280, height = 720;
+    unsigned int warmupFrames = 60, frames = 300;
+    SceneGenerator::Config scene;
+    bool shadows = false, hdr = false, pbr = false, multiDraw = false, deferred = false, depthPrePass = false;
+    bool objectLighting = false;
+    bool gpuCulling = false;
+    bool occlusionQueries = false;
+    bool softwareOcclusion = false;
+    float occluderRatio = 1.f;
+    unsigned int occlusionThreads = 0;
+    bool nullDevice = false;
+    bool bufferHeap = false;
+    unsigned int shadowSize = SHADOW_CASCADE_SIZE;
+    GLenum shadowFormat = SHADOW_DEPTH_FORMAT;
+    ShadowCascades::Filter shadowFilter = ShadowCascades::POISSON;
+    ShadowCascades::Quality shadowQuality = ShadowCascades::MEDIUM;
+    bool shadowCache = true;
+    unsigned int dynamicGroups = 0;
+    unsigned int pointShadows = 0;
+    Polytope::PositionStream positionStream = Polytope::PositionStream::NONE;
+    std::string capture, output;
+};
+
+void printUsage() {
+    std::cout << "renderergl_bench [options]" << std::endl
+        << "  --width N --height N     viewport (1280x720)" << std::endl
+        << "  --warmup N --frames N    warm-up and measured frames (60, 300)" << std::endl
+        << "  --scene grid|scatter|points" << std::endl
+        << "  --seed N                 scene generator seed (1)" << std::endl
+        << "  --objects N              polytopes, or points of the point clouds (1000)" << std::endl
+        << "  --triangles N            triangles per polytope, cubes up to 12, spheres above (12)" << std::endl
+        << "  --per-group N            polytopes per group (64)" << std::endl
+        << "  --depth N                levels of nested scenes (1)" << std::endl
+        << "  --materials N            different materials (8)" << std::endl
+        << "  --textures N             different diffuse textures (0)" << std::endl
+        << "  --transparent PERCENT    polytopes with a translucent texture (0)" << std::endl
+        << "  --lights N               point lights (1)" << std::endl
+        << "  --light-range R          attenuation radius of the lights, 0: PointLight defaults (0)" << std::endl
+        << "  --unique-geometry        a vertex buffer per polytope instead of shared ones" << std::endl
+        << "  --buffer-heap            vertex and index buffers sub-allocated from a few big GL buffers" << std::endl
+        << "  --shadows --hdr --pbr --mdi" << std::endl
+        << "  --shadow-size N          width and height of every shadow cascade (2048)" << std::endl
+        << "  --shadow-format 16|24|32f  depth format of the shadow maps (24)" << std::endl
+        << "  --shadow-filter hardware|poisson|rotated|pcss  shadow filter (poisson)" << std::endl
+        << "  --shadow-quality low|medium|high|ultra  4, 8, 16 or 32 samples of the filter (medium)" << std::endl
+        << "  --no-shadow-cache        render the shadows of the static casters every frame" << std::endl
+        << "  --dynamic-groups N       groups which rotate every frame, dynamic shadow casters (0)" << std::endl
+        << "  --point-shadows N        cube shadows of the N most important point lights, 0: none (0)" << std::endl
+        << "  --deferred               deferred shading of the opaque polytopes, with --pbr" << std::endl
+        << "  --object-lights          a light list per draw instead of the clustered lighting" << std::endl
+        << "  --gpu-culling            frustum and occlusion culling of the multi draw batches in a compute shader, with --mdi" << std::endl
+        << "  --occlusion-queries      hardware occlusion queries of the last frame and conditional rendering" << std::endl
+        << "  --software-occlusion     occlusion culling against the occluders rasterized on the CPU" << std::endl
+        << "  --occluders PERCENT      opaque polytopes which are occluders, with --software-occlusion (100)" << std::endl
+        << "  --occlusion-threads N    threads of the software rasterizer, 0: up to 4 hardware threads (0)" << std::endl
+        << "  --depth-prepass          depth only pass of the opaque polytopes before shading them" << std::endl
+        << "  --position-stream none|float|quantized  position only vertex buffers of the depth passes (none)" << std::endl
+        << "  --null-device            record the GL commands without executing them, no GL context" << std::endl
+        << "  --capture FILE           write the GL commands of every frame to FILE, see renderergl_replay" << std::endl
+        << "  --output FILE            write the JSON results to FILE instead of stdout" << std::endl;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+
+    SceneGenerator::Config& scene = options.scene;
+
+    for(int i = 1; i < argc; i ++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if(arg == "--shadows") options.shadows = true;
+        else if(arg == "--hdr") options.hdr = true;
+        else if(arg == "--pbr") options.pbr = true;
+        else if(arg == "--mdi") options.multiDraw = true;
+        else if(arg == "--deferred") options.deferred = true;
+        else if(arg == "--depth-prepass") options.depthPrePass = true;
+        else if(arg == "--null-device") options.nullDevice = true;
+        else if(arg == "--no-shadow-cache") options.shadowCache = false;
+        else if(arg == "--object-lights") options.objectLighting = true;
+        else if(arg == "--gpu-culling") options.gpuCulling = true;
+        else if(arg == "--occlusion-queries") options.occlusionQueries = true;
+        else if(arg == "--software-occlusion") options.softwareOcclusion = true;
+        else if(arg == "--unique-geometry") scene.shareGeometry = false;
+        else if(arg == "--buffer-heap") options.bufferHeap = true;
+        else if(arg == "--output" && hasValue) options.output = argv[++ i];
+        else if(arg == "--capture" && hasValue) options.capture = argv[++ i];
+        else if(arg == "--light-range" && hasValue) scene.lightRange = std::max(0.f, (float)std::atof(argv[++ i]));
+        else if(arg == "--shadow-format" && hasValue) {
+            std::string format = argv[++ i];
+            if(format == "16") options.shadowFormat = GL_DEPTH_COMPONENT16;
+            else if(format == "24") options.shadowFormat = GL_DEPTH_COMPONENT24;
+            else if(format == "32f") options.shadowFormat = GL_DEPTH_COMPONENT32F;
+            else return false;
+        }
+        else if(arg == "--shadow-filter" && hasValue) {
+            std::string filter = argv[++ i];
+            if(filter == "hardware") options.shadowFilter = ShadowCascades::HARDWARE;
+            else if(filter == "poisson") options.shadowFilter = ShadowCascades::POISSON;
+            else if(filter == "rotated") options.shadowFilter = ShadowCascades::ROTATED_DISK;
+            else if(filter == "pcss") options.shadowFilter = ShadowCascades::PCSS;
+            else return false;
+        }
+        else if(arg == "--shadow-quality" && hasValue) {
+            std::string quality = argv[++ i];
+            if(quality == "low") options.shadowQuality = ShadowCascades::LOW;
+            else if(quality == "medium") options.shadowQuality = ShadowCascades::MEDIUM;
+            else if(quality == "high") options.shadowQuality = ShadowCascades::HIGH;
+            else if(quality == "ultra") options.shadowQuality = ShadowCascades::ULTRA;
+            else return false;
+        }
+        else if(arg == "--position-stream" && hasValue) {
+            std::string stream = argv[++ i];
+            if(stream == "none") options.positionStream = Polytope::PositionStream::NONE;
+            else if(stream == "float") options.positionStream = Polytope::PositionStream::FLOAT;
+            else if(stream == "quantized") options.positionStream = Polytope::PositionStream::QUANTIZED;
+            else return false;
+        }
+        else if(arg == "--scene" && hasValue) {
+            bool valid;
+            scene.layout = SceneGenerator::parseLayout(argv[++ i], valid);
+            if(!valid) return false;
+        }
+        else if(hasValue) {
+            unsigned int value = std::max(0, std::atoi(argv[i + 1]));
+            if(arg == "--width") options.width = std::max(1u, value);
+            else if(arg == "--height") options.height = std::max(1u, value);
+            else if(arg == "--warmup") options.warmupFrames = value;
+            else if(arg == "--frames") options.frames = std::max(1u, value);
+            else if(arg == "--seed") scene.seed = value;
+            else if(arg == "--objects") scene.objects = value;
+            else if(arg == "--triangles") scene.trianglesPerObject = value;
+            else if(arg == "--per-group") scene.objectsPerGroup = std::max(1u, value);
+            else if(arg == "--depth") scene.depth = std::max(1u, value);
+            else if(arg == "--materials") scene.materials = std::max(1u, value);
+            else if(arg == "--textures") scene.textures = value;
+            else if(arg == "--transparent") scene.transparentRatio = std::min(100u, value) / 100.f;
+            else if(arg == "--occluders") options.occluderRatio = std::min(100u, value) / 100.f;
+            else if(arg == "--occlusion-threads") options.occlusionThreads = value;
+            else if(arg == "--lights") scene.lights = value;
+            else if(arg == "--shadow-size") options.shadowSize = std::max(1u, value);
+            else if(arg == "--dynamic-groups") options.dynamicGroups = value;
+            else if(arg == "--point-shadows") options.pointShadows = value;
+            else return false;
+            i ++;
+        }
+        else return false;
+    }
+    return true;
+}
+
+void collectGroups(Scene::Ptr& scene, std::vector<Group::Ptr>& groups) {
+    for(auto& group : scene->getGroups()) groups.push_back(group);
+    for(auto& child : scene->getScenes()) collectGroups(child, groups);
+}
+
+void addToArena(GeometryArena::Ptr& arena, Scene::Ptr& scene) {
+    for(auto& group : scene->getGroups()) arena->add(group);
+    for(auto& child : scene->getScenes()) addToArena(arena, child);
+}
+
+double percentile(std::vector<double> values, double p) {
+    if(values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)std::ceil(p / 100.0 * values.size());
+    return values[std::min(values.size(), std::max<size_t>(index, 1)) - 1];
+}
+
+// Resident and peak memory of the process in KB, 0 where /proc isn't available
+void processMemory(size_t& resident, size_t& peak) {
+    resident = peak = 0;
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while(std::getline(status, line)) {
+        if(line.compare(0, 6, "VmRSS:") == 0) resident = std::atol(line.c_str() + 6);
+        else if(line.compare(0, 6, "VmHWM:") == 0) peak = std::atol(line.c_str() + 6);
+    }
+}
+
+void writeHeap(std::ostream& json, const char* name, const BufferHeap::Ptr& heap, bool last) {
+    BufferHeap::Stats stats = heap != nullptr ? heap->getStats() : BufferHeap::Stats{ 0, 0, 0, 0, 0, 0, 0 };
+    json << "    \"" << name << "\": { \"capacity\": " << stats.capacity << ", \"used\": " << stats.used
+        << ", \"fragmented\": " << stats.fragmented << ", \"allocations\": " << stats.allocations << " }"
+        << (last ? "" : ",") << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+    Options options;
+    if(!parseOptions(argc, argv, options)) {
+        printUsage();
+        return -1;
+    }
+
+    // The null device measures the renderer CPU time alone
+    HeadlessContext context;
+    NullRenderDevice::Ptr nullDevice = nullptr;
+    if(options.nullDevice) {
+        nullDevice = NullRenderDevice::New();
+        nullDevice->setRecording(false);
+        RenderDevice::set(nullDevice);
+    }
+    else if(!context.create()) return -1;
+
+    // The capture has to see the creation of every resource
+    CaptureRenderDevice::Ptr captureDevice = nullptr;
+    if(!options.capture.empty()) {
+        RenderDevice::Ptr wrapped = nullDevice != nullptr ? RenderDevice::Ptr(nullDevice) : GLRenderDevice::New();
+        captureDevice = CaptureRenderDevice::New(wrapped, options.capture);
+        if(!captureDevice->isOpen()) return -1;
+        RenderDevice::set(captureDevice);
+    }
+    RenderDevice* device = RenderDevice::get();
+
+    // Renderer
+    Renderer::Ptr renderer = Renderer::New(options.width, options.height);
+
+    renderer->setShadowMapping(options.shadows && options.scene.lights > 0);
+    renderer->setShadowLightPos(glm::vec3(-2.f, 4.f, -1.f));
+    renderer->getShadowCascades()->setSize(options.shadowSize);
+    renderer->getShadowCascades()->setFormat(options.shadowFormat);
+    renderer->getShadowCascades()->setCaching(options.shadowCache);
+    renderer->getShadowCascades()->setFilter(options.shadowFilter);
+    renderer->getShadowCascades()->setQuality(options.shadowQuality);
+    renderer->setPointShadowMapping(options.pointShadows > 0);
+    renderer->getPointShadows()->setBudget(options.pointShadows);
+    renderer->getPointShadows()->setCaching(options.shadowCache);
+    renderer->getPointShadows()->setFilter(options.shadowFilter);
+    renderer->getPointShadows()->setQuality(options.shadowQuality);
+    renderer->setHDR(options.hdr);
+    renderer->setPBREnabled(options.pbr);
+    renderer->setMultiDrawIndirect(options.multiDraw);
+    renderer->setDeferred(options.deferred);
+    renderer->setDepthPrePass(options.depthPrePass);
+    renderer->setObjectLighting(options.objectLighting);
+    renderer->setGPUCulling(options.gpuCulling);
+    renderer->setOcclusionCulling(options.occlusionQueries);
+    renderer->setSoftwareOcclusion(options.softwareOcclusion);
+    if(options.softwareOcclusion && options.occlusionThreads > 0) renderer->getSoftwareOcclusion()->setThreads(options.occlusionThreads);
+
+    // Scene
+    auto buildStart = std::chrono::high_resolution_clock::now();
+    if(options.bufferHeap) {
+        VertexBuffer::setHeap(BufferHeap::New());
+        IndexBuffer::setHeap(BufferHeap::New());
+    }
+    Polytope::setDefaultPositionStream(options.positionStream);
+    if(options.softwareOcclusion) options.scene.occluderRatio = options.occluderRatio;
+    SceneGenerator generator(options.scene);
+    SceneGenerator::GeneratedScene scene = generator.generate();
+    scene.addTo(renderer);
+    if(renderer->isMultiDrawIndirect()) addToArena(renderer->getGeometryArena(), scene.scene);
+
+    // Moving groups, the others keep their cached shadows
+    std::vector<Group::Ptr> dynamicGroups;
+    collectGroups(scene.scene, dynamicGroups);
+    dynamicGroups.resize(std::min<size_t>(dynamicGroups.size(), options.dynamicGroups));
+    for(auto& group : dynamicGroups) group->setDynamicShadow(true);
+    auto animate = [&]() {
+        for(auto& group : dynamicGroups) group->rotate(0.5f, glm::vec3(0.f, 1.f, 0.f));
+    };
+
+    // Freed ranges are reused once the GPU is done, a little compaction every frame
+    auto collectHeaps = [&]() {
+        for(const BufferHeap::Ptr& heap : { VertexBuffer::getHeap(), IndexBuffer::getHeap() }) {
+            if(heap == nullptr) continue;
+            heap->collect();
+            heap->compact(1 << 20);
+        }
+    };
+    device->finish();
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - buildStart).count();
+
+    double aspectRatio = static_cast<double>(options.width) / options.height;
+    TrackballCamera::Ptr camera = TrackballCamera::perspectiveCamera(glm::radians(45.0f), aspectRatio, 0.1, std::max(1000.f, scene.radius * 4.f));
+    camera->zoom(-scene.radius * 2.5f);
+    renderer->setCamera(std::dynamic_pointer_cast<Camera>(camera));
+
+    // Warm-up: shaders, driver caches and the GPU profiler ring
+    for(unsigned int i = 0; i < options.warmupFrames; i ++) {
+        animate();
+        renderer->render();
+        collectHeaps();
+    }
+    device->finish();
+
+    renderer->getStats()->setHistorySize(options.frames);
+    if(nullDevice != nullptr) nullDevice->reset();
+
+    // Measured frames. CPU time is the render call, frame time waits for the GPU too
+    std::vector<double> cpuTimes, frameTimes;
+    for(unsigned int i = 0; i < options.frames; i ++) {
+        animate();
+        auto start = std::chrono::high_resolution_clock::now();
+        renderer->render();
+        collectHeaps();
+        auto submitted = std::chrono::high_resolution_clock::now();
+        device->finish();
+        auto end = std::chrono::high_resolution_clock::now();
+
+        cpuTimes.push_back(std::chrono::duration<double, std::milli>(submitted - start).count());
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    RenderStats::AverageFrame average = renderer->getStats()->getAverage();
+    size_t resident, peak;
+    processMemory(resident, peak);
+
+    // Results
+    std::ostringstream json;
+    json.precision(10);    // averaged byte counts
+    json << "{" << std::endl;
+    json << "  \"device\": \"" << device->getName() << "\"," << std::endl;
+    json << "  \"renderer\": \"" << device->getString(GL_RENDERER) << "\"," << std::endl;
+    json << "  \"version\": \"" << device->getString(GL_VERSION) << "\"," << std::endl;
+    const SceneGenerator::Config& config = options.scene;
+    json << "  \"config\": { \"width\": " << options.width << ", \"height\": " << options.height
+        << ", \"warmupFrames\": " << options.warmupFrames << ", \"frames\": " << options.frames
+        << ", \"shadows\": " << (options.shadows ? "true" : "false") << ", \"shadowSize\": " << options.shadowSize
+        << ", \"shadowFilter\": \"" << ShadowCascades::getFilterName(options.shadowFilter) << "\", \"shadowSamples\": " << ShadowCascades::getSamples(options.shadowQuality)
+        << ", \"shadowCache\": " << (options.shadowCache ? "true" : "false") << ", \"dynamicGroups\": " << options.dynamicGroups
+        << ", \"pointShadows\": " << options.pointShadows
+        << ", \"shadowFormat\": \"" << (options.shadowFormat == GL_DEPTH_COMPONENT16 ? "16" : options.shadowFormat == GL_DEPTH_COMPONENT24 ? "24" : "32f") << "\""
+        << ", \"hdr\": " << (options.hdr ? "true" : "false")
+        << ", \"pbr\": " << (options.pbr ? "true" : "false") << ", \"deferred\": " << (options.deferred ? "true" : "false")
+        << ", \"depthPrePass\": " << (options.depthPrePass ? "true" : "false")
+        << ", \"objectLighting\": " << (options.objectLighting ? "true" : "false")
+        << ", \"positionStream\": \"" << (options.positionStream == Polytope::PositionStream::NONE ? "none" : options.positionStream == Polytope::PositionStream::FLOAT ? "float" : "quantized") << "\""
+        << ", \"bufferHeap\": " << (options.bufferHeap ? "true" : "false")
+        << ", \"multiDraw\": " << (renderer->isMultiDrawIndirect() ? "true" : "false")
+        << ", \"gpuCulling\": " << (renderer->isGPUCulling() ? "true" : "false")
+        << ", \"occlusionQueries\": " << (renderer->isOcclusionCulling() ? "true" : "false")
+        << ", \"softwareOcclusion\": " << (renderer->isSoftwareOcclusion() ? "true" : "false") << " }," << std::endl;
+    json << "  \"scene\": { \"layout\": \"" << SceneGenerator::getLayoutName(config.layout) << "\", \"seed\": " << config.seed
+        << ", \"objects\": " << config.objects << ", \"trianglesPerObject\": " << config.trianglesPerObject
+        << ", \"depth\": " << config.depth << ", \"materials\": " << config.materials << ", \"textures\": " << config.textures
+        << ", \"transparentRatio\": " << config.transparentRatio << ", \"lights\": " << config.lights << ", \"lightRange\": " << config.lightRange
+        << ", \"polytopes\": " << scene.polytopes << ", \"groups\": " << scene.groups << ", \"scenes\": " << scene.scenes
+        << ", \"triangles\": " << scene.triangles << ", \"points\": " << scene.points << " }," << std::endl;
+    json << "  \"sceneBuildMs\": " << buildMs << "," << std::endl;
+
+    for(auto& series : { std::make_pair("cpuMs", &cpuTimes), std::make_pair("frameMs", &frameTimes) }) {
+        json << "  \"" << series.first << "\": { \"p50\": " << percentile(*series.second, 50)
+            << ", \"p95\": " << percentile(*series.second, 95) << ", \"p99\": " << percentile(*series.second, 99)
+            << ", \"max\": " << percentile(*series.second, 100) << " }," << std::endl;
+    }
+
+    json << "  \"gpuMs\": {";
+    const std::vector<GPUProfiler::Scope>& scopes = renderer->getGPUProfiler()->getScopes();
+    for(size_t i = 0; i < scopes.size(); i ++)
+        json << (i == 0 ? " " : ", ") << "\"" << scopes[i].name << "\": " << scopes[i].average;
+    json << " }," << std::endl;
+
+    json << "  \"stats\": { \"drawCalls\": " << average.total.drawCalls << ", \"instances\": " << average.total.instances
+        << ", \"triangles\": " << average.total.triangles << ", \"programBinds\": " << average.total.programBinds
+        << ", \"textureBinds\": " << average.total.textureBinds << ", \"uploadedBytes\": " << average.total.uploadedBytes
+        << ", \"vertexBytes\": " << average.total.vertexBytes << " }," << std::endl;
+
+    // Point lights per draw of the last frame, against all the point lights of the clustered lighting
+    if(options.objectLighting) {
+        const ObjectLights::Ptr& objectLights = renderer->getObjectLights();
+        json << "  \"objectLights\": { \"lights\": " << objectLights->getLightCount() << ", \"draws\": " << objectLights->getQueries()
+            << ", \"lightsPerDraw\": " << objectLights->getLightsPerQuery() << " }," << std::endl;
+    }
+
+    // Draws given to the culling in the last frame and the ones it kept, read back from the GPU
+    if(renderer->isMultiDrawIndirect() && renderer->isGPUCulling()) {
+        const GPUCulling::Ptr& gpuCulling = renderer->getGPUCulling();
+        json << "  \"gpuCulling\": { \"draws\": " << gpuCulling->getSubmittedDraws() << ", \"visible\": " << gpuCulling->readVisibleDraws()
+            << ", \"compaction\": " << (gpuCulling->isCompaction() ? "true" : "false") << " }," << std::endl;
+    }
+
+    // Queries of the last frame, the nodes drawn conditionally and the results read which found them hidden
+    if(renderer->isOcclusionCulling()) {
+        const OcclusionQueries::Ptr& queries = renderer->getOcclusionQueries();
+        const OcclusionQueries::Ptr& gBufferQueries = renderer->getGBufferOcclusionQueries();
+        json << "  \"occlusionQueries\": { \"queries\": " << queries->getQueries() + gBufferQueries->getQueries()
+            << ", \"conditional\": " << queries->getConditionalNodes() + gBufferQueries->getConditionalNodes()
+            << ", \"occluded\": " << queries->getOccludedNodes() + gBufferQueries->getOccludedNodes()
+            << ", \"nodes\": " << queries->getNodeCount() + gBufferQueries->getNodeCount() << " }," << std::endl;
+    }
+
+    // Occluder triangles of the last frame, the time to rasterize them and the tests of the draws against them
+    if(renderer->isSoftwareOcclusion()) {
+        const SoftwareOcclusion::Ptr& occlusion = renderer->getSoftwareOcclusion();
+        json << "  \"softwareOcclusion\": { \"width\": " << occlusion->getWidth() << ", \"height\": " << occlusion->getHeight()
+            << ", \"threads\": " << occlusion->getThreads() << ", \"occluderRatio\": " << config.occluderRatio
+            << ", \"triangles\": " << occlusion->getTriangleCount() << ", \"rasterizeMs\": " << occlusion->getRasterizeTime()
+            << ", \"tested\": " << occlusion->getTested() << ", \"culled\": " << occlusion->getCulled() << " }," << std::endl;
+    }
+
+    // What each pass costs, the depth pre-pass against what it saves in the scene pass
+    json << "  \"passes\": {";
+    for(int pass = 0; pass < RenderStats::PASS_COUNT; pass ++) {
+        const RenderStats::AverageCounters& counters = average.passes[pass];
+        json << (pass == 0 ? " " : ", ") << "\"" << RenderStats::getPassName(static_cast<RenderStats::Pass>(pass))
+            << "\": { \"drawCalls\": " << counters.drawCalls << ", \"triangles\": " << counters.triangles
+            << ", \"vertexBytes\": " << counters.vertexBytes << " }";
+    }
+    json << " }," << std::endl;
+
+    if(nullDevice != nullptr) {
+        json << "  \"commandsPerFrame\": {";
+        for(int type = 0; type < NullRenderDevice::COMMAND_TYPE_COUNT; type ++) {
+            NullRenderDevice::CommandType commandType = static_cast<NullRenderDevice::CommandType>(type);
+            json << (type == 0 ? " " : ", ") << "\"" << NullRenderDevice::getCommandName(commandType) << "\": "
+                << (double)nullDevice->getCount(commandType) / options.frames;
+        }
+        json << " }," << std::endl;
+    }
+
+    json << "  \"memory\": {" << std::endl;
+    json << "    \"residentKB\": " << resident << "," << std::endl;
+    json << "    \"peakResidentKB\": " << peak << "," << std::endl;
+    writeHeap(json, "vertexHeap", VertexBuffer::getHeap(), false);
+    writeHeap(json, "indexHeap", IndexBuffer::getHeap(), true);
+    json << "  }" << std::endl;
+    json << "}" << std::endl;
+
+    // The buffers still alive release the heaps, while the context exists
+    VertexBuffer::setHeap(nullptr);
+    IndexBuffer::setHeap(nullptr);
+
+    if(options.output.empty()) std::cout << json.str();
+    else {
+        std::ofstream file(options.output);
+        if(!file.is_open()) {
+            std::cout << "Couldn't write " << options.output << std::endl;
+            return -1;
+        }
+        file << json.str();
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include <engine/opengl/device/CommandReplayer.h>
+#include <engine/opengl/device/NullRenderDevice.h>
+#include "HeadlessContext.h"
+
+struct Options {
+    std::string capture;
+    unsigned int loops = 10;
+    bool nullDevice = false;
+    std::string output;
+};
+
+void printUsage() {
+    std::cout << "renderergl_replay [options] CAPTURE" << std::endl
+        << "  --loops N                times the captured frames are replayed (10)" << std::endl
+        << "  --null-device            replay on the null device, no GL context" << std::endl
+        << "  --output FILE            write the JSON results to FILE instead of stdout" << std::endl;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for(int i = 1; i < argc; i ++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if(arg == "--null-device") options.nullDevice = true;
+        else if(arg == "--output" && hasValue) options.output = argv[++ i];
+        else if(arg == "--loops" && hasValue) options.loops = std::max(1, std::atoi(argv[++ i]));
+        else if(arg.compare(0, 2, "--") != 0 && options.capture.empty()) options.capture = arg;
+        else return false;
+    }
+    return !options.capture.empty();
+}
+
+double percentile(std::vector<double> values, double p) {
+    if(values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)std::ceil(p / 100.0 * values.size());
+    return values[std::min(values.size(), std::max<size_t>(index, 1)) - 1];
+}
+
+int main(int argc, char* argv[]) {
+
+    Options options;
+    if(!parseOptions(argc, argv, options)) {
+        printUsage();
+        return -1;
+    }
+
+    HeadlessContext context;
+    if(options.nullDevice) {
+        NullRenderDevice::Ptr nullDevice = NullRenderDevice::New();
+        nullDevice->setRecording(false);
+        RenderDevice::set(nullDevice);
+    }
+    else if(!context.create()) return -1;
+    RenderDevice* device = RenderDevice::get();
+    if(!device->init()) return -1;
+
+    CommandReplayer::Ptr replayer = CommandReplayer::New();
+    if(!replayer->load(options.capture)) return -1;
+
+    // The first frame creates the resources
+    auto setupStart = std::chrono::high_resolution_clock::now();
+    if(!replayer->replayFrame()) {
+        std::cout << "The capture has no frames" << std::endl;
+        return -1;
+    }
+    device->finish();
+    double setupMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - setupStart).count();
+    size_t setupCommands = replayer->getCommands();
+
+    // The next ones are replayed in a loop as fast as possible
+    std::vector<double> frameTimes;
+    auto replayStart = std::chrono::high_resolution_clock::now();
+    for(unsigned int loop = 0; loop < options.loops; loop ++) {
+        replayer->rewind(1);
+        while(true) {
+            auto start = std::chrono::high_resolution_clock::now();
+            if(!replayer->replayFrame()) break;
+            device->finish();
+            frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+        }
+        if(replayer->hasFailed() || frameTimes.empty()) break;
+    }
+    double replayMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - replayStart).count();
+
+    if(replayer->hasFailed()) return -1;
+    size_t frames = frameTimes.size();
+    size_t framesPerLoop = options.loops > 0 ? frames / options.loops : 0;
+
+    // Results
+    std::ostringstream json;
+    json << "{" << std::endl;
+    json << "  \"device\": \"" << device->getName() << "\"," << std::endl;
+    json << "  \"renderer\": \"" << device->getString(GL_RENDERER) << "\"," << std::endl;
+    json << "  \"version\": \"" << device->getString(GL_VERSION) << "\"," << std::endl;
+    json << "  \"capture\": { \"path\": \"" << options.capture << "\", \"bytes\": " << replayer->getSize()
+        << ", \"frames\": " << framesPerLoop + 1 << " }," << std::endl;
+    json << "  \"setupMs\": " << setupMs << "," << std::endl;
+    json << "  \"setupCommands\": " << setupCommands << "," << std::endl;
+    json << "  \"replayedFrames\": " << frames << "," << std::endl;
+    json << "  \"commandsPerFrame\": " << (frames > 0 ? (double)(replayer->getCommands() - setupCommands) / frames : 0.0) << "," << std::endl;
+    json << "  \"framesPerSecond\": " << (replayMs > 0.0 ? frames * 1000.0 / replayMs : 0.0) << "," << std::endl;
+    json << "  \"frameMs\": { \"p50\": " << percentile(frameTimes, 50) << ", \"p95\": " << percentile(frameTimes, 95)
+        << ", \"p99\": " << percentile(frameTimes, 99) << ", \"max\": " << percentile(frameTimes, 100) << " }" << std::endl;
+    json << "}" << std::endl;
+
+    if(options.output.empty()) std::cout << json.str();
+    else {
+        std::ofstream file(options.output);
+        if(!file.is_open()) {
+            std::cout << "Couldn't write " << options.output << std::endl;
+            return -1;
+        }
+        file << json.str();
+    }
+
+    return 0;
+}
\ No newline at end of file
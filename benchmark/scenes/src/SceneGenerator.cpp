@@ -0,0 +1,318 @@
+#include "SceneGenerator.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include <engine/shapes/Cube.h>
+#include <engine/shapes/Sphere.h>
+
+#define TEXTURE_SIZE 64
+#define TRANSLUCENT_ALPHA 96
+#define POINT_CLOUD_RADIUS 10.f
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Presets
+
+SceneGenerator::Config SceneGenerator::Config::grid(unsigned int objects) {
+    Config config;
+    config.objects = objects;
+    return config;
+}
+
+SceneGenerator::Config SceneGenerator::Config::nested(unsigned int objects, unsigned int depth) {
+    Config config;
+    config.objects = objects;
+    config.depth = depth;
+    config.objectsPerGroup = 16;
+    return config;
+}
+
+SceneGenerator::Config SceneGenerator::Config::manyLights(unsigned int objects, unsigned int lights) {
+    Config config;
+    config.layout = Layout::Scatter;
+    config.objects = objects;
+    config.lights = lights;
+    config.lightRange = config.spacing * 2.f;
+    return config;
+}
+
+SceneGenerator::Config SceneGenerator::Config::pointCloud(unsigned int points) {
+    Config config;
+    config.layout = Layout::PointCloud;
+    config.objects = points;
+    config.lights = 0;
+    return config;
+}
+
+SceneGenerator::Config SceneGenerator::Config::mixed(unsigned int objects) {
+    Config config;
+    config.layout = Layout::Scatter;
+    config.objects = objects;
+    config.trianglesPerObject = 256;
+    config.materials = 16;
+    config.textures = 4;
+    config.transparentRatio = 0.25f;
+    config.lights = 4;
+    return config;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SceneGenerator::GeneratedScene::addTo(const Renderer::Ptr& renderer) {
+    renderer->addScene(scene);
+    for(auto& light : lights) renderer->addLight(*light);
+}
+
+SceneGenerator::SceneGenerator(const Config& _config)
+    : config(_config), random(_config.seed) {
+}
+
+float SceneGenerator::uniform() {
+    return (random() >> 8) * (1.f / 16777216.f);
+}
+
+float SceneGenerator::uniform(float min, float max) {
+    return min + (max - min) * uniform();
+}
+
+glm::vec3 SceneGenerator::color() {
+    float r = uniform(), g = uniform(), b = uniform();
+    return glm::vec3(r, g, b);
+}
+
+glm::vec3 SceneGenerator::insideSphere(float radius) {
+    // Rejection sampling, the evaluation order is fixed so it doesn't depend on the compiler
+    while(true) {
+        float x = uniform(-1.f, 1.f);
+        float y = uniform(-1.f, 1.f);
+        float z = uniform(-1.f, 1.f);
+        if(x * x + y * y + z * z <= 1.f) return glm::vec3(x, y, z) * radius;
+    }
+}
+
+void SceneGenerator::createMesh() {
+
+    if(config.trianglesPerObject <= 12) mesh = Cube::New();
+    else {
+        // A sphere of n latitudes and n longitudes has about 2 n^2 triangles
+        int n = std::max(3, (int)std::ceil(std::sqrt(config.trianglesPerObject / 2.0)));
+        mesh = Sphere::New(0.5f, n, n);
+    }
+
+    // Read back once, the vertices already have tangents
+    if(!config.shareGeometry) {
+        meshVertices = mesh->getVertices();
+        if(mesh->getIndicesLength() > 0) meshIndices = mesh->getIndices();
+    }
+
+    // The occluders share the triangles of the mesh
+    if(config.occluderRatio > 0.f) occluder = mesh->readOccluder();
+}
+
+Polytope::Ptr SceneGenerator::createPolytope() {
+    if(config.shareGeometry) return Polytope::New(*mesh);
+    if(meshIndices.empty()) return Polytope::New(meshVertices, false);
+    return Polytope::New(meshVertices, meshIndices, false);
+}
+
+Polytope::Ptr SceneGenerator::createPointCloud(float radius, unsigned int count) {
+
+    std::vector<Vec3f> points;
+    points.reserve(count);
+
+    // Noisy sphere shell, colored by height
+    for(unsigned int i = 0; i < count; i ++) {
+        glm::vec3 direction = insideSphere(1.f);
+        float length = glm::length(direction);
+        if(length < 1e-4f) direction = glm::vec3(0, 1, 0);
+        else direction /= length;
+
+        glm::vec3 point = direction * radius * uniform(0.9f, 1.f);
+        float height = 0.5f + 0.5f * direction.y;
+        points.push_back(Vec3f(point.x, point.y, point.z, height, 0.5f, 1.f - height));
+    }
+
+    return Polytope::New(points, false);
+}
+
+Texture::Ptr SceneGenerator::createTexture(bool translucent) {
+
+    // Checkerboard of two random colors
+    glm::vec3 first = color(), second = color();
+    unsigned char alpha = translucent ? TRANSLUCENT_ALPHA : 255;
+
+    std::vector<unsigned char> pixels(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+    for(unsigned int y = 0; y < TEXTURE_SIZE; y ++) {
+        for(unsigned int x = 0; x < TEXTURE_SIZE; x ++) {
+            const glm::vec3& c = ((x / 8 + y / 8) % 2 == 0) ? first : second;
+            unsigned char* pixel = &pixels[(y * TEXTURE_SIZE + x) * 4];
+            pixel[0] = (unsigned char)(c.r * 255);
+            pixel[1] = (unsigned char)(c.g * 255);
+            pixel[2] = (unsigned char)(c.b * 255);
+            pixel[3] = alpha;
+        }
+    }
+
+    Texture::Ptr texture = Texture::New(TEXTURE_SIZE, TEXTURE_SIZE, Texture::Type::TextureDiffuse);
+    texture->changeTexture(pixels.data());
+    return texture;
+}
+
+Scene::Ptr SceneGenerator::createHierarchy(std::vector<Group::Ptr>& groups, size_t first, size_t last, unsigned int level, GeneratedScene& generated) {
+
+    Scene::Ptr scene = Scene::New();
+    generated.scenes ++;
+
+    unsigned int depth = std::max(1u, config.depth);
+    if(level + 1 >= depth) {
+        for(size_t i = first; i < last; i ++) scene->addGroup(groups[i]);
+        return scene;
+    }
+
+    // Enough children per level to spread the groups over the leaves, 1 makes a chain
+    unsigned int branching = (unsigned int)std::ceil(std::pow((double)groups.size(), 1.0 / (depth - 1)));
+    branching = std::max(1u, branching);
+
+    size_t count = last - first;
+    size_t children = std::max<size_t>(1, std::min<size_t>(branching, count));
+    for(size_t i = 0; i < children; i ++) {
+        size_t begin = first + count * i / children;
+        size_t end = first + count * (i + 1) / children;
+
+        // Rotations around the origin keep everything inside the bounding sphere
+        Scene::Ptr child = createHierarchy(groups, begin, end, level + 1, generated);
+        child->rotate(uniform(-10.f, 10.f), glm::vec3(0, 1, 0));
+        scene->addScene(child);
+    }
+
+    return scene;
+}
+
+SceneGenerator::GeneratedScene SceneGenerator::generate() {
+
+    GeneratedScene generated;
+    random.seed(config.seed);
+
+    // Materials and textures, shared by the polytopes
+    for(unsigned int i = 0; i < std::max(1u, config.materials); i ++) {
+        glm::vec3 diffuse = color();
+        glm::vec3 specular = glm::vec3(uniform(0.1f, 1.f));
+        float shininess = (float)(2 << (random() % 8));
+        generated.materials.push_back(PhongMaterial::New(diffuse, specular, shininess));
+    }
+
+    for(unsigned int i = 0; i < config.textures; i ++) generated.textures.push_back(createTexture(false));
+
+    Texture::Ptr translucent = nullptr;
+    if(config.transparentRatio > 0.f) {
+        translucent = createTexture(true);
+        generated.textures.push_back(translucent);
+    }
+
+    std::vector<Group::Ptr> groups;
+    unsigned int objectsPerGroup = std::max(1u, config.objectsPerGroup);
+
+    if(config.layout == Layout::PointCloud) {
+        unsigned int pointsPerCloud = std::max(1u, config.pointsPerCloud);
+        unsigned int clouds = (config.objects + pointsPerCloud - 1) / pointsPerCloud;
+        unsigned int side = std::max(1u, (unsigned int)std::ceil(std::sqrt((double)clouds)));
+        float spacing = POINT_CLOUD_RADIUS * 3.f;
+        float offset = (side - 1) * spacing * 0.5f;
+
+        for(unsigned int i = 0; i < clouds; i ++) {
+            Group::Ptr group = Group::New(GL_POINTS);
+            // The last cloud takes the rest, objects is the exact number of points
+            unsigned int count = std::min(pointsPerCloud, config.objects - i * pointsPerCloud);
+            Polytope::Ptr cloud = createPointCloud(POINT_CLOUD_RADIUS, count);
+            cloud->translate(glm::vec3((i % side) * spacing - offset, 0.f, (i / side) * spacing - offset));
+            group->add(cloud);
+            groups.push_back(group);
+
+            generated.polytopes ++;
+            generated.points += count;
+        }
+        generated.radius = std::sqrt(2.f) * offset + POINT_CLOUD_RADIUS;
+    }
+    else {
+        createMesh();
+        unsigned int triangles = (mesh->getIndicesLength() > 0 ? mesh->getIndicesLength() : mesh->getVertexLength()) / 3;
+
+        unsigned int side = std::max(1u, (unsigned int)std::ceil(std::cbrt((double)config.objects)));
+        float offset = (side - 1) * config.spacing * 0.5f;
+        float scatterRadius = std::max(1.f, config.spacing * std::cbrt((float)config.objects) * 0.75f);
+
+        Group::Ptr group = nullptr;
+        for(unsigned int i = 0; i < config.objects; i ++) {
+            if(i % objectsPerGroup == 0) {
+                group = Group::New();
+                groups.push_back(group);
+            }
+
+            Polytope::Ptr polytope = createPolytope();
+            polytope->setMaterial(generated.materials[random() % generated.materials.size()]);
+
+            if(translucent != nullptr && uniform() < config.transparentRatio) {
+                polytope->addTexture(translucent);
+                polytope->setTransparent(true);
+            }
+            else if(config.textures > 0) polytope->addTexture(generated.textures[random() % config.textures]);
+
+            // Evenly spread and without drawing from the generator, the scene is the same with or without them
+            bool occluding = (unsigned int)(i * config.occluderRatio) != (unsigned int)((i + 1) * config.occluderRatio);
+            if(occluder != nullptr && occluding && !polytope->isTransparent()) polytope->setOccluder(occluder);
+
+            if(config.layout == Layout::Grid) {
+                unsigned int x = i % side, y = (i / side) % side, z = i / (side * side);
+                polytope->translate(glm::vec3(x, y, z) * config.spacing - glm::vec3(offset));
+            }
+            else {
+                polytope->translate(insideSphere(scatterRadius));
+                glm::vec3 axis = insideSphere(1.f) + glm::vec3(0.f, 1e-3f, 0.f);
+                polytope->rotate(uniform(0.f, 360.f), glm::normalize(axis));
+                polytope->scale(glm::vec3(uniform(0.5f, 1.5f)));
+            }
+
+            group->add(polytope);
+            generated.polytopes ++;
+            generated.triangles += triangles;
+        }
+
+        generated.radius = config.layout == Layout::Grid ? std::sqrt(3.f) * offset + 1.f : scatterRadius + 1.5f;
+    }
+
+    generated.groups = groups.size();
+    generated.scene = createHierarchy(groups, 0, groups.size(), 0, generated);
+
+    // Lights around the objects
+    for(unsigned int i = 0; i < config.lights; i ++) {
+        glm::vec3 position = insideSphere(generated.radius * 1.2f);
+        glm::vec3 lightColor = color();
+        if(config.lightRange > 0.f) {
+            // The brightest color reaches the attenuation cutoff at lightRange
+            float linear = 2.f / config.lightRange;
+            float quadratic = (1.f / ATTENUATION_CUTOFF - 3.f) / (config.lightRange * config.lightRange);
+            generated.lights.push_back(PointLight::New(position, lightColor, 1.f, linear, quadratic));
+        }
+        else generated.lights.push_back(PointLight::New(position, lightColor));
+    }
+
+    return generated;
+}
+
+SceneGenerator::Layout SceneGenerator::parseLayout(const std::string& name, bool& valid) {
+    valid = true;
+    if(name == "grid") return Layout::Grid;
+    if(name == "scatter") return Layout::Scatter;
+    if(name == "points") return Layout::PointCloud;
+    valid = false;
+    return Layout::Grid;
+}
+
+const char* SceneGenerator::getLayoutName(Layout layout) {
+    switch(layout) {
+        case Layout::Grid: return "grid";
+        case Layout::Scatter: return "scatter";
+        case Layout::PointCloud: return "points";
+    }
+    return "";
+}
\ No newline at end of file
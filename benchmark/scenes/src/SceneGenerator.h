@@ -0,0 +1,105 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <random>
+
+#include <engine/renderer/Renderer.h>
+
+/**
+ * @brief Seeded synthetic scenes for the benchmarks, built through the public scene graph API.
+ *
+ * The same seed gives the same scene on every platform: only std::mt19937 is used, whose output
+ * is fixed by the standard, and never the std distributions, whose output isn't.
+ *
+ * Polytopes go in groups of objectsPerGroup, and the groups in a tree of scenes of the given depth.
+ * With shareGeometry, polytopes of the same shape share their vertex and index buffers like
+ * copies of a polytope do, otherwise each one gets its own (1M cubes are about 1.6 GB then).
+ */
+class SceneGenerator {
+public:
+    enum class Layout {
+        Grid,           // polytopes in a cubic grid
+        Scatter,        // polytopes in random positions, rotations and scales inside a sphere
+        PointCloud      // clouds of pointsPerCloud points drawn as GL_POINTS, objects points in total
+    };
+
+    struct Config {
+        Layout layout = Layout::Grid;
+        uint32_t seed = 1;
+
+        unsigned int objects = 1000;
+        unsigned int trianglesPerObject = 12;   // 12 or less: cubes, more: spheres of about that many
+        unsigned int pointsPerCloud = 100000;
+        unsigned int objectsPerGroup = 64;
+        unsigned int depth = 1;                 // levels of scenes, 1: every group in the root scene
+        bool shareGeometry = true;
+
+        unsigned int materials = 8;
+        unsigned int textures = 0;              // diffuse textures, every texture takes a texture unit
+        float transparentRatio = 0.f;           // polytopes with a translucent texture
+        float occluderRatio = 0.f;              // opaque polytopes which are occluders of the software occlusion culling
+        unsigned int lights = 1;                // point lights
+        float lightRange = 0.f;                 // attenuation radius of the lights, 0: PointLight defaults
+
+        float spacing = 2.f;
+
+        static Config grid(unsigned int objects);
+        static Config nested(unsigned int objects, unsigned int depth);
+        static Config manyLights(unsigned int objects, unsigned int lights);
+        static Config pointCloud(unsigned int points);
+        static Config mixed(unsigned int objects);
+    };
+
+    struct GeneratedScene {
+        Scene::Ptr scene;
+        std::vector<PointLight::Ptr> lights;    // the renderer keeps raw pointers to them
+        std::vector<Material::Ptr> materials;
+        std::vector<Texture::Ptr> textures;
+
+        unsigned int polytopes = 0, groups = 0, scenes = 0;
+        size_t triangles = 0, points = 0;
+        float radius = 0.f;                     // of the bounding sphere around the origin
+
+        /**
+         * @brief Adds the scene and the lights to the renderer
+         */
+        void addTo(const Renderer::Ptr& renderer);
+    };
+private:
+    Config config;
+    std::mt19937 random;
+
+    std::vector<Vec3f> meshVertices;
+    std::vector<unsigned int> meshIndices;
+    Polytope::Ptr mesh;
+    std::shared_ptr<Polytope::Occluder> occluder;
+public:
+    SceneGenerator(const Config& _config);
+    SceneGenerator() = default;
+    ~SceneGenerator() = default;
+private:
+    float uniform();                                    // [0, 1)
+    float uniform(float min, float max);
+    glm::vec3 color();
+    glm::vec3 insideSphere(float radius);
+
+    void createMesh();
+    Polytope::Ptr createPolytope();
+    Polytope::Ptr createPointCloud(float radius, unsigned int count);
+    Texture::Ptr createTexture(bool translucent);
+
+    Scene::Ptr createHierarchy(std::vector<Group::Ptr>& groups, size_t first, size_t last, unsigned int level, GeneratedScene& generated);
+public:
+    /**
+     * @brief Needs a GL context, polytopes and textures are uploaded while they are created
+     */
+    GeneratedScene generate();
+
+    static Layout parseLayout(const std::string& name, bool& valid);
+    static const char* getLayoutName(Layout layout);
+public:
+    inline const Config& getConfig() const { return config; }
+};
\ No newline at end of file
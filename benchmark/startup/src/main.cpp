@@ -0,0 +1,92 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+#include <engine/renderer/Renderer.h>
+#include <engine/opengl/shader/ShaderCache.h>
+
+#include <GLFW/glfw3.h>
+
+const int WIDTH = 1280;
+const int HEIGHT = 720;
+
+GLFWwindow* window;
+
+// Constructs a renderer and returns the elapsed milliseconds
+double measureStartup() {
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    {
+        Renderer::Ptr renderer = Renderer::New(WIDTH, HEIGHT);
+        glFinish();
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+int main(int argc, char* argv[]) {
+
+    int runs = argc > 1 ? std::max(1, std::atoi(argv[1])) : 5;
+
+    // Create hidden window
+    if (!glfwInit()) {
+        std::cout << "Couldn't initialize window" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    window = glfwCreateWindow(WIDTH, HEIGHT, "Startup benchmark", NULL, NULL);
+
+    if (!window) {
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    ShaderCache::enable(SHADER_CACHE_DIRECTORY);
+
+    // Cold: nothing in the program binary cache
+    std::vector<double> cold;
+    unsigned int coldMisses = 0;
+    for(int i = 0; i < runs; i ++) {
+        ShaderCache::clear();
+        ShaderCache::resetStatistics();
+        cold.push_back(measureStartup());
+        coldMisses = ShaderCache::getMisses();
+    }
+
+    // Warm: programs are loaded from the cache written by the last cold run
+    std::vector<double> warm;
+    unsigned int warmHits = 0;
+    for(int i = 0; i < runs; i ++) {
+        ShaderCache::resetStatistics();
+        warm.push_back(measureStartup());
+        warmHits = ShaderCache::getHits();
+    }
+
+    bool cacheSupported = ShaderCache::isSupported();
+
+    std::cout << "{" << std::endl;
+    std::cout << "  \"renderer\": \"" << glGetString(GL_RENDERER) << "\"," << std::endl;
+    std::cout << "  \"runs\": " << runs << "," << std::endl;
+    std::cout << "  \"programBinarySupported\": " << (cacheSupported ? "true" : "false") << "," << std::endl;
+    std::cout << "  \"coldStartupMs\": " << median(cold) << "," << std::endl;
+    std::cout << "  \"coldCacheMisses\": " << coldMisses << "," << std::endl;
+    std::cout << "  \"warmStartupMs\": " << median(warm) << "," << std::endl;
+    std::cout << "  \"warmCacheHits\": " << warmHits << std::endl;
+    std::cout << "}" << std::endl;
+
+    glfwTerminate();
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#[[
+    Generates a header with the GLSL sources as raw string literals, so the
+    library doesn't need to read the glsl folder at runtime.
+
+    Usage: cmake -DSHADERS_PATH=<glsl folder> -DOUTPUT=<header> -P EmbedShaders.cmake
+]]
+
+file(GLOB shaderFiles ${SHADERS_PATH}/*.frag ${SHADERS_PATH}/*.vert ${SHADERS_PATH}/*.geom ${SHADERS_PATH}/*.comp)
+list(SORT shaderFiles)
+
+set(content "#pragma once\n\n// Generated by cmake/EmbedShaders.cmake, do not edit\n\n")
+string(APPEND content "#include <string>\n#include <unordered_map>\n\n")
+string(APPEND content "static const std::unordered_map<std::string, const char*> embeddedShaders = {\n")
+
+foreach(filename ${shaderFiles})
+    get_filename_component(name ${filename} NAME)
+    file(READ ${filename} code)
+    string(APPEND content "    { \"${name}\", R\"RGL_GLSL(${code}\n)RGL_GLSL\" },\n")
+endforeach()
+
+string(APPEND content "};")
+
+# Only touch the header when the shaders changed
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} previousContent)
+endif()
+if(NOT "${previousContent}" STREQUAL "${content}")
+    file(WRITE ${OUTPUT} "${content}")
+endif()
\ No newline at end of file
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+// RENDERERGL_NO_SIMD forces the plain floats
+#if !defined(RENDERERGL_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define FLOAT4_SSE2
+    #include <emmintrin.h>
+#elif !defined(RENDERERGL_NO_SIMD) && defined(__aarch64__)
+    #define FLOAT4_NEON
+    #include <arm_neon.h>
+#endif
+
+/**
+ * @brief Four floats operated on at once, with SSE2 or NEON when the target has them.
+ *
+ * A comparison gives a mask, all the bits of a lane are set where it's true, for &, | and
+ * select. floor, ceil and toInt expect values that fit an int.
+ */
+struct Float4 {
+    // Lanes set in the mask
+    inline int count() const {
+        int lanes = mask();
+        return (lanes & 1) + (lanes >> 1 & 1) + (lanes >> 2 & 1) + (lanes >> 3 & 1);
+    }
+
+#if defined(FLOAT4_SSE2)
+    __m128 v;
+
+    inline Float4() = default;
+    inline Float4(__m128 _v) : v(_v) {}
+
+    inline static Float4 set(float value) { return _mm_set1_ps(value); }
+    inline static Float4 set(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+    inline static Float4 load(const float* values) { return _mm_loadu_ps(values); }
+    inline void store(float* values) const { _mm_storeu_ps(values, v); }
+    inline void toInt(int* values) const { _mm_storeu_si128((__m128i*)values, _mm_cvttps_epi32(v)); }
+
+    inline Float4 operator + (const Float4& b) const { return _mm_add_ps(v, b.v); }
+    inline Float4 operator - (const Float4& b) const { return _mm_sub_ps(v, b.v); }
+    inline Float4 operator * (const Float4& b) const { return _mm_mul_ps(v, b.v); }
+    inline Float4 operator / (const Float4& b) const { return _mm_div_ps(v, b.v); }
+
+    inline Float4 operator < (const Float4& b) const { return _mm_cmplt_ps(v, b.v); }
+    inline Float4 operator <= (const Float4& b) const { return _mm_cmple_ps(v, b.v); }
+    inline Float4 operator > (const Float4& b) const { return _mm_cmpgt_ps(v, b.v); }
+    inline Float4 operator >= (const Float4& b) const { return _mm_cmpge_ps(v, b.v); }
+    inline Float4 operator & (const Float4& b) const { return _mm_and_ps(v, b.v); }
+    inline Float4 operator | (const Float4& b) const { return _mm_or_ps(v, b.v); }
+
+    inline static Float4 min(const Float4& a, const Float4& b) { return _mm_min_ps(a.v, b.v); }
+    inline static Float4 max(const Float4& a, const Float4& b) { return _mm_max_ps(a.v, b.v); }
+    inline static Float4 select(const Float4& mask, const Float4& a, const Float4& b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+
+    // Truncated, then one less where it went up
+    inline static Float4 floor(const Float4& a) {
+        __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+        return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a.v), _mm_set1_ps(1.f)));
+    }
+
+    inline static Float4 ceil(const Float4& a) {
+        __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+        return _mm_add_ps(truncated, _mm_and_ps(_mm_cmplt_ps(truncated, a.v), _mm_set1_ps(1.f)));
+    }
+
+    // Bit i set when lane i of the mask is
+    inline int mask() const { return _mm_movemask_ps(v); }
+
+    inline float horizontalMin() const {
+        __m128 pairs = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(_mm_min_ps(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+
+    inline float horizontalMax() const {
+        __m128 pairs = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(_mm_max_ps(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+#elif defined(FLOAT4_NEON)
+    float32x4_t v;
+
+    inline Float4() = default;
+    inline Float4(float32x4_t _v) : v(_v) {}
+    inline Float4(uint32x4_t _v) : v(vreinterpretq_f32_u32(_v)) {}
+
+    inline static Float4 set(float value) { return vdupq_n_f32(value); }
+    inline static Float4 set(float a, float b, float c, float d) {
+        float values[4] = { a, b, c, d };
+        return vld1q_f32(values);
+    }
+    inline static Float4 load(const float* values) { return vld1q_f32(values); }
+    inline void store(float* values) const { vst1q_f32(values, v); }
+    inline void toInt(int* values) const { vst1q_s32(values, vcvtq_s32_f32(v)); }
+
+    inline Float4 operator + (const Float4& b) const { return vaddq_f32(v, b.v); }
+    inline Float4 operator - (const Float4& b) const { return vsubq_f32(v, b.v); }
+    inline Float4 operator * (const Float4& b) const { return vmulq_f32(v, b.v); }
+    inline Float4 operator / (const Float4& b) const { return vdivq_f32(v, b.v); }
+
+    inline Float4 operator < (const Float4& b) const { return vcltq_f32(v, b.v); }
+    inline Float4 operator <= (const Float4& b) const { return vcleq_f32(v, b.v); }
+    inline Float4 operator > (const Float4& b) const { return vcgtq_f32(v, b.v); }
+    inline Float4 operator >= (const Float4& b) const { return vcgeq_f32(v, b.v); }
+    inline Float4 operator & (const Float4& b) const { return vandq_u32(vreinterpretq_u32_f32(v), vreinterpretq_u32_f32(b.v)); }
+    inline Float4 operator | (const Float4& b) const { return vorrq_u32(vreinterpretq_u32_f32(v), vreinterpretq_u32_f32(b.v)); }
+
+    inline static Float4 min(const Float4& a, const Float4& b) { return vminq_f32(a.v, b.v); }
+    inline static Float4 max(const Float4& a, const Float4& b) { return vmaxq_f32(a.v, b.v); }
+    inline static Float4 select(const Float4& mask, const Float4& a, const Float4& b) { return vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v); }
+
+    inline static Float4 floor(const Float4& a) { return vrndmq_f32(a.v); }
+    inline static Float4 ceil(const Float4& a) { return vrndpq_f32(a.v); }
+
+    inline int mask() const {
+        static const uint32_t bits[4] = { 1, 2, 4, 8 };
+        return (int)vaddvq_u32(vandq_u32(vreinterpretq_u32_f32(v), vld1q_u32(bits)));
+    }
+
+    inline float horizontalMin() const { return vminvq_f32(v); }
+    inline float horizontalMax() const { return vmaxvq_f32(v); }
+#else
+    float v[4];
+
+    inline Float4() = default;
+
+    inline static Float4 set(float value) { return set(value, value, value, value); }
+    inline static Float4 set(float a, float b, float c, float d) {
+        Float4 result;
+        result.v[0] = a;
+        result.v[1] = b;
+        result.v[2] = c;
+        result.v[3] = d;
+        return result;
+    }
+    inline static Float4 load(const float* values) { return set(values[0], values[1], values[2], values[3]); }
+    inline void store(float* values) const { for(int i = 0; i < 4; i++) values[i] = v[i]; }
+    inline void toInt(int* values) const { for(int i = 0; i < 4; i++) values[i] = (int)v[i]; }
+
+    inline Float4 operator + (const Float4& b) const { return set(v[0] + b.v[0], v[1] + b.v[1], v[2] + b.v[2], v[3] + b.v[3]); }
+    inline Float4 operator - (const Float4& b) const { return set(v[0] - b.v[0], v[1] - b.v[1], v[2] - b.v[2], v[3] - b.v[3]); }
+    inline Float4 operator * (const Float4& b) const { return set(v[0] * b.v[0], v[1] * b.v[1], v[2] * b.v[2], v[3] * b.v[3]); }
+    inline Float4 operator / (const Float4& b) const { return set(v[0] / b.v[0], v[1] / b.v[1], v[2] / b.v[2], v[3] / b.v[3]); }
+
+    inline Float4 operator < (const Float4& b) const { return compare(b, [](float x, float y) { return x < y; }); }
+    inline Float4 operator <= (const Float4& b) const { return compare(b, [](float x, float y) { return x <= y; }); }
+    inline Float4 operator > (const Float4& b) const { return compare(b, [](float x, float y) { return x > y; }); }
+    inline Float4 operator >= (const Float4& b) const { return compare(b, [](float x, float y) { return x >= y; }); }
+    inline Float4 operator & (const Float4& b) const { return combine(b, [](uint32_t x, uint32_t y) { return x & y; }); }
+    inline Float4 operator | (const Float4& b) const { return combine(b, [](uint32_t x, uint32_t y) { return x | y; }); }
+
+    inline static Float4 min(const Float4& a, const Float4& b) { return set(std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]), std::min(a.v[2], b.v[2]), std::min(a.v[3], b.v[3])); }
+    inline static Float4 max(const Float4& a, const Float4& b) { return set(std::max(a.v[0], b.v[0]), std::max(a.v[1], b.v[1]), std::max(a.v[2], b.v[2]), std::max(a.v[3], b.v[3])); }
+    inline static Float4 select(const Float4& mask, const Float4& a, const Float4& b) {
+        Float4 result;
+        for(int i = 0; i < 4; i++) result.v[i] = bits(mask.v[i]) != 0 ? a.v[i] : b.v[i];
+        return result;
+    }
+
+    inline static Float4 floor(const Float4& a) { return set(std::floor(a.v[0]), std::floor(a.v[1]), std::floor(a.v[2]), std::floor(a.v[3])); }
+    inline static Float4 ceil(const Float4& a) { return set(std::ceil(a.v[0]), std::ceil(a.v[1]), std::ceil(a.v[2]), std::ceil(a.v[3])); }
+
+    inline int mask() const {
+        int result = 0;
+        for(int i = 0; i < 4; i++) result |= (int)(bits(v[i]) >> 31) << i;
+        return result;
+    }
+
+    inline float horizontalMin() const { return std::min(std::min(v[0], v[1]), std::min(v[2], v[3])); }
+    inline float horizontalMax() const { return std::max(std::max(v[0], v[1]), std::max(v[2], v[3])); }
+private:
+    inline static uint32_t bits(float value) {
+        uint32_t result;
+        std::memcpy(&result, &value, sizeof(result));
+        return result;
+    }
+
+    inline static float fromBits(uint32_t value) {
+        float result;
+        std::memcpy(&result, &value, sizeof(result));
+        return result;
+    }
+
+    template<typename Compare>
+    inline Float4 compare(const Float4& b, Compare compare) const {
+        Float4 result;
+        for(int i = 0; i < 4; i++) result.v[i] = fromBits(compare(v[i], b.v[i]) ? 0xFFFFFFFFu : 0u);
+        return result;
+    }
+
+    template<typename Combine>
+    inline Float4 combine(const Float4& b, Combine combine) const {
+        Float4 result;
+        for(int i = 0; i < 4; i++) result.v[i] = fromBits(combine(bits(v[i]), bits(b.v[i])));
+        return result;
+    }
+#endif
+};
\ No newline at end of file
@@ -1,18 +1,21 @@
 #include "Group.h"
 
+#include <map>
+#include <tuple>
+
 unsigned long Group::groupCount = 0;
 
 Group::Group(unsigned int _primitive, bool _showWire) 
     : primitive(_primitive), showWire(_showWire), modelMatrix(1.f), visible(true), 
     pointSize(POINT_SIZE), lineWidth(LINE_WIDTH), outliningWidth(OUTLINING_WIDTH),
-    id(groupCount) {
+    baked(false), depthPrePass(true), dynamicShadow(false), id(groupCount) {
     groupCount ++;
 }
 
 Group::Group() 
     : primitive(GL_TRIANGLES), showWire(false), modelMatrix(1.f), visible(true), 
     pointSize(POINT_SIZE), lineWidth(LINE_WIDTH), outliningWidth(OUTLINING_WIDTH),
-    id(groupCount) {
+    baked(false), depthPrePass(true), dynamicShadow(false), id(groupCount) {
     groupCount ++;
 }
 
@@ -37,4 +40,113 @@ bool Group::isSelected() {
 
 void Group::setSelected(bool selected) {
     for(auto& p : polytopes) p->setSelected(selected);
+}
+
+bool Group::bakeStatic() {
+
+    if(primitive == GL_TRIANGLE_STRIP || primitive == GL_TRIANGLE_FAN || primitive == GL_LINE_STRIP || primitive == GL_LINE_LOOP) {
+        std::cout << "Group " << id << " can't be baked, strips and fans can't be merged" << std::endl;
+        return false;
+    }
+
+    unbakeStatic();
+
+    // Polytopes drawn with the same state go to the same batch
+    typedef std::tuple<Material*, std::vector<Texture*>, int, float, bool> BatchKey;
+    std::map<BatchKey, std::vector<Polytope::Ptr>> batches;
+    std::vector<BatchKey> order;
+
+    for(auto& polytope : polytopes) {
+        // Dynamic polytopes keep changing, they are drawn as they are
+        if(dynamic_cast<DynamicPolytope*>(polytope.get()) != nullptr || polytope->getVertexLength() == 0) {
+            bakedPolytopes.push_back(polytope);
+            continue;
+        }
+
+        std::vector<Texture*> textures;
+        for(auto& texture : polytope->getTextures()) textures.push_back(texture.get());
+        BatchKey key(polytope->getMaterial().get(), textures, (int)polytope->getFaceCulling(), polytope->getEmissionStrength(), polytope->isTransparent());
+
+        if(batches.find(key) == batches.end()) order.push_back(key);
+        batches[key].push_back(polytope);
+    }
+
+    for(auto& key : order) {
+
+        std::vector<Polytope::Ptr>& batch = batches[key];
+        std::vector<Vec3f> vertices;
+        std::vector<unsigned int> indices;
+        std::vector<BakedRange> ranges;
+
+        for(auto& polytope : batch) {
+
+            BakedRange range = { polytope, (unsigned int)vertices.size(), 0, (unsigned int)indices.size(), 0 };
+
+            glm::mat4 model = polytope->getModelMatrix();
+            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+            glm::mat3 tangentMatrix = glm::mat3(model);
+
+            for(Vec3f vertex : polytope->getVertices()) {
+                glm::vec3 position = glm::vec3(model * glm::vec4(vertex.x, vertex.y, vertex.z, 1.f));
+                glm::vec3 normal = normalMatrix * glm::vec3(vertex.nx, vertex.ny, vertex.nz);
+                glm::vec3 tangent = tangentMatrix * glm::vec3(vertex.tanx, vertex.tany, vertex.tanz);
+                glm::vec3 bitangent = tangentMatrix * glm::vec3(vertex.bitanx, vertex.bitany, vertex.bitanz);
+
+                vertex.x = position.x;  vertex.y = position.y;  vertex.z = position.z;
+                vertex.nx = normal.x;   vertex.ny = normal.y;   vertex.nz = normal.z;
+                vertex.tanx = tangent.x;    vertex.tany = tangent.y;    vertex.tanz = tangent.z;
+                vertex.bitanx = bitangent.x;    vertex.bitany = bitangent.y;    vertex.bitanz = bitangent.z;
+
+                vertices.push_back(vertex);
+            }
+
+            // Non indexed polytopes get the trivial indices
+            if(polytope->getIndicesLength() > 0 && polytope->getIndexBuffer() != nullptr) {
+                for(unsigned int index : polytope->getIndices()) indices.push_back(range.firstVertex + index);
+            }
+            else {
+                for(unsigned int i = 0; i < polytope->getVertexLength(); i ++) indices.push_back(range.firstVertex + i);
+            }
+
+            range.vertexCount = vertices.size() - range.firstVertex;
+            range.indexCount = indices.size() - range.firstIndex;
+            ranges.push_back(range);
+            bakedSources.insert(polytope.get());
+        }
+
+        // Tangents were already computed by the originals
+        Polytope::Ptr bakedPolytope = Polytope::New(vertices, indices, false);
+        Polytope::Ptr& first = batch.front();
+        bakedPolytope->setMaterial(first->getMaterial());
+        for(auto& texture : first->getTextures()) bakedPolytope->addTexture(texture);
+        bakedPolytope->setFaceCulling(first->getFaceCulling());
+        bakedPolytope->setEmissionStrength(first->getEmissionStrength());
+        bakedPolytope->setTransparent(first->isTransparent());
+
+        bakedRanges[bakedPolytope.get()] = ranges;
+        bakedPolytopes.push_back(bakedPolytope);
+    }
+
+    baked = true;
+    return true;
+}
+
+void Group::unbakeStatic() {
+    bakedPolytopes.clear();
+    bakedRanges.clear();
+    bakedSources.clear();
+    baked = false;
+}
+
+Polytope::Ptr Group::getSourcePolytope(const Polytope::Ptr& bakedPolytope, unsigned int index) {
+
+    // Not baked, it is an original one
+    auto it = bakedRanges.find(bakedPolytope.get());
+    if(it == bakedRanges.end()) return bakedPolytope;
+
+    for(auto& range : it->second) {
+        if(index >= range.firstIndex && index < range.firstIndex + range.indexCount) return range.source;
+    }
+
+    return nullptr;
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "Polytope.h"
 #include "DynamicPolytope.h"
@@ -15,11 +17,27 @@
 
 class Group {
     GENERATE_PTR(Group)
+public:
+    // Part of a baked polytope that comes from an original one
+    struct BakedRange {
+        Polytope::Ptr source;
+        unsigned int firstVertex, vertexCount;
+        unsigned int firstIndex, indexCount;
+    };
 private:
     std::vector<Polytope::Ptr> polytopes;
+
+    // Static baking
+    std::vector<Polytope::Ptr> bakedPolytopes;
+    std::unordered_map<const Polytope*, std::vector<BakedRange>> bakedRanges;
+    std::unordered_set<const Polytope*> bakedSources;
+    bool baked;
+
     unsigned int primitive;
     float pointSize, lineWidth, outliningWidth;
     bool showWire, visible;
+    bool depthPrePass;
+    bool dynamicShadow;
     glm::mat4 modelMatrix;
 
     static unsigned long groupCount;
@@ -32,15 +50,38 @@ public:
     void removePolytope(Polytope::Ptr& polytope);
     bool isSelected();
     void setSelected(bool selected);
+
+    /**
+     * @brief Merges the polytopes with the same material, textures, face culling and emission
+     * into one polytope each, with their model matrices applied to the vertices.
+     *
+     * The originals are kept for selection and picking (see getSourcePolytope). Moving a polytope
+     * needs unbakeStatic first, adding or removing polytopes unbakes the group.
+     * Dynamic polytopes and strip or fan primitives are not baked.
+     */
+    bool bakeStatic();
+    void unbakeStatic();
+
+    /**
+     * @brief Original polytope of the index at position index of a baked polytope (3 * triangle for triangles)
+     */
+    Polytope::Ptr getSourcePolytope(const Polytope::Ptr& bakedPolytope, unsigned int index);
 public:
     inline void translate(const glm::vec3& v) { modelMatrix = glm::translate(modelMatrix, v); }
     inline void rotate(float degrees, const glm::vec3& axis) { modelMatrix = glm::rotate(modelMatrix, glm::radians(degrees), axis); }
     inline void scale(const glm::vec3& s) { modelMatrix = glm::scale(modelMatrix, s); }
 
-    inline void add(const Polytope::Ptr& polytope) { polytopes.push_back(polytope); }
+    inline void add(const Polytope::Ptr& polytope) { unbakeStatic(); polytopes.push_back(polytope); }
     inline std::vector<Polytope::Ptr>& getPolytopes() { return polytopes; }
 
-    inline void removePolytope(int index) { polytopes.erase(polytopes.begin() + index); }
+    inline void removePolytope(int index) { unbakeStatic(); polytopes.erase(polytopes.begin() + index); }
+
+    // Polytopes to draw: the baked ones when the group is baked
+    inline std::vector<Polytope::Ptr>& getDrawPolytopes() { return baked ? bakedPolytopes : polytopes; }
+
+    inline bool isBaked() const { return baked; }
+    inline bool isBakedSource(const Polytope::Ptr& polytope) const { return bakedSources.find(polytope.get()) != bakedSources.end(); }
+    inline std::vector<BakedRange>& getBakedRanges(const Polytope::Ptr& bakedPolytope) { return bakedRanges[bakedPolytope.get()]; }
 
     inline void setVisible(bool visible) { this->visible = visible; }
     inline bool isVisible() const { return visible; }
@@ -48,6 +89,15 @@ public:
     inline void setShowWire(bool showWire) { this->showWire = showWire; }
     inline bool isShowWire() const { return showWire; }
 
+    // Opaque triangles of the group are in the depth pre-pass of the renderer when it's enabled
+    inline void setDepthPrePass(bool depthPrePass) { this->depthPrePass = depthPrePass; }
+    inline bool isDepthPrePass() const { return depthPrePass; }
+
+    // Casters which move often: drawn every frame over the cached shadows of the static ones,
+    // moving them doesn't render the static shadows again
+    inline void setDynamicShadow(bool dynamicShadow) { this->dynamicShadow = dynamicShadow; }
+    inline bool isDynamicShadow() const { return dynamicShadow; }
+
     inline void setPrimitive(unsigned int primitive) { this->primitive = primitive; }
     inline unsigned int getPrimitive() const { return primitive; }
 
@@ -1,38 +1,52 @@
 #include "Polytope.h"
 
+#include "engine/opengl/device/RenderDevice.h"
+
 #include <GL/glew.h>
 
+#include <map>
+#include <tuple>
+
+unsigned long Polytope::polytopeCount = 0;
+Polytope::PositionStream Polytope::defaultPositionStream = Polytope::PositionStream::NONE;
+
 Polytope::Polytope(size_t length) 
     : vertexLength(length), modelMatrix(1.f), indicesLength(0), selected(false), 
-    faceCulling(FaceCulling::BACK), emissionStrength(1.0) {
+    faceCulling(FaceCulling::BACK), emissionStrength(1.0), transparent(false), boundsMin(0.f), boundsMax(0.f) {
     initPolytope(length);
 }
 
 Polytope::Polytope(std::vector<Vec3f>& vertices, bool _tangentAndBitangents)
     : vertexLength(vertices.size()), modelMatrix(1.f), indicesLength(0), selected(false), 
-    faceCulling(FaceCulling::BACK), emissionStrength(1.0), tangentAndBitangents(_tangentAndBitangents) {
+    faceCulling(FaceCulling::BACK), emissionStrength(1.0), transparent(false), tangentAndBitangents(_tangentAndBitangents),
+    boundsMin(0.f), boundsMax(0.f) {
     initPolytope(vertices);
 }
 
 Polytope::Polytope(std::vector<Vec3f>& vertices, std::vector<unsigned int>& indices, bool _tangentAndBitangents) 
     : vertexLength(vertices.size()), modelMatrix(1.f), indicesLength(indices.size()), selected(false), 
-    faceCulling(FaceCulling::BACK), emissionStrength(1.0), tangentAndBitangents(_tangentAndBitangents) {
+    faceCulling(FaceCulling::BACK), emissionStrength(1.0), transparent(false), tangentAndBitangents(_tangentAndBitangents),
+    boundsMin(0.f), boundsMax(0.f) {
     initPolytope(vertices, indices);
 }
 
 Polytope::Polytope(const Polytope& polytope) 
-    : vertexArray(polytope.vertexArray), vertexBuffer(polytope.vertexBuffer), textures(polytope.textures),
+    : vertexArray(polytope.vertexArray), vertexBuffer(polytope.vertexBuffer),
+    positionVertexArray(polytope.positionVertexArray), positionBuffer(polytope.positionBuffer), textures(polytope.textures),
     vertexLength(polytope.vertexLength), indicesLength(polytope.indicesLength), material(polytope.material),
     modelMatrix(polytope.modelMatrix), selected(polytope.selected), faceCulling(polytope.faceCulling),
-    emissionStrength(polytope.emissionStrength), tangentAndBitangents(polytope.tangentAndBitangents) {
+    emissionStrength(polytope.emissionStrength), transparent(polytope.transparent), tangentAndBitangents(polytope.tangentAndBitangents),
+    boundsMin(polytope.boundsMin), boundsMax(polytope.boundsMax), occluder(polytope.occluder) {
 }
 
 Polytope::Polytope(Polytope&& polytope) noexcept 
     : vertexArray(std::move(polytope.vertexArray)), vertexBuffer(std::move(polytope.vertexBuffer)),
+    positionVertexArray(std::move(polytope.positionVertexArray)), positionBuffer(std::move(polytope.positionBuffer)),
     textures(std::move(polytope.textures)), vertexLength(polytope.vertexLength), indicesLength(polytope.indicesLength),
     material(std::move(polytope.material)), modelMatrix(std::move(polytope.modelMatrix)), selected(polytope.selected),
-    faceCulling(polytope.faceCulling), emissionStrength(polytope.emissionStrength),
-    tangentAndBitangents(polytope.tangentAndBitangents) {
+    faceCulling(polytope.faceCulling), emissionStrength(polytope.emissionStrength), transparent(polytope.transparent),
+    tangentAndBitangents(polytope.tangentAndBitangents), boundsMin(polytope.boundsMin), boundsMax(polytope.boundsMax),
+    occluder(std::move(polytope.occluder)) {
 }
 
 void Polytope::setTangentsAndBitangents(Vec3f& vertex0, Vec3f& vertex1, Vec3f& vertex2) {
@@ -62,10 +76,7 @@ void Polytope::setTangentsAndBitangents(Vec3f& vertex0, Vec3f& vertex1, Vec3f& v
 }
 
 void Polytope::calculateTangentsAndBitangents(std::vector<Vec3f>& vertices) {
-
-    if(!tangentAndBitangents) return;
-
-    for(int i = 0; i < vertices.size(); i += 3) {
+    for(size_t i = 0; i + 2 < vertices.size(); i += 3) {
 
         Vec3f& vertex0 = vertices[i];
         Vec3f& vertex1 = vertices[i + 1];
@@ -76,11 +87,8 @@ void Polytope::calculateTangentsAndBitangents(std::vector<Vec3f>& vertices) {
 }
 
 void Polytope::calculateTangentsAndBitangents(std::vector<Vec3f>& vertices, std::vector<unsigned int>& indices) {
+    for(size_t i = 0; i + 2 < indices.size(); i += 3) {
 
-    if(!tangentAndBitangents) return;
-
-    for(int i = 0; i < indices.size(); i += 3) {
-        
         Vec3f& vertex0 = vertices[indices[i]];
         Vec3f& vertex1 = vertices[indices[i + 1]];
         Vec3f& vertex2 = vertices[indices[i + 2]];
@@ -94,22 +102,27 @@ void Polytope::initPolytope(size_t length) {
     vertexBuffer = VertexBuffer::New(length);
     material = PhongMaterial::New(MATERIAL_DIFFUSE, MATERIAL_SPECULAR, MATERIAL_SHININESS);
     unbind();
+    if(defaultPositionStream != PositionStream::NONE) initPositionStream(std::vector<Vec3f>(length), PositionStream::FLOAT);
 }
 
 void Polytope::initPolytope(std::vector<Vec3f>& vertices) {
-    calculateTangentsAndBitangents(vertices);
+    if(tangentAndBitangents) calculateTangentsAndBitangents(vertices);
     vertexArray = VertexArray::New();
     vertexBuffer = VertexBuffer::New(vertices);
+    calculateBounds(vertices);
     material = PhongMaterial::New(MATERIAL_DIFFUSE, MATERIAL_SPECULAR, MATERIAL_SHININESS);
     unbind();
+    initPositionStream(vertices, defaultPositionStream);
 }
 
 void Polytope::initPolytope(std::vector<Vec3f>& vertices, std::vector<unsigned int>& indices) {
-    calculateTangentsAndBitangents(vertices, indices);
+    if(tangentAndBitangents) calculateTangentsAndBitangents(vertices, indices);
     vertexArray = VertexArray::New();
     vertexBuffer = VertexBuffer::New(vertices, indices);
+    calculateBounds(vertices);
     material = PhongMaterial::New(MATERIAL_DIFFUSE, MATERIAL_SPECULAR, MATERIAL_SHININESS);
     unbind();
+    initPositionStream(vertices, defaultPositionStream);
 }
 
 void Polytope::bind() {
@@ -125,13 +138,20 @@ void Polytope::unbind() {
 void Polytope::updateVertices(std::vector<Vec3f>& vertices) {
     if(vertexBuffer != nullptr) {
         vertexBuffer->updateVertices(vertices);
+        if(positionBuffer != nullptr) positionBuffer->updatePositions(vertices);
         vertexLength = vertices.size();
+        calculateBounds(vertices);
     }
 }
 
 void Polytope::updateVertex(int pos, Vec3f newVertex) {
-    if(vertexBuffer != nullptr)
+    if(vertexBuffer != nullptr) {
         vertexBuffer->updateVertex(pos, newVertex);
+        if(positionBuffer != nullptr && !positionBuffer->updatePosition(pos, newVertex))
+            positionBuffer->updatePositions(vertexBuffer->getVertices());
+        boundsMin = glm::min(boundsMin, glm::vec3(newVertex.x, newVertex.y, newVertex.z));
+        boundsMax = glm::max(boundsMax, glm::vec3(newVertex.x, newVertex.y, newVertex.z));
+    }
 }
 
 void Polytope::updateIndices(std::vector<unsigned int>& indices) {
@@ -152,11 +172,95 @@ void Polytope::removeTexture(const Texture::Ptr& texture) {
     }
 }
 
+void Polytope::drawCall(unsigned int primitive, unsigned int stride) {
+    if(!vertexBuffer->HasIndexBuffer()) {
+        RenderDevice::get()->drawArrays(primitive, 0, vertexLength);
+        RenderStats::countDraw(primitive, vertexLength);
+        RenderStats::countVertexFetch((size_t)vertexLength * stride);
+    }
+    else {
+        RenderDevice::get()->drawElements(primitive, indicesLength, GL_UNSIGNED_INT, (void*)getIndexBuffer()->getOffset());
+        RenderStats::countDraw(primitive, indicesLength);
+        RenderStats::countVertexFetch((size_t)indicesLength * stride);
+    }
+}
+
 void Polytope::draw(unsigned int primitive, bool showWire) {
     bind();
-    if(!showWire)   glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    else            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    if(!vertexBuffer->HasIndexBuffer()) glDrawArrays(primitive, 0, vertexLength);
-    else    glDrawElements(primitive, indicesLength, GL_UNSIGNED_INT, 0);
+    if(!showWire)   RenderDevice::get()->polygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    else            RenderDevice::get()->polygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    drawCall(primitive, 17 * sizeof(float));
     unbind();
+}
+
+void Polytope::initPositionStream(const std::vector<Vec3f>& vertices, PositionStream positionStream) {
+
+    // The old vertex array unbinds itself when it's deleted
+    positionVertexArray = nullptr;
+    positionBuffer = nullptr;
+    if(positionStream == PositionStream::NONE) return;
+
+    positionVertexArray = VertexArray::New();
+    positionBuffer = PositionBuffer::New(vertices, positionStream == PositionStream::QUANTIZED);
+
+    // The element array binding is part of the vertex array
+    if(vertexBuffer->HasIndexBuffer() && getIndexBuffer() != nullptr) getIndexBuffer()->bind();
+
+    positionVertexArray->unbind();
+}
+
+void Polytope::createPositionStream(PositionStream positionStream) {
+    if(vertexBuffer == nullptr) return;
+    std::vector<Vec3f> vertices;
+    if(positionStream != PositionStream::NONE) vertices = vertexBuffer->getVertices();
+    initPositionStream(vertices, positionStream);
+}
+
+void Polytope::drawPositions(unsigned int primitive, bool showWire) {
+
+    if(positionVertexArray == nullptr) {
+        draw(primitive, showWire);
+        return;
+    }
+
+    positionVertexArray->bind();
+    if(!showWire)   RenderDevice::get()->polygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    else            RenderDevice::get()->polygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    drawCall(primitive, positionBuffer->getStride());
+    positionVertexArray->unbind();
+}
+
+std::shared_ptr<Polytope::Occluder> Polytope::readOccluder() {
+
+    std::shared_ptr<Occluder> triangles = std::make_shared<Occluder>();
+    if(vertexBuffer == nullptr) return triangles;
+
+    // Vertices only split by their normals or texture coordinates are welded, they are transformed once
+    std::vector<unsigned int> welded;
+    std::map<std::tuple<float, float, float>, unsigned int> positions;
+    for(auto& vertex : vertexBuffer->getVertices()) {
+        auto it = positions.emplace(std::make_tuple(vertex.x, vertex.y, vertex.z), triangles->positions.size()).first;
+        if(it->second == triangles->positions.size()) triangles->positions.push_back(glm::vec3(vertex.x, vertex.y, vertex.z));
+        welded.push_back(it->second);
+    }
+
+    if(indicesLength > 0) {
+        for(unsigned int index : getIndices()) triangles->indices.push_back(welded[index]);
+    }
+    else triangles->indices = welded;
+    return triangles;
+}
+
+void Polytope::calculateBounds(const std::vector<Vec3f>& vertices) {
+
+    if(vertices.empty()) {
+        boundsMin = boundsMax = glm::vec3(0.f);
+        return;
+    }
+
+    boundsMin = boundsMax = glm::vec3(vertices[0].x, vertices[0].y, vertices[0].z);
+    for(const Vec3f& vertex : vertices) {
+        boundsMin = glm::min(boundsMin, glm::vec3(vertex.x, vertex.y, vertex.z));
+        boundsMax = glm::max(boundsMax, glm::vec3(vertex.x, vertex.y, vertex.z));
+    }
 }
\ No newline at end of file
@@ -11,12 +11,15 @@
 
 #include "engine/opengl/buffer/VertexArray.h"
 #include "engine/opengl/buffer/VertexBuffer.h"
+#include "engine/opengl/buffer/PositionBuffer.h"
 
 #include "engine/lighting/Material.h"
 #include "engine/lighting/PhongMaterial.h"
 
 #include "engine/texture/Texture.h"
 
+#include "engine/renderer/RenderStats.h"
+
 #include "engine/ptr.h"
 
 #define MATERIAL_DIFFUSE glm::vec3(1.0f)
@@ -29,9 +32,22 @@ public:
     enum class FaceCulling {
         NONE, FRONT, BACK
     };
+
+    // Positions of the depth only passes (shadows, depth pre-pass, selection)
+    enum class PositionStream {
+        NONE, FLOAT, QUANTIZED
+    };
+
+    // Triangles of the software occlusion culling in model space, the polytope or a simpler proxy inside it
+    struct Occluder {
+        std::vector<glm::vec3> positions;
+        std::vector<unsigned int> indices;
+    };
 protected:
     VertexArray::Ptr vertexArray;
     VertexBuffer::Ptr vertexBuffer;
+    VertexArray::Ptr positionVertexArray;
+    PositionBuffer::Ptr positionBuffer;
     std::vector<Texture::Ptr> textures;
     unsigned int vertexLength, indicesLength;
     Material::Ptr material;
@@ -39,7 +55,16 @@ protected:
     bool selected;
     FaceCulling faceCulling;
     float emissionStrength;
+    bool transparent;
     bool tangentAndBitangents;
+    glm::vec3 boundsMin, boundsMax;
+    std::shared_ptr<Occluder> occluder;
+
+    // Every polytope gets its own, copies too
+    static unsigned long polytopeCount;
+    unsigned long id = polytopeCount ++;
+
+    static PositionStream defaultPositionStream;
 public:
     Polytope(size_t length);
     Polytope(std::vector<Vec3f>& vertices, bool _tangentAndBitangents = true);
@@ -48,11 +73,12 @@ public:
     Polytope(Polytope&& polytope) noexcept;
     Polytope() = default;
     virtual ~Polytope() = default;
-protected:
-    void setTangentsAndBitangents(Vec3f& vertex0, Vec3f& vertex1, Vec3f& vertex2);
-    void calculateTangentsAndBitangents(std::vector<Vec3f>& vertices);
-    void calculateTangentsAndBitangents(std::vector<Vec3f>& vertices, std::vector<unsigned int>& indices);
 public:
+    // CPU only, they don't need a GL context
+    static void setTangentsAndBitangents(Vec3f& vertex0, Vec3f& vertex1, Vec3f& vertex2);
+    static void calculateTangentsAndBitangents(std::vector<Vec3f>& vertices);
+    static void calculateTangentsAndBitangents(std::vector<Vec3f>& vertices, std::vector<unsigned int>& indices);
+
     void initPolytope(size_t length);
     void initPolytope(std::vector<Vec3f>& vertices);
     void initPolytope(std::vector<Vec3f>& vertices, std::vector<unsigned int>& indices);
@@ -63,6 +89,33 @@ public:
     void updateIndices(std::vector<unsigned int>& indices);
     void removeTexture(const Texture::Ptr& texture);
     void draw(unsigned int primitive, bool showWire = false);
+
+    /**
+     * @brief Creates the position only buffer and its vertex array, which shares the index buffer
+     *
+     * The vertices are read back from the vertex buffer. NONE frees them.
+     */
+    void createPositionStream(PositionStream positionStream);
+
+    /**
+     * @brief Draws with the position only vertex array, or like draw when there isn't one
+     *
+     * Quantized positions need getPositionDecode in front of the model matrix
+     */
+    void drawPositions(unsigned int primitive, bool showWire = false);
+
+    /**
+     * @brief The triangles of the polytope for setOccluder, read back from the vertex buffer
+     */
+    std::shared_ptr<Occluder> readOccluder();
+
+    /**
+     * @brief Axis aligned box of the vertices in model space
+     */
+    void calculateBounds(const std::vector<Vec3f>& vertices);
+protected:
+    void initPositionStream(const std::vector<Vec3f>& vertices, PositionStream positionStream);
+    void drawCall(unsigned int primitive, unsigned int stride);
 public:
     inline void translate(const glm::vec3& v) { modelMatrix = glm::translate(modelMatrix, v); }
     inline void rotate(float degrees, const glm::vec3& axis) { modelMatrix = glm::rotate(modelMatrix, glm::radians(degrees), axis); }
@@ -72,11 +125,26 @@ public:
     inline VertexBuffer::Ptr& getVertexBuffer() { return vertexBuffer; }
     inline IndexBuffer::Ptr& getIndexBuffer() { return vertexBuffer->getIndexBuffer(); }
 
+    inline VertexArray::Ptr& getPositionVertexArray() { return positionVertexArray; }
+    inline PositionBuffer::Ptr& getPositionBuffer() { return positionBuffer; }
+    inline PositionStream getPositionStream() const {
+        return positionBuffer == nullptr ? PositionStream::NONE : positionBuffer->isQuantized() ? PositionStream::QUANTIZED : PositionStream::FLOAT;
+    }
+    inline glm::mat4 getPositionDecode() const { return positionBuffer != nullptr ? positionBuffer->getDecodeMatrix() : glm::mat4(1.f); }
+
+    /**
+     * Polytopes created after this call get a position stream, QUANTIZED is FLOAT for the ones
+     * created with a length only (DynamicPolytope), their positions aren't known yet
+    */
+    inline static void setDefaultPositionStream(PositionStream positionStream) { defaultPositionStream = positionStream; }
+    inline static PositionStream getDefaultPositionStream() { return defaultPositionStream; }
+
     inline void addTexture(const Texture::Ptr& texture) { textures.push_back(texture); }
     inline void removeTexture(int index) { textures.erase(textures.begin() + index); }
     inline std::vector<Texture::Ptr>& getTextures() { return textures; }
 
     inline unsigned int getVertexLength() const { return vertexLength; }
+    inline unsigned int getIndicesLength() const { return indicesLength; }
 
     inline void setModelMatrix(const glm::mat4& modelMatrix) { this->modelMatrix = modelMatrix; }
     inline glm::mat4& getModelMatrix() { return modelMatrix; }
@@ -99,4 +167,19 @@ public:
 
     inline void setEmissionStrength(float emissionStrength) { this->emissionStrength = emissionStrength; }
     float getEmissionStrength() const { return emissionStrength; }
+
+    // Blended with what is behind, the deferred renderer draws it forward
+    inline void setTransparent(bool transparent) { this->transparent = transparent; }
+    inline bool isTransparent() const { return transparent; }
+
+    inline const glm::vec3& getBoundsMin() const { return boundsMin; }
+    inline const glm::vec3& getBoundsMax() const { return boundsMax; }
+    inline glm::vec3 getBoundsCenter() const { return (boundsMin + boundsMax) * 0.5f; }
+
+    // Hides what is behind it from the software occlusion culling, copies share it. Null: not an occluder
+    inline void setOccluder(const std::shared_ptr<Occluder>& occluder) { this->occluder = occluder; }
+    inline const std::shared_ptr<Occluder>& getOccluder() const { return occluder; }
+    inline bool isOccluder() const { return occluder != nullptr; }
+
+    inline unsigned long getID() const { return id; }
 };
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "LightClusters.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "engine/opengl/device/RenderDevice.h"
+
+#define CLUSTERS_COUNT (CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z)
+
+LightClusters::LightClusters()
+    : globalLights(0), boundsProjection(0.f), nearPlane(0.1f), farPlane(100.f), clustering(true), clustered(false),
+    lightTexture(nullptr), gridTexture(nullptr), indexTexture(nullptr) {
+    grid.resize(CLUSTERS_COUNT, glm::uvec2(0));
+}
+
+float LightClusters::sliceDepth(int slice) const {
+    return nearPlane * std::pow(farPlane / nearPlane, (float)slice / CLUSTERS_Z);
+}
+
+void LightClusters::computeBounds(const glm::mat4& projection) {
+
+    boundsProjection = projection;
+
+    // Planes of a perspective projection
+    nearPlane = projection[3][2] / (projection[2][2] - 1.f);
+    farPlane = projection[3][2] / (projection[2][2] + 1.f);
+    if(!std::isfinite(farPlane) || farPlane <= nearPlane) farPlane = nearPlane * 10000.f;
+
+    boundsMin.resize(CLUSTERS_COUNT);
+    boundsMax.resize(CLUSTERS_COUNT);
+
+    for(int z = 0; z < CLUSTERS_Z; z ++) {
+        float depths[2] = { sliceDepth(z), sliceDepth(z + 1) };
+        for(int y = 0; y < CLUSTERS_Y; y ++) {
+            float ndcY[2] = { 2.f * y / CLUSTERS_Y - 1.f, 2.f * (y + 1) / CLUSTERS_Y - 1.f };
+            for(int x = 0; x < CLUSTERS_X; x ++) {
+                float ndcX[2] = { 2.f * x / CLUSTERS_X - 1.f, 2.f * (x + 1) / CLUSTERS_X - 1.f };
+
+                // The 8 corners, a point at ndc and view depth d is ((ndc + P20) * d / P00, ...)
+                glm::vec3 min(INFINITY), max(-INFINITY);
+                for(float d : depths) {
+                    for(float nx : ndcX) {
+                        for(float ny : ndcY) {
+                            glm::vec3 corner((nx + projection[2][0]) * d / projection[0][0], (ny + projection[2][1]) * d / projection[1][1], -d);
+                            min = glm::min(min, corner);
+                            max = glm::max(max, corner);
+                        }
+                    }
+                }
+
+                int cluster = x + CLUSTERS_X * (y + CLUSTERS_Y * z);
+                boundsMin[cluster] = min;
+                boundsMax[cluster] = max;
+            }
+        }
+    }
+}
+
+void LightClusters::assign(unsigned int light, const glm::vec3& center, float radius, const glm::mat4& projection) {
+
+    // Depth slices touched by the sphere
+    float depth = -center.z;
+    float minDepth = std::max(depth - radius, nearPlane), maxDepth = std::min(depth + radius, farPlane);
+    if(minDepth > maxDepth) return;
+
+    float scale = CLUSTERS_Z / std::log(farPlane / nearPlane);
+    int minSlice = std::clamp((int)std::floor(std::log(minDepth / nearPlane) * scale), 0, CLUSTERS_Z - 1);
+    int maxSlice = std::clamp((int)std::floor(std::log(maxDepth / nearPlane) * scale), 0, CLUSTERS_Z - 1);
+
+    for(int z = minSlice; z <= maxSlice; z ++) {
+
+        // Conservative tile range: the sphere bounds projected at both ends of the slice
+        float d0 = std::max(sliceDepth(z), minDepth), d1 = std::min(sliceDepth(z + 1), maxDepth);
+        float minX = std::min((center.x - radius) / d0, (center.x - radius) / d1) * projection[0][0] - projection[2][0];
+        float maxX = std::max((center.x + radius) / d0, (center.x + radius) / d1) * projection[0][0] - projection[2][0];
+        float minY = std::min((center.y - radius) / d0, (center.y - radius) / d1) * projection[1][1] - projection[2][1];
+        float maxY = std::max((center.y + radius) / d0, (center.y + radius) / d1) * projection[1][1] - projection[2][1];
+        if(minX > 1.f || maxX < -1.f || minY > 1.f || maxY < -1.f) continue;
+
+        int x0 = std::clamp((int)std::floor((minX + 1.f) * 0.5f * CLUSTERS_X), 0, CLUSTERS_X - 1);
+        int x1 = std::clamp((int)std::floor((maxX + 1.f) * 0.5f * CLUSTERS_X), 0, CLUSTERS_X - 1);
+        int y0 = std::clamp((int)std::floor((minY + 1.f) * 0.5f * CLUSTERS_Y), 0, CLUSTERS_Y - 1);
+        int y1 = std::clamp((int)std::floor((maxY + 1.f) * 0.5f * CLUSTERS_Y), 0, CLUSTERS_Y - 1);
+
+        // Exact sphere and froxel box test
+        for(int y = y0; y <= y1; y ++) {
+            for(int x = x0; x <= x1; x ++) {
+                unsigned int cluster = x + CLUSTERS_X * (y + CLUSTERS_Y * z);
+                glm::vec3 closest = glm::clamp(center, boundsMin[cluster], boundsMax[cluster]);
+                glm::vec3 offset = closest - center;
+                if(glm::dot(offset, offset) <= radius * radius) assignments.push_back(glm::uvec2(cluster, light));
+            }
+        }
+    }
+}
+
+void LightClusters::addLight(Light* light, bool hdr, float radius, int shadowSlot) {
+
+    float intensity = hdr ? light->getIntensity() : 1.0f;
+    PointLight* pointLight = dynamic_cast<PointLight*>(light);
+
+    lightData.push_back(glm::vec4(light->getPosition(), radius));
+    lightData.push_back(glm::vec4(light->getColor() * intensity, pointLight != nullptr ? 1.f : 0.f));
+    if(pointLight != nullptr) lightData.push_back(glm::vec4(pointLight->getConstant(), pointLight->getLinear(), pointLight->getQuadratic(), shadowSlot + 1.f));
+    else lightData.push_back(glm::vec4(1.f, 0.f, 0.f, 0.f));
+}
+
+void LightClusters::build(const std::vector<Light*>& lights, const glm::mat4& projection, const glm::mat4& view, bool hdr,
+    const PointShadows* pointShadows) {
+
+    lightData.clear();
+    indices.clear();
+    assignments.clear();
+    localLights.clear();
+    std::fill(grid.begin(), grid.end(), glm::uvec2(0));
+
+    // Orthographic projections don't have depth slices
+    clustered = clustering && projection[3][3] == 0.f;
+    if(clustered && projection != boundsProjection) computeBounds(projection);
+
+    // Without clustering the lights with a radius are assigned to the objects
+    bool local = clustered || !clustering;
+
+    // Global lights first, the shaders loop over [0, globalLights) for every fragment
+    std::vector<std::pair<Light*, float>> clusteredLights;
+    for(size_t i = 0; i < lights.size(); i ++) {
+        PointLight* pointLight = dynamic_cast<PointLight*>(lights[i]);
+        float radius = INFINITY;
+        if(pointLight != nullptr) {
+            glm::vec3 color = pointLight->getColor() * (hdr ? pointLight->getIntensity() : 1.0f);
+            radius = pointLight->getRadius(std::max(color.r, std::max(color.g, color.b)));
+        }
+
+        if(i == 0 || !local || !std::isfinite(radius)) addLight(lights[i], hdr, 0.f, pointShadows != nullptr ? pointShadows->getSlot(lights[i]) : -1);
+        else if(radius > 0.f) clusteredLights.push_back(std::make_pair(lights[i], radius));
+    }
+    globalLights = lightData.size() / LIGHT_TEXELS;
+
+    for(auto& [light, radius] : clusteredLights) {
+        unsigned int index = lightData.size() / LIGHT_TEXELS;
+        addLight(light, hdr, radius, pointShadows != nullptr ? pointShadows->getSlot(light) : -1);
+        localLights.push_back(glm::vec4(light->getPosition(), radius));
+        if(clustered) assign(index, glm::vec3(view * glm::vec4(light->getPosition(), 1.f)), radius, projection);
+    }
+
+    // Counting sort of the assignments by froxel
+    for(const glm::uvec2& assignment : assignments) grid[assignment.x].y ++;
+    unsigned int offset = 0;
+    for(glm::uvec2& cluster : grid) {
+        cluster.x = offset;
+        offset += cluster.y;
+        cluster.y = 0;
+    }
+
+    indices.resize(assignments.size());
+    for(const glm::uvec2& assignment : assignments) {
+        glm::uvec2& cluster = grid[assignment.x];
+        indices[cluster.x + cluster.y] = assignment.y;
+        cluster.y ++;
+    }
+}
+
+void LightClusters::upload() {
+
+    if(lightTexture == nullptr) {
+        lightTexture = BufferTexture::New(GL_RGBA32F);
+        gridTexture = BufferTexture::New(GL_RG32UI);
+        indexTexture = BufferTexture::New(GL_R32UI);
+    }
+
+    lightTexture->update(lightData.data(), lightData.size() * sizeof(glm::vec4));
+    gridTexture->update(grid.data(), grid.size() * sizeof(glm::uvec2));
+    indexTexture->update(indices.data(), indices.size() * sizeof(unsigned int));
+}
+
+void LightClusters::uniforms(ShaderProgram::Ptr& shaderProgram, unsigned int viewportWidth, unsigned int viewportHeight) {
+
+    if(lightTexture == nullptr) return;
+
+    lightTexture->bind();
+    gridTexture->bind();
+    indexTexture->bind();
+    shaderProgram->uniformInt("lightData", lightTexture->getUnit());
+    shaderProgram->uniformInt("lightGrid", gridTexture->getUnit());
+    shaderProgram->uniformInt("lightIndices", indexTexture->getUnit());
+
+    shaderProgram->uniformInt("nLights", globalLights);
+    shaderProgram->uniformInt("clustered", clustered);
+
+    // slice = log(depth) * scale + bias
+    float scale = CLUSTERS_Z / std::log(farPlane / nearPlane);
+    shaderProgram->uniformFloat("clusterScale", scale);
+    shaderProgram->uniformFloat("clusterBias", -std::log(nearPlane) * scale);
+    shaderProgram->uniformFloat("clusterTileWidth", (float)viewportWidth / CLUSTERS_X);
+    shaderProgram->uniformFloat("clusterTileHeight", (float)viewportHeight / CLUSTERS_Y);
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "Light.h"
+#include "PointLight.h"
+#include "PointShadows.h"
+
+#include "engine/texture/BufferTexture.h"
+
+// Froxels: screen tiles and exponential depth slices. Same values in PBR.frag and SimpleLighting.frag
+#define CLUSTERS_X 16
+#define CLUSTERS_Y 9
+#define CLUSTERS_Z 24
+
+// vec4 texels per light in the light data buffer
+#define LIGHT_TEXELS 3
+
+/**
+ * @brief Clustered forward lighting, the shaders only loop over the lights of the fragment cluster.
+ *
+ * The view frustum is split in CLUSTERS_X x CLUSTERS_Y x CLUSTERS_Z froxels. Every frame the point
+ * lights are assigned on the CPU to the froxels their attenuation radius touches, and the lights,
+ * the froxel ranges and the light index lists are uploaded to buffer textures.
+ *
+ * The first light of the renderer and the lights which don't attenuate (directional lights,
+ * point lights with infinite radius) are global: every fragment loops over them. With an
+ * orthographic projection every light is global.
+ *
+ * Without clustering the froxels aren't built, the lights with a radius keep their spheres for
+ * the per object assignment (see ObjectLights).
+ */
+class LightClusters {
+    GENERATE_PTR(LightClusters)
+private:
+    // Per light: position and radius, color and point light flag, constant, linear, quadratic and shadow slot + 1
+    std::vector<glm::vec4> lightData;
+    // Per froxel: offset and count in the index list
+    std::vector<glm::uvec2> grid;
+    std::vector<unsigned int> indices;
+    unsigned int globalLights;
+
+    // (froxel, light) pairs, sorted by froxel into the index list
+    std::vector<glm::uvec2> assignments;
+
+    // View space bounds of the froxels, they only change with the projection
+    std::vector<glm::vec3> boundsMin, boundsMax;
+    glm::mat4 boundsProjection;
+    float nearPlane, farPlane;
+    bool clustering, clustered;
+
+    // World center and radius of the lights after the global ones
+    std::vector<glm::vec4> localLights;
+
+    BufferTexture::Ptr lightTexture, gridTexture, indexTexture;
+public:
+    LightClusters();
+    ~LightClusters() = default;
+private:
+    void computeBounds(const glm::mat4& projection);
+    void assign(unsigned int light, const glm::vec3& center, float radius, const glm::mat4& projection);
+    float sliceDepth(int slice) const;
+    void addLight(Light* light, bool hdr, float radius, int shadowSlot);
+public:
+    /**
+     * @brief Fills the lights, froxels and index lists on the CPU, it doesn't need a GL context.
+     * The lights keep their slot of the point shadows
+     */
+    void build(const std::vector<Light*>& lights, const glm::mat4& projection, const glm::mat4& view, bool hdr,
+        const PointShadows* pointShadows = nullptr);
+
+    /**
+     * @brief Uploads what build made to the buffer textures, they are created the first time
+     */
+    void upload();
+
+    /**
+     * @brief Binds the buffer textures and sets the cluster uniforms of a lighting program
+     */
+    void uniforms(ShaderProgram::Ptr& shaderProgram, unsigned int viewportWidth, unsigned int viewportHeight);
+public:
+    inline unsigned int getLightCount() const { return lightData.size() / LIGHT_TEXELS; }
+    inline unsigned int getGlobalLights() const { return globalLights; }
+    inline size_t getIndexCount() const { return indices.size(); }
+    inline bool isClustered() const { return clustered; }
+
+    // Off: no froxels, the shaders take per object light lists instead
+    inline void setClustering(bool clustering) { this->clustering = clustering; }
+    inline bool isClustering() const { return clustering; }
+    inline const std::vector<glm::vec4>& getLocalLights() const { return localLights; }
+
+    inline const glm::uvec2& getCluster(unsigned int x, unsigned int y, unsigned int z) const { return grid[x + CLUSTERS_X * (y + CLUSTERS_Y * z)]; }
+    inline const std::vector<unsigned int>& getIndices() const { return indices; }
+};
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "ObjectLights.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+ObjectLights::ObjectLights()
+    : firstIndex(0), cellSize(1.f), stamp(0), queries(0), assigned(0) {
+}
+
+glm::ivec3 ObjectLights::getCell(const glm::vec3& position) const {
+    // Far away positions are clamped, the ints don't overflow
+    return glm::ivec3(glm::clamp(glm::floor(position / cellSize), glm::vec3(-1e6f), glm::vec3(1e6f)));
+}
+
+unsigned int ObjectLights::getBucket(const glm::ivec3& cell) const {
+    unsigned int hash = (unsigned int)cell.x * 73856093u ^ (unsigned int)cell.y * 19349663u ^ (unsigned int)cell.z * 83492791u;
+    return hash & (buckets.size() - 1);
+}
+
+void ObjectLights::build(const std::vector<glm::vec4>& spheres, unsigned int firstIndex) {
+
+    this->spheres = spheres;
+    this->firstIndex = firstIndex;
+    buckets.clear();
+    entries.clear();
+    largeLights.clear();
+    pairs.clear();
+    queries = assigned = 0;
+
+    if(spheres.empty()) return;
+
+    // Cells of the mean diameter, most lights touch a few of them
+    float diameter = 0.f;
+    for(const glm::vec4& sphere : spheres) diameter += 2.f * sphere.w;
+    cellSize = std::max(diameter / spheres.size(), 1e-3f);
+
+    // A power of 2 of buckets, twice the lights
+    unsigned int bucketCount = 64;
+    while(bucketCount < 2 * spheres.size()) bucketCount <<= 1;
+    buckets.assign(bucketCount, glm::uvec2(0));
+
+    for(unsigned int i = 0; i < spheres.size(); i ++) {
+        glm::vec3 center(spheres[i]);
+        glm::ivec3 low = getCell(center - spheres[i].w), high = getCell(center + spheres[i].w);
+        glm::ivec3 span = high - low + 1;
+        if((long long)span.x * span.y * span.z > OBJECT_LIGHTS_MAX_CELLS) {
+            largeLights.push_back(i);
+            continue;
+        }
+
+        for(int z = low.z; z <= high.z; z ++) {
+            for(int y = low.y; y <= high.y; y ++) {
+                for(int x = low.x; x <= high.x; x ++) pairs.push_back(glm::uvec2(getBucket(glm::ivec3(x, y, z)), i));
+            }
+        }
+    }
+
+    // Counting sort of the pairs by bucket
+    for(const glm::uvec2& pair : pairs) buckets[pair.x].y ++;
+    unsigned int offset = 0;
+    for(glm::uvec2& bucket : buckets) {
+        bucket.x = offset;
+        offset += bucket.y;
+        bucket.y = 0;
+    }
+
+    entries.resize(pairs.size());
+    for(const glm::uvec2& pair : pairs) {
+        glm::uvec2& bucket = buckets[pair.x];
+        entries[bucket.x + bucket.y] = pair.y;
+        bucket.y ++;
+    }
+
+    stamps.assign(spheres.size(), 0);
+    stamp = 0;
+}
+
+void ObjectLights::test(unsigned int light, const glm::vec3& low, const glm::vec3& high) {
+
+    // A light can be in several cells of the box, and buckets are shared by several cells
+    if(stamps[light] == stamp) return;
+    stamps[light] = stamp;
+
+    glm::vec3 center(spheres[light]);
+    float radius = spheres[light].w;
+    float distance = glm::length(glm::clamp(center, low, high) - center);
+    if(distance <= radius) candidates.push_back(std::make_pair(distance / radius, light));
+}
+
+unsigned int ObjectLights::query(const glm::mat4& model, const glm::vec3& boundsMin, const glm::vec3& boundsMax, int* indices) {
+
+    queries ++;
+    if(spheres.empty()) return 0;
+
+    // World box of the draw: the center and the projected extents
+    glm::vec3 center = glm::vec3(model * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.f));
+    glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+    glm::vec3 projected = glm::abs(glm::vec3(model[0])) * extent.x + glm::abs(glm::vec3(model[1])) * extent.y + glm::abs(glm::vec3(model[2])) * extent.z;
+    glm::vec3 low = center - projected, high = center + projected;
+
+    candidates.clear();
+    if(++ stamp == 0) {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        stamp = 1;
+    }
+
+    for(unsigned int light : largeLights) test(light, low, high);
+
+    // Big boxes test every light instead of walking their cells
+    glm::ivec3 lowCell = getCell(low), highCell = getCell(high);
+    glm::ivec3 span = highCell - lowCell + 1;
+    if((long long)span.x * span.y * span.z > OBJECT_LIGHTS_MAX_CELLS) {
+        for(unsigned int light = 0; light < spheres.size(); light ++) test(light, low, high);
+    }
+    else {
+        for(int z = lowCell.z; z <= highCell.z; z ++) {
+            for(int y = lowCell.y; y <= highCell.y; y ++) {
+                for(int x = lowCell.x; x <= highCell.x; x ++) {
+                    const glm::uvec2& bucket = buckets[getBucket(glm::ivec3(x, y, z))];
+                    for(unsigned int i = bucket.x; i < bucket.x + bucket.y; i ++) test(entries[i], low, high);
+                }
+            }
+        }
+    }
+
+    // The closest lights relative to their radius, then in the order of the light data
+    unsigned int count = std::min((unsigned int)candidates.size(), (unsigned int)OBJECT_MAX_LIGHTS);
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+    for(unsigned int i = 0; i < count; i ++) indices[i] = firstIndex + candidates[i].second;
+    std::sort(indices, indices + count);
+
+    assigned += count;
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "engine/ptr.h"
+
+// Lights per draw besides the global ones. Same value in PBR.frag and SimpleLighting.frag
+#define OBJECT_MAX_LIGHTS 8
+
+// Cells a light can span in the grid, the bigger ones are tested by every query
+#define OBJECT_LIGHTS_MAX_CELLS 64
+
+/**
+ * @brief Per object light lists, the forward lighting without froxels.
+ *
+ * The influence spheres of the point lights (the attenuation radius, see PointLight::getRadius)
+ * are hashed every frame in a uniform grid of cells as big as their mean diameter. A draw looks
+ * up the cells its world bounding box covers and gets the lights whose sphere touches the box,
+ * the OBJECT_MAX_LIGHTS closest ones (relative to their radius) when there are more.
+ *
+ * The indices are the ones of the light data of LightClusters, where the lights with a radius
+ * follow the global lights.
+ */
+class ObjectLights {
+    GENERATE_PTR(ObjectLights)
+private:
+    // World center and radius, the light index is firstIndex + the sphere index
+    std::vector<glm::vec4> spheres;
+    unsigned int firstIndex;
+    float cellSize;
+
+    // Per bucket of the grid: offset and count in the entries, then the lights too big for the grid
+    std::vector<glm::uvec2> buckets;
+    std::vector<unsigned int> entries;
+    std::vector<unsigned int> largeLights;
+
+    // (bucket, light) pairs, sorted by bucket into the entries
+    std::vector<glm::uvec2> pairs;
+
+    // Lights already tested by the query
+    std::vector<unsigned int> stamps;
+    unsigned int stamp;
+    std::vector<std::pair<float, unsigned int>> candidates;
+
+    // Draws and lights assigned since the last build
+    unsigned int queries, assigned;
+public:
+    ObjectLights();
+    ~ObjectLights() = default;
+private:
+    glm::ivec3 getCell(const glm::vec3& position) const;
+    unsigned int getBucket(const glm::ivec3& cell) const;
+    void test(unsigned int light, const glm::vec3& low, const glm::vec3& high);
+public:
+    /**
+     * @brief Hashes the spheres of this frame, CPU only
+     */
+    void build(const std::vector<glm::vec4>& spheres, unsigned int firstIndex);
+
+    /**
+     * @brief Lights touching the box of the draw, up to OBJECT_MAX_LIGHTS in ascending order. Returns their count
+     */
+    unsigned int query(const glm::mat4& model, const glm::vec3& boundsMin, const glm::vec3& boundsMax, int* indices);
+public:
+    inline unsigned int getLightCount() const { return spheres.size(); }
+    inline unsigned int getQueries() const { return queries; }
+    inline unsigned int getAssigned() const { return assigned; }
+    inline float getLightsPerQuery() const { return queries > 0 ? (float)assigned / queries : 0.f; }
+};
\ No newline at end of file
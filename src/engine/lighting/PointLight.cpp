@@ -1,5 +1,8 @@
 #include "PointLight.h"
 
+#include <cmath>
+#include <limits>
+
 PointLight::PointLight(const glm::vec3& position) 
     : PointLight(position, glm::vec3(1)) {
 }
@@ -9,5 +12,16 @@ PointLight::PointLight(const glm::vec3& position, const glm::vec3& color)
 }
 
 PointLight::PointLight(const glm::vec3& position, const glm::vec3& color, float _constant, float _linear, float _quadratic) 
-    : Light(position, color), constant(_constant), linear(_linear), quadratic(_quadratic) {
+    : Light(position, color), constant(_constant), linear(_linear), quadratic(_quadratic),
+    shadowCaster(true), shadowPriority(1.f) {
+}
+
+float PointLight::getRadius(float brightness) const {
+
+    float c = constant - brightness / ATTENUATION_CUTOFF;
+    if(c >= 0.f) return 0.f;
+
+    if(quadratic > 0.f) return (-linear + std::sqrt(linear * linear - 4.f * quadratic * c)) / (2.f * quadratic);
+    if(linear > 0.f) return -c / linear;
+    return std::numeric_limits<float>::infinity();
 }
\ No newline at end of file
@@ -6,18 +6,31 @@
 #define LINEAR 0.09f
 #define QUADRATIC 0.032f
 
+// Attenuated brightness below which a point light doesn't reach
+#define ATTENUATION_CUTOFF (5.0f / 256.0f)
+
 class PointLight : public Light {
     GENERATE_PTR(PointLight)
 private:
     float constant;
     float linear;
     float quadratic;
+
+    // Omnidirectional shadows, the most important lights of the budget get them
+    bool shadowCaster;
+    float shadowPriority;
 public:
     PointLight(const glm::vec3& position);
     PointLight(const glm::vec3& position, const glm::vec3& color);
     PointLight(const glm::vec3& position, const glm::vec3& color, float _constant, float _linear, float _quadratic);
     PointLight() = default;
     virtual ~PointLight() = default;
+public:
+    /**
+     * @brief Distance where brightness / (constant + linear * d + quadratic * d^2) falls
+     * to ATTENUATION_CUTOFF. 0 if it's never brighter, infinity if it doesn't attenuate
+     */
+    float getRadius(float brightness) const;
 public:
     inline void setConstant(float constant) { this->constant = constant; }
     inline float getConstant() const { return constant; }
@@ -27,4 +40,11 @@ public:
 
     inline void setQuadratic(float quadratic) { this->quadratic = quadratic; }
     inline float getQuadratic() const { return quadratic; }
+
+    inline void setShadowCaster(bool shadowCaster) { this->shadowCaster = shadowCaster; }
+    inline bool isShadowCaster() const { return shadowCaster; }
+
+    // Weight of the light when the shadow budget is shared out, 0 never gets shadows
+    inline void setShadowPriority(float shadowPriority) { this->shadowPriority = shadowPriority; }
+    inline float getShadowPriority() const { return shadowPriority; }
 };
\ No newline at end of file
@@ -0,0 +1,263 @@
+#include "PointShadows.h"
+
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "engine/opengl/device/RenderDevice.h"
+
+PointShadows::PointShadows(unsigned int _budget, unsigned int _size, GLenum _format)
+    : budget(glm::clamp(_budget, 1u, (unsigned int)POINT_SHADOW_MAX_LIGHTS)), size(_size), format(_format), caching(true),
+    filter(ShadowCascades::POISSON), quality(ShadowCascades::MEDIUM), filterRadius(SHADOW_FILTER_RADIUS),
+    frameBuffer(nullptr), depthTexture(nullptr) {
+    for(Slot& slot : slots) {
+        slot.light = nullptr;
+        slot.position = glm::vec3(0.f);
+        slot.farPlane = 0.f;
+        for(glm::mat4& matrix : slot.faceMatrices) matrix = glm::mat4(1.f);
+        for(uint64_t& signature : slot.signatures) signature = 0;
+        slot.cachedFaces = 0;
+    }
+}
+
+void PointShadows::allocate() {
+
+    // 6 layers per slot of the budget
+    depthTexture = DepthArrayTexture::New(size, size, 6 * budget, format);
+
+    frameBuffer = FrameBuffer::New();
+    frameBuffer->toTextureLayered(GL_DEPTH_ATTACHMENT, depthTexture->getID());
+    RenderDevice::get()->drawBuffer(GL_NONE);
+    RenderDevice::get()->readBuffer(GL_NONE);
+
+    if(!frameBuffer->isComplete()) std::cout << "Point shadows framebuffer not complete!" << std::endl;
+
+    frameBuffer->unbind();
+}
+
+void PointShadows::getFaceBasis(unsigned int face, glm::vec3& forward, glm::vec3& up) {
+
+    // Orientation of the cube map faces
+    static const glm::vec3 forwards[6] = { { 1.f, 0.f, 0.f }, { -1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f }, { 0.f, -1.f, 0.f }, { 0.f, 0.f, 1.f }, { 0.f, 0.f, -1.f } };
+    static const glm::vec3 ups[6] = { { 0.f, -1.f, 0.f }, { 0.f, -1.f, 0.f }, { 0.f, 0.f, 1.f }, { 0.f, 0.f, -1.f }, { 0.f, -1.f, 0.f }, { 0.f, -1.f, 0.f } };
+
+    forward = forwards[face];
+    up = ups[face];
+}
+
+glm::mat4 PointShadows::computeFaceMatrix(unsigned int face, const glm::vec3& position, float farPlane, float faceScale) {
+
+    glm::vec3 forward, up;
+    getFaceBasis(face, forward, up);
+
+    // 90 degrees, a bit more with the margin
+    glm::mat4 projection = glm::perspective(glm::radians(90.f), 1.f, POINT_SHADOW_NEAR, farPlane);
+    projection[0][0] *= faceScale;
+    projection[1][1] *= faceScale;
+
+    return projection * glm::lookAt(position, position + forward, up);
+}
+
+void PointShadows::updateSlot(Slot& slot, const glm::vec3& position, float farPlane) {
+
+    if(slot.position == position && slot.farPlane == farPlane) return;
+
+    slot.position = position;
+    slot.farPlane = farPlane;
+    for(unsigned int face = 0; face < 6; face ++) slot.faceMatrices[face] = computeFaceMatrix(face, position, farPlane, getFaceScale());
+
+    // Every face moved with the light
+    slot.cachedFaces = 0;
+}
+
+void PointShadows::update(const std::vector<Light*>& lights, const glm::mat4& projection, const glm::mat4& view, const glm::vec3& eye,
+    bool hdr, const Light* excluded) {
+
+    // Planes of the view frustum (Gribb and Hartmann), the lights behind one of them don't light what's seen
+    glm::mat4 matrix = glm::transpose(projection * view);
+    glm::vec4 planes[6];
+    for(int i = 0; i < 3; i ++) {
+        planes[2 * i] = matrix[3] + matrix[i];
+        planes[2 * i + 1] = matrix[3] - matrix[i];
+    }
+
+    struct Candidate {
+        const Light* light;
+        glm::vec3 position;
+        float farPlane, score;
+    };
+    std::vector<Candidate> candidates;
+
+    for(Light* light : lights) {
+
+        PointLight* pointLight = dynamic_cast<PointLight*>(light);
+        if(light == excluded || pointLight == nullptr) continue;
+        if(!pointLight->isShadowCaster() || pointLight->getShadowPriority() <= 0.f) continue;
+
+        // The shadows end where the light does
+        glm::vec3 color = pointLight->getColor() * (hdr ? pointLight->getIntensity() : 1.0f);
+        float farPlane = std::min(pointLight->getRadius(std::max(color.r, std::max(color.g, color.b))), POINT_SHADOW_FAR);
+        if(farPlane <= POINT_SHADOW_NEAR) continue;
+
+        glm::vec3 position = light->getPosition();
+        bool visible = true;
+        for(const glm::vec4& plane : planes) visible &= glm::dot(glm::vec3(plane), position) + plane.w >= -farPlane * glm::length(glm::vec3(plane));
+        if(!visible) continue;
+
+        // Size of the light sphere on screen, 1 from inside
+        float distance = glm::length(position - eye);
+        float score = pointLight->getShadowPriority() * std::min(1.f, farPlane / std::max(distance, 1e-4f));
+        if(getSlot(light) >= 0) score *= POINT_SHADOW_HYSTERESIS;
+
+        candidates.push_back({ light, position, farPlane, score });
+    }
+
+    // The best lights of the budget
+    size_t count = std::min(candidates.size(), (size_t)budget);
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.score > b.score;
+    });
+    candidates.resize(count);
+
+    // The lights left out free their slots, the others keep theirs
+    for(Slot& slot : slots) {
+        if(slot.light == nullptr) continue;
+        bool chosen = std::any_of(candidates.begin(), candidates.end(), [&slot](const Candidate& candidate) { return candidate.light == slot.light; });
+        if(!chosen) slot.light = nullptr;
+    }
+
+    for(const Candidate& candidate : candidates) {
+        int index = getSlot(candidate.light);
+        if(index < 0) {
+            for(index = 0; slots[index].light != nullptr; index ++);
+            slots[index].light = candidate.light;
+            slots[index].cachedFaces = 0;
+        }
+        updateSlot(slots[index], candidate.position, candidate.farPlane);
+    }
+}
+
+unsigned int PointShadows::getCasterFaces(unsigned int slot, const glm::mat4& model, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const {
+
+    const Slot& data = slots[slot];
+
+    // World box of the caster, around the light
+    glm::vec3 center = glm::vec3(model * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.f)) - data.position;
+    glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+    glm::vec3 projected = glm::abs(glm::vec3(model[0])) * extent.x + glm::abs(glm::vec3(model[1])) * extent.y + glm::abs(glm::vec3(model[2])) * extent.z;
+    glm::vec3 low = center - projected, high = center + projected;
+
+    // Out of the light range
+    glm::vec3 closest = glm::clamp(glm::vec3(0.f), low, high);
+    if(glm::dot(closest, closest) > data.farPlane * data.farPlane) return 0;
+
+    // A face sees |u| <= w / faceScale along its axis w, the box must be inside the 4 planes of the pyramid
+    float slope = 1.f / getFaceScale();
+    unsigned int faces = 0;
+    for(unsigned int face = 0; face < 6; face ++) {
+        int axis = face / 2;
+        float w = face % 2 == 0 ? high[axis] : -low[axis];
+        if(w <= 0.f) continue;
+
+        bool inside = true;
+        for(int other = 0; other < 3; other ++) {
+            if(other != axis) inside &= w * slope + high[other] >= 0.f && w * slope - low[other] >= 0.f;
+        }
+        if(inside) faces |= 1u << face;
+    }
+    return faces;
+}
+
+unsigned int PointShadows::setCasters(unsigned int slot, const uint64_t* signatures, unsigned int dynamicFaces) {
+
+    Slot& data = slots[slot];
+    for(unsigned int face = 0; face < 6; face ++) {
+        if(signatures[face] != data.signatures[face]) data.cachedFaces &= ~(1u << face);
+        data.signatures[face] = signatures[face];
+    }
+    if(!caching) data.cachedFaces = 0;
+
+    return (~data.cachedFaces | dynamicFaces) & 0x3F;
+}
+
+void PointShadows::bindFaces(unsigned int slot, unsigned int faces, unsigned int dynamicFaces) {
+
+    if(depthTexture == nullptr) allocate();
+
+    frameBuffer->bind();
+    RenderDevice::get()->viewport(0, 0, size, size);
+
+    // A layer at a time, clearing the layered attachment would clear the other faces too
+    for(unsigned int face = 0; face < 6; face ++) {
+        if((faces & (1u << face)) == 0) continue;
+        frameBuffer->toTextureLayer(GL_DEPTH_ATTACHMENT, depthTexture->getID(), 6 * slot + face);
+        RenderDevice::get()->clear(GL_DEPTH_BUFFER_BIT);
+    }
+    frameBuffer->toTextureLayered(GL_DEPTH_ATTACHMENT, depthTexture->getID());
+
+    slots[slot].cachedFaces |= faces & ~dynamicFaces;
+}
+
+void PointShadows::depthUniforms(ShaderProgram::Ptr& shaderProgram, unsigned int slot) {
+
+    shaderProgram->uniformInt("layer", 6 * slot);
+    for(unsigned int face = 0; face < 6; face ++)
+        shaderProgram->uniformMat4("faceMatrices[" + std::to_string(face) + "]", slots[slot].faceMatrices[face]);
+}
+
+void PointShadows::uniforms(ShaderProgram::Ptr& shaderProgram) {
+
+    if(depthTexture == nullptr) return;
+
+    depthTexture->bind();
+    shaderProgram->uniformInt("pointShadowMap", depthTexture->getUnit());
+    shaderProgram->uniformFloat("pointShadowFaceScale", getFaceScale());
+
+    // PCSS needs the size of every light, the point lights take the rotated disk instead
+    shaderProgram->uniformInt("pointShadowFilter", filter == ShadowCascades::PCSS ? ShadowCascades::ROTATED_DISK : filter);
+    shaderProgram->uniformInt("pointShadowSamples", ShadowCascades::getSamples(quality));
+    shaderProgram->uniformFloat("pointShadowRadius", filterRadius);
+
+    for(unsigned int i = 0; i < budget; i ++)
+        shaderProgram->uniformFloat("pointShadowFar[" + std::to_string(i) + "]", slots[i].farPlane);
+}
+
+int PointShadows::getSlot(const Light* light) const {
+    for(unsigned int i = 0; i < budget; i ++) {
+        if(slots[i].light == light) return i;
+    }
+    return -1;
+}
+
+void PointShadows::invalidate() {
+    for(Slot& slot : slots) slot.cachedFaces = 0;
+}
+
+void PointShadows::release() {
+    depthTexture = nullptr;
+    frameBuffer = nullptr;
+    for(Slot& slot : slots) slot.light = nullptr;
+    invalidate();
+}
+
+void PointShadows::setBudget(unsigned int budget) {
+    budget = glm::clamp(budget, 1u, (unsigned int)POINT_SHADOW_MAX_LIGHTS);
+    if(budget == this->budget) return;
+    this->budget = budget;
+    release();
+}
+
+void PointShadows::setSize(unsigned int size) {
+    if(size <= 2 * POINT_SHADOW_MARGIN) {
+        std::cout << "Point shadows size must be greater than " << 2 * POINT_SHADOW_MARGIN << std::endl;
+        return;
+    }
+    if(size == this->size) return;
+    this->size = size;
+
+    // The face matrices depend on the margin
+    for(Slot& slot : slots) slot.farPlane = 0.f;
+    release();
+}
\ No newline at end of file
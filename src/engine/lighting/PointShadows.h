@@ -0,0 +1,170 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/common.hpp>
+
+#include "Light.h"
+#include "PointLight.h"
+#include "ShadowCascades.h"
+
+#include "engine/opengl/shader/Shader.h"
+#include "engine/opengl/buffer/FrameBuffer.h"
+#include "engine/texture/DepthArrayTexture.h"
+
+// Same value in SimpleLighting.frag
+#define POINT_SHADOW_MAX_LIGHTS 8
+
+#define POINT_SHADOW_SIZE 512
+#define POINT_SHADOW_BUDGET 4
+#define POINT_SHADOW_NEAR 0.05f
+// Far plane of the lights which don't attenuate
+#define POINT_SHADOW_FAR 100.f
+// Texels around every face for the filters, they read the neighbour faces there otherwise
+#define POINT_SHADOW_MARGIN 4
+// Score bonus of the lights which already have shadows, equal lights don't swap them every frame
+#define POINT_SHADOW_HYSTERESIS 1.1f
+
+/**
+ * @brief Omnidirectional shadows of the point lights, a cube of 6 faces per light.
+ *
+ * Only the budget of lights gets shadows: every frame the shadow casters in the view frustum are
+ * scored by their priority and their size on screen (radius over distance to the camera), the
+ * best ones take a slot. A light keeps its slot, and its cached faces, as long as it's chosen.
+ *
+ * The faces are the layers of a depth texture array (6 per slot, in the order of the cube map
+ * faces +X, -X, +Y, -Y, +Z, -Z), all of them are rendered in one pass: the geometry shader emits
+ * every triangle to the layers of the faces its caster touches (gl_Layer). A face frustum is
+ * a bit wider than 90 degrees, the margin keeps the filter taps inside the face.
+ *
+ * A face is rendered again only when the light moves or the signature of the static casters in
+ * it changes (the renderer hashes them per face). The faces with dynamic casters are rendered
+ * every frame.
+ */
+class PointShadows {
+    GENERATE_PTR(PointShadows)
+public:
+    struct Slot {
+        // nullptr when the slot is free
+        const Light* light;
+        glm::vec3 position;
+        float farPlane;
+        glm::mat4 faceMatrices[6];
+
+        // Static casters of every face and the faces up to date
+        uint64_t signatures[6];
+        unsigned int cachedFaces;
+    };
+private:
+    Slot slots[POINT_SHADOW_MAX_LIGHTS];
+    unsigned int budget, size;
+    GLenum format;
+    bool caching;
+
+    ShadowCascades::Filter filter;
+    ShadowCascades::Quality quality;
+    float filterRadius;
+
+    FrameBuffer::Ptr frameBuffer;
+    DepthArrayTexture::Ptr depthTexture;
+public:
+    PointShadows(unsigned int _budget = POINT_SHADOW_BUDGET, unsigned int _size = POINT_SHADOW_SIZE, GLenum _format = SHADOW_DEPTH_FORMAT);
+    ~PointShadows() = default;
+private:
+    void allocate();
+    void updateSlot(Slot& slot, const glm::vec3& position, float farPlane);
+public:
+    /**
+     * @brief Forward and up vectors of a cube face, the view of the face looks along forward
+     */
+    static void getFaceBasis(unsigned int face, glm::vec3& forward, glm::vec3& up);
+
+    /**
+     * @brief Projection and view of a cube face, the projection is scaled by faceScale to cover the margin
+     */
+    static glm::mat4 computeFaceMatrix(unsigned int face, const glm::vec3& position, float farPlane, float faceScale);
+
+    /**
+     * @brief Chooses the lights of this frame among the point lights, except the excluded one (the light
+     * of the cascaded shadows). The lights left out lose their slots. CPU only
+     */
+    void update(const std::vector<Light*>& lights, const glm::mat4& projection, const glm::mat4& view, const glm::vec3& eye,
+        bool hdr, const Light* excluded);
+
+    /**
+     * @brief Faces of the slot the box can cast a shadow in, a bit per face. 0 when it's out of the light range
+     */
+    unsigned int getCasterFaces(unsigned int slot, const glm::mat4& model, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+
+    /**
+     * @brief Signatures of the static casters of every face of the slot, the faces where it changed or
+     * with dynamic casters are dropped. Returns the faces to render
+     */
+    unsigned int setCasters(unsigned int slot, const uint64_t* signatures, unsigned int dynamicFaces);
+
+    /**
+     * @brief Clears the faces of the slot and binds every layer of the depth texture to draw them.
+     * The faces are cached once they're rendered, except the dynamic ones
+     */
+    void bindFaces(unsigned int slot, unsigned int faces, unsigned int dynamicFaces);
+
+    /**
+     * @brief Face matrices and first layer of the slot, for the depth program
+     */
+    void depthUniforms(ShaderProgram::Ptr& shaderProgram, unsigned int slot);
+
+    /**
+     * @brief Binds the depth texture and sets the point shadow uniforms of a lighting program
+     */
+    void uniforms(ShaderProgram::Ptr& shaderProgram);
+
+    /**
+     * @brief Slot of the light, -1 without shadows this frame
+     */
+    int getSlot(const Light* light) const;
+
+    /**
+     * @brief Renders every face again the next frame
+     */
+    void invalidate();
+
+    /**
+     * @brief Frees the depth texture and the frame buffer, the slots are free again
+     */
+    void release();
+
+    /**
+     * @brief Number of lights with shadows per frame, up to POINT_SHADOW_MAX_LIGHTS
+     */
+    void setBudget(unsigned int budget);
+
+    /**
+     * @brief Width and height of every face
+     */
+    void setSize(unsigned int size);
+public:
+    inline const Slot& getSlotData(unsigned int slot) const { return slots[slot]; }
+    inline unsigned int getBudget() const { return budget; }
+    inline unsigned int getSize() const { return size; }
+
+    // Projected size of the face over the size of the texture, the rest is the margin
+    inline float getFaceScale() const { return (float)(size - 2 * POINT_SHADOW_MARGIN) / size; }
+
+    // Off: every face is rendered every frame
+    inline void setCaching(bool caching) { this->caching = caching; invalidate(); }
+    inline bool isCaching() const { return caching; }
+
+    inline void setFilter(ShadowCascades::Filter filter) { this->filter = filter; }
+    inline ShadowCascades::Filter getFilter() const { return filter; }
+
+    inline void setQuality(ShadowCascades::Quality quality) { this->quality = quality; }
+    inline ShadowCascades::Quality getQuality() const { return quality; }
+
+    inline void setFilterRadius(float filterRadius) { this->filterRadius = filterRadius; }
+    inline float getFilterRadius() const { return filterRadius; }
+
+    inline DepthArrayTexture::Ptr& getDepthTexture() { return depthTexture; }
+};
\ No newline at end of file
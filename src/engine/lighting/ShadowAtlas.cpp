@@ -0,0 +1,153 @@
+#include "ShadowAtlas.h"
+
+#include <algorithm>
+
+#include "engine/opengl/device/RenderDevice.h"
+
+ShadowAtlas::ShadowAtlas(unsigned int _size, GLenum _format, unsigned int _minTileSize)
+    : size(_size), minTileSize(_minTileSize), usedArea(0), format(_format),
+    frameBuffer(nullptr), depthTexture(nullptr) {
+    clear();
+}
+
+void ShadowAtlas::allocate() {
+
+    depthTexture = DepthTexture::New(size, size, format);
+
+    frameBuffer = FrameBuffer::New();
+    frameBuffer->toTexture(GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture->getID());
+    RenderDevice::get()->drawBuffer(GL_NONE);
+    RenderDevice::get()->readBuffer(GL_NONE);
+
+    if(!frameBuffer->isComplete()) std::cout << "Shadow atlas framebuffer not complete!" << std::endl;
+
+    frameBuffer->unbind();
+}
+
+void ShadowAtlas::split(int node) {
+
+    int children;
+    if(!freeBlocks.empty()) {
+        children = freeBlocks.back();
+        freeBlocks.pop_back();
+    }
+    else {
+        children = nodes.size();
+        nodes.resize(nodes.size() + 4);
+    }
+
+    const Node parent = nodes[node];
+    unsigned int half = parent.size / 2;
+    for(int i = 0; i < 4; i ++)
+        nodes[children + i] = { parent.x + (i & 1) * half, parent.y + (i >> 1) * half, half, node, -1, false };
+
+    nodes[node].children = children;
+}
+
+int ShadowAtlas::find(int node, unsigned int size) {
+
+    if(nodes[node].used || nodes[node].size < size) return -1;
+
+    if(nodes[node].children < 0) {
+        if(nodes[node].size == size) return node;
+        split(node);
+    }
+    // Some of its tiles are used
+    else if(nodes[node].size == size) return -1;
+
+    for(int i = 0; i < 4; i ++) {
+        int found = find(nodes[node].children + i, size);
+        if(found >= 0) return found;
+    }
+
+    return -1;
+}
+
+ShadowAtlas::Tile ShadowAtlas::allocateTile(unsigned int size) {
+
+    unsigned int tileSize = getMinTileSize();
+    while(tileSize < size && tileSize < this->size) tileSize *= 2;
+
+    int node = size <= this->size ? find(0, tileSize) : -1;
+    if(node < 0) return { 0, 0, 0, -1 };
+
+    nodes[node].used = true;
+    usedArea += (size_t)tileSize * tileSize;
+
+    return { nodes[node].x, nodes[node].y, tileSize, node };
+}
+
+void ShadowAtlas::freeTile(const Tile& tile) {
+
+    if(!tile.isValid() || tile.node >= (int)nodes.size()) return;
+
+    Node& node = nodes[tile.node];
+    if(!node.used || node.x != tile.x || node.y != tile.y || node.size != tile.size) {
+        std::cout << "Shadow atlas tile is not allocated" << std::endl;
+        return;
+    }
+
+    node.used = false;
+    usedArea -= (size_t)tile.size * tile.size;
+
+    // Merge the free siblings back in their parent
+    for(int parent = node.parent; parent >= 0; parent = nodes[parent].parent) {
+        int children = nodes[parent].children;
+        for(int i = 0; i < 4; i ++) {
+            const Node& child = nodes[children + i];
+            if(child.used || child.children >= 0) return;
+        }
+        freeBlocks.push_back(children);
+        nodes[parent].children = -1;
+    }
+}
+
+void ShadowAtlas::clear() {
+    nodes.assign(1, { 0, 0, size, -1, -1, false });
+    freeBlocks.clear();
+    usedArea = 0;
+}
+
+void ShadowAtlas::begin() {
+
+    if(depthTexture == nullptr) allocate();
+
+    frameBuffer->bind();
+    RenderDevice::get()->viewport(0, 0, size, size);
+    RenderDevice::get()->clear(GL_DEPTH_BUFFER_BIT);
+}
+
+void ShadowAtlas::bindTile(const Tile& tile) {
+    RenderDevice::get()->viewport(tile.x, tile.y, tile.size, tile.size);
+}
+
+glm::vec4 ShadowAtlas::getTileTransform(const Tile& tile) const {
+    float scale = (float)tile.size / size;
+    return glm::vec4(scale, scale, (float)tile.x / size, (float)tile.y / size);
+}
+
+void ShadowAtlas::release() {
+    depthTexture = nullptr;
+    frameBuffer = nullptr;
+}
+
+void ShadowAtlas::setSize(unsigned int size) {
+    if(size == 0 || (size & (size - 1)) != 0) {
+        std::cout << "Shadow atlas size must be a power of two" << std::endl;
+        return;
+    }
+    if(size == this->size) return;
+    this->size = size;
+    release();
+    clear();
+}
+
+void ShadowAtlas::setFormat(GLenum format) {
+    if(!DepthTexture::isShadowFormat(format)) {
+        std::cout << "Shadow atlas format must be GL_DEPTH_COMPONENT16, GL_DEPTH_COMPONENT24 or GL_DEPTH_COMPONENT32F" << std::endl;
+        return;
+    }
+    if(format == this->format) return;
+    this->format = format;
+    release();
+}
\ No newline at end of file
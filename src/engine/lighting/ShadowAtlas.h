@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include <glm/vec4.hpp>
+
+#include "engine/opengl/buffer/FrameBuffer.h"
+#include "engine/texture/DepthTexture.h"
+
+#define SHADOW_ATLAS_SIZE 4096
+#define SHADOW_ATLAS_MIN_TILE 128
+#define SHADOW_ATLAS_FORMAT GL_DEPTH_COMPONENT24
+
+/**
+ * @brief Shadow maps of several lights packed in one depth texture.
+ *
+ * A quadtree allocator splits the atlas in square tiles with power of two sizes, from the
+ * atlas size down to the minimum tile. A request takes the first free tile of its size in
+ * Z order, splitting bigger tiles, and freed tiles merge back with their free siblings.
+ *
+ * The tiles are allocated on the CPU without GL context, the depth texture is created the
+ * first time the atlas is bound. Changing its size frees every tile.
+ *
+ * The renderer keeps one for the shadow passes of the application but doesn't render into it:
+ * the cascades and the point shadows have their own texture arrays.
+ */
+class ShadowAtlas {
+    GENERATE_PTR(ShadowAtlas)
+public:
+    // Position and size in pixels, node -1 when the allocation failed
+    struct Tile {
+        unsigned int x, y, size;
+        int node;
+
+        inline bool isValid() const { return node >= 0; }
+    };
+private:
+    struct Node {
+        unsigned int x, y, size;
+        int parent;
+        // First of the 4 children, -1 for leaves
+        int children;
+        bool used;
+    };
+
+    std::vector<Node> nodes;
+    // Blocks of 4 nodes released by merges
+    std::vector<int> freeBlocks;
+    unsigned int size;
+    // As configured, the atlas size when it's smaller
+    unsigned int minTileSize;
+    size_t usedArea;
+    GLenum format;
+
+    FrameBuffer::Ptr frameBuffer;
+    DepthTexture::Ptr depthTexture;
+public:
+    ShadowAtlas(unsigned int _size = SHADOW_ATLAS_SIZE, GLenum _format = SHADOW_ATLAS_FORMAT, unsigned int _minTileSize = SHADOW_ATLAS_MIN_TILE);
+    ~ShadowAtlas() = default;
+private:
+    void allocate();
+    void split(int node);
+    int find(int node, unsigned int size);
+public:
+    /**
+     * @brief Smallest power of two tile of at least size pixels, an invalid tile when the atlas is full
+     */
+    Tile allocateTile(unsigned int size);
+    void freeTile(const Tile& tile);
+
+    /**
+     * @brief Frees every tile
+     */
+    void clear();
+
+    /**
+     * @brief Binds the frame buffer and clears the whole atlas, call it once before rendering the tiles
+     */
+    void begin();
+
+    /**
+     * @brief Sets the viewport to the tile
+     */
+    void bindTile(const Tile& tile);
+
+    /**
+     * @brief Scale (xy) and offset (zw) from the [0, 1] coordinates of a shadow map to the tile
+     */
+    glm::vec4 getTileTransform(const Tile& tile) const;
+
+    /**
+     * @brief Frees the depth texture and the frame buffer, the tiles stay allocated
+     */
+    void release();
+
+    /**
+     * @brief Power of two width and height of the atlas, frees every tile
+     */
+    void setSize(unsigned int size);
+
+    /**
+     * @brief GL_DEPTH_COMPONENT16, GL_DEPTH_COMPONENT24 or GL_DEPTH_COMPONENT32F
+     */
+    void setFormat(GLenum format);
+public:
+    inline unsigned int getSize() const { return size; }
+    inline GLenum getFormat() const { return format; }
+    inline unsigned int getMinTileSize() const { return std::min(minTileSize, size); }
+
+    // Pixels of the allocated tiles
+    inline size_t getUsedArea() const { return usedArea; }
+    inline float getOccupancy() const { return (float)usedArea / ((float)size * size); }
+
+    inline DepthTexture::Ptr& getDepthTexture() { return depthTexture; }
+};
\ No newline at end of file
@@ -0,0 +1,252 @@
+#include "ShadowCascades.h"
+
+#include <cmath>
+#include <string>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "engine/opengl/device/RenderDevice.h"
+
+ShadowCascades::ShadowCascades(unsigned int _cascadeCount, unsigned int _size, GLenum _format)
+    : cascadeCount(glm::clamp(_cascadeCount, 1u, (unsigned int)SHADOW_MAX_CASCADES)), size(_size), format(_format),
+    splitLambda(SHADOW_SPLIT_LAMBDA), blend(SHADOW_CASCADE_BLEND), frameBuffer(nullptr), depthTexture(nullptr),
+    filter(POISSON), quality(MEDIUM), filterRadius(SHADOW_FILTER_RADIUS), lightSize(SHADOW_LIGHT_SIZE),
+    caching(true), dynamicCasters(false), casterSignature(0), cacheFrameBuffer(nullptr), cacheTexture(nullptr) {
+    for(Cascade& cascade : cascades) cascade = { glm::mat4(1.f), 0.f, 0.f, 0.f };
+    invalidate();
+}
+
+void ShadowCascades::allocate() {
+
+    // Every layer, the cascade count can change later
+    depthTexture = DepthArrayTexture::New(size, size, SHADOW_MAX_CASCADES, format);
+
+    frameBuffer = FrameBuffer::New();
+    frameBuffer->toTextureLayer(GL_DEPTH_ATTACHMENT, depthTexture->getID(), 0);
+    RenderDevice::get()->drawBuffer(GL_NONE);
+    RenderDevice::get()->readBuffer(GL_NONE);
+
+    if(!frameBuffer->isComplete()) std::cout << "Shadow cascades framebuffer not complete!" << std::endl;
+
+    frameBuffer->unbind();
+}
+
+void ShadowCascades::allocateCache() {
+
+    // Only copied to the cascades, never sampled
+    cacheTexture = DepthArrayTexture::New(size, size, SHADOW_MAX_CASCADES, format, false);
+
+    cacheFrameBuffer = FrameBuffer::New();
+    cacheFrameBuffer->toTextureLayer(GL_DEPTH_ATTACHMENT, cacheTexture->getID(), 0);
+    RenderDevice::get()->drawBuffer(GL_NONE);
+    RenderDevice::get()->readBuffer(GL_NONE);
+
+    if(!cacheFrameBuffer->isComplete()) std::cout << "Shadow cache framebuffer not complete!" << std::endl;
+
+    cacheFrameBuffer->unbind();
+}
+
+std::vector<glm::vec4> ShadowCascades::getFrustumCornersWorldSpace(const glm::mat4& projection, const glm::mat4& view) {
+
+    const glm::mat4 inverse = glm::inverse(projection * view);
+
+    std::vector<glm::vec4> corners;
+    corners.reserve(8);
+    for(int x = 0; x < 2; x ++) {
+        for(int y = 0; y < 2; y ++) {
+            for(int z = 0; z < 2; z ++) {
+                const glm::vec4 point = inverse * glm::vec4(2.f * x - 1.f, 2.f * y - 1.f, 2.f * z - 1.f, 1.f);
+                corners.push_back(point / point.w);
+            }
+        }
+    }
+    return corners;
+}
+
+void ShadowCascades::computeSplits(float nearPlane, float farPlane, unsigned int cascadeCount, float lambda, float* splits) {
+    for(unsigned int i = 1; i <= cascadeCount; i ++) {
+        float fraction = (float)i / cascadeCount;
+        float logarithmic = nearPlane * std::pow(farPlane / nearPlane, fraction);
+        float uniform = nearPlane + (farPlane - nearPlane) * fraction;
+        splits[i - 1] = lambda * logarithmic + (1.f - lambda) * uniform;
+    }
+}
+
+glm::mat4 ShadowCascades::computeLightSpaceMatrix(const glm::mat4& cameraProjection, const glm::mat4& cameraView, const glm::vec3& lightDirection,
+    float nearPlane, float farPlane, unsigned int size, float& texelSize) {
+
+    // Perspective of the camera between the planes of the split
+    float fovy = 2.f * std::atan(1.f / cameraProjection[1][1]);
+    float aspect = cameraProjection[1][1] / cameraProjection[0][0];
+    std::vector<glm::vec4> corners = getFrustumCornersWorldSpace(glm::perspective(fovy, aspect, nearPlane, farPlane), cameraView);
+
+    // Bounding sphere of the slice, its size doesn't change when the camera rotates
+    glm::vec3 center(0.f);
+    for(const glm::vec4& corner : corners) center += glm::vec3(corner);
+    center /= corners.size();
+
+    float radius = 0.f;
+    for(const glm::vec4& corner : corners) radius = std::max(radius, glm::length(glm::vec3(corner) - center));
+    radius = std::ceil(radius * 16.f) / 16.f;
+
+    // Light from above when there's no direction
+    glm::vec3 direction = glm::length(lightDirection) > 0.f ? glm::normalize(lightDirection) : glm::vec3(0.f, 1.f, 0.f);
+    glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.f, 0.f, 1.f) : glm::vec3(0.f, 1.f, 0.f);
+    glm::mat4 lightView = glm::lookAt(center + direction * radius, center, up);
+    glm::mat4 lightProjection = glm::ortho(-radius, radius, -radius, radius, 0.f, 2.f * radius);
+
+    // Move the projection so the world origin falls on a texel, then the texels don't slide with the camera
+    glm::vec4 origin = lightProjection * lightView * glm::vec4(0.f, 0.f, 0.f, 1.f) * (size * 0.5f);
+    glm::vec2 offset = (glm::round(glm::vec2(origin)) - glm::vec2(origin)) * (2.f / size);
+    lightProjection[3][0] += offset.x;
+    lightProjection[3][1] += offset.y;
+
+    texelSize = 2.f * radius / size;
+
+    return lightProjection * lightView;
+}
+
+void ShadowCascades::update(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& lightDirection, float nearPlane, float farPlane) {
+
+    float splits[SHADOW_MAX_CASCADES];
+    computeSplits(nearPlane, farPlane, cascadeCount, splitLambda, splits);
+
+    for(unsigned int i = 0; i < cascadeCount; i ++) {
+        Cascade& cascade = cascades[i];
+        cascade.splitNear = i > 0 ? splits[i - 1] : nearPlane;
+        cascade.splitFar = splits[i];
+        cascade.lightSpaceMatrix = computeLightSpaceMatrix(projection, view, lightDirection, cascade.splitNear, cascade.splitFar, size, cascade.texelSize);
+    }
+}
+
+bool ShadowCascades::isCaster(unsigned int cascade, const glm::mat4& model, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const {
+
+    // The light space matrix is affine, the box in clip space is its center and the projected extents
+    glm::mat4 matrix = cascades[cascade].lightSpaceMatrix * model;
+    glm::vec3 center = glm::vec3(matrix * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.f));
+    glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+    glm::vec3 projected = glm::abs(glm::vec3(matrix[0])) * extent.x + glm::abs(glm::vec3(matrix[1])) * extent.y + glm::abs(glm::vec3(matrix[2])) * extent.z;
+
+    return std::abs(center.x) - projected.x <= 1.f && std::abs(center.y) - projected.y <= 1.f && center.z - projected.z <= 1.f;
+}
+
+void ShadowCascades::bindCascade(unsigned int cascade) {
+
+    if(depthTexture == nullptr) allocate();
+
+    frameBuffer->bind();
+    frameBuffer->toTextureLayer(GL_DEPTH_ATTACHMENT, depthTexture->getID(), cascade);
+    RenderDevice::get()->viewport(0, 0, size, size);
+}
+
+void ShadowCascades::uniforms(ShaderProgram::Ptr& shaderProgram) {
+
+    if(depthTexture == nullptr) return;
+
+    depthTexture->bind();
+    shaderProgram->uniformInt("shadowMap", depthTexture->getUnit());
+    shaderProgram->uniformInt("shadowDepthMap", depthTexture->getDepthUnit());
+    shaderProgram->uniformInt("cascadeCount", cascadeCount);
+    shaderProgram->uniformFloat("cascadeBlend", blend);
+
+    shaderProgram->uniformInt("shadowFilter", filter);
+    shaderProgram->uniformInt("shadowSamples", getSamples(quality));
+    shaderProgram->uniformFloat("shadowRadius", filterRadius);
+    shaderProgram->uniformFloat("shadowLightSize", lightSize);
+
+    for(unsigned int i = 0; i < cascadeCount; i ++) {
+        std::string index = "[" + std::to_string(i) + "]";
+        shaderProgram->uniformMat4("lightSpaceMatrices" + index, cascades[i].lightSpaceMatrix);
+        shaderProgram->uniformFloat("cascadeSplits" + index, cascades[i].splitFar);
+        shaderProgram->uniformFloat("cascadeTexelSizes" + index, cascades[i].texelSize);
+    }
+}
+
+void ShadowCascades::setCasters(uint64_t signature, bool dynamicCasters) {
+
+    // The static shadows move to the cache texture with dynamic casters, and back without them
+    if(signature != casterSignature || dynamicCasters != this->dynamicCasters) invalidate();
+
+    casterSignature = signature;
+    this->dynamicCasters = dynamicCasters;
+
+    // The cache texture is only kept while there are dynamic casters
+    if(!dynamicCasters) {
+        cacheTexture = nullptr;
+        cacheFrameBuffer = nullptr;
+    }
+}
+
+bool ShadowCascades::isCached(unsigned int cascade) const {
+    return caching && cached[cascade] && cachedMatrices[cascade] == cascades[cascade].lightSpaceMatrix;
+}
+
+void ShadowCascades::bindStaticCascade(unsigned int cascade) {
+
+    cached[cascade] = true;
+    cachedMatrices[cascade] = cascades[cascade].lightSpaceMatrix;
+
+    if(!dynamicCasters) {
+        bindCascade(cascade);
+        return;
+    }
+
+    if(cacheTexture == nullptr) allocateCache();
+
+    cacheFrameBuffer->bind();
+    cacheFrameBuffer->toTextureLayer(GL_DEPTH_ATTACHMENT, cacheTexture->getID(), cascade);
+    RenderDevice::get()->viewport(0, 0, size, size);
+}
+
+void ShadowCascades::restoreCascade(unsigned int cascade) {
+
+    cacheFrameBuffer->bind();
+    cacheFrameBuffer->toTextureLayer(GL_DEPTH_ATTACHMENT, cacheTexture->getID(), cascade);
+    bindCascade(cascade);
+
+    RenderDevice::get()->bindFramebuffer(GL_READ_FRAMEBUFFER, cacheFrameBuffer->getID());
+    RenderDevice::get()->blitFramebuffer(0, 0, size, size, 0, 0, size, size, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    frameBuffer->bind();
+}
+
+void ShadowCascades::invalidate() {
+    for(bool& cascade : cached) cascade = false;
+}
+
+const char* ShadowCascades::getFilterName(Filter filter) {
+    switch(filter) {
+        case HARDWARE: return "Hardware";
+        case POISSON: return "Poisson";
+        case ROTATED_DISK: return "Rotated disk";
+        case PCSS: return "PCSS";
+    }
+    return "";
+}
+
+void ShadowCascades::release() {
+    depthTexture = nullptr;
+    frameBuffer = nullptr;
+    cacheTexture = nullptr;
+    cacheFrameBuffer = nullptr;
+    invalidate();
+}
+
+void ShadowCascades::setSize(unsigned int size) {
+    if(size == 0) {
+        std::cout << "Shadow cascades size must be greater than 0" << std::endl;
+        return;
+    }
+    if(size == this->size) return;
+    this->size = size;
+    release();
+}
+
+void ShadowCascades::setFormat(GLenum format) {
+    if(!DepthTexture::isShadowFormat(format)) {
+        std::cout << "Shadow cascades format must be GL_DEPTH_COMPONENT16, GL_DEPTH_COMPONENT24 or GL_DEPTH_COMPONENT32F" << std::endl;
+        return;
+    }
+    if(format == this->format) return;
+    this->format = format;
+    release();
+}
\ No newline at end of file
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/common.hpp>
+
+#include "engine/opengl/shader/Shader.h"
+#include "engine/opengl/buffer/FrameBuffer.h"
+#include "engine/texture/DepthTexture.h"
+#include "engine/texture/DepthArrayTexture.h"
+
+// Same value in SimpleLighting.frag
+#define SHADOW_MAX_CASCADES 4
+
+#define SHADOW_CASCADE_SIZE 2048
+#define SHADOW_DEPTH_FORMAT GL_DEPTH_COMPONENT24
+#define SHADOW_SPLIT_LAMBDA 0.75f
+#define SHADOW_CASCADE_BLEND 0.1f
+
+// Poisson disk of the filters, same value in SimpleLighting.frag
+#define SHADOW_MAX_SAMPLES 32
+
+#define SHADOW_FILTER_RADIUS 1.5f
+#define SHADOW_LIGHT_SIZE 0.02f
+
+/**
+ * @brief Cascaded shadow maps of the shadow light, a layer of a depth texture array per cascade.
+ *
+ * The camera frustum is split with the practical split scheme, a blend of logarithmic and
+ * uniform splits. Every cascade is an orthographic projection around the bounding sphere of
+ * its slice, snapped to texels so the shadows don't shimmer when the camera moves.
+ *
+ * The matrices are computed on the CPU without GL context, the depth texture is created the
+ * first time a cascade is bound. Changing its size or format releases it, it's created again
+ * the next time the shadows are rendered.
+ *
+ * The shadows of the static casters are cached: a cascade is rendered again only when its light
+ * space matrix or the casters change (the renderer gives a signature of their transforms). With
+ * dynamic casters the static ones are cached in a second texture, copied to the cascade every
+ * frame before the dynamic casters are drawn over them.
+ *
+ * Every shadow sample is a hardware PCF lookup (4 texels compared and filtered). The filters
+ * take a fixed number of samples per fragment, twice in the blending part of the cascades:
+ * HARDWARE 1, POISSON and ROTATED_DISK the samples of the quality (4, 8, 16 or 32), PCSS the
+ * samples of the quality plus half of them for the blocker search.
+ */
+class ShadowCascades {
+    GENERATE_PTR(ShadowCascades)
+public:
+    // Same values in SimpleLighting.frag
+    enum Filter {
+        HARDWARE,       // one PCF lookup
+        POISSON,        // Poisson disk of PCF lookups
+        ROTATED_DISK,   // Poisson disk rotated per pixel: noise instead of banding
+        PCSS            // rotated disk sized by the distance to the blockers: contact hardening
+    };
+    enum Quality { LOW, MEDIUM, HIGH, ULTRA };
+
+    struct Cascade {
+        glm::mat4 lightSpaceMatrix;
+        float splitNear, splitFar;
+        // World size of a texel of the cascade
+        float texelSize;
+    };
+private:
+    Cascade cascades[SHADOW_MAX_CASCADES];
+    unsigned int cascadeCount, size;
+    GLenum format;
+    float splitLambda, blend;
+
+    Filter filter;
+    Quality quality;
+    float filterRadius, lightSize;
+
+    FrameBuffer::Ptr frameBuffer;
+    DepthArrayTexture::Ptr depthTexture;
+
+    // Shadows of the static casters
+    bool caching, dynamicCasters;
+    uint64_t casterSignature;
+    bool cached[SHADOW_MAX_CASCADES];
+    glm::mat4 cachedMatrices[SHADOW_MAX_CASCADES];
+    FrameBuffer::Ptr cacheFrameBuffer;
+    DepthArrayTexture::Ptr cacheTexture;
+public:
+    ShadowCascades(unsigned int _cascadeCount = SHADOW_MAX_CASCADES, unsigned int _size = SHADOW_CASCADE_SIZE, GLenum _format = SHADOW_DEPTH_FORMAT);
+    ~ShadowCascades() = default;
+private:
+    void allocate();
+    void allocateCache();
+public:
+    static std::vector<glm::vec4> getFrustumCornersWorldSpace(const glm::mat4& projection, const glm::mat4& view);
+
+    /**
+     * @brief Far distance of every split, lambda 0 is uniform and 1 logarithmic
+     */
+    static void computeSplits(float nearPlane, float farPlane, unsigned int cascadeCount, float lambda, float* splits);
+
+    /**
+     * @brief Texel snapped light space matrix of the camera frustum between nearPlane and farPlane.
+     * The light looks along -lightDirection, texelSize is the world size of a texel
+     */
+    static glm::mat4 computeLightSpaceMatrix(const glm::mat4& cameraProjection, const glm::mat4& cameraView, const glm::vec3& lightDirection,
+        float nearPlane, float farPlane, unsigned int size, float& texelSize);
+
+    /**
+     * @brief Splits and light space matrices of this frame, CPU only
+     */
+    void update(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& lightDirection, float nearPlane, float farPlane);
+
+    /**
+     * @brief False when the box can't cast a shadow in the cascade: outside of it or behind the receivers.
+     * Casters between the light and the cascade are kept, they are clamped to its near plane
+     */
+    bool isCaster(unsigned int cascade, const glm::mat4& model, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+
+    /**
+     * @brief Binds the frame buffer to the layer of the cascade and sets the viewport
+     */
+    void bindCascade(unsigned int cascade);
+
+    /**
+     * @brief Binds the depth texture and sets the cascade uniforms of a lighting program
+     */
+    void uniforms(ShaderProgram::Ptr& shaderProgram);
+
+    /**
+     * @brief Static casters of this frame: their signature changes when one of them moves, appears or
+     * disappears. The cached cascades are dropped when it changes
+     */
+    void setCasters(uint64_t signature, bool dynamicCasters);
+
+    /**
+     * @brief True when the static shadows of the cascade are up to date
+     */
+    bool isCached(unsigned int cascade) const;
+
+    /**
+     * @brief Binds the layer which keeps the static shadows of the cascade, the cascade itself without
+     * dynamic casters. The cascade is cached once it's rendered
+     */
+    void bindStaticCascade(unsigned int cascade);
+
+    /**
+     * @brief Copies the static shadows to the cascade and binds it, to draw the dynamic casters
+     */
+    void restoreCascade(unsigned int cascade);
+
+    /**
+     * @brief Renders every cascade again the next frame
+     */
+    void invalidate();
+
+    /**
+     * @brief Frees the depth textures and the frame buffers, when the shadows are disabled
+     */
+    void release();
+
+    /**
+     * @brief Width and height of every cascade
+     */
+    void setSize(unsigned int size);
+
+    /**
+     * @brief GL_DEPTH_COMPONENT16, GL_DEPTH_COMPONENT24 or GL_DEPTH_COMPONENT32F
+     */
+    void setFormat(GLenum format);
+public:
+    inline const Cascade& getCascade(unsigned int cascade) const { return cascades[cascade]; }
+
+    inline void setCascadeCount(unsigned int cascadeCount) { this->cascadeCount = glm::clamp(cascadeCount, 1u, (unsigned int)SHADOW_MAX_CASCADES); }
+    inline unsigned int getCascadeCount() const { return cascadeCount; }
+
+    inline void setSplitLambda(float splitLambda) { this->splitLambda = splitLambda; }
+    inline float getSplitLambda() const { return splitLambda; }
+
+    // Part of every cascade blended with the next one, so the change of resolution doesn't show
+    inline void setBlend(float blend) { this->blend = blend; }
+    inline float getBlend() const { return blend; }
+
+    // Off: every cascade is rendered every frame
+    inline void setCaching(bool caching) { this->caching = caching; invalidate(); }
+    inline bool isCaching() const { return caching; }
+    inline bool hasDynamicCasters() const { return dynamicCasters; }
+
+    inline void setFilter(Filter filter) { this->filter = filter; }
+    inline Filter getFilter() const { return filter; }
+
+    inline void setQuality(Quality quality) { this->quality = quality; }
+    inline Quality getQuality() const { return quality; }
+
+    static const char* getFilterName(Filter filter);
+
+    // Samples per fragment of the Poisson disk
+    static inline unsigned int getSamples(Quality quality) { return 4u << quality; }
+
+    // Radius in texels of the Poisson and rotated disks
+    inline void setFilterRadius(float filterRadius) { this->filterRadius = filterRadius; }
+    inline float getFilterRadius() const { return filterRadius; }
+
+    // PCSS: tangent of the angular radius of the light, the width of the penumbra per unit from the blocker
+    inline void setLightSize(float lightSize) { this->lightSize = lightSize; }
+    inline float getLightSize() const { return lightSize; }
+
+    inline unsigned int getSize() const { return size; }
+    inline GLenum getFormat() const { return format; }
+    inline DepthArrayTexture::Ptr& getDepthTexture() { return depthTexture; }
+};
\ No newline at end of file
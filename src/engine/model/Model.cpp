@@ -1,12 +1,16 @@
 #include "Model.h"
 
+#include "engine/profiler/Instrumentation.h"
+
 Model::Model(const std::string& _path, bool _pbr) 
     : path(_path), pbr(_pbr) {
     loadModel();
 }
 
 void Model::loadModel() {
-    
+
+    RENDERERGL_ZONE("Model::loadModel");
+
     // read file via ASSIMP
     Assimp::Importer importer;
     const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
@@ -38,47 +42,47 @@ void Model::processNode(aiNode *node, const aiScene *scene) {
     for(unsigned int i = 0; i < node->mNumChildren; i++) processNode(node->mChildren[i], scene);
 }
 
-Polytope::Ptr Model::processMesh(aiMesh *mesh, const aiScene *scene) {
-    // data to fill
-    std::vector<Vec3f> vertices;
-    std::vector<unsigned int> indices;
-    std::vector<Texture::Ptr> textures;   
+void Model::convertMesh(const aiMesh *mesh, std::vector<Vec3f>& vertices, std::vector<unsigned int>& indices) {
+
+    vertices.clear();
+    indices.clear();
+    vertices.reserve(mesh->mNumVertices);
+    indices.reserve(mesh->mNumFaces * 3);
 
     // walk through each of the mesh's vertices
     for(unsigned int i = 0; i < mesh->mNumVertices; i++) {
         Vec3f vertex;
-        glm::vec3 vector; // we declare a placeholder vector since assimp uses its own vector class that doesn't directly convert to glm's vec3 class so we transfer the data to this placeholder glm::vec3 first.
-        // positions
-        vertex.x = vector.x = mesh->mVertices[i].x;
-        vertex.y = vector.y = mesh->mVertices[i].y;
-        vertex.z = vector.z = mesh->mVertices[i].z;
+
+        // positions, assimp uses its own vector class so we copy the components
+        vertex.x = mesh->mVertices[i].x;
+        vertex.y = mesh->mVertices[i].y;
+        vertex.z = mesh->mVertices[i].z;
 
         vertex.r = vertex.g = vertex.b = 1.0f;
 
         // normals
         if (mesh->HasNormals()) {
-            vertex.nx = vector.x = mesh->mNormals[i].x;
-            vertex.ny = vector.y = mesh->mNormals[i].y;
-            vertex.nz = vector.z = mesh->mNormals[i].z;
+            vertex.nx = mesh->mNormals[i].x;
+            vertex.ny = mesh->mNormals[i].y;
+            vertex.nz = mesh->mNormals[i].z;
         }
         // texture coordinates
         if(mesh->mTextureCoords[0])  {
 
-            glm::vec2 vec;
             // a vertex can contain up to 8 different texture coordinates. We thus make the assumption that we won't 
             // use models where a vertex can have multiple texture coordinates so we always take the first set (0).
-            vertex.tx = vec.x = mesh->mTextureCoords[0][i].x; 
-            vertex.ty = vec.y = mesh->mTextureCoords[0][i].y;
+            vertex.tx = mesh->mTextureCoords[0][i].x; 
+            vertex.ty = mesh->mTextureCoords[0][i].y;
 
             // tangent
-            vertex.tanx = vector.x = mesh->mTangents[i].x;
-            vertex.tany = vector.y = mesh->mTangents[i].y;
-            vertex.tanz = vector.z = mesh->mTangents[i].z;
+            vertex.tanx = mesh->mTangents[i].x;
+            vertex.tany = mesh->mTangents[i].y;
+            vertex.tanz = mesh->mTangents[i].z;
 
             // bitangent
-            vertex.bitanx = vector.x = mesh->mBitangents[i].x;
-            vertex.bitany = vector.y = mesh->mBitangents[i].y;
-            vertex.bitanz = vector.z = mesh->mBitangents[i].z;
+            vertex.bitanx = mesh->mBitangents[i].x;
+            vertex.bitany = mesh->mBitangents[i].y;
+            vertex.bitanz = mesh->mBitangents[i].z;
 
             vertex.hasTangents = true;
         }
@@ -87,10 +91,19 @@ Polytope::Ptr Model::processMesh(aiMesh *mesh, const aiScene *scene) {
     }
     // now wak through each of the mesh's faces (a face is a mesh its triangle) and retrieve the corresponding vertex indices.
     for(unsigned int i = 0; i < mesh->mNumFaces; i++) {
-        aiFace face = mesh->mFaces[i];
+        const aiFace& face = mesh->mFaces[i];
         // retrieve all indices of the face and store them in the indices vector
-        for(unsigned int j = 0; j < face.mNumIndices; j++) indices.push_back(face.mIndices[j]);        
+        indices.insert(indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
     }
+}
+
+Polytope::Ptr Model::processMesh(aiMesh *mesh, const aiScene *scene) {
+    // data to fill
+    std::vector<Vec3f> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<Texture::Ptr> textures;   
+
+    convertMesh(mesh, vertices, indices);
 
     // process materials
     aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];    
@@ -28,6 +28,11 @@ private:
     void processNode(aiNode *node, const aiScene *scene);
     Polytope::Ptr processMesh(aiMesh *mesh, const aiScene *scene);
     std::vector<Texture::Ptr> loadMaterialTextures(aiMaterial *mat, aiTextureType type, const std::string& typeName);
+public:
+    /**
+     * @brief Vertices and indices of an assimp mesh, CPU only
+     */
+    static void convertMesh(const aiMesh *mesh, std::vector<Vec3f>& vertices, std::vector<unsigned int>& indices);
 public:
     inline bool isPBR() const { return pbr; }
 };
\ No newline at end of file
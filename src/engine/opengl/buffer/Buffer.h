@@ -7,13 +7,15 @@
 class Buffer {
 protected:
     unsigned int id;
+    size_t offset;      // start in the GL buffer, not 0 when it lives in a BufferHeap
     virtual void initBuffer() = 0;
 public:
-    Buffer() : id(0) {}
+    Buffer() : id(0), offset(0) {}
     virtual ~Buffer() = default;
 public:
     virtual void bind() = 0;
     virtual void unbind() = 0;
 public:
     inline unsigned int getID() const { return id; }
+    inline size_t getOffset() const { return offset; }
 };
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "BufferHeap.h"
+
+#include "engine/opengl/device/RenderDevice.h"
+#include "engine/renderer/RenderStats.h"
+
+#include <algorithm>
+
+BufferHeap::BufferHeap(unsigned int _pageSize, unsigned int _alignment, unsigned int _usage)
+    : usage(_usage), pageSize(_pageSize), alignment(std::max(_alignment, 1u)) {
+}
+
+BufferHeap::~BufferHeap() {
+    for(auto& pending : pendingFrees) RenderDevice::get()->deleteSync(pending.fence);
+    for(auto& page : pages) RenderDevice::get()->deleteBuffers(1, &page.id);
+}
+
+unsigned int BufferHeap::addPage(unsigned int size) {
+    Page page;
+    page.allocator = TLSFAllocator(size, alignment);
+
+    RenderDevice::get()->genBuffers(1, &page.id);
+    RenderDevice::get()->bindBuffer(GL_COPY_WRITE_BUFFER, page.id);
+    RenderDevice::get()->bufferData(GL_COPY_WRITE_BUFFER, size, nullptr, usage);
+    RenderDevice::get()->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    pages.push_back(page);
+    return pages.size() - 1;
+}
+
+void BufferHeap::release(const Allocation& allocation) {
+    pages[allocation.page].allocator.free(allocation.offset);
+}
+
+BufferHeap::Allocation BufferHeap::allocate(unsigned int size, const RelocationCallback& onRelocate) {
+
+    Allocation allocation = { 0, 0, 0, 0 };
+    if(size == 0) return allocation;
+
+    unsigned int offset = TLSFAllocator::INVALID_OFFSET;
+    unsigned int page = 0;
+    for(; page < pages.size(); page ++) {
+        offset = pages[page].allocator.allocate(size);
+        if(offset != TLSFAllocator::INVALID_OFFSET) break;
+    }
+
+    // Bigger allocations than a page get their own page
+    if(offset == TLSFAllocator::INVALID_OFFSET) {
+        unsigned int alignedSize = (size + alignment - 1) / alignment * alignment;
+        page = addPage(std::max(pageSize, alignedSize));
+        offset = pages[page].allocator.allocate(size);
+    }
+
+    if(offset == TLSFAllocator::INVALID_OFFSET) {
+        std::cout << "Couldn't allocate " << size << " bytes in the buffer heap" << std::endl;
+        return allocation;
+    }
+
+    allocation = { pages[page].id, page, offset, pages[page].allocator.getSize(offset) };
+    if(onRelocate) pages[page].movable[offset] = onRelocate;
+
+    return allocation;
+}
+
+void BufferHeap::upload(const Allocation& allocation, const void* data, unsigned int size, unsigned int offset) {
+    RenderDevice::get()->bindBuffer(GL_COPY_WRITE_BUFFER, allocation.buffer);
+    RenderDevice::get()->bufferSubData(GL_COPY_WRITE_BUFFER, allocation.offset + offset, size, data);
+    RenderDevice::get()->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    RenderStats::countUpload(size);
+}
+
+void BufferHeap::setRelocationCallback(const Allocation& allocation, const RelocationCallback& onRelocate) {
+    if(!allocation.isValid()) return;
+    auto movable = pages[allocation.page].movable.find(allocation.offset);
+    if(movable != pages[allocation.page].movable.end()) movable->second = onRelocate;
+}
+
+void BufferHeap::free(const Allocation& allocation) {
+    if(!allocation.isValid()) return;
+    pages[allocation.page].movable.erase(allocation.offset);
+    unfencedFrees.push_back(allocation);
+}
+
+void BufferHeap::collect() {
+
+    // One fence for everything freed since the last call
+    if(!unfencedFrees.empty()) {
+        pendingFrees.push_back({ RenderDevice::get()->fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), unfencedFrees });
+        unfencedFrees.clear();
+    }
+
+    // Fences signal in order
+    while(!pendingFrees.empty()) {
+        GLenum status = RenderDevice::get()->clientWaitSync(pendingFrees.front().fence, 0, 0);
+        if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+
+        for(auto& allocation : pendingFrees.front().allocations) release(allocation);
+        RenderDevice::get()->deleteSync(pendingFrees.front().fence);
+        pendingFrees.pop_front();
+    }
+}
+
+unsigned int BufferHeap::compact(unsigned int budget) {
+
+    // Most fragmented page with something that can be moved
+    int target = -1;
+    unsigned int mostFragmented = 0;
+    for(unsigned int i = 0; i < pages.size(); i ++) {
+        const TLSFAllocator& allocator = pages[i].allocator;
+        unsigned int fragmented = allocator.getFree() - allocator.getLargestFreeBlock();
+        if(fragmented > mostFragmented && !pages[i].movable.empty()) {
+            mostFragmented = fragmented;
+            target = i;
+        }
+    }
+    if(target == -1) return 0;
+
+    Page& page = pages[target];
+
+    // The highest allocations first, they are the ones splitting the free space
+    std::vector<unsigned int> offsets;
+    for(auto& movable : page.movable) offsets.push_back(movable.first);
+    std::reverse(offsets.begin(), offsets.end());
+
+    unsigned int moved = 0;
+    RenderDevice::get()->bindBuffer(GL_COPY_READ_BUFFER, page.id);
+    RenderDevice::get()->bindBuffer(GL_COPY_WRITE_BUFFER, page.id);
+
+    for(unsigned int from : offsets) {
+        if(moved >= budget) break;
+
+        unsigned int size = page.allocator.getSize(from);
+        unsigned int to = page.allocator.allocate(size);
+        if(to == TLSFAllocator::INVALID_OFFSET) continue;
+        if(to > from) {
+            page.allocator.free(to);
+            continue;
+        }
+
+        RenderDevice::get()->copyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, from, to, size);
+
+        RelocationCallback onRelocate = page.movable[from];
+        page.movable.erase(from);
+        page.movable[to] = onRelocate;
+
+        Allocation source = { page.id, (unsigned int)target, from, size };
+        Allocation destination = { page.id, (unsigned int)target, to, size };
+        onRelocate(source, destination);
+
+        // Draws already submitted may still read the old range
+        unfencedFrees.push_back(source);
+        moved += size;
+    }
+
+    RenderDevice::get()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+    RenderDevice::get()->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    return moved;
+}
+
+BufferHeap::Stats BufferHeap::getStats() const {
+
+    Stats stats = { 0, 0, 0, 0, 0, (unsigned int)pages.size(), 0 };
+
+    for(auto& page : pages) {
+        stats.capacity += page.allocator.getCapacity();
+        stats.used += page.allocator.getUsed();
+        stats.free += page.allocator.getFree();
+        stats.fragmented += page.allocator.getFree() - page.allocator.getLargestFreeBlock();
+        stats.allocations += page.allocator.getAllocationsCount();
+    }
+
+    for(auto& allocation : unfencedFrees) stats.pendingFree += allocation.size;
+    for(auto& pending : pendingFrees)
+        for(auto& allocation : pending.allocations) stats.pendingFree += allocation.size;
+
+    return stats;
+}
\ No newline at end of file
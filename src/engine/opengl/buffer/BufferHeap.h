@@ -0,0 +1,99 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <map>
+#include <functional>
+
+#include <GL/glew.h>
+
+#include "TLSFAllocator.h"
+
+#include "engine/ptr.h"
+
+#define BUFFER_HEAP_PAGE_SIZE (32 << 20)
+#define BUFFER_HEAP_ALIGNMENT 16     // uniform blocks need GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+
+/**
+ * @brief A few big GL buffers sub-allocated with TLSF, for vertex, index and uniform data.
+ *
+ * Freed ranges are not reused until a fence says the GPU is done with them (see collect).
+ * Allocations with a relocation callback can be moved by compact, which packs them to the
+ * beginning of their page so the free space ends up in one block.
+ */
+class BufferHeap {
+    GENERATE_PTR(BufferHeap)
+public:
+    struct Allocation {
+        unsigned int buffer = 0;
+        unsigned int page = 0;
+        unsigned int offset = 0, size = 0;
+
+        inline bool isValid() const { return buffer != 0; }
+    };
+
+    typedef std::function<void(const Allocation& from, const Allocation& to)> RelocationCallback;
+
+    struct Stats {
+        size_t capacity;
+        size_t used, free;
+        size_t fragmented;      // free bytes out of the largest free block of each page
+        size_t pendingFree;     // part of used, waiting for the GPU to be released
+        unsigned int pages, allocations;
+    };
+private:
+    struct Page {
+        unsigned int id;
+        TLSFAllocator allocator;
+        std::map<unsigned int, RelocationCallback> movable;     // offset -> callback
+    };
+
+    struct PendingFrees {
+        GLsync fence;
+        std::vector<Allocation> allocations;
+    };
+private:
+    unsigned int usage;
+    unsigned int pageSize, alignment;
+    std::vector<Page> pages;
+
+    std::vector<Allocation> unfencedFrees;
+    std::deque<PendingFrees> pendingFrees;
+public:
+    BufferHeap(unsigned int _pageSize = BUFFER_HEAP_PAGE_SIZE, unsigned int _alignment = BUFFER_HEAP_ALIGNMENT, unsigned int _usage = GL_DYNAMIC_DRAW);
+    ~BufferHeap();
+private:
+    unsigned int addPage(unsigned int size);
+    void release(const Allocation& allocation);
+public:
+    Allocation allocate(unsigned int size, const RelocationCallback& onRelocate = nullptr);
+    void upload(const Allocation& allocation, const void* data, unsigned int size, unsigned int offset = 0);
+
+    /**
+     * @brief Replaces the relocation callback of a movable allocation, when its owner moves
+     */
+    void setRelocationCallback(const Allocation& allocation, const RelocationCallback& onRelocate);
+
+    /**
+     * @brief The range is reused once the GPU has finished the commands submitted before this call
+     */
+    void free(const Allocation& allocation);
+
+    /**
+     * @brief Fences the frees of this frame and releases the ones the GPU is done with, call it once per frame
+     */
+    void collect();
+
+    /**
+     * @brief Moves movable allocations down in the most fragmented page, at most budget bytes
+     * @return bytes moved
+     */
+    unsigned int compact(unsigned int budget);
+
+    Stats getStats() const;
+public:
+    inline unsigned int getPageSize() const { return pageSize; }
+    inline unsigned int getAlignment() const { return alignment; }
+    inline size_t getPagesCount() const { return pages.size(); }
+};
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "FrameBuffer.h"
 
+#include "engine/opengl/device/RenderDevice.h"
+
 FrameBuffer::FrameBuffer()
     : Buffer() {
     initBuffer();
@@ -7,36 +9,44 @@ FrameBuffer::FrameBuffer()
 
 FrameBuffer::~FrameBuffer() {
     unbind();
-    glDeleteFramebuffers(1, &id);
+    RenderDevice::get()->deleteFramebuffers(1, &id);
 }
 
 void FrameBuffer::initBuffer() {
-    glGenFramebuffers(1, &id);
-    glBindFramebuffer(GL_FRAMEBUFFER, id);
+    RenderDevice::get()->genFramebuffers(1, &id);
+    RenderDevice::get()->bindFramebuffer(GL_FRAMEBUFFER, id);
 }
 
 void FrameBuffer::toTexture(int attachment, int texturePrimitive, int textureID) {
-    glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, texturePrimitive, textureID, 0);
+    RenderDevice::get()->framebufferTexture2D(GL_FRAMEBUFFER, attachment, texturePrimitive, textureID, 0);
+}
+
+void FrameBuffer::toTextureLayer(int attachment, int textureID, int layer) {
+    RenderDevice::get()->framebufferTextureLayer(GL_FRAMEBUFFER, attachment, textureID, 0, layer);
+}
+
+void FrameBuffer::toTextureLayered(int attachment, int textureID) {
+    RenderDevice::get()->framebufferTexture(GL_FRAMEBUFFER, attachment, textureID, 0);
 }
 
 void FrameBuffer::blitFrom(FrameBuffer::Ptr& frameBuffer, unsigned int width, unsigned int height) {
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, frameBuffer->getID());
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, id);
-    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    RenderDevice::get()->bindFramebuffer(GL_READ_FRAMEBUFFER, frameBuffer->getID());
+    RenderDevice::get()->bindFramebuffer(GL_DRAW_FRAMEBUFFER, id);
+    RenderDevice::get()->blitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 }
 
 void FrameBuffer::setRenderBuffer(int attachment, int renderBufferID) {
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, renderBufferID);
+    RenderDevice::get()->framebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, renderBufferID);
 }
 
 void FrameBuffer::bind() {
-    glBindFramebuffer(GL_FRAMEBUFFER, id);
+    RenderDevice::get()->bindFramebuffer(GL_FRAMEBUFFER, id);
 }
 
 void FrameBuffer::unbind() {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    RenderDevice::get()->bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 bool FrameBuffer::isComplete() {
-    return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    return RenderDevice::get()->checkFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
 }
\ No newline at end of file
@@ -11,6 +11,9 @@ protected:
     void initBuffer() override;
 public:
     void toTexture(int attachment, int texturePrimitive, int textureID);
+    void toTextureLayer(int attachment, int textureID, int layer);
+    // Every layer, the geometry shader picks one with gl_Layer
+    void toTextureLayered(int attachment, int textureID);
     void blitFrom(FrameBuffer::Ptr& frameBuffer, unsigned int width, unsigned int height);
     void setRenderBuffer(int attachment, int renderBufferID);
     void bind() override;
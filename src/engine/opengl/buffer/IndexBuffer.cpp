@@ -1,68 +1,137 @@
 #include "IndexBuffer.h"
 
+#include "engine/opengl/device/RenderDevice.h"
+#include "engine/renderer/RenderStats.h"
+
 #include <string.h>
+#include <algorithm>
+
+BufferHeap::Ptr IndexBuffer::defaultHeap = nullptr;
 
 IndexBuffer::IndexBuffer() : Buffer() { }
 
+IndexBuffer::IndexBuffer(size_t _length)
+    : Buffer(), length(_length) {
+    initBuffer();
+}
+
 IndexBuffer::IndexBuffer(const std::vector<unsigned int> indices)
     : Buffer(), length(indices.size()) {
     initBuffer(indices);
 }
 
-IndexBuffer::IndexBuffer(const IndexBuffer& indexBuffer) 
-    : length(indexBuffer.length) {
-    id = indexBuffer.id;
-}
-
-IndexBuffer::IndexBuffer(IndexBuffer&& indexBuffer) noexcept 
-    : length(indexBuffer.length) {
-    id = indexBuffer.id;
+IndexBuffer::IndexBuffer(IndexBuffer&& indexBuffer) noexcept
+    : Buffer(), length(0) {
+    take(indexBuffer);
 }
 
-IndexBuffer& IndexBuffer::operator=(const IndexBuffer& indexBuffer) {
-    id = indexBuffer.id;
-    length = indexBuffer.length;
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& indexBuffer) noexcept {
+    if(this != &indexBuffer) {
+        releaseStorage();
+        take(indexBuffer);
+    }
     return *this;
 }
 
 IndexBuffer::~IndexBuffer() {
     unbind();
-    glDeleteBuffers(1, &id);
+    releaseStorage();
+}
+
+void IndexBuffer::allocateStorage(const unsigned int* data) {
+
+    unsigned int size = length * sizeof(unsigned int);
+
+    if(defaultHeap != nullptr && size > 0) {
+        heap = defaultHeap;
+        allocation = heap->allocate(size, relocation());
+    }
+
+    if(allocation.isValid()) {
+        id = allocation.buffer;
+        offset = allocation.offset;
+        RenderDevice::get()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
+        if(data != nullptr) RenderDevice::get()->bufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, size, data);
+    }
+    else {
+        RenderDevice::get()->genBuffers(1, &id);
+        RenderDevice::get()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
+        RenderDevice::get()->bufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW);
+    }
+
+    if(data != nullptr) RenderStats::countUpload(size);
+}
+
+void IndexBuffer::releaseStorage() {
+    if(allocation.isValid()) heap->free(allocation);
+    else if(id != 0) RenderDevice::get()->deleteBuffers(1, &id);
+
+    heap = nullptr;
+    allocation = BufferHeap::Allocation();
+    id = 0;
+    offset = 0;
+}
+
+void IndexBuffer::take(IndexBuffer& indexBuffer) {
+
+    length = indexBuffer.length;
+    id = indexBuffer.id;
+    offset = indexBuffer.offset;
+    heap = std::move(indexBuffer.heap);
+    allocation = indexBuffer.allocation;
+
+    indexBuffer.length = 0;
+    indexBuffer.id = 0;
+    indexBuffer.offset = 0;
+    indexBuffer.allocation = BufferHeap::Allocation();
+
+    // Compaction calls the new owner
+    if(allocation.isValid()) heap->setRelocationCallback(allocation, relocation());
+}
+
+BufferHeap::RelocationCallback IndexBuffer::relocation() {
+
+    // The element buffer binding of the VAO stays the same, only the offset changes
+    return [this](const BufferHeap::Allocation&, const BufferHeap::Allocation& to) {
+        allocation = to;
+        offset = to.offset;
+    };
 }
 
 void IndexBuffer::initBuffer(std::vector<unsigned int> indices) {
-    glGenBuffers(1, &id);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_DYNAMIC_DRAW);
+    allocateStorage(&indices[0]);
 }
 
-void IndexBuffer::initBuffer() { }
+void IndexBuffer::initBuffer() {
+    allocateStorage(nullptr);
+}
 
 void IndexBuffer::bind() {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
+    RenderDevice::get()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
 }
 
 void IndexBuffer::unbind() {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    RenderDevice::get()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 void IndexBuffer::updateIndices(const std::vector<unsigned int>& indices) {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
-    unsigned int* ptr = (unsigned int*)glMapBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_WRITE_ONLY);
-    memcpy(ptr, &indices[0], indices.size());
-    glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    RenderDevice::get()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
+    unsigned int* ptr = (unsigned int*)RenderDevice::get()->mapBufferRange(GL_ELEMENT_ARRAY_BUFFER, offset, length * sizeof(unsigned int), GL_MAP_WRITE_BIT);
+    memcpy(ptr, &indices[0], std::min(indices.size(), length) * sizeof(unsigned int));
+    RenderDevice::get()->unmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+    RenderStats::countUpload(std::min(indices.size(), length) * sizeof(unsigned int));
+    RenderDevice::get()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 std::vector<unsigned int> IndexBuffer::getIndices() {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
-    unsigned int* ptr = (unsigned int*)glMapBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_READ_ONLY);
+    RenderDevice::get()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
+    unsigned int* ptr = (unsigned int*)RenderDevice::get()->mapBufferRange(GL_ELEMENT_ARRAY_BUFFER, offset, length * sizeof(unsigned int), GL_MAP_READ_BIT);
 
     std::vector<unsigned int> indices;
     for(int i = 0; i < length; i ++) indices.push_back(ptr[i]);
     
-    glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    RenderDevice::get()->unmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+    RenderDevice::get()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     return indices;
 }
\ No newline at end of file
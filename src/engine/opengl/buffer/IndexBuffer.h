@@ -1,20 +1,34 @@
+#pragma once
+
 #include <iostream>
 #include <vector>
 
 #include "Buffer.h"
+#include "BufferHeap.h"
 
 class IndexBuffer : public Buffer {
     GENERATE_PTR(IndexBuffer)
 private:
     size_t length;
+    BufferHeap::Ptr heap;
+    BufferHeap::Allocation allocation;
+
+    static BufferHeap::Ptr defaultHeap;
 public:
     IndexBuffer();
+    IndexBuffer(size_t _length);
     IndexBuffer(const std::vector<unsigned int> indices);
-    IndexBuffer(const IndexBuffer& indexBuffer);
+    // The storage has one owner, a moved buffer leaves the other one empty
+    IndexBuffer(const IndexBuffer& indexBuffer) = delete;
     IndexBuffer(IndexBuffer&& indexBuffer) noexcept;
-    IndexBuffer& operator=(const IndexBuffer& indexBuffer);
+    IndexBuffer& operator=(const IndexBuffer& indexBuffer) = delete;
+    IndexBuffer& operator=(IndexBuffer&& indexBuffer) noexcept;
     ~IndexBuffer();
 private:
+    void allocateStorage(const unsigned int* data);
+    void releaseStorage();
+    void take(IndexBuffer& indexBuffer);
+    BufferHeap::RelocationCallback relocation();
     void initBuffer(std::vector<unsigned int> indices);
     void initBuffer() override;
 public:
@@ -22,4 +36,13 @@ public:
     void unbind() override;
     void updateIndices(const std::vector<unsigned int>& indices);
     std::vector<unsigned int> getIndices();
+public:
+    inline size_t getLength() const { return length; }
+
+    /**
+     * Index buffers created after this call are sub-allocated from heap, nullptr goes back to one GL buffer each.
+     * The heap can move them while compacting, draws must use getOffset()
+    */
+    inline static void setHeap(const BufferHeap::Ptr& heap) { defaultHeap = heap; }
+    inline static BufferHeap::Ptr& getHeap() { return defaultHeap; }
 };
\ No newline at end of file
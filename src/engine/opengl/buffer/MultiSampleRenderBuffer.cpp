@@ -1,13 +1,15 @@
 #include "MultiSampleRenderBuffer.h"
 
+#include "engine/opengl/device/RenderDevice.h"
+
 MultiSampleRenderBuffer::MultiSampleRenderBuffer(unsigned int width, unsigned int height, unsigned int _samples) 
     : RenderBuffer(width, height, GL_DEPTH24_STENCIL8), samples(_samples) {
     initBuffer();
 }
 
 void MultiSampleRenderBuffer::initBuffer() {
-    glGenRenderbuffers(1, &id);
-    glBindRenderbuffer(GL_RENDERBUFFER, id);
-    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, internalFormat, width, height);
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    RenderDevice::get()->genRenderbuffers(1, &id);
+    RenderDevice::get()->bindRenderbuffer(GL_RENDERBUFFER, id);
+    RenderDevice::get()->renderbufferStorageMultisample(GL_RENDERBUFFER, samples, internalFormat, width, height);
+    RenderDevice::get()->bindRenderbuffer(GL_RENDERBUFFER, 0);
 }
\ No newline at end of file
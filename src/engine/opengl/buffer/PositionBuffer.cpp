@@ -0,0 +1,126 @@
+#include "PositionBuffer.h"
+
+#include "engine/opengl/device/RenderDevice.h"
+#include "engine/renderer/RenderStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+PositionBuffer::PositionBuffer(size_t _length, bool _quantized)
+    : Buffer(), length(_length), quantized(_quantized), boxMin(0.f), boxSize(1.f) {
+    initBuffer();
+}
+
+PositionBuffer::PositionBuffer(const std::vector<Vec3f>& vertices, bool _quantized)
+    : Buffer(), length(vertices.size()), quantized(_quantized), boxMin(0.f), boxSize(1.f) {
+    RenderDevice::get()->genBuffers(1, &id);
+    upload(vertices);
+    vertexAttributes();
+    unbind();
+}
+
+PositionBuffer::~PositionBuffer() {
+    RenderDevice::get()->deleteBuffers(1, &id);
+}
+
+void PositionBuffer::vertexAttributes() {
+    RenderDevice::get()->enableVertexAttribArray(0);
+    if(quantized) RenderDevice::get()->vertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, getStride(), (void*)0);
+    else RenderDevice::get()->vertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, getStride(), (void*)0);
+}
+
+void PositionBuffer::quantize(const std::vector<Vec3f>& vertices, const glm::vec3& boxMin, const glm::vec3& boxSize, uint16_t* data) {
+
+    // Flat axes have a zero size, all their positions are the minimum
+    glm::vec3 scale;
+    for(int i = 0; i < 3; i ++) scale[i] = boxSize[i] > 0.f ? 65535.f / boxSize[i] : 0.f;
+
+    for(const Vec3f& vertex : vertices) {
+        glm::vec3 q = glm::clamp((glm::vec3(vertex.x, vertex.y, vertex.z) - boxMin) * scale, 0.f, 65535.f);
+        *data ++ = (uint16_t)std::lround(q.x);
+        *data ++ = (uint16_t)std::lround(q.y);
+        *data ++ = (uint16_t)std::lround(q.z);
+    }
+}
+
+void PositionBuffer::upload(const std::vector<Vec3f>& vertices) {
+
+    length = vertices.size();
+    size_t size = length * getStride();
+
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, id);
+
+    if(quantized) {
+        glm::vec3 boxMax(0.f);
+        boxMin = glm::vec3(0.f);
+        if(!vertices.empty()) boxMin = boxMax = glm::vec3(vertices[0].x, vertices[0].y, vertices[0].z);
+        for(const Vec3f& vertex : vertices) {
+            boxMin = glm::min(boxMin, glm::vec3(vertex.x, vertex.y, vertex.z));
+            boxMax = glm::max(boxMax, glm::vec3(vertex.x, vertex.y, vertex.z));
+        }
+        boxSize = boxMax - boxMin;
+
+        std::vector<uint16_t> data(length * 3);
+        quantize(vertices, boxMin, boxSize, data.data());
+        RenderDevice::get()->bufferData(GL_ARRAY_BUFFER, size, data.data(), GL_DYNAMIC_DRAW);
+    }
+    else {
+        std::vector<float> data;
+        data.reserve(length * 3);
+        for(const Vec3f& vertex : vertices) data.insert(data.end(), { vertex.x, vertex.y, vertex.z });
+        RenderDevice::get()->bufferData(GL_ARRAY_BUFFER, size, data.data(), GL_DYNAMIC_DRAW);
+    }
+
+    RenderStats::countUpload(size);
+}
+
+void PositionBuffer::initBuffer() {
+    RenderDevice::get()->genBuffers(1, &id);
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, id);
+    RenderDevice::get()->bufferData(GL_ARRAY_BUFFER, length * getStride(), nullptr, GL_DYNAMIC_DRAW);
+    vertexAttributes();
+    unbind();
+}
+
+void PositionBuffer::updatePositions(const std::vector<Vec3f>& vertices) {
+
+    // The buffer keeps its name, the vertex arrays which use it don't change
+    upload(vertices);
+    unbind();
+}
+
+bool PositionBuffer::updatePosition(int pos, const Vec3f& vertex) {
+
+    if(pos < 0 || (size_t)pos >= length) return true;
+
+    glm::vec3 position(vertex.x, vertex.y, vertex.z);
+    if(quantized && (glm::any(glm::lessThan(position, boxMin)) || glm::any(glm::greaterThan(position, boxMin + boxSize))))
+        return false;
+
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, id);
+    if(quantized) {
+        uint16_t data[3];
+        quantize({ vertex }, boxMin, boxSize, data);
+        RenderDevice::get()->bufferSubData(GL_ARRAY_BUFFER, pos * getStride(), sizeof(data), data);
+    }
+    else RenderDevice::get()->bufferSubData(GL_ARRAY_BUFFER, pos * getStride(), sizeof(float) * 3, &vertex.x);
+
+    RenderStats::countUpload(getStride());
+    unbind();
+    return true;
+}
+
+void PositionBuffer::bind() {
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, id);
+}
+
+void PositionBuffer::unbind() {
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+glm::mat4 PositionBuffer::getDecodeMatrix() const {
+    if(!quantized) return glm::mat4(1.f);
+    return glm::scale(glm::translate(glm::mat4(1.f), boxMin), boxSize);
+}
\ No newline at end of file
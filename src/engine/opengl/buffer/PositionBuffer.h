@@ -0,0 +1,56 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <cstdint>
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "Buffer.h"
+
+#include "engine/Vec3.h"
+
+/**
+ * @brief Positions alone, tightly packed, for the passes which only need the depth.
+ *
+ * 12 bytes per vertex against the 68 of VertexBuffer, or 6 quantized: every axis is an
+ * unsigned normalized short of the box of the positions, which getDecodeMatrix maps back.
+ * The attribute is the location 0 of the shaders, as in VertexBuffer.
+ */
+class PositionBuffer : public Buffer {
+    GENERATE_PTR(PositionBuffer)
+private:
+    size_t length;
+    bool quantized;
+    glm::vec3 boxMin, boxSize;
+public:
+    PositionBuffer(size_t _length, bool _quantized = false);
+    PositionBuffer(const std::vector<Vec3f>& vertices, bool _quantized = false);
+    ~PositionBuffer();
+private:
+    void vertexAttributes();
+    void upload(const std::vector<Vec3f>& vertices);
+    void initBuffer() override;
+public:
+    void updatePositions(const std::vector<Vec3f>& vertices);
+
+    /**
+     * @brief False when the vertex is out of the quantization box, the positions must be updated all together
+     */
+    bool updatePosition(int pos, const Vec3f& vertex);
+
+    void bind() override;
+    void unbind() override;
+
+    /**
+     * @brief From the [0, 1] quantized positions to the model space, identity when they aren't quantized
+     */
+    glm::mat4 getDecodeMatrix() const;
+
+    static void quantize(const std::vector<Vec3f>& vertices, const glm::vec3& boxMin, const glm::vec3& boxSize, uint16_t* data);
+public:
+    inline size_t getLength() const { return length; }
+    inline bool isQuantized() const { return quantized; }
+    inline unsigned int getStride() const { return quantized ? 3 * sizeof(uint16_t) : 3 * sizeof(float); }
+};
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "RenderBuffer.h"
 
+#include "engine/opengl/device/RenderDevice.h"
+
 RenderBuffer::RenderBuffer(unsigned int _width, unsigned int _height, int _internalFormat) 
     : Buffer(), width(_width), height(_height), internalFormat(_internalFormat) {
     initBuffer();
@@ -7,19 +9,19 @@ RenderBuffer::RenderBuffer(unsigned int _width, unsigned int _height, int _inter
 
 RenderBuffer::~RenderBuffer() {
     unbind();
-    glDeleteRenderbuffers(1, &id);
+    RenderDevice::get()->deleteRenderbuffers(1, &id);
 }
 
 void RenderBuffer::initBuffer() {
-    glGenRenderbuffers(1, &id);
-    glBindRenderbuffer(GL_RENDERBUFFER, id);
-    glRenderbufferStorage(GL_RENDERBUFFER, internalFormat, width, height);
+    RenderDevice::get()->genRenderbuffers(1, &id);
+    RenderDevice::get()->bindRenderbuffer(GL_RENDERBUFFER, id);
+    RenderDevice::get()->renderbufferStorage(GL_RENDERBUFFER, internalFormat, width, height);
 }
 
 void RenderBuffer::bind() {
-    glBindRenderbuffer(GL_RENDERBUFFER, id);
+    RenderDevice::get()->bindRenderbuffer(GL_RENDERBUFFER, id);
 }
 
 void RenderBuffer::unbind() {
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    RenderDevice::get()->bindRenderbuffer(GL_RENDERBUFFER, 0);
 }
\ No newline at end of file
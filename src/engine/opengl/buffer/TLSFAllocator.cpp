@@ -0,0 +1,265 @@
+#include "TLSFAllocator.h"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Index of the most and least significant set bit, x can't be 0
+static int lastSetBit(unsigned int x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 31 - __builtin_clz(x);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, x);
+    return index;
+#else
+    int bit = -1;
+    while(x) { x >>= 1; bit ++; }
+    return bit;
+#endif
+}
+
+static int firstSetBit(unsigned int x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(x);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, x);
+    return index;
+#else
+    int bit = 0;
+    while(!(x & 1)) { x >>= 1; bit ++; }
+    return bit;
+#endif
+}
+
+TLSFAllocator::TLSFAllocator(unsigned int _capacity, unsigned int _alignment)
+    : capacity(0), alignment(std::max(_alignment, 1u)), used(0) {
+    reset();
+    grow(_capacity);
+}
+
+TLSFAllocator::TLSFAllocator()
+    : TLSFAllocator(0) {
+}
+
+void TLSFAllocator::mapping(unsigned int size, int& fl, int& sl) {
+    if(size < TLSF_SL_COUNT) {
+        fl = 0;
+        sl = size;
+    }
+    else {
+        int msb = lastSetBit(size);
+        fl = msb - TLSF_SL_BITS + 1;
+        sl = (size >> (msb - TLSF_SL_BITS)) - TLSF_SL_COUNT;
+    }
+}
+
+void TLSFAllocator::searchMapping(unsigned int size, int& fl, int& sl) {
+    // Round up to the next class so any block of the class found is big enough
+    unsigned long long rounded = size;
+    if(size >= TLSF_SL_COUNT) rounded += (1u << (lastSetBit(size) - TLSF_SL_BITS)) - 1;
+    mapping((unsigned int)std::min(rounded, 0xFFFFFFFFull), fl, sl);
+}
+
+int TLSFAllocator::newBlock(unsigned int offset, unsigned int size) {
+    Block block = { offset, size, -1, -1, -1, -1, true };
+    if(!unusedBlocks.empty()) {
+        int index = unusedBlocks.back();
+        unusedBlocks.pop_back();
+        blocks[index] = block;
+        return index;
+    }
+    blocks.push_back(block);
+    return blocks.size() - 1;
+}
+
+void TLSFAllocator::releaseBlock(int index) {
+    Block& block = blocks[index];
+    if(block.prevPhysical != -1) blocks[block.prevPhysical].nextPhysical = block.nextPhysical;
+    if(block.nextPhysical != -1) blocks[block.nextPhysical].prevPhysical = block.prevPhysical;
+    if(lastBlock == index) lastBlock = block.prevPhysical;
+    unusedBlocks.push_back(index);
+}
+
+void TLSFAllocator::insertFreeBlock(int index) {
+    int fl, sl;
+    mapping(blocks[index].size, fl, sl);
+
+    Block& block = blocks[index];
+    block.free = true;
+    block.prevFree = -1;
+    block.nextFree = freeLists[fl][sl];
+    if(block.nextFree != -1) blocks[block.nextFree].prevFree = index;
+    freeLists[fl][sl] = index;
+
+    flBitmap |= 1u << fl;
+    slBitmap[fl] |= 1u << sl;
+}
+
+void TLSFAllocator::removeFreeBlock(int index) {
+    int fl, sl;
+    mapping(blocks[index].size, fl, sl);
+
+    Block& block = blocks[index];
+    if(block.prevFree != -1) blocks[block.prevFree].nextFree = block.nextFree;
+    else freeLists[fl][sl] = block.nextFree;
+    if(block.nextFree != -1) blocks[block.nextFree].prevFree = block.prevFree;
+    block.prevFree = block.nextFree = -1;
+
+    if(freeLists[fl][sl] == -1) {
+        slBitmap[fl] &= ~(1u << sl);
+        if(slBitmap[fl] == 0) flBitmap &= ~(1u << fl);
+    }
+}
+
+int TLSFAllocator::findFreeBlock(unsigned int size) {
+    int fl, sl;
+    searchMapping(size, fl, sl);
+
+    // Same first level, same or bigger second level
+    unsigned int slMap = slBitmap[fl] & (~0u << sl);
+    if(slMap == 0) {
+        // Any bigger first level
+        unsigned int flMap = fl + 1 < TLSF_FL_COUNT ? flBitmap & (~0u << (fl + 1)) : 0;
+        if(flMap != 0) {
+            fl = firstSetBit(flMap);
+            slMap = slBitmap[fl];
+        }
+    }
+    if(slMap != 0) return freeLists[fl][firstSetBit(slMap)];
+
+    // Nothing in the bigger classes, a block of the size class itself may still fit
+    mapping(size, fl, sl);
+    for(int index = freeLists[fl][sl]; index != -1; index = blocks[index].nextFree)
+        if(blocks[index].size >= size) return index;
+
+    return -1;
+}
+
+unsigned int TLSFAllocator::allocate(unsigned int size) {
+
+    if(size == 0) return INVALID_OFFSET;
+    unsigned long long aligned = (size + (unsigned long long)alignment - 1) / alignment * alignment;
+    if(aligned > capacity - used) return INVALID_OFFSET;
+    size = aligned;
+
+    int index = findFreeBlock(size);
+    if(index == -1) return INVALID_OFFSET;
+    removeFreeBlock(index);
+
+    // Split, the rest goes back to the free lists
+    if(blocks[index].size > size) {
+        int rest = newBlock(blocks[index].offset + size, blocks[index].size - size);
+        blocks[rest].prevPhysical = index;
+        blocks[rest].nextPhysical = blocks[index].nextPhysical;
+        if(blocks[rest].nextPhysical != -1) blocks[blocks[rest].nextPhysical].prevPhysical = rest;
+        blocks[index].nextPhysical = rest;
+        blocks[index].size = size;
+        if(lastBlock == index) lastBlock = rest;
+        insertFreeBlock(rest);
+    }
+
+    blocks[index].free = false;
+    usedBlocks[blocks[index].offset] = index;
+    used += size;
+
+    return blocks[index].offset;
+}
+
+bool TLSFAllocator::free(unsigned int offset) {
+
+    auto it = usedBlocks.find(offset);
+    if(it == usedBlocks.end()) return false;
+
+    int index = it->second;
+    usedBlocks.erase(it);
+    used -= blocks[index].size;
+
+    // Merge with next block
+    int next = blocks[index].nextPhysical;
+    if(next != -1 && blocks[next].free) {
+        removeFreeBlock(next);
+        blocks[index].size += blocks[next].size;
+        releaseBlock(next);
+    }
+
+    // Merge with previous block
+    int prev = blocks[index].prevPhysical;
+    if(prev != -1 && blocks[prev].free) {
+        removeFreeBlock(prev);
+        blocks[prev].size += blocks[index].size;
+        releaseBlock(index);
+        index = prev;
+    }
+
+    insertFreeBlock(index);
+    return true;
+}
+
+void TLSFAllocator::grow(unsigned int newCapacity) {
+
+    newCapacity = newCapacity / alignment * alignment;
+    if(newCapacity <= capacity) return;
+
+    unsigned int size = newCapacity - capacity;
+    if(lastBlock != -1 && blocks[lastBlock].free) {
+        removeFreeBlock(lastBlock);
+        blocks[lastBlock].size += size;
+        insertFreeBlock(lastBlock);
+    }
+    else {
+        int index = newBlock(capacity, size);
+        blocks[index].prevPhysical = lastBlock;
+        if(lastBlock != -1) blocks[lastBlock].nextPhysical = index;
+        lastBlock = index;
+        insertFreeBlock(index);
+    }
+
+    capacity = newCapacity;
+}
+
+void TLSFAllocator::reset() {
+
+    unsigned int oldCapacity = capacity;
+
+    blocks.clear();
+    unusedBlocks.clear();
+    usedBlocks.clear();
+
+    flBitmap = 0;
+    std::fill(slBitmap, slBitmap + TLSF_FL_COUNT, 0u);
+    std::fill(&freeLists[0][0], &freeLists[0][0] + TLSF_FL_COUNT * TLSF_SL_COUNT, -1);
+
+    capacity = used = 0;
+    lastBlock = -1;
+    grow(oldCapacity);
+}
+
+unsigned int TLSFAllocator::getSize(unsigned int offset) const {
+    auto it = usedBlocks.find(offset);
+    return it != usedBlocks.end() ? blocks[it->second].size : 0;
+}
+
+unsigned int TLSFAllocator::getLargestFreeBlock() const {
+
+    if(flBitmap == 0) return 0;
+
+    // Blocks in the highest class are the biggest ones, but not sorted inside it
+    int fl = lastSetBit(flBitmap);
+    int sl = lastSetBit(slBitmap[fl]);
+
+    unsigned int largest = 0;
+    for(int index = freeLists[fl][sl]; index != -1; index = blocks[index].nextFree)
+        largest = std::max(largest, blocks[index].size);
+
+    return largest;
+}
+
+float TLSFAllocator::getFragmentation() const {
+    unsigned int free = getFree();
+    if(free == 0) return 0.f;
+    return 1.f - (float)getLargestFreeBlock() / free;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+
+#define TLSF_SL_BITS 5
+#define TLSF_SL_COUNT (1 << TLSF_SL_BITS)
+#define TLSF_FL_COUNT (32 - TLSF_SL_BITS + 1)
+
+/**
+ * @brief Two level segregated fit allocator over the range [0, capacity).
+ *
+ * It only does the bookkeeping of offsets, so it doesn't need a GL context. Allocation
+ * and free are O(1): free blocks are kept in size classes (power of two, split in
+ * TLSF_SL_COUNT linear steps) found with two bitmaps, and neighbour blocks are merged on free.
+ */
+class TLSFAllocator {
+public:
+    static const unsigned int INVALID_OFFSET = 0xFFFFFFFF;
+private:
+    struct Block {
+        unsigned int offset, size;
+        int prevPhysical, nextPhysical;
+        int prevFree, nextFree;
+        bool free;
+    };
+private:
+    std::vector<Block> blocks;
+    std::vector<int> unusedBlocks;
+    std::unordered_map<unsigned int, int> usedBlocks;   // offset -> block
+
+    unsigned int flBitmap;
+    unsigned int slBitmap[TLSF_FL_COUNT];
+    int freeLists[TLSF_FL_COUNT][TLSF_SL_COUNT];
+
+    unsigned int capacity, alignment, used;
+    int lastBlock;
+public:
+    TLSFAllocator(unsigned int _capacity, unsigned int _alignment = 1);
+    TLSFAllocator();
+    ~TLSFAllocator() = default;
+private:
+    static void mapping(unsigned int size, int& fl, int& sl);
+    static void searchMapping(unsigned int size, int& fl, int& sl);
+
+    int newBlock(unsigned int offset, unsigned int size);
+    void releaseBlock(int index);
+    void insertFreeBlock(int index);
+    void removeFreeBlock(int index);
+    int findFreeBlock(unsigned int size);
+public:
+    /**
+     * @return offset of the allocation or INVALID_OFFSET if there is no block big enough
+     */
+    unsigned int allocate(unsigned int size);
+    bool free(unsigned int offset);
+
+    /**
+     * @brief Appends [capacity, newCapacity) as free space
+     */
+    void grow(unsigned int newCapacity);
+    void reset();
+
+    unsigned int getSize(unsigned int offset) const;
+    unsigned int getLargestFreeBlock() const;
+    float getFragmentation() const;     // 1 - largest free block / free space
+public:
+    inline unsigned int getCapacity() const { return capacity; }
+    inline unsigned int getAlignment() const { return alignment; }
+    inline unsigned int getUsed() const { return used; }
+    inline unsigned int getFree() const { return capacity - used; }
+    inline size_t getAllocationsCount() const { return usedBlocks.size(); }
+    inline bool isEmpty() const { return used == 0; }
+};
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "VertexArray.h"
 
+#include "engine/opengl/device/RenderDevice.h"
+
 VertexArray::VertexArray() 
     : Buffer() {
     initBuffer();
@@ -20,18 +22,18 @@ VertexArray& VertexArray::operator=(const VertexArray& vertexArray) {
 
 VertexArray::~VertexArray() {
     unbind();
-    glDeleteVertexArrays(1, &id);
+    RenderDevice::get()->deleteVertexArrays(1, &id);
 }
 
 void VertexArray::initBuffer() {
-    glGenVertexArrays(1, &id);
-    glBindVertexArray(id);
+    RenderDevice::get()->genVertexArrays(1, &id);
+    RenderDevice::get()->bindVertexArray(id);
 }
 
 void VertexArray::bind() {
-    glBindVertexArray(id);
+    RenderDevice::get()->bindVertexArray(id);
 }
 
 void VertexArray::unbind() {
-    glBindVertexArray(0);
+    RenderDevice::get()->bindVertexArray(0);
 }
\ No newline at end of file
@@ -1,8 +1,17 @@
 #include "VertexBuffer.h"
 
+#include "engine/opengl/device/RenderDevice.h"
+#include "engine/renderer/RenderStats.h"
+
 #include <string.h>
+#include <cstddef>
+
+// The 17 floats of a vertex are contiguous in Vec3f, in the same order as in the buffer
+static_assert(offsetof(Vec3f, bitanz) - offsetof(Vec3f, x) == 16 * sizeof(float), "Vec3f floats aren't packed");
+
+BufferHeap::Ptr VertexBuffer::defaultHeap = nullptr;
 
-VertexBuffer::VertexBuffer() : Buffer() { }
+VertexBuffer::VertexBuffer() : Buffer(), vertexArrayID(0) { }
 
 VertexBuffer::VertexBuffer(size_t _length) 
     : Buffer(), length(_length), hasIndexBuffer(false) {
@@ -14,83 +23,157 @@ VertexBuffer::VertexBuffer(std::vector<Vec3f>& vertices)
     initBuffer(vertices, {});
 }
 
-VertexBuffer::VertexBuffer(std::vector<Vec3f>& vertices, std::vector<unsigned int> indices) 
+VertexBuffer::VertexBuffer(std::vector<Vec3f>& vertices, const std::vector<unsigned int>& indices) 
     : Buffer(), length(vertices.size()), hasIndexBuffer(true) {
     initBuffer(vertices, indices);
 }
 
-VertexBuffer::VertexBuffer(const VertexBuffer& vertexBuffer) 
-    : length(vertexBuffer.length), hasIndexBuffer(vertexBuffer.hasIndexBuffer) {
-    if(vertexBuffer.indexBuffer != nullptr) indexBuffer = vertexBuffer.indexBuffer;
-    id = vertexBuffer.id;
-}
-
-VertexBuffer::VertexBuffer(VertexBuffer&& vertexBuffer) noexcept 
-    : length(vertexBuffer.length), hasIndexBuffer(vertexBuffer.hasIndexBuffer) {
-    if(indexBuffer != nullptr) indexBuffer = std::move(vertexBuffer.indexBuffer);
-    id = vertexBuffer.id;
+VertexBuffer::VertexBuffer(VertexBuffer&& vertexBuffer) noexcept
+    : Buffer(), hasIndexBuffer(false), length(0), vertexArrayID(0) {
+    take(vertexBuffer);
 }
 
-VertexBuffer& VertexBuffer::operator=(const VertexBuffer& vertexBuffer) {
-    id = vertexBuffer.id;
-    length = vertexBuffer.length;
-    hasIndexBuffer = vertexBuffer.hasIndexBuffer;
-    if(indexBuffer != nullptr) indexBuffer = vertexBuffer.indexBuffer;
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& vertexBuffer) noexcept {
+    if(this != &vertexBuffer) {
+        releaseStorage();
+        take(vertexBuffer);
+    }
     return *this;
 }
 
 VertexBuffer::~VertexBuffer() {
     unbind();
-    glDeleteBuffers(1, &id);
+    releaseStorage();
+}
+
+void VertexBuffer::allocateStorage(const float* data) {
+
+    unsigned int size = length * sizeof(float) * 17;
+    RenderDevice::get()->getIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArrayID);
+
+    if(defaultHeap != nullptr && size > 0) {
+        heap = defaultHeap;
+        allocation = heap->allocate(size, relocation());
+    }
+
+    if(allocation.isValid()) {
+        id = allocation.buffer;
+        offset = allocation.offset;
+        RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, id);
+        if(data != nullptr) RenderDevice::get()->bufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    }
+    else {
+        RenderDevice::get()->genBuffers(1, &id);
+        RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, id);
+        RenderDevice::get()->bufferData(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW);
+    }
+
+    if(data != nullptr) RenderStats::countUpload(size);
+}
+
+void VertexBuffer::releaseStorage() {
+    if(allocation.isValid()) heap->free(allocation);
+    else if(id != 0) RenderDevice::get()->deleteBuffers(1, &id);
+
+    heap = nullptr;
+    allocation = BufferHeap::Allocation();
+    id = 0;
+    offset = 0;
+}
+
+void VertexBuffer::take(VertexBuffer& vertexBuffer) {
+
+    indexBuffer = std::move(vertexBuffer.indexBuffer);
+    hasIndexBuffer = vertexBuffer.hasIndexBuffer;
+    length = vertexBuffer.length;
+    id = vertexBuffer.id;
+    offset = vertexBuffer.offset;
+    heap = std::move(vertexBuffer.heap);
+    allocation = vertexBuffer.allocation;
+    vertexArrayID = vertexBuffer.vertexArrayID;
+
+    vertexBuffer.hasIndexBuffer = false;
+    vertexBuffer.length = 0;
+    vertexBuffer.id = 0;
+    vertexBuffer.offset = 0;
+    vertexBuffer.allocation = BufferHeap::Allocation();
+
+    // Compaction calls the new owner
+    if(allocation.isValid()) heap->setRelocationCallback(allocation, relocation());
+}
+
+BufferHeap::RelocationCallback VertexBuffer::relocation() {
+    return [this](const BufferHeap::Allocation&, const BufferHeap::Allocation& to) {
+        relocate(to);
+    };
+}
+
+void VertexBuffer::relocate(const BufferHeap::Allocation& to) {
+
+    allocation = to;
+    offset = to.offset;
+    if(vertexArrayID == 0) return;
+
+    // Attribute pointers have the old offset baked in
+    int previousVertexArray = 0;
+    RenderDevice::get()->getIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+    RenderDevice::get()->bindVertexArray(vertexArrayID);
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, id);
+    vertexAttributes();
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, 0);
+    RenderDevice::get()->bindVertexArray(previousVertexArray);
 }
 
 void VertexBuffer::vertexAttributes() {
 
     // position attribute
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 17 * sizeof(float), (void*)0);
+    RenderDevice::get()->enableVertexAttribArray(0);
+    RenderDevice::get()->vertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 17 * sizeof(float), (void*)offset);
 
     // color attribute
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 17 * sizeof(float), (void*)(3 * sizeof(float)));
+    RenderDevice::get()->enableVertexAttribArray(1);
+    RenderDevice::get()->vertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 17 * sizeof(float), (void*)(offset + 3 * sizeof(float)));
 
     // normal attribute
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 17 * sizeof(float), (void*)(6 * sizeof(float)));
+    RenderDevice::get()->enableVertexAttribArray(2);
+    RenderDevice::get()->vertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 17 * sizeof(float), (void*)(offset + 6 * sizeof(float)));
 
     // texture coordinates attribute
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 17 * sizeof(float), (void*)(9 * sizeof(float)));
+    RenderDevice::get()->enableVertexAttribArray(3);
+    RenderDevice::get()->vertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 17 * sizeof(float), (void*)(offset + 9 * sizeof(float)));
 
     // tangent attribute
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 17 * sizeof(float), (void*)(11 * sizeof(float)));
+    RenderDevice::get()->enableVertexAttribArray(4);
+    RenderDevice::get()->vertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 17 * sizeof(float), (void*)(offset + 11 * sizeof(float)));
     
     // bitangent attribute
-    glEnableVertexAttribArray(5);
-    glVertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, 17 * sizeof(float), (void*)(14 * sizeof(float)));
+    RenderDevice::get()->enableVertexAttribArray(5);
+    RenderDevice::get()->vertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, 17 * sizeof(float), (void*)(offset + 14 * sizeof(float)));
 }
 
-void VertexBuffer::initBuffer(std::vector<Vec3f>& vertices, std::vector<unsigned int> indices) {
+void VertexBuffer::interleave(const std::vector<Vec3f>& vertices, float* data) {
+    for(const Vec3f& vertex : vertices) {
+        memcpy(data, &vertex.x, 17 * sizeof(float));
+        data += 17;
+    }
+}
 
-    // Load vertices
-    unsigned int index = 0;
-    float* glVertices = new float[vertices.size() * 17];
+void VertexBuffer::deinterleave(const float* data, size_t length, std::vector<Vec3f>& vertices) {
+    vertices.resize(length);
     for(Vec3f& vertex : vertices) {
-        glVertices[index] = vertex.x;   glVertices[index + 1] = vertex.y;   glVertices[index + 2] = vertex.z;
-        glVertices[index + 3] = vertex.r;   glVertices[index + 4] = vertex.g;   glVertices[index + 5] = vertex.b;
-        glVertices[index + 6] = vertex.nx;   glVertices[index + 7] = vertex.ny;   glVertices[index + 8] = vertex.nz;
-        glVertices[index + 9] = vertex.tx;  glVertices[index + 10] = vertex.ty; 
-        glVertices[index + 11] = vertex.tanx;  glVertices[index + 12] = vertex.tany; glVertices[index + 13] = vertex.tanz;
-        glVertices[index + 14] = vertex.bitanx; glVertices[index + 15] = vertex.bitany; glVertices[index + 16] = vertex.bitanz;
-        index += 17;
+        memcpy(&vertex.x, data, 17 * sizeof(float));
+        data += 17;
     }
+}
+
+void VertexBuffer::initBuffer(std::vector<Vec3f>& vertices, const std::vector<unsigned int>& indices) {
+
+    // Load vertices
+    std::vector<float> glVertices(vertices.size() * 17);
+    interleave(vertices, glVertices.data());
 
     // Vertex buffer
-    glGenBuffers(1, &id);
-    glBindBuffer(GL_ARRAY_BUFFER, id);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float) * 17, glVertices, GL_DYNAMIC_DRAW);
-    delete[] glVertices;
+    allocateStorage(glVertices.data());
 
     // Index Buffer
     if(hasIndexBuffer && !indices.empty()) indexBuffer = std::make_shared<IndexBuffer>(indices);
@@ -105,9 +188,7 @@ void VertexBuffer::initBuffer(std::vector<Vec3f>& vertices, std::vector<unsigned
 void VertexBuffer::initBuffer() { 
 
     // Vertex buffer
-    glGenBuffers(1, &id);
-    glBindBuffer(GL_ARRAY_BUFFER, id);
-    glBufferData(GL_ARRAY_BUFFER, length * sizeof(float) * 17, nullptr, GL_DYNAMIC_DRAW);
+    allocateStorage(nullptr);
 
     // Vertex Attributes
     vertexAttributes();
@@ -118,28 +199,20 @@ void VertexBuffer::initBuffer() {
 
 void VertexBuffer::updateVertices(std::vector<Vec3f>& vertices) {
 
-    glBindBuffer(GL_ARRAY_BUFFER, id);
-    float* ptr = (float*)glMapBuffer(GL_ARRAY_BUFFER, GL_READ_WRITE);
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, id);
+    float* ptr = (float*)RenderDevice::get()->mapBufferRange(GL_ARRAY_BUFFER, offset, length * sizeof(float) * 17, GL_MAP_READ_BIT | GL_MAP_WRITE_BIT);
 
-    unsigned int index = 0;
-    for(Vec3f& vertex : vertices) {
-        ptr[index] = vertex.x;     ptr[index + 1] = vertex.y; ptr[index + 2] = vertex.z;
-        ptr[index + 3] = vertex.r; ptr[index + 4] = vertex.g; ptr[index + 5] = vertex.b;
-        ptr[index + 6] = vertex.nx; ptr[index + 7] = vertex.ny; ptr[index + 8] = vertex.nz;
-        ptr[index + 9] = vertex.tx; ptr[index + 10] = vertex.ty;
-        ptr[index + 11] = vertex.tanx; ptr[index + 12] = vertex.tany; ptr[index + 13] = vertex.tanz;
-        ptr[index + 14] = vertex.bitanx; ptr[index + 15] = vertex.bitany; ptr[index + 16] = vertex.bitanz;
-        index += 17;
-    }
+    interleave(vertices, ptr);
 
-    glUnmapBuffer(GL_ARRAY_BUFFER);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    RenderDevice::get()->unmapBuffer(GL_ARRAY_BUFFER);
+    RenderStats::countUpload(vertices.size() * sizeof(float) * 17);
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void VertexBuffer::updateVertex(int pos, Vec3f newVertex) {
 
-    glBindBuffer(GL_ARRAY_BUFFER, id);
-    float* ptr = (float*)glMapBuffer(GL_ARRAY_BUFFER, GL_READ_WRITE);
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, id);
+    float* ptr = (float*)RenderDevice::get()->mapBufferRange(GL_ARRAY_BUFFER, offset, length * sizeof(float) * 17, GL_MAP_READ_BIT | GL_MAP_WRITE_BIT);
 
     int index = pos * 17;
     ptr[index] = newVertex.x;     ptr[index + 1] = newVertex.y; ptr[index + 2] = newVertex.z;
@@ -149,45 +222,29 @@ void VertexBuffer::updateVertex(int pos, Vec3f newVertex) {
     ptr[index + 11] = newVertex.tanx; ptr[index + 12] = newVertex.tany; ptr[index + 13] = newVertex.tanz;
     ptr[index + 14] = newVertex.bitanx; ptr[index + 15] = newVertex.bitany; ptr[index + 16] = newVertex.bitanz;
 
-    glUnmapBuffer(GL_ARRAY_BUFFER);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    RenderDevice::get()->unmapBuffer(GL_ARRAY_BUFFER);
+    RenderStats::countUpload(sizeof(float) * 17);
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 std::vector<Vec3f> VertexBuffer::getVertices() {
 
-    glBindBuffer(GL_ARRAY_BUFFER, id);
-    float* ptr = (float*)glMapBuffer(GL_ARRAY_BUFFER, GL_READ_WRITE);
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, id);
+    float* ptr = (float*)RenderDevice::get()->mapBufferRange(GL_ARRAY_BUFFER, offset, length * sizeof(float) * 17, GL_MAP_READ_BIT | GL_MAP_WRITE_BIT);
 
     std::vector<Vec3f> vertices;
-    for(int i = 0; i < length; i ++) {
-        Vec3f vertex(
-            ptr[i * 17], ptr[i * 17 + 1], ptr[i * 17 + 2],
-            ptr[i * 17 + 3], ptr[i * 17 + 4], ptr[i * 17 + 5],
-            ptr[i * 17 + 6], ptr[i * 17 + 7], ptr[i * 17 + 8],
-            ptr[i * 17 + 9], ptr[i * 17 + 10]
-        );
-
-        vertex.tanx = ptr[i * 17 + 11];
-        vertex.tany = ptr[i * 17 + 12];
-        vertex.tanz = ptr[i * 17 + 13];
-
-        vertex.bitanx = ptr[i * 17 + 14];
-        vertex.bitany = ptr[i * 17 + 15];
-        vertex.bitanz = ptr[i * 17 + 16];
-
-        vertices.push_back(vertex);
-    }
+    deinterleave(ptr, length, vertices);
 
-    glUnmapBuffer(GL_ARRAY_BUFFER);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    RenderDevice::get()->unmapBuffer(GL_ARRAY_BUFFER);
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, 0);
 
     return vertices;
 }
 
 void VertexBuffer::bind() {
-    glBindBuffer(GL_ARRAY_BUFFER, id);
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, id);
 }
 
 void VertexBuffer::unbind() {
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, 0);
 }
\ No newline at end of file
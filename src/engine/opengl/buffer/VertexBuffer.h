@@ -6,6 +6,7 @@
 
 #include "Buffer.h"
 #include "IndexBuffer.h"
+#include "BufferHeap.h"
 
 #include "engine/Vec3.h"
 
@@ -15,18 +16,30 @@ private:
     IndexBuffer::Ptr indexBuffer;
     bool hasIndexBuffer;
     size_t length;
+    BufferHeap::Ptr heap;
+    BufferHeap::Allocation allocation;
+    int vertexArrayID;
+
+    static BufferHeap::Ptr defaultHeap;
 public:
     VertexBuffer();
     VertexBuffer(size_t _length);
     VertexBuffer(std::vector<Vec3f>& vertices);
-    VertexBuffer(std::vector<Vec3f>& vertices, std::vector<unsigned int> indices);
-    VertexBuffer(const VertexBuffer& vertexBuffer);
+    VertexBuffer(std::vector<Vec3f>& vertices, const std::vector<unsigned int>& indices);
+    // The storage has one owner, a moved buffer leaves the other one empty
+    VertexBuffer(const VertexBuffer& vertexBuffer) = delete;
     VertexBuffer(VertexBuffer&& vertexBuffer) noexcept;
-    VertexBuffer& operator=(const VertexBuffer& vertexBuffer);
+    VertexBuffer& operator=(const VertexBuffer& vertexBuffer) = delete;
+    VertexBuffer& operator=(VertexBuffer&& vertexBuffer) noexcept;
     ~VertexBuffer();
 protected:
     void vertexAttributes();
-    void initBuffer(std::vector<Vec3f>& vertices, std::vector<unsigned int> indices);
+    void allocateStorage(const float* data);
+    void releaseStorage();
+    void take(VertexBuffer& vertexBuffer);
+    void relocate(const BufferHeap::Allocation& to);
+    BufferHeap::RelocationCallback relocation();
+    void initBuffer(std::vector<Vec3f>& vertices, const std::vector<unsigned int>& indices);
     void initBuffer() override;
 public:
     void updateVertices(std::vector<Vec3f>& vertices);
@@ -34,9 +47,20 @@ public:
     std::vector<Vec3f> getVertices();
     void bind() override;
     void unbind() override;
+
+    // Vertices to and from the 17 floats per vertex layout of the buffer
+    static void interleave(const std::vector<Vec3f>& vertices, float* data);
+    static void deinterleave(const float* data, size_t length, std::vector<Vec3f>& vertices);
 public:
     inline IndexBuffer::Ptr& getIndexBuffer() { return indexBuffer; }
     inline bool HasIndexBuffer() const { return hasIndexBuffer; }
     inline void setLength(size_t length) { this->length = length; }
     inline size_t getLength() const { return length; }
+
+    /**
+     * Vertex buffers created after this call are sub-allocated from heap, nullptr goes back to one GL buffer each.
+     * When the heap moves a buffer its attributes are set again in the VAO bound at creation
+    */
+    inline static void setHeap(const BufferHeap::Ptr& heap) { defaultHeap = heap; }
+    inline static BufferHeap::Ptr& getHeap() { return defaultHeap; }
 };
\ No newline at end of file
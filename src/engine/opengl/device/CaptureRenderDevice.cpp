@@ -0,0 +1,786 @@
+#include "CaptureRenderDevice.h"
+
+#include <iostream>
+#include <string.h>
+
+CaptureRenderDevice::CaptureRenderDevice(const RenderDevice::Ptr& renderDevice, const std::string& path)
+    : wrapped(renderDevice), file(path, std::ios::binary | std::ios::trunc), frames(0) {
+
+    if(!file.is_open()) std::cout << "Couldn't write the capture " << path << std::endl;
+
+    writer.write<uint32_t>(COMMAND_STREAM_MAGIC);
+    writer.write<uint32_t>(COMMAND_STREAM_VERSION);
+}
+
+void CaptureRenderDevice::writeNames(CommandStream::Opcode opcode, GLsizei n, const GLuint* names) {
+    write(opcode);
+    writer.write(names, n * sizeof(GLuint));
+}
+
+void CaptureRenderDevice::flush() {
+    const std::vector<unsigned char>& data = writer.getData();
+    if(file.is_open() && !data.empty()) {
+        file.write((const char*)data.data(), data.size());
+        file.flush();
+    }
+    writer.clear();
+}
+
+bool CaptureRenderDevice::init() {
+    return wrapped->init();
+}
+
+bool CaptureRenderDevice::isSupported(Feature feature) {
+    // A binary only works on the driver which made it
+    if(feature == PROGRAM_BINARY) return false;
+    return wrapped->isSupported(feature);
+}
+
+void CaptureRenderDevice::endFrame() {
+    wrapped->endFrame();
+    write(CommandStream::END_FRAME);
+    flush();
+    frames ++;
+}
+
+// Buffers
+
+void CaptureRenderDevice::genBuffers(GLsizei n, GLuint* buffers) {
+    wrapped->genBuffers(n, buffers);
+    writeNames(CommandStream::GEN_BUFFERS, n, buffers);
+}
+
+void CaptureRenderDevice::deleteBuffers(GLsizei n, const GLuint* buffers) {
+    wrapped->deleteBuffers(n, buffers);
+    writeNames(CommandStream::DELETE_BUFFERS, n, buffers);
+}
+
+void CaptureRenderDevice::bindBuffer(GLenum target, GLuint buffer) {
+    wrapped->bindBuffer(target, buffer);
+    write(CommandStream::BIND_BUFFER);
+    writer.write(target);
+    writer.write(buffer);
+}
+
+void CaptureRenderDevice::bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    wrapped->bufferData(target, size, data, usage);
+    write(CommandStream::BUFFER_DATA);
+    writer.write(target);
+    writer.write<int64_t>(size);
+    writer.write(data, data != nullptr ? size : 0);
+    writer.write(usage);
+}
+
+void CaptureRenderDevice::bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    wrapped->bufferSubData(target, offset, size, data);
+    write(CommandStream::BUFFER_SUB_DATA);
+    writer.write(target);
+    writer.write<int64_t>(offset);
+    writer.write(data, size);
+}
+
+void CaptureRenderDevice::copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) {
+    wrapped->copyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+    write(CommandStream::COPY_BUFFER_SUB_DATA);
+    writer.write(readTarget);
+    writer.write(writeTarget);
+    writer.write<int64_t>(readOffset);
+    writer.write<int64_t>(writeOffset);
+    writer.write<int64_t>(size);
+}
+
+void* CaptureRenderDevice::mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    void* pointer = wrapped->mapBufferRange(target, offset, length, access);
+    mappings[target] = { pointer, offset, length, access };
+    return pointer;
+}
+
+GLboolean CaptureRenderDevice::unmapBuffer(GLenum target) {
+
+    // What was written through the pointer is replayed as an upload
+    auto mapping = mappings.find(target);
+    if(mapping != mappings.end()) {
+        if(mapping->second.pointer != nullptr && (mapping->second.access & GL_MAP_WRITE_BIT)) {
+            write(CommandStream::MAPPED_WRITE);
+            writer.write(target);
+            writer.write<int64_t>(mapping->second.offset);
+            writer.write(mapping->second.pointer, mapping->second.length);
+        }
+        mappings.erase(mapping);
+    }
+
+    return wrapped->unmapBuffer(target);
+}
+
+void CaptureRenderDevice::bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    wrapped->bindBufferBase(target, index, buffer);
+    write(CommandStream::BIND_BUFFER_BASE);
+    writer.write(target);
+    writer.write(index);
+    writer.write(buffer);
+}
+
+// Vertex arrays
+
+void CaptureRenderDevice::genVertexArrays(GLsizei n, GLuint* arrays) {
+    wrapped->genVertexArrays(n, arrays);
+    writeNames(CommandStream::GEN_VERTEX_ARRAYS, n, arrays);
+}
+
+void CaptureRenderDevice::deleteVertexArrays(GLsizei n, const GLuint* arrays) {
+    wrapped->deleteVertexArrays(n, arrays);
+    writeNames(CommandStream::DELETE_VERTEX_ARRAYS, n, arrays);
+}
+
+void CaptureRenderDevice::bindVertexArray(GLuint array) {
+    wrapped->bindVertexArray(array);
+    write(CommandStream::BIND_VERTEX_ARRAY);
+    writer.write(array);
+}
+
+void CaptureRenderDevice::enableVertexAttribArray(GLuint index) {
+    wrapped->enableVertexAttribArray(index);
+    write(CommandStream::ENABLE_VERTEX_ATTRIB_ARRAY);
+    writer.write(index);
+}
+
+void CaptureRenderDevice::vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) {
+    wrapped->vertexAttribPointer(index, size, type, normalized, stride, pointer);
+    write(CommandStream::VERTEX_ATTRIB_POINTER);
+    writer.write(index);
+    writer.write(size);
+    writer.write(type);
+    writer.write(normalized);
+    writer.write(stride);
+    writer.write<uint64_t>((uintptr_t)pointer); // Offset in the bound buffer
+}
+
+void CaptureRenderDevice::vertexAttribDivisor(GLuint index, GLuint divisor) {
+    wrapped->vertexAttribDivisor(index, divisor);
+    write(CommandStream::VERTEX_ATTRIB_DIVISOR);
+    writer.write(index);
+    writer.write(divisor);
+}
+
+// Textures
+
+void CaptureRenderDevice::genTextures(GLsizei n, GLuint* textures) {
+    wrapped->genTextures(n, textures);
+    writeNames(CommandStream::GEN_TEXTURES, n, textures);
+}
+
+void CaptureRenderDevice::deleteTextures(GLsizei n, const GLuint* textures) {
+    wrapped->deleteTextures(n, textures);
+    writeNames(CommandStream::DELETE_TEXTURES, n, textures);
+}
+
+void CaptureRenderDevice::bindTexture(GLenum target, GLuint texture) {
+    wrapped->bindTexture(target, texture);
+    write(CommandStream::BIND_TEXTURE);
+    writer.write(target);
+    writer.write(texture);
+}
+
+void CaptureRenderDevice::activeTexture(GLenum texture) {
+    wrapped->activeTexture(texture);
+    write(CommandStream::ACTIVE_TEXTURE);
+    writer.write(texture);
+}
+
+void CaptureRenderDevice::texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* data) {
+    wrapped->texImage2D(target, level, internalFormat, width, height, border, format, type, data);
+    write(CommandStream::TEX_IMAGE_2D);
+    writer.write(target);
+    writer.write(level);
+    writer.write(internalFormat);
+    writer.write(width);
+    writer.write(height);
+    writer.write(border);
+    writer.write(format);
+    writer.write(type);
+    writer.write(data, data != nullptr ? getImageSize(width, height, format, type) : 0);
+}
+
+void CaptureRenderDevice::texImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void* data) {
+    wrapped->texImage3D(target, level, internalFormat, width, height, depth, border, format, type, data);
+    write(CommandStream::TEX_IMAGE_3D);
+    writer.write(target);
+    writer.write(level);
+    writer.write(internalFormat);
+    writer.write(width);
+    writer.write(height);
+    writer.write(depth);
+    writer.write(border);
+    writer.write(format);
+    writer.write(type);
+    writer.write(data, data != nullptr ? getImageSize(width, height, format, type) * depth : 0);
+}
+
+void CaptureRenderDevice::texImage2DMultisample(GLenum target, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height, GLboolean fixedSampleLocations) {
+    wrapped->texImage2DMultisample(target, samples, internalFormat, width, height, fixedSampleLocations);
+    write(CommandStream::TEX_IMAGE_2D_MULTISAMPLE);
+    writer.write(target);
+    writer.write(samples);
+    writer.write(internalFormat);
+    writer.write(width);
+    writer.write(height);
+    writer.write(fixedSampleLocations);
+}
+
+void CaptureRenderDevice::texParameteri(GLenum target, GLenum pname, GLint param) {
+    wrapped->texParameteri(target, pname, param);
+    write(CommandStream::TEX_PARAMETER_I);
+    writer.write(target);
+    writer.write(pname);
+    writer.write(param);
+}
+
+void CaptureRenderDevice::texParameterfv(GLenum target, GLenum pname, const GLfloat* params) {
+    wrapped->texParameterfv(target, pname, params);
+    write(CommandStream::TEX_PARAMETER_FV);
+    writer.write(target);
+    writer.write(pname);
+    writer.write(params, (pname == GL_TEXTURE_BORDER_COLOR ? 4 : 1) * sizeof(GLfloat));
+}
+
+void CaptureRenderDevice::generateMipmap(GLenum target) {
+    wrapped->generateMipmap(target);
+    write(CommandStream::GENERATE_MIPMAP);
+    writer.write(target);
+}
+
+void CaptureRenderDevice::texBuffer(GLenum target, GLenum internalFormat, GLuint buffer) {
+    wrapped->texBuffer(target, internalFormat, buffer);
+    write(CommandStream::TEX_BUFFER);
+    writer.write(target);
+    writer.write(internalFormat);
+    writer.write(buffer);
+}
+
+void CaptureRenderDevice::genSamplers(GLsizei n, GLuint* samplers) {
+    wrapped->genSamplers(n, samplers);
+    writeNames(CommandStream::GEN_SAMPLERS, n, samplers);
+}
+
+void CaptureRenderDevice::deleteSamplers(GLsizei n, const GLuint* samplers) {
+    wrapped->deleteSamplers(n, samplers);
+    writeNames(CommandStream::DELETE_SAMPLERS, n, samplers);
+}
+
+void CaptureRenderDevice::bindSampler(GLuint unit, GLuint sampler) {
+    wrapped->bindSampler(unit, sampler);
+    write(CommandStream::BIND_SAMPLER);
+    writer.write(unit);
+    writer.write(sampler);
+}
+
+void CaptureRenderDevice::samplerParameteri(GLuint sampler, GLenum pname, GLint param) {
+    wrapped->samplerParameteri(sampler, pname, param);
+    write(CommandStream::SAMPLER_PARAMETER_I);
+    writer.write(sampler);
+    writer.write(pname);
+    writer.write(param);
+}
+
+void CaptureRenderDevice::samplerParameterfv(GLuint sampler, GLenum pname, const GLfloat* params) {
+    wrapped->samplerParameterfv(sampler, pname, params);
+    write(CommandStream::SAMPLER_PARAMETER_FV);
+    writer.write(sampler);
+    writer.write(pname);
+    writer.write(params, (pname == GL_TEXTURE_BORDER_COLOR ? 4 : 1) * sizeof(GLfloat));
+}
+
+// Frame buffers
+
+void CaptureRenderDevice::genFramebuffers(GLsizei n, GLuint* framebuffers) {
+    wrapped->genFramebuffers(n, framebuffers);
+    writeNames(CommandStream::GEN_FRAMEBUFFERS, n, framebuffers);
+}
+
+void CaptureRenderDevice::deleteFramebuffers(GLsizei n, const GLuint* framebuffers) {
+    wrapped->deleteFramebuffers(n, framebuffers);
+    writeNames(CommandStream::DELETE_FRAMEBUFFERS, n, framebuffers);
+}
+
+void CaptureRenderDevice::bindFramebuffer(GLenum target, GLuint framebuffer) {
+    wrapped->bindFramebuffer(target, framebuffer);
+    write(CommandStream::BIND_FRAMEBUFFER);
+    writer.write(target);
+    writer.write(framebuffer);
+}
+
+void CaptureRenderDevice::framebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level) {
+    wrapped->framebufferTexture2D(target, attachment, textureTarget, texture, level);
+    write(CommandStream::FRAMEBUFFER_TEXTURE_2D);
+    writer.write(target);
+    writer.write(attachment);
+    writer.write(textureTarget);
+    writer.write(texture);
+    writer.write(level);
+}
+
+void CaptureRenderDevice::framebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer) {
+    wrapped->framebufferTextureLayer(target, attachment, texture, level, layer);
+    write(CommandStream::FRAMEBUFFER_TEXTURE_LAYER);
+    writer.write(target);
+    writer.write(attachment);
+    writer.write(texture);
+    writer.write(level);
+    writer.write(layer);
+}
+
+void CaptureRenderDevice::framebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level) {
+    wrapped->framebufferTexture(target, attachment, texture, level);
+    write(CommandStream::FRAMEBUFFER_TEXTURE);
+    writer.write(target);
+    writer.write(attachment);
+    writer.write(texture);
+    writer.write(level);
+}
+
+void CaptureRenderDevice::framebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer) {
+    wrapped->framebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+    write(CommandStream::FRAMEBUFFER_RENDERBUFFER);
+    writer.write(target);
+    writer.write(attachment);
+    writer.write(renderbufferTarget);
+    writer.write(renderbuffer);
+}
+
+void CaptureRenderDevice::blitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) {
+    wrapped->blitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+    write(CommandStream::BLIT_FRAMEBUFFER);
+    for(GLint value : { srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1 }) writer.write(value);
+    writer.write(mask);
+    writer.write(filter);
+}
+
+void CaptureRenderDevice::drawBuffer(GLenum buffer) {
+    wrapped->drawBuffer(buffer);
+    write(CommandStream::DRAW_BUFFER);
+    writer.write(buffer);
+}
+
+void CaptureRenderDevice::drawBuffers(GLsizei n, const GLenum* buffers) {
+    wrapped->drawBuffers(n, buffers);
+    write(CommandStream::DRAW_BUFFERS);
+    writer.write(buffers, n * sizeof(GLenum));
+}
+
+void CaptureRenderDevice::readBuffer(GLenum buffer) {
+    wrapped->readBuffer(buffer);
+    write(CommandStream::READ_BUFFER);
+    writer.write(buffer);
+}
+
+void CaptureRenderDevice::genRenderbuffers(GLsizei n, GLuint* renderbuffers) {
+    wrapped->genRenderbuffers(n, renderbuffers);
+    writeNames(CommandStream::GEN_RENDERBUFFERS, n, renderbuffers);
+}
+
+void CaptureRenderDevice::deleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) {
+    wrapped->deleteRenderbuffers(n, renderbuffers);
+    writeNames(CommandStream::DELETE_RENDERBUFFERS, n, renderbuffers);
+}
+
+void CaptureRenderDevice::bindRenderbuffer(GLenum target, GLuint renderbuffer) {
+    wrapped->bindRenderbuffer(target, renderbuffer);
+    write(CommandStream::BIND_RENDERBUFFER);
+    writer.write(target);
+    writer.write(renderbuffer);
+}
+
+void CaptureRenderDevice::renderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height) {
+    wrapped->renderbufferStorage(target, internalFormat, width, height);
+    write(CommandStream::RENDERBUFFER_STORAGE);
+    writer.write(target);
+    writer.write(internalFormat);
+    writer.write(width);
+    writer.write(height);
+}
+
+void CaptureRenderDevice::renderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height) {
+    wrapped->renderbufferStorageMultisample(target, samples, internalFormat, width, height);
+    write(CommandStream::RENDERBUFFER_STORAGE_MULTISAMPLE);
+    writer.write(target);
+    writer.write(samples);
+    writer.write(internalFormat);
+    writer.write(width);
+    writer.write(height);
+}
+
+// Shaders
+
+GLuint CaptureRenderDevice::createShader(GLenum type) {
+    GLuint shader = wrapped->createShader(type);
+    write(CommandStream::CREATE_SHADER);
+    writer.write(type);
+    writer.write(shader);
+    return shader;
+}
+
+void CaptureRenderDevice::deleteShader(GLuint shader) {
+    wrapped->deleteShader(shader);
+    write(CommandStream::DELETE_SHADER);
+    writer.write(shader);
+}
+
+void CaptureRenderDevice::shaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length) {
+    wrapped->shaderSource(shader, count, string, length);
+    write(CommandStream::SHADER_SOURCE);
+    writer.write(shader);
+    writer.write(count);
+    for(GLsizei i = 0; i < count; i ++) {
+        // A negative or missing length is a null terminated string
+        if(length != nullptr && length[i] >= 0) writer.writeString(string[i], length[i]);
+        else writer.writeString(string[i]);
+    }
+}
+
+void CaptureRenderDevice::compileShader(GLuint shader) {
+    wrapped->compileShader(shader);
+    write(CommandStream::COMPILE_SHADER);
+    writer.write(shader);
+}
+
+GLuint CaptureRenderDevice::createProgram() {
+    GLuint program = wrapped->createProgram();
+    write(CommandStream::CREATE_PROGRAM);
+    writer.write(program);
+    return program;
+}
+
+void CaptureRenderDevice::deleteProgram(GLuint program) {
+    wrapped->deleteProgram(program);
+    for(auto it = uniformLocations.begin(); it != uniformLocations.end();) {
+        if((GLuint)(*it >> 32) == program) it = uniformLocations.erase(it);
+        else it ++;
+    }
+    write(CommandStream::DELETE_PROGRAM);
+    writer.write(program);
+}
+
+void CaptureRenderDevice::attachShader(GLuint program, GLuint shader) {
+    wrapped->attachShader(program, shader);
+    write(CommandStream::ATTACH_SHADER);
+    writer.write(program);
+    writer.write(shader);
+}
+
+void CaptureRenderDevice::detachShader(GLuint program, GLuint shader) {
+    wrapped->detachShader(program, shader);
+    write(CommandStream::DETACH_SHADER);
+    writer.write(program);
+    writer.write(shader);
+}
+
+void CaptureRenderDevice::linkProgram(GLuint program) {
+    wrapped->linkProgram(program);
+    write(CommandStream::LINK_PROGRAM);
+    writer.write(program);
+}
+
+void CaptureRenderDevice::useProgram(GLuint program) {
+    wrapped->useProgram(program);
+    write(CommandStream::USE_PROGRAM);
+    writer.write(program);
+}
+
+void CaptureRenderDevice::programParameteri(GLuint program, GLenum pname, GLint value) {
+    wrapped->programParameteri(program, pname, value);
+    write(CommandStream::PROGRAM_PARAMETER_I);
+    writer.write(program);
+    writer.write(pname);
+    writer.write(value);
+}
+
+void CaptureRenderDevice::getProgramBinary(GLuint, GLsizei, GLsizei* length, GLenum*, void*) {
+    if(length != nullptr) *length = 0;
+}
+
+void CaptureRenderDevice::programBinary(GLuint, GLenum, const void*, GLsizei) {
+    std::cout << "Program binaries can't be captured" << std::endl;
+}
+
+GLint CaptureRenderDevice::getUniformLocation(GLuint program, const GLchar* name) {
+    GLint location = wrapped->getUniformLocation(program, name);
+
+    // Only the first lookup of every location is written
+    if(location < 0 || !uniformLocations.insert(((uint64_t)program << 32) | (uint32_t)location).second) return location;
+
+    write(CommandStream::GET_UNIFORM_LOCATION);
+    writer.write(program);
+    writer.writeString(name);
+    writer.write(location);
+    return location;
+}
+
+void CaptureRenderDevice::uniform1i(GLint location, GLint v0) {
+    wrapped->uniform1i(location, v0);
+    write(CommandStream::UNIFORM_1I);
+    writer.write(location);
+    writer.write(v0);
+}
+
+void CaptureRenderDevice::uniform1f(GLint location, GLfloat v0) {
+    wrapped->uniform1f(location, v0);
+    write(CommandStream::UNIFORM_1F);
+    writer.write(location);
+    writer.write(v0);
+}
+
+void CaptureRenderDevice::uniform3fv(GLint location, GLsizei count, const GLfloat* value) {
+    wrapped->uniform3fv(location, count, value);
+    write(CommandStream::UNIFORM_3FV);
+    writer.write(location);
+    writer.write(value, count * 3 * sizeof(GLfloat));
+}
+
+void CaptureRenderDevice::uniform1iv(GLint location, GLsizei count, const GLint* value) {
+    wrapped->uniform1iv(location, count, value);
+    write(CommandStream::UNIFORM_1IV);
+    writer.write(location);
+    writer.write(value, count * sizeof(GLint));
+}
+
+void CaptureRenderDevice::uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    wrapped->uniformMatrix4fv(location, count, transpose, value);
+    write(CommandStream::UNIFORM_MATRIX_4FV);
+    writer.write(location);
+    writer.write(transpose);
+    writer.write(value, count * 16 * sizeof(GLfloat));
+}
+
+// Compute
+
+void CaptureRenderDevice::dispatchCompute(GLuint numGroupsX, GLuint numGroupsY, GLuint numGroupsZ) {
+    wrapped->dispatchCompute(numGroupsX, numGroupsY, numGroupsZ);
+    write(CommandStream::DISPATCH_COMPUTE);
+    writer.write(numGroupsX);
+    writer.write(numGroupsY);
+    writer.write(numGroupsZ);
+}
+
+void CaptureRenderDevice::memoryBarrier(GLbitfield barriers) {
+    wrapped->memoryBarrier(barriers);
+    write(CommandStream::MEMORY_BARRIER);
+    writer.write(barriers);
+}
+
+// State
+
+void CaptureRenderDevice::enable(GLenum cap) {
+    wrapped->enable(cap);
+    write(CommandStream::ENABLE);
+    writer.write(cap);
+}
+
+void CaptureRenderDevice::disable(GLenum cap) {
+    wrapped->disable(cap);
+    write(CommandStream::DISABLE);
+    writer.write(cap);
+}
+
+void CaptureRenderDevice::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    wrapped->viewport(x, y, width, height);
+    write(CommandStream::VIEWPORT);
+    writer.write(x);
+    writer.write(y);
+    writer.write(width);
+    writer.write(height);
+}
+
+void CaptureRenderDevice::clear(GLbitfield mask) {
+    wrapped->clear(mask);
+    write(CommandStream::CLEAR);
+    writer.write(mask);
+}
+
+void CaptureRenderDevice::clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+    wrapped->clearColor(red, green, blue, alpha);
+    write(CommandStream::CLEAR_COLOR);
+    writer.write(red);
+    writer.write(green);
+    writer.write(blue);
+    writer.write(alpha);
+}
+
+void CaptureRenderDevice::blendFunc(GLenum sfactor, GLenum dfactor) {
+    wrapped->blendFunc(sfactor, dfactor);
+    write(CommandStream::BLEND_FUNC);
+    writer.write(sfactor);
+    writer.write(dfactor);
+}
+
+void CaptureRenderDevice::blendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) {
+    wrapped->blendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+    write(CommandStream::BLEND_FUNC_SEPARATE);
+    writer.write(srcRGB);
+    writer.write(dstRGB);
+    writer.write(srcAlpha);
+    writer.write(dstAlpha);
+}
+
+void CaptureRenderDevice::depthFunc(GLenum func) {
+    wrapped->depthFunc(func);
+    write(CommandStream::DEPTH_FUNC);
+    writer.write(func);
+}
+
+void CaptureRenderDevice::depthRange(GLdouble nearVal, GLdouble farVal) {
+    wrapped->depthRange(nearVal, farVal);
+    write(CommandStream::DEPTH_RANGE);
+    writer.write(nearVal);
+    writer.write(farVal);
+}
+
+void CaptureRenderDevice::cullFace(GLenum mode) {
+    wrapped->cullFace(mode);
+    write(CommandStream::CULL_FACE);
+    writer.write(mode);
+}
+
+void CaptureRenderDevice::frontFace(GLenum mode) {
+    wrapped->frontFace(mode);
+    write(CommandStream::FRONT_FACE);
+    writer.write(mode);
+}
+
+void CaptureRenderDevice::polygonMode(GLenum face, GLenum mode) {
+    wrapped->polygonMode(face, mode);
+    write(CommandStream::POLYGON_MODE);
+    writer.write(face);
+    writer.write(mode);
+}
+
+void CaptureRenderDevice::pointSize(GLfloat size) {
+    wrapped->pointSize(size);
+    write(CommandStream::SET_POINT_SIZE);
+    writer.write(size);
+}
+
+void CaptureRenderDevice::lineWidth(GLfloat width) {
+    wrapped->lineWidth(width);
+    write(CommandStream::SET_LINE_WIDTH);
+    writer.write(width);
+}
+
+void CaptureRenderDevice::stencilMask(GLuint mask) {
+    wrapped->stencilMask(mask);
+    write(CommandStream::STENCIL_MASK);
+    writer.write(mask);
+}
+
+void CaptureRenderDevice::depthMask(GLboolean flag) {
+    wrapped->depthMask(flag);
+    write(CommandStream::DEPTH_MASK);
+    writer.write(flag);
+}
+
+void CaptureRenderDevice::colorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) {
+    wrapped->colorMask(red, green, blue, alpha);
+    write(CommandStream::COLOR_MASK);
+    writer.write(red);
+    writer.write(green);
+    writer.write(blue);
+    writer.write(alpha);
+}
+
+// Draws
+
+void CaptureRenderDevice::drawArrays(GLenum mode, GLint first, GLsizei count) {
+    wrapped->drawArrays(mode, first, count);
+    write(CommandStream::DRAW_ARRAYS);
+    writer.write(mode);
+    writer.write(first);
+    writer.write(count);
+}
+
+void CaptureRenderDevice::drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+    wrapped->drawElements(mode, count, type, indices);
+    write(CommandStream::DRAW_ELEMENTS);
+    writer.write(mode);
+    writer.write(count);
+    writer.write(type);
+    writer.write<uint64_t>((uintptr_t)indices); // Offset in the bound index buffer
+}
+
+void CaptureRenderDevice::multiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride) {
+    wrapped->multiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+    write(CommandStream::MULTI_DRAW_ELEMENTS_INDIRECT);
+    writer.write(mode);
+    writer.write(type);
+    writer.write<uint64_t>((uintptr_t)indirect); // Offset in the bound indirect buffer
+    writer.write(drawCount);
+    writer.write(stride);
+}
+
+void CaptureRenderDevice::multiDrawElementsIndirectCount(GLenum mode, GLenum type, const void* indirect, GLintptr drawCount, GLsizei maxDrawCount, GLsizei stride) {
+    wrapped->multiDrawElementsIndirectCount(mode, type, indirect, drawCount, maxDrawCount, stride);
+    write(CommandStream::MULTI_DRAW_ELEMENTS_INDIRECT_COUNT);
+    writer.write(mode);
+    writer.write(type);
+    writer.write<uint64_t>((uintptr_t)indirect); // Offset in the bound indirect buffer
+    writer.write<int64_t>(drawCount);            // Offset in the bound parameter buffer
+    writer.write(maxDrawCount);
+    writer.write(stride);
+}
+
+// Queries and sync objects
+
+void CaptureRenderDevice::genQueries(GLsizei n, GLuint* ids) {
+    wrapped->genQueries(n, ids);
+    writeNames(CommandStream::GEN_QUERIES, n, ids);
+}
+
+void CaptureRenderDevice::deleteQueries(GLsizei n, const GLuint* ids) {
+    wrapped->deleteQueries(n, ids);
+    writeNames(CommandStream::DELETE_QUERIES, n, ids);
+}
+
+void CaptureRenderDevice::queryCounter(GLuint id, GLenum target) {
+    wrapped->queryCounter(id, target);
+    write(CommandStream::QUERY_COUNTER);
+    writer.write(id);
+    writer.write(target);
+}
+
+void CaptureRenderDevice::beginQuery(GLenum target, GLuint id) {
+    wrapped->beginQuery(target, id);
+    write(CommandStream::BEGIN_QUERY);
+    writer.write(target);
+    writer.write(id);
+}
+
+void CaptureRenderDevice::endQuery(GLenum target) {
+    wrapped->endQuery(target);
+    write(CommandStream::END_QUERY);
+    writer.write(target);
+}
+
+void CaptureRenderDevice::beginConditionalRender(GLuint id, GLenum mode) {
+    wrapped->beginConditionalRender(id, mode);
+    write(CommandStream::BEGIN_CONDITIONAL_RENDER);
+    writer.write(id);
+    writer.write(mode);
+}
+
+void CaptureRenderDevice::endConditionalRender() {
+    wrapped->endConditionalRender();
+    write(CommandStream::END_CONDITIONAL_RENDER);
+}
+
+GLsync CaptureRenderDevice::fenceSync(GLenum condition, GLbitfield flags) {
+    GLsync sync = wrapped->fenceSync(condition, flags);
+    write(CommandStream::FENCE_SYNC);
+    writer.write(condition);
+    writer.write(flags);
+    writer.write<uint64_t>((uintptr_t)sync);
+    return sync;
+}
+
+void CaptureRenderDevice::deleteSync(GLsync sync) {
+    wrapped->deleteSync(sync);
+    write(CommandStream::DELETE_SYNC);
+    writer.write<uint64_t>((uintptr_t)sync);
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "RenderDevice.h"
+#include "CommandStream.h"
+
+/**
+ * @brief Executes the commands on another device and writes them into a command stream file.
+ *
+ * Every frame is flushed to the file at endFrame, the commands after the last frame are dropped
+ * so the destruction of the renderer isn't replayed at the end of every loop. Set it before
+ * creating the renderer and the scene: the capture starts with the creation of the resources,
+ * CommandReplayer can't replay a stream whose resources were made before. Program binaries
+ * aren't supported, so the stream always has the shader sources.
+ */
+class CaptureRenderDevice : public RenderDevice {
+    GENERATE_PTR(CaptureRenderDevice)
+private:
+    struct Mapping {
+        void* pointer;
+        GLintptr offset;
+        GLsizeiptr length;
+        GLbitfield access;
+    };
+private:
+    RenderDevice::Ptr wrapped;
+    std::ofstream file;
+    CommandStream::Writer writer;
+    std::unordered_map<GLenum, Mapping> mappings;
+    std::unordered_set<uint64_t> uniformLocations;
+    size_t frames;
+public:
+    CaptureRenderDevice(const RenderDevice::Ptr& renderDevice, const std::string& path);
+    ~CaptureRenderDevice() = default;
+private:
+    inline void write(CommandStream::Opcode opcode) { writer.write<uint8_t>(opcode); }
+    void writeNames(CommandStream::Opcode opcode, GLsizei n, const GLuint* names);
+    void flush();
+public:
+    bool init() override;
+    bool isSupported(Feature feature) override;
+    inline const char* getName() const override { return "Capture"; }
+    void endFrame() override;
+
+    // Buffers
+    void genBuffers(GLsizei n, GLuint* buffers) override;
+    void deleteBuffers(GLsizei n, const GLuint* buffers) override;
+    void bindBuffer(GLenum target, GLuint buffer) override;
+    void bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) override;
+    void bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) override;
+    void copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) override;
+    void* mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) override;
+    GLboolean unmapBuffer(GLenum target) override;
+    void bindBufferBase(GLenum target, GLuint index, GLuint buffer) override;
+
+    // Vertex arrays
+    void genVertexArrays(GLsizei n, GLuint* arrays) override;
+    void deleteVertexArrays(GLsizei n, const GLuint* arrays) override;
+    void bindVertexArray(GLuint array) override;
+    void enableVertexAttribArray(GLuint index) override;
+    void vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) override;
+    void vertexAttribDivisor(GLuint index, GLuint divisor) override;
+
+    // Textures
+    void genTextures(GLsizei n, GLuint* textures) override;
+    void deleteTextures(GLsizei n, const GLuint* textures) override;
+    void bindTexture(GLenum target, GLuint texture) override;
+    void activeTexture(GLenum texture) override;
+    void texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* data) override;
+    void texImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void* data) override;
+    void texImage2DMultisample(GLenum target, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height, GLboolean fixedSampleLocations) override;
+    void texParameteri(GLenum target, GLenum pname, GLint param) override;
+    void texParameterfv(GLenum target, GLenum pname, const GLfloat* params) override;
+    void generateMipmap(GLenum target) override;
+    void texBuffer(GLenum target, GLenum internalFormat, GLuint buffer) override;
+    inline void getTexImage(GLenum target, GLint level, GLenum format, GLenum type, void* pixels) override { wrapped->getTexImage(target, level, format, type, pixels); }
+    void genSamplers(GLsizei n, GLuint* samplers) override;
+    void deleteSamplers(GLsizei n, const GLuint* samplers) override;
+    void bindSampler(GLuint unit, GLuint sampler) override;
+    void samplerParameteri(GLuint sampler, GLenum pname, GLint param) override;
+    void samplerParameterfv(GLuint sampler, GLenum pname, const GLfloat* params) override;
+
+    // Frame buffers
+    void genFramebuffers(GLsizei n, GLuint* framebuffers) override;
+    void deleteFramebuffers(GLsizei n, const GLuint* framebuffers) override;
+    void bindFramebuffer(GLenum target, GLuint framebuffer) override;
+    void framebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level) override;
+    void framebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer) override;
+    void framebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level) override;
+    void framebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer) override;
+    inline GLenum checkFramebufferStatus(GLenum target) override { return wrapped->checkFramebufferStatus(target); }
+    void blitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) override;
+    void drawBuffer(GLenum buffer) override;
+    void drawBuffers(GLsizei n, const GLenum* buffers) override;
+    void readBuffer(GLenum buffer) override;
+    void genRenderbuffers(GLsizei n, GLuint* renderbuffers) override;
+    void deleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) override;
+    void bindRenderbuffer(GLenum target, GLuint renderbuffer) override;
+    void renderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height) override;
+    void renderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height) override;
+
+    // Shaders
+    GLuint createShader(GLenum type) override;
+    void deleteShader(GLuint shader) override;
+    void shaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length) override;
+    void compileShader(GLuint shader) override;
+    inline void getShaderiv(GLuint shader, GLenum pname, GLint* params) override { wrapped->getShaderiv(shader, pname, params); }
+    inline void getShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog) override { wrapped->getShaderInfoLog(shader, bufSize, length, infoLog); }
+    GLuint createProgram() override;
+    void deleteProgram(GLuint program) override;
+    void attachShader(GLuint program, GLuint shader) override;
+    void detachShader(GLuint program, GLuint shader) override;
+    void linkProgram(GLuint program) override;
+    inline void getProgramiv(GLuint program, GLenum pname, GLint* params) override { wrapped->getProgramiv(program, pname, params); }
+    inline void getProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog) override { wrapped->getProgramInfoLog(program, bufSize, length, infoLog); }
+    void useProgram(GLuint program) override;
+    void programParameteri(GLuint program, GLenum pname, GLint value) override;
+    void getProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary) override;
+    void programBinary(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length) override;
+    GLint getUniformLocation(GLuint program, const GLchar* name) override;
+    void uniform1i(GLint location, GLint v0) override;
+    void uniform1f(GLint location, GLfloat v0) override;
+    void uniform3fv(GLint location, GLsizei count, const GLfloat* value) override;
+    void uniform1iv(GLint location, GLsizei count, const GLint* value) override;
+    void uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) override;
+
+    // Compute
+    void dispatchCompute(GLuint numGroupsX, GLuint numGroupsY, GLuint numGroupsZ) override;
+    void memoryBarrier(GLbitfield barriers) override;
+
+    // State
+    void enable(GLenum cap) override;
+    void disable(GLenum cap) override;
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height) override;
+    void clear(GLbitfield mask) override;
+    void clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) override;
+    void blendFunc(GLenum sfactor, GLenum dfactor) override;
+    void blendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) override;
+    void depthFunc(GLenum func) override;
+    void depthRange(GLdouble nearVal, GLdouble farVal) override;
+    void cullFace(GLenum mode) override;
+    void frontFace(GLenum mode) override;
+    void polygonMode(GLenum face, GLenum mode) override;
+    void pointSize(GLfloat size) override;
+    void lineWidth(GLfloat width) override;
+    void stencilMask(GLuint mask) override;
+    void depthMask(GLboolean flag) override;
+    void colorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) override;
+    inline void getIntegerv(GLenum pname, GLint* data) override { wrapped->getIntegerv(pname, data); }
+    inline const GLubyte* getString(GLenum name) override { return wrapped->getString(name); }
+    inline void finish() override { wrapped->finish(); }
+
+    // Draws
+    void drawArrays(GLenum mode, GLint first, GLsizei count) override;
+    void drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) override;
+    void multiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride) override;
+    void multiDrawElementsIndirectCount(GLenum mode, GLenum type, const void* indirect, GLintptr drawCount, GLsizei maxDrawCount, GLsizei stride) override;
+
+    // Queries and sync objects
+    void genQueries(GLsizei n, GLuint* ids) override;
+    void deleteQueries(GLsizei n, const GLuint* ids) override;
+    void queryCounter(GLuint id, GLenum target) override;
+    void beginQuery(GLenum target, GLuint id) override;
+    void endQuery(GLenum target) override;
+    void beginConditionalRender(GLuint id, GLenum mode) override;
+    void endConditionalRender() override;
+    inline void getQueryObjectiv(GLuint id, GLenum pname, GLint* params) override { wrapped->getQueryObjectiv(id, pname, params); }
+    inline void getQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params) override { wrapped->getQueryObjectui64v(id, pname, params); }
+    GLsync fenceSync(GLenum condition, GLbitfield flags) override;
+    inline GLenum clientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) override { return wrapped->clientWaitSync(sync, flags, timeout); }
+    void deleteSync(GLsync sync) override;
+public:
+    inline bool isOpen() const { return file.is_open(); }
+    inline size_t getFrames() const { return frames; }
+};
\ No newline at end of file
@@ -0,0 +1,595 @@
+#include "CommandReplayer.h"
+
+#include <iostream>
+#include <fstream>
+
+CommandReplayer::CommandReplayer()
+    : frame(0), program(0), commands(0) {
+}
+
+bool CommandReplayer::load(const std::string& path) {
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if(!file.is_open()) {
+        std::cout << "Couldn't open the capture " << path << std::endl;
+        return false;
+    }
+
+    data.resize((size_t)file.tellg());
+    file.seekg(0);
+    file.read((char*)data.data(), data.size());
+    reader = CommandStream::Reader(data.data(), data.size());
+
+    uint32_t magic = reader.read<uint32_t>();
+    uint32_t version = reader.read<uint32_t>();
+    if(magic != COMMAND_STREAM_MAGIC || version != COMMAND_STREAM_VERSION) {
+        std::cout << path << " isn't a command stream of version " << COMMAND_STREAM_VERSION << std::endl;
+        return false;
+    }
+
+    frames = { reader.getPosition() };
+    frame = 0;
+    return true;
+}
+
+bool CommandReplayer::replayFrame() {
+
+    if(reader.isEnd() || reader.hasFailed()) return false;
+
+    while(!reader.isEnd()) {
+        CommandStream::Opcode opcode = static_cast<CommandStream::Opcode>(reader.read<uint8_t>());
+        if(opcode == CommandStream::END_FRAME) {
+            frame ++;
+            if(frame == frames.size()) frames.push_back(reader.getPosition());
+            return true;
+        }
+
+        if(!execute(opcode) || reader.hasFailed()) {
+            std::cout << "Corrupted command stream at byte " << reader.getPosition() << std::endl;
+            reader.setPosition(data.size());
+            return false;
+        }
+        commands ++;
+    }
+
+    // The capture was closed in the middle of a frame
+    return false;
+}
+
+void CommandReplayer::rewind(size_t frame) {
+    if(frame >= frames.size()) return;
+    reader.setPosition(frames[frame]);
+    this->frame = frame;
+}
+
+GLuint CommandReplayer::getName(CommandStream::Names type, GLuint name) {
+    if(name == 0) return 0;
+    auto it = names[type].find(name);
+    return it != names[type].end() ? it->second : 0;
+}
+
+GLint CommandReplayer::getUniformLocation(GLint location) {
+    if(location < 0) return location;
+    auto it = uniformLocations.find(((uint64_t)program << 32) | (uint32_t)location);
+    return it != uniformLocations.end() ? it->second : -1;
+}
+
+void CommandReplayer::generate(CommandStream::Names type, void (RenderDevice::*gen)(GLsizei, GLuint*)) {
+    size_t size;
+    const GLuint* captured = (const GLuint*)reader.readArray(size);
+    GLsizei n = (GLsizei)(size / sizeof(GLuint));
+
+    scratch.resize(n);
+    (RenderDevice::get()->*gen)(n, scratch.data());
+    for(GLsizei i = 0; i < n; i ++) names[type][captured[i]] = scratch[i];
+}
+
+void CommandReplayer::destroy(CommandStream::Names type, void (RenderDevice::*del)(GLsizei, const GLuint*)) {
+    size_t size;
+    const GLuint* captured = (const GLuint*)reader.readArray(size);
+    GLsizei n = (GLsizei)(size / sizeof(GLuint));
+
+    scratch.resize(n);
+    for(GLsizei i = 0; i < n; i ++) {
+        scratch[i] = getName(type, captured[i]);
+        names[type].erase(captured[i]);
+    }
+    (RenderDevice::get()->*del)(n, scratch.data());
+}
+
+bool CommandReplayer::execute(CommandStream::Opcode opcode) {
+
+    // Arguments are read into locals first, the evaluation order of function arguments isn't defined
+    RenderDevice* device = RenderDevice::get();
+    size_t size;
+
+    switch(opcode) {
+
+        // Buffers
+        case CommandStream::GEN_BUFFERS: generate(CommandStream::BUFFER, &RenderDevice::genBuffers); break;
+        case CommandStream::DELETE_BUFFERS: destroy(CommandStream::BUFFER, &RenderDevice::deleteBuffers); break;
+        case CommandStream::BIND_BUFFER: {
+            GLenum target = reader.read<GLenum>();
+            GLuint buffer = reader.read<GLuint>();
+            device->bindBuffer(target, getName(CommandStream::BUFFER, buffer));
+            break;
+        }
+        case CommandStream::BUFFER_DATA: {
+            GLenum target = reader.read<GLenum>();
+            GLsizeiptr bytes = (GLsizeiptr)reader.read<int64_t>();
+            const void* values = reader.readArray(size);
+            GLenum usage = reader.read<GLenum>();
+            device->bufferData(target, bytes, values, usage);
+            break;
+        }
+        case CommandStream::BUFFER_SUB_DATA:
+        case CommandStream::MAPPED_WRITE: {
+            GLenum target = reader.read<GLenum>();
+            GLintptr offset = (GLintptr)reader.read<int64_t>();
+            const void* values = reader.readArray(size);
+            if(size > 0) device->bufferSubData(target, offset, size, values);
+            break;
+        }
+        case CommandStream::COPY_BUFFER_SUB_DATA: {
+            GLenum readTarget = reader.read<GLenum>();
+            GLenum writeTarget = reader.read<GLenum>();
+            GLintptr readOffset = (GLintptr)reader.read<int64_t>();
+            GLintptr writeOffset = (GLintptr)reader.read<int64_t>();
+            GLsizeiptr bytes = (GLsizeiptr)reader.read<int64_t>();
+            device->copyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, bytes);
+            break;
+        }
+        case CommandStream::BIND_BUFFER_BASE: {
+            GLenum target = reader.read<GLenum>();
+            GLuint index = reader.read<GLuint>();
+            GLuint buffer = reader.read<GLuint>();
+            device->bindBufferBase(target, index, getName(CommandStream::BUFFER, buffer));
+            break;
+        }
+
+        // Vertex arrays
+        case CommandStream::GEN_VERTEX_ARRAYS: generate(CommandStream::VERTEX_ARRAY, &RenderDevice::genVertexArrays); break;
+        case CommandStream::DELETE_VERTEX_ARRAYS: destroy(CommandStream::VERTEX_ARRAY, &RenderDevice::deleteVertexArrays); break;
+        case CommandStream::BIND_VERTEX_ARRAY: device->bindVertexArray(getName(CommandStream::VERTEX_ARRAY, reader.read<GLuint>())); break;
+        case CommandStream::ENABLE_VERTEX_ATTRIB_ARRAY: device->enableVertexAttribArray(reader.read<GLuint>()); break;
+        case CommandStream::VERTEX_ATTRIB_POINTER: {
+            GLuint index = reader.read<GLuint>();
+            GLint components = reader.read<GLint>();
+            GLenum type = reader.read<GLenum>();
+            GLboolean normalized = reader.read<GLboolean>();
+            GLsizei stride = reader.read<GLsizei>();
+            uintptr_t offset = (uintptr_t)reader.read<uint64_t>();
+            device->vertexAttribPointer(index, components, type, normalized, stride, (const void*)offset);
+            break;
+        }
+        case CommandStream::VERTEX_ATTRIB_DIVISOR: {
+            GLuint index = reader.read<GLuint>();
+            GLuint divisor = reader.read<GLuint>();
+            device->vertexAttribDivisor(index, divisor);
+            break;
+        }
+
+        // Textures
+        case CommandStream::GEN_TEXTURES: generate(CommandStream::TEXTURE, &RenderDevice::genTextures); break;
+        case CommandStream::DELETE_TEXTURES: destroy(CommandStream::TEXTURE, &RenderDevice::deleteTextures); break;
+        case CommandStream::BIND_TEXTURE: {
+            GLenum target = reader.read<GLenum>();
+            GLuint texture = reader.read<GLuint>();
+            device->bindTexture(target, getName(CommandStream::TEXTURE, texture));
+            break;
+        }
+        case CommandStream::ACTIVE_TEXTURE: device->activeTexture(reader.read<GLenum>()); break;
+        case CommandStream::TEX_IMAGE_2D: {
+            GLenum target = reader.read<GLenum>();
+            GLint level = reader.read<GLint>();
+            GLint internalFormat = reader.read<GLint>();
+            GLsizei width = reader.read<GLsizei>();
+            GLsizei height = reader.read<GLsizei>();
+            GLint border = reader.read<GLint>();
+            GLenum format = reader.read<GLenum>();
+            GLenum type = reader.read<GLenum>();
+            const void* pixels = reader.readArray(size);
+            device->texImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+            break;
+        }
+        case CommandStream::TEX_IMAGE_3D: {
+            GLenum target = reader.read<GLenum>();
+            GLint level = reader.read<GLint>();
+            GLint internalFormat = reader.read<GLint>();
+            GLsizei width = reader.read<GLsizei>();
+            GLsizei height = reader.read<GLsizei>();
+            GLsizei depth = reader.read<GLsizei>();
+            GLint border = reader.read<GLint>();
+            GLenum format = reader.read<GLenum>();
+            GLenum type = reader.read<GLenum>();
+            const void* pixels = reader.readArray(size);
+            device->texImage3D(target, level, internalFormat, width, height, depth, border, format, type, pixels);
+            break;
+        }
+        case CommandStream::TEX_IMAGE_2D_MULTISAMPLE: {
+            GLenum target = reader.read<GLenum>();
+            GLsizei samples = reader.read<GLsizei>();
+            GLenum internalFormat = reader.read<GLenum>();
+            GLsizei width = reader.read<GLsizei>();
+            GLsizei height = reader.read<GLsizei>();
+            GLboolean fixedSampleLocations = reader.read<GLboolean>();
+            device->texImage2DMultisample(target, samples, internalFormat, width, height, fixedSampleLocations);
+            break;
+        }
+        case CommandStream::TEX_PARAMETER_I: {
+            GLenum target = reader.read<GLenum>();
+            GLenum pname = reader.read<GLenum>();
+            GLint param = reader.read<GLint>();
+            device->texParameteri(target, pname, param);
+            break;
+        }
+        case CommandStream::TEX_PARAMETER_FV: {
+            GLenum target = reader.read<GLenum>();
+            GLenum pname = reader.read<GLenum>();
+            const GLfloat* params = (const GLfloat*)reader.readArray(size);
+            if(params != nullptr) device->texParameterfv(target, pname, params);
+            break;
+        }
+        case CommandStream::GENERATE_MIPMAP: device->generateMipmap(reader.read<GLenum>()); break;
+        case CommandStream::TEX_BUFFER: {
+            GLenum target = reader.read<GLenum>();
+            GLenum internalFormat = reader.read<GLenum>();
+            GLuint buffer = reader.read<GLuint>();
+            device->texBuffer(target, internalFormat, getName(CommandStream::BUFFER, buffer));
+            break;
+        }
+        case CommandStream::GEN_SAMPLERS: generate(CommandStream::SAMPLER, &RenderDevice::genSamplers); break;
+        case CommandStream::DELETE_SAMPLERS: destroy(CommandStream::SAMPLER, &RenderDevice::deleteSamplers); break;
+        case CommandStream::BIND_SAMPLER: {
+            GLuint unit = reader.read<GLuint>();
+            GLuint sampler = reader.read<GLuint>();
+            device->bindSampler(unit, getName(CommandStream::SAMPLER, sampler));
+            break;
+        }
+        case CommandStream::SAMPLER_PARAMETER_I: {
+            GLuint sampler = reader.read<GLuint>();
+            GLenum pname = reader.read<GLenum>();
+            GLint param = reader.read<GLint>();
+            device->samplerParameteri(getName(CommandStream::SAMPLER, sampler), pname, param);
+            break;
+        }
+        case CommandStream::SAMPLER_PARAMETER_FV: {
+            GLuint sampler = reader.read<GLuint>();
+            GLenum pname = reader.read<GLenum>();
+            const GLfloat* params = (const GLfloat*)reader.readArray(size);
+            if(params != nullptr) device->samplerParameterfv(getName(CommandStream::SAMPLER, sampler), pname, params);
+            break;
+        }
+
+        // Frame buffers
+        case CommandStream::GEN_FRAMEBUFFERS: generate(CommandStream::FRAMEBUFFER, &RenderDevice::genFramebuffers); break;
+        case CommandStream::DELETE_FRAMEBUFFERS: destroy(CommandStream::FRAMEBUFFER, &RenderDevice::deleteFramebuffers); break;
+        case CommandStream::BIND_FRAMEBUFFER: {
+            GLenum target = reader.read<GLenum>();
+            GLuint framebuffer = reader.read<GLuint>();
+            device->bindFramebuffer(target, getName(CommandStream::FRAMEBUFFER, framebuffer));
+            break;
+        }
+        case CommandStream::FRAMEBUFFER_TEXTURE_2D: {
+            GLenum target = reader.read<GLenum>();
+            GLenum attachment = reader.read<GLenum>();
+            GLenum textureTarget = reader.read<GLenum>();
+            GLuint texture = reader.read<GLuint>();
+            GLint level = reader.read<GLint>();
+            device->framebufferTexture2D(target, attachment, textureTarget, getName(CommandStream::TEXTURE, texture), level);
+            break;
+        }
+        case CommandStream::FRAMEBUFFER_TEXTURE_LAYER: {
+            GLenum target = reader.read<GLenum>();
+            GLenum attachment = reader.read<GLenum>();
+            GLuint texture = reader.read<GLuint>();
+            GLint level = reader.read<GLint>();
+            GLint layer = reader.read<GLint>();
+            device->framebufferTextureLayer(target, attachment, getName(CommandStream::TEXTURE, texture), level, layer);
+            break;
+        }
+        case CommandStream::FRAMEBUFFER_TEXTURE: {
+            GLenum target = reader.read<GLenum>();
+            GLenum attachment = reader.read<GLenum>();
+            GLuint texture = reader.read<GLuint>();
+            GLint level = reader.read<GLint>();
+            device->framebufferTexture(target, attachment, getName(CommandStream::TEXTURE, texture), level);
+            break;
+        }
+        case CommandStream::FRAMEBUFFER_RENDERBUFFER: {
+            GLenum target = reader.read<GLenum>();
+            GLenum attachment = reader.read<GLenum>();
+            GLenum renderbufferTarget = reader.read<GLenum>();
+            GLuint renderbuffer = reader.read<GLuint>();
+            device->framebufferRenderbuffer(target, attachment, renderbufferTarget, getName(CommandStream::RENDERBUFFER, renderbuffer));
+            break;
+        }
+        case CommandStream::BLIT_FRAMEBUFFER: {
+            GLint rect[8];
+            for(GLint& value : rect) value = reader.read<GLint>();
+            GLbitfield mask = reader.read<GLbitfield>();
+            GLenum filter = reader.read<GLenum>();
+            device->blitFramebuffer(rect[0], rect[1], rect[2], rect[3], rect[4], rect[5], rect[6], rect[7], mask, filter);
+            break;
+        }
+        case CommandStream::DRAW_BUFFER: device->drawBuffer(reader.read<GLenum>()); break;
+        case CommandStream::DRAW_BUFFERS: {
+            const GLenum* buffers = (const GLenum*)reader.readArray(size);
+            if(buffers != nullptr) device->drawBuffers(size / sizeof(GLenum), buffers);
+            break;
+        }
+        case CommandStream::READ_BUFFER: device->readBuffer(reader.read<GLenum>()); break;
+        case CommandStream::GEN_RENDERBUFFERS: generate(CommandStream::RENDERBUFFER, &RenderDevice::genRenderbuffers); break;
+        case CommandStream::DELETE_RENDERBUFFERS: destroy(CommandStream::RENDERBUFFER, &RenderDevice::deleteRenderbuffers); break;
+        case CommandStream::BIND_RENDERBUFFER: {
+            GLenum target = reader.read<GLenum>();
+            GLuint renderbuffer = reader.read<GLuint>();
+            device->bindRenderbuffer(target, getName(CommandStream::RENDERBUFFER, renderbuffer));
+            break;
+        }
+        case CommandStream::RENDERBUFFER_STORAGE: {
+            GLenum target = reader.read<GLenum>();
+            GLenum internalFormat = reader.read<GLenum>();
+            GLsizei width = reader.read<GLsizei>();
+            GLsizei height = reader.read<GLsizei>();
+            device->renderbufferStorage(target, internalFormat, width, height);
+            break;
+        }
+        case CommandStream::RENDERBUFFER_STORAGE_MULTISAMPLE: {
+            GLenum target = reader.read<GLenum>();
+            GLsizei samples = reader.read<GLsizei>();
+            GLenum internalFormat = reader.read<GLenum>();
+            GLsizei width = reader.read<GLsizei>();
+            GLsizei height = reader.read<GLsizei>();
+            device->renderbufferStorageMultisample(target, samples, internalFormat, width, height);
+            break;
+        }
+
+        // Shaders, they share the names with the programs
+        case CommandStream::CREATE_SHADER: {
+            GLenum type = reader.read<GLenum>();
+            GLuint shader = reader.read<GLuint>();
+            names[CommandStream::PROGRAM][shader] = device->createShader(type);
+            break;
+        }
+        case CommandStream::DELETE_SHADER: {
+            GLuint shader = reader.read<GLuint>();
+            device->deleteShader(getName(CommandStream::PROGRAM, shader));
+            names[CommandStream::PROGRAM].erase(shader);
+            break;
+        }
+        case CommandStream::SHADER_SOURCE: {
+            GLuint shader = reader.read<GLuint>();
+            GLsizei count = reader.read<GLsizei>();
+            std::vector<const GLchar*> strings(count);
+            std::vector<GLint> lengths(count);
+            for(GLsizei i = 0; i < count; i ++) {
+                strings[i] = (const GLchar*)reader.readArray(size);
+                lengths[i] = (GLint)size;
+            }
+            device->shaderSource(getName(CommandStream::PROGRAM, shader), count, strings.data(), lengths.data());
+            break;
+        }
+        case CommandStream::COMPILE_SHADER: device->compileShader(getName(CommandStream::PROGRAM, reader.read<GLuint>())); break;
+        case CommandStream::CREATE_PROGRAM: {
+            GLuint captured = reader.read<GLuint>();
+            names[CommandStream::PROGRAM][captured] = device->createProgram();
+            break;
+        }
+        case CommandStream::DELETE_PROGRAM: {
+            GLuint captured = reader.read<GLuint>();
+            device->deleteProgram(getName(CommandStream::PROGRAM, captured));
+            names[CommandStream::PROGRAM].erase(captured);
+            for(auto it = uniformLocations.begin(); it != uniformLocations.end();) {
+                if((GLuint)(it->first >> 32) == captured) it = uniformLocations.erase(it);
+                else it ++;
+            }
+            break;
+        }
+        case CommandStream::ATTACH_SHADER:
+        case CommandStream::DETACH_SHADER: {
+            GLuint captured = reader.read<GLuint>();
+            GLuint shader = reader.read<GLuint>();
+            if(opcode == CommandStream::ATTACH_SHADER) device->attachShader(getName(CommandStream::PROGRAM, captured), getName(CommandStream::PROGRAM, shader));
+            else device->detachShader(getName(CommandStream::PROGRAM, captured), getName(CommandStream::PROGRAM, shader));
+            break;
+        }
+        case CommandStream::LINK_PROGRAM: device->linkProgram(getName(CommandStream::PROGRAM, reader.read<GLuint>())); break;
+        case CommandStream::USE_PROGRAM: {
+            program = reader.read<GLuint>();
+            device->useProgram(getName(CommandStream::PROGRAM, program));
+            break;
+        }
+        case CommandStream::PROGRAM_PARAMETER_I: {
+            GLuint captured = reader.read<GLuint>();
+            GLenum pname = reader.read<GLenum>();
+            GLint value = reader.read<GLint>();
+            device->programParameteri(getName(CommandStream::PROGRAM, captured), pname, value);
+            break;
+        }
+        case CommandStream::GET_UNIFORM_LOCATION: {
+            GLuint captured = reader.read<GLuint>();
+            std::string name = reader.readString();
+            GLint location = reader.read<GLint>();
+            uint64_t key = ((uint64_t)captured << 32) | (uint32_t)location;
+            uniformLocations[key] = device->getUniformLocation(getName(CommandStream::PROGRAM, captured), name.c_str());
+            break;
+        }
+        case CommandStream::UNIFORM_1I: {
+            GLint location = reader.read<GLint>();
+            GLint v0 = reader.read<GLint>();
+            device->uniform1i(getUniformLocation(location), v0);
+            break;
+        }
+        case CommandStream::UNIFORM_1F: {
+            GLint location = reader.read<GLint>();
+            GLfloat v0 = reader.read<GLfloat>();
+            device->uniform1f(getUniformLocation(location), v0);
+            break;
+        }
+        case CommandStream::UNIFORM_3FV: {
+            GLint location = reader.read<GLint>();
+            const GLfloat* values = (const GLfloat*)reader.readArray(size);
+            if(values != nullptr) device->uniform3fv(getUniformLocation(location), size / (3 * sizeof(GLfloat)), values);
+            break;
+        }
+        case CommandStream::UNIFORM_1IV: {
+            GLint location = reader.read<GLint>();
+            const GLint* values = (const GLint*)reader.readArray(size);
+            if(values != nullptr) device->uniform1iv(getUniformLocation(location), size / sizeof(GLint), values);
+            break;
+        }
+        case CommandStream::UNIFORM_MATRIX_4FV: {
+            GLint location = reader.read<GLint>();
+            GLboolean transpose = reader.read<GLboolean>();
+            const GLfloat* values = (const GLfloat*)reader.readArray(size);
+            if(values != nullptr) device->uniformMatrix4fv(getUniformLocation(location), size / (16 * sizeof(GLfloat)), transpose, values);
+            break;
+        }
+
+        // Compute
+        case CommandStream::DISPATCH_COMPUTE: {
+            GLuint numGroupsX = reader.read<GLuint>();
+            GLuint numGroupsY = reader.read<GLuint>();
+            GLuint numGroupsZ = reader.read<GLuint>();
+            device->dispatchCompute(numGroupsX, numGroupsY, numGroupsZ);
+            break;
+        }
+        case CommandStream::MEMORY_BARRIER: device->memoryBarrier(reader.read<GLbitfield>()); break;
+
+        // State
+        case CommandStream::ENABLE: device->enable(reader.read<GLenum>()); break;
+        case CommandStream::DISABLE: device->disable(reader.read<GLenum>()); break;
+        case CommandStream::VIEWPORT: {
+            GLint x = reader.read<GLint>();
+            GLint y = reader.read<GLint>();
+            GLsizei width = reader.read<GLsizei>();
+            GLsizei height = reader.read<GLsizei>();
+            device->viewport(x, y, width, height);
+            break;
+        }
+        case CommandStream::CLEAR: device->clear(reader.read<GLbitfield>()); break;
+        case CommandStream::CLEAR_COLOR: {
+            GLfloat color[4];
+            for(GLfloat& value : color) value = reader.read<GLfloat>();
+            device->clearColor(color[0], color[1], color[2], color[3]);
+            break;
+        }
+        case CommandStream::BLEND_FUNC: {
+            GLenum sfactor = reader.read<GLenum>();
+            GLenum dfactor = reader.read<GLenum>();
+            device->blendFunc(sfactor, dfactor);
+            break;
+        }
+        case CommandStream::BLEND_FUNC_SEPARATE: {
+            GLenum factors[4];
+            for(GLenum& value : factors) value = reader.read<GLenum>();
+            device->blendFuncSeparate(factors[0], factors[1], factors[2], factors[3]);
+            break;
+        }
+        case CommandStream::DEPTH_FUNC: device->depthFunc(reader.read<GLenum>()); break;
+        case CommandStream::DEPTH_RANGE: {
+            GLdouble nearVal = reader.read<GLdouble>();
+            GLdouble farVal = reader.read<GLdouble>();
+            device->depthRange(nearVal, farVal);
+            break;
+        }
+        case CommandStream::CULL_FACE: device->cullFace(reader.read<GLenum>()); break;
+        case CommandStream::FRONT_FACE: device->frontFace(reader.read<GLenum>()); break;
+        case CommandStream::POLYGON_MODE: {
+            GLenum face = reader.read<GLenum>();
+            GLenum mode = reader.read<GLenum>();
+            device->polygonMode(face, mode);
+            break;
+        }
+        case CommandStream::SET_POINT_SIZE: device->pointSize(reader.read<GLfloat>()); break;
+        case CommandStream::SET_LINE_WIDTH: device->lineWidth(reader.read<GLfloat>()); break;
+        case CommandStream::STENCIL_MASK: device->stencilMask(reader.read<GLuint>()); break;
+        case CommandStream::DEPTH_MASK: device->depthMask(reader.read<GLboolean>()); break;
+        case CommandStream::COLOR_MASK: {
+            GLboolean mask[4];
+            for(GLboolean& value : mask) value = reader.read<GLboolean>();
+            device->colorMask(mask[0], mask[1], mask[2], mask[3]);
+            break;
+        }
+
+        // Draws
+        case CommandStream::DRAW_ARRAYS: {
+            GLenum mode = reader.read<GLenum>();
+            GLint first = reader.read<GLint>();
+            GLsizei count = reader.read<GLsizei>();
+            device->drawArrays(mode, first, count);
+            break;
+        }
+        case CommandStream::DRAW_ELEMENTS: {
+            GLenum mode = reader.read<GLenum>();
+            GLsizei count = reader.read<GLsizei>();
+            GLenum type = reader.read<GLenum>();
+            uintptr_t offset = (uintptr_t)reader.read<uint64_t>();
+            device->drawElements(mode, count, type, (const void*)offset);
+            break;
+        }
+        case CommandStream::MULTI_DRAW_ELEMENTS_INDIRECT: {
+            GLenum mode = reader.read<GLenum>();
+            GLenum type = reader.read<GLenum>();
+            uintptr_t offset = (uintptr_t)reader.read<uint64_t>();
+            GLsizei drawCount = reader.read<GLsizei>();
+            GLsizei stride = reader.read<GLsizei>();
+            device->multiDrawElementsIndirect(mode, type, (const void*)offset, drawCount, stride);
+            break;
+        }
+        case CommandStream::MULTI_DRAW_ELEMENTS_INDIRECT_COUNT: {
+            GLenum mode = reader.read<GLenum>();
+            GLenum type = reader.read<GLenum>();
+            uintptr_t offset = (uintptr_t)reader.read<uint64_t>();
+            GLintptr drawCount = (GLintptr)reader.read<int64_t>();
+            GLsizei maxDrawCount = reader.read<GLsizei>();
+            GLsizei stride = reader.read<GLsizei>();
+            device->multiDrawElementsIndirectCount(mode, type, (const void*)offset, drawCount, maxDrawCount, stride);
+            break;
+        }
+
+        // Queries and sync objects
+        case CommandStream::GEN_QUERIES: generate(CommandStream::QUERY, &RenderDevice::genQueries); break;
+        case CommandStream::DELETE_QUERIES: destroy(CommandStream::QUERY, &RenderDevice::deleteQueries); break;
+        case CommandStream::QUERY_COUNTER: {
+            GLuint id = reader.read<GLuint>();
+            GLenum target = reader.read<GLenum>();
+            device->queryCounter(getName(CommandStream::QUERY, id), target);
+            break;
+        }
+        case CommandStream::BEGIN_QUERY: {
+            GLenum target = reader.read<GLenum>();
+            GLuint id = reader.read<GLuint>();
+            device->beginQuery(target, getName(CommandStream::QUERY, id));
+            break;
+        }
+        case CommandStream::END_QUERY: device->endQuery(reader.read<GLenum>()); break;
+        case CommandStream::BEGIN_CONDITIONAL_RENDER: {
+            GLuint id = reader.read<GLuint>();
+            GLenum mode = reader.read<GLenum>();
+            device->beginConditionalRender(getName(CommandStream::QUERY, id), mode);
+            break;
+        }
+        case CommandStream::END_CONDITIONAL_RENDER: device->endConditionalRender(); break;
+        case CommandStream::FENCE_SYNC: {
+            GLenum condition = reader.read<GLenum>();
+            GLbitfield flags = reader.read<GLbitfield>();
+            uint64_t captured = reader.read<uint64_t>();
+            syncs[captured] = device->fenceSync(condition, flags);
+            break;
+        }
+        case CommandStream::DELETE_SYNC: {
+            auto sync = syncs.find(reader.read<uint64_t>());
+            if(sync != syncs.end()) {
+                device->deleteSync(sync->second);
+                syncs.erase(sync);
+            }
+            break;
+        }
+
+        default: return false;
+    }
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "RenderDevice.h"
+#include "CommandStream.h"
+
+/**
+ * @brief Executes a command stream written by CaptureRenderDevice on the current render device.
+ *
+ * The names of the capture are mapped to the ones made while replaying, and uniform locations
+ * to the ones of the replayed programs. The first frame creates the resources, the next ones can
+ * be replayed again and again with rewind.
+ */
+class CommandReplayer {
+    GENERATE_PTR(CommandReplayer)
+private:
+    std::vector<unsigned char> data;
+    CommandStream::Reader reader;
+    std::vector<size_t> frames;
+    size_t frame;
+
+    std::unordered_map<GLuint, GLuint> names[CommandStream::NAMES_COUNT];
+    std::unordered_map<uint64_t, GLsync> syncs;
+    std::unordered_map<uint64_t, GLint> uniformLocations;
+    GLuint program;
+
+    std::vector<GLuint> scratch;
+    size_t commands;
+public:
+    CommandReplayer();
+    ~CommandReplayer() = default;
+private:
+    GLuint getName(CommandStream::Names type, GLuint name);
+    GLint getUniformLocation(GLint location);
+    void generate(CommandStream::Names type, void (RenderDevice::*gen)(GLsizei, GLuint*));
+    void destroy(CommandStream::Names type, void (RenderDevice::*del)(GLsizei, const GLuint*));
+    bool execute(CommandStream::Opcode opcode);
+public:
+    /**
+     * @brief Reads the whole file, false if it isn't a command stream
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Executes the commands until the end of the frame, false at the end of the stream
+     */
+    bool replayFrame();
+
+    /**
+     * @brief Goes back to the beginning of a frame which has already been replayed
+     */
+    void rewind(size_t frame);
+public:
+    inline bool hasFailed() const { return reader.hasFailed(); }
+    inline bool isEnd() const { return reader.isEnd(); }
+    inline size_t getFrame() const { return frame; }
+    inline size_t getCommands() const { return commands; }
+    inline size_t getSize() const { return data.size(); }
+};
\ No newline at end of file
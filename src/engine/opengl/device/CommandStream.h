@@ -0,0 +1,140 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <string.h>
+
+#define COMMAND_STREAM_MAGIC 0x43474C52 // "RLGC"
+#define COMMAND_STREAM_VERSION 9
+
+/**
+ * @brief Binary format of captured GL commands.
+ *
+ * A header (magic and version) and then the commands: an opcode and its arguments in the order
+ * of the GL function. Names are the ones of the capture, arrays are written with their size in
+ * bytes before. Queries which only read back (getIntegerv, getProgramiv...) aren't written.
+ */
+class CommandStream {
+public:
+
+    enum Opcode : uint8_t {
+        // Buffers
+        GEN_BUFFERS, DELETE_BUFFERS, BIND_BUFFER, BUFFER_DATA, BUFFER_SUB_DATA, COPY_BUFFER_SUB_DATA,
+        MAPPED_WRITE, BIND_BUFFER_BASE,
+
+        // Vertex arrays
+        GEN_VERTEX_ARRAYS, DELETE_VERTEX_ARRAYS, BIND_VERTEX_ARRAY, ENABLE_VERTEX_ATTRIB_ARRAY,
+        VERTEX_ATTRIB_POINTER, VERTEX_ATTRIB_DIVISOR,
+
+        // Textures
+        GEN_TEXTURES, DELETE_TEXTURES, BIND_TEXTURE, ACTIVE_TEXTURE, TEX_IMAGE_2D, TEX_IMAGE_3D, TEX_IMAGE_2D_MULTISAMPLE,
+        TEX_PARAMETER_I, TEX_PARAMETER_FV, GENERATE_MIPMAP, TEX_BUFFER, GEN_SAMPLERS, DELETE_SAMPLERS, BIND_SAMPLER,
+        SAMPLER_PARAMETER_I, SAMPLER_PARAMETER_FV,
+
+        // Frame buffers
+        GEN_FRAMEBUFFERS, DELETE_FRAMEBUFFERS, BIND_FRAMEBUFFER, FRAMEBUFFER_TEXTURE_2D, FRAMEBUFFER_TEXTURE_LAYER, FRAMEBUFFER_TEXTURE, FRAMEBUFFER_RENDERBUFFER,
+        BLIT_FRAMEBUFFER, DRAW_BUFFER, DRAW_BUFFERS, READ_BUFFER, GEN_RENDERBUFFERS, DELETE_RENDERBUFFERS, BIND_RENDERBUFFER,
+        RENDERBUFFER_STORAGE, RENDERBUFFER_STORAGE_MULTISAMPLE,
+
+        // Shaders
+        CREATE_SHADER, DELETE_SHADER, SHADER_SOURCE, COMPILE_SHADER, CREATE_PROGRAM, DELETE_PROGRAM,
+        ATTACH_SHADER, DETACH_SHADER, LINK_PROGRAM, USE_PROGRAM, PROGRAM_PARAMETER_I, GET_UNIFORM_LOCATION,
+        UNIFORM_1I, UNIFORM_1F, UNIFORM_3FV, UNIFORM_1IV, UNIFORM_MATRIX_4FV,
+
+        // Compute
+        DISPATCH_COMPUTE, MEMORY_BARRIER,
+
+        // State
+        ENABLE, DISABLE, VIEWPORT, CLEAR, CLEAR_COLOR, BLEND_FUNC, BLEND_FUNC_SEPARATE, DEPTH_FUNC,
+        DEPTH_RANGE, CULL_FACE, FRONT_FACE, POLYGON_MODE, SET_POINT_SIZE, SET_LINE_WIDTH, STENCIL_MASK,
+        DEPTH_MASK, COLOR_MASK,
+
+        // Draws
+        DRAW_ARRAYS, DRAW_ELEMENTS, MULTI_DRAW_ELEMENTS_INDIRECT, MULTI_DRAW_ELEMENTS_INDIRECT_COUNT,
+
+        // Queries and sync objects
+        GEN_QUERIES, DELETE_QUERIES, QUERY_COUNTER, BEGIN_QUERY, END_QUERY, BEGIN_CONDITIONAL_RENDER,
+        END_CONDITIONAL_RENDER, FENCE_SYNC, DELETE_SYNC,
+
+        END_FRAME, OPCODE_COUNT
+    };
+
+    // GL objects with their own names
+    enum Names {
+        BUFFER, VERTEX_ARRAY, TEXTURE, SAMPLER, FRAMEBUFFER, RENDERBUFFER, PROGRAM, QUERY, SYNC, NAMES_COUNT
+    };
+
+    class Writer {
+    private:
+        std::vector<unsigned char> data;
+    public:
+        template<typename T>
+        inline void write(const T& value) {
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+            data.insert(data.end(), bytes, bytes + sizeof(T));
+        }
+
+        inline void write(const void* bytes, size_t size) {
+            write<uint64_t>(size);
+            if(size > 0) data.insert(data.end(), (const unsigned char*)bytes, (const unsigned char*)bytes + size);
+        }
+
+        inline void writeString(const char* string, size_t length) { write(string, length); }
+        inline void writeString(const char* string) { write(string, strlen(string)); }
+
+        inline void clear() { data.clear(); }
+        inline const std::vector<unsigned char>& getData() const { return data; }
+    };
+
+    class Reader {
+    private:
+        const unsigned char* data;
+        size_t size, position;
+        bool failed;
+    public:
+        Reader(const unsigned char* _data, size_t _size)
+            : data(_data), size(_size), position(0), failed(false) {
+        }
+        Reader() : Reader(nullptr, 0) {}
+
+        template<typename T>
+        inline T read() {
+            T value {};
+            if(position + sizeof(T) > size) {
+                failed = true;
+                position = size;
+                return value;
+            }
+            memcpy(&value, data + position, sizeof(T));
+            position += sizeof(T);
+            return value;
+        }
+
+        /**
+         * @brief Pointer to the array in the stream, nullptr when it's empty
+         */
+        inline const void* readArray(size_t& length) {
+            length = (size_t)read<uint64_t>();
+            if(position + length > size) {
+                failed = true;
+                position = size;
+                length = 0;
+            }
+            const void* array = length > 0 ? data + position : nullptr;
+            position += length;
+            return array;
+        }
+
+        inline std::string readString() {
+            size_t length;
+            const char* string = (const char*)readArray(length);
+            return string != nullptr ? std::string(string, length) : std::string();
+        }
+
+        inline bool isEnd() const { return position >= size; }
+        inline bool hasFailed() const { return failed; }
+        inline size_t getPosition() const { return position; }
+        inline void setPosition(size_t position) { this->position = position; }
+    };
+};
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include "GLRenderDevice.h"
+
+#include <iostream>
+
+bool GLRenderDevice::init() {
+    GLenum error = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // GLX GLEW with an EGL context: the GL functions are loaded, only the GLX ones aren't
+    if(error == GLEW_ERROR_NO_GLX_DISPLAY) error = GLEW_OK;
+#endif
+    if (error != GLEW_OK) {
+        std::cout << "Couldn't initialize GLEW" << std::endl;
+        return false;
+    }
+
+    // Let the driver compile shaders in its own threads
+    if(GLEW_KHR_parallel_shader_compile) glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    else if(GLEW_ARB_parallel_shader_compile) glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+
+    return true;
+}
+
+bool GLRenderDevice::isSupported(Feature feature) {
+    switch(feature) {
+        case MULTI_DRAW_INDIRECT: return GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance);
+        case TIMER_QUERY: return GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+        case PROGRAM_BINARY: return GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary;
+        case COMPUTE_SHADER: return GLEW_VERSION_4_3 || (GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object);
+        case INDIRECT_COUNT: return GLEW_VERSION_4_6 || GLEW_ARB_indirect_parameters;
+    }
+    return false;
+}
+
+void GLRenderDevice::multiDrawElementsIndirectCount(GLenum mode, GLenum type, const void* indirect, GLintptr drawCount, GLsizei maxDrawCount, GLsizei stride) {
+    // Core since GL 4.6, ARB_indirect_parameters before
+    if(GLEW_VERSION_4_6) glMultiDrawElementsIndirectCount(mode, type, indirect, drawCount, maxDrawCount, stride);
+    else glMultiDrawElementsIndirectCountARB(mode, type, indirect, drawCount, maxDrawCount, stride);
+}
\ No newline at end of file
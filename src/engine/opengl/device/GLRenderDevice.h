@@ -0,0 +1,145 @@
+#pragma once
+
+#include "RenderDevice.h"
+
+/**
+ * @brief OpenGL through GLEW, it needs a current context
+ */
+class GLRenderDevice : public RenderDevice {
+    GENERATE_PTR(GLRenderDevice)
+public:
+    GLRenderDevice() = default;
+    ~GLRenderDevice() = default;
+public:
+    bool init() override;
+    bool isSupported(Feature feature) override;
+    inline const char* getName() const override { return "OpenGL"; }
+
+    // Buffers
+    inline void genBuffers(GLsizei n, GLuint* buffers) override { glGenBuffers(n, buffers); }
+    inline void deleteBuffers(GLsizei n, const GLuint* buffers) override { glDeleteBuffers(n, buffers); }
+    inline void bindBuffer(GLenum target, GLuint buffer) override { glBindBuffer(target, buffer); }
+    inline void bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) override { glBufferData(target, size, data, usage); }
+    inline void bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) override { glBufferSubData(target, offset, size, data); }
+    inline void copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) override { glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size); }
+    inline void* mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) override { return glMapBufferRange(target, offset, length, access); }
+    inline GLboolean unmapBuffer(GLenum target) override { return glUnmapBuffer(target); }
+    inline void bindBufferBase(GLenum target, GLuint index, GLuint buffer) override { glBindBufferBase(target, index, buffer); }
+
+    // Vertex arrays
+    inline void genVertexArrays(GLsizei n, GLuint* arrays) override { glGenVertexArrays(n, arrays); }
+    inline void deleteVertexArrays(GLsizei n, const GLuint* arrays) override { glDeleteVertexArrays(n, arrays); }
+    inline void bindVertexArray(GLuint array) override { glBindVertexArray(array); }
+    inline void enableVertexAttribArray(GLuint index) override { glEnableVertexAttribArray(index); }
+    inline void vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) override { glVertexAttribPointer(index, size, type, normalized, stride, pointer); }
+    inline void vertexAttribDivisor(GLuint index, GLuint divisor) override { glVertexAttribDivisor(index, divisor); }
+
+    // Textures
+    inline void genTextures(GLsizei n, GLuint* textures) override { glGenTextures(n, textures); }
+    inline void deleteTextures(GLsizei n, const GLuint* textures) override { glDeleteTextures(n, textures); }
+    inline void bindTexture(GLenum target, GLuint texture) override { glBindTexture(target, texture); }
+    inline void activeTexture(GLenum texture) override { glActiveTexture(texture); }
+    inline void texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* data) override { glTexImage2D(target, level, internalFormat, width, height, border, format, type, data); }
+    inline void texImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void* data) override { glTexImage3D(target, level, internalFormat, width, height, depth, border, format, type, data); }
+    inline void texImage2DMultisample(GLenum target, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height, GLboolean fixedSampleLocations) override { glTexImage2DMultisample(target, samples, internalFormat, width, height, fixedSampleLocations); }
+    inline void texParameteri(GLenum target, GLenum pname, GLint param) override { glTexParameteri(target, pname, param); }
+    inline void texParameterfv(GLenum target, GLenum pname, const GLfloat* params) override { glTexParameterfv(target, pname, params); }
+    inline void generateMipmap(GLenum target) override { glGenerateMipmap(target); }
+    inline void texBuffer(GLenum target, GLenum internalFormat, GLuint buffer) override { glTexBuffer(target, internalFormat, buffer); }
+    inline void getTexImage(GLenum target, GLint level, GLenum format, GLenum type, void* pixels) override { glGetTexImage(target, level, format, type, pixels); }
+    inline void genSamplers(GLsizei n, GLuint* samplers) override { glGenSamplers(n, samplers); }
+    inline void deleteSamplers(GLsizei n, const GLuint* samplers) override { glDeleteSamplers(n, samplers); }
+    inline void bindSampler(GLuint unit, GLuint sampler) override { glBindSampler(unit, sampler); }
+    inline void samplerParameteri(GLuint sampler, GLenum pname, GLint param) override { glSamplerParameteri(sampler, pname, param); }
+    inline void samplerParameterfv(GLuint sampler, GLenum pname, const GLfloat* params) override { glSamplerParameterfv(sampler, pname, params); }
+
+    // Frame buffers
+    inline void genFramebuffers(GLsizei n, GLuint* framebuffers) override { glGenFramebuffers(n, framebuffers); }
+    inline void deleteFramebuffers(GLsizei n, const GLuint* framebuffers) override { glDeleteFramebuffers(n, framebuffers); }
+    inline void bindFramebuffer(GLenum target, GLuint framebuffer) override { glBindFramebuffer(target, framebuffer); }
+    inline void framebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level) override { glFramebufferTexture2D(target, attachment, textureTarget, texture, level); }
+    inline void framebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer) override { glFramebufferTextureLayer(target, attachment, texture, level, layer); }
+    inline void framebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level) override { glFramebufferTexture(target, attachment, texture, level); }
+    inline void framebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer) override { glFramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer); }
+    inline GLenum checkFramebufferStatus(GLenum target) override { return glCheckFramebufferStatus(target); }
+    inline void blitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) override { glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter); }
+    inline void drawBuffer(GLenum buffer) override { glDrawBuffer(buffer); }
+    inline void drawBuffers(GLsizei n, const GLenum* buffers) override { glDrawBuffers(n, buffers); }
+    inline void readBuffer(GLenum buffer) override { glReadBuffer(buffer); }
+    inline void genRenderbuffers(GLsizei n, GLuint* renderbuffers) override { glGenRenderbuffers(n, renderbuffers); }
+    inline void deleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) override { glDeleteRenderbuffers(n, renderbuffers); }
+    inline void bindRenderbuffer(GLenum target, GLuint renderbuffer) override { glBindRenderbuffer(target, renderbuffer); }
+    inline void renderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height) override { glRenderbufferStorage(target, internalFormat, width, height); }
+    inline void renderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height) override { glRenderbufferStorageMultisample(target, samples, internalFormat, width, height); }
+
+    // Shaders
+    inline GLuint createShader(GLenum type) override { return glCreateShader(type); }
+    inline void deleteShader(GLuint shader) override { glDeleteShader(shader); }
+    inline void shaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length) override { glShaderSource(shader, count, string, length); }
+    inline void compileShader(GLuint shader) override { glCompileShader(shader); }
+    inline void getShaderiv(GLuint shader, GLenum pname, GLint* params) override { glGetShaderiv(shader, pname, params); }
+    inline void getShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog) override { glGetShaderInfoLog(shader, bufSize, length, infoLog); }
+    inline GLuint createProgram() override { return glCreateProgram(); }
+    inline void deleteProgram(GLuint program) override { glDeleteProgram(program); }
+    inline void attachShader(GLuint program, GLuint shader) override { glAttachShader(program, shader); }
+    inline void detachShader(GLuint program, GLuint shader) override { glDetachShader(program, shader); }
+    inline void linkProgram(GLuint program) override { glLinkProgram(program); }
+    inline void getProgramiv(GLuint program, GLenum pname, GLint* params) override { glGetProgramiv(program, pname, params); }
+    inline void getProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog) override { glGetProgramInfoLog(program, bufSize, length, infoLog); }
+    inline void useProgram(GLuint program) override { glUseProgram(program); }
+    inline void programParameteri(GLuint program, GLenum pname, GLint value) override { glProgramParameteri(program, pname, value); }
+    inline void getProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary) override { glGetProgramBinary(program, bufSize, length, binaryFormat, binary); }
+    inline void programBinary(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length) override { glProgramBinary(program, binaryFormat, binary, length); }
+    inline GLint getUniformLocation(GLuint program, const GLchar* name) override { return glGetUniformLocation(program, name); }
+    inline void uniform1i(GLint location, GLint v0) override { glUniform1i(location, v0); }
+    inline void uniform1f(GLint location, GLfloat v0) override { glUniform1f(location, v0); }
+    inline void uniform3fv(GLint location, GLsizei count, const GLfloat* value) override { glUniform3fv(location, count, value); }
+    inline void uniform1iv(GLint location, GLsizei count, const GLint* value) override { glUniform1iv(location, count, value); }
+    inline void uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) override { glUniformMatrix4fv(location, count, transpose, value); }
+
+    // Compute
+    inline void dispatchCompute(GLuint numGroupsX, GLuint numGroupsY, GLuint numGroupsZ) override { glDispatchCompute(numGroupsX, numGroupsY, numGroupsZ); }
+    inline void memoryBarrier(GLbitfield barriers) override { glMemoryBarrier(barriers); }
+
+    // State
+    inline void enable(GLenum cap) override { glEnable(cap); }
+    inline void disable(GLenum cap) override { glDisable(cap); }
+    inline void viewport(GLint x, GLint y, GLsizei width, GLsizei height) override { glViewport(x, y, width, height); }
+    inline void clear(GLbitfield mask) override { glClear(mask); }
+    inline void clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) override { glClearColor(red, green, blue, alpha); }
+    inline void blendFunc(GLenum sfactor, GLenum dfactor) override { glBlendFunc(sfactor, dfactor); }
+    inline void blendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) override { glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha); }
+    inline void depthFunc(GLenum func) override { glDepthFunc(func); }
+    inline void depthRange(GLdouble nearVal, GLdouble farVal) override { glDepthRange(nearVal, farVal); }
+    inline void cullFace(GLenum mode) override { glCullFace(mode); }
+    inline void frontFace(GLenum mode) override { glFrontFace(mode); }
+    inline void polygonMode(GLenum face, GLenum mode) override { glPolygonMode(face, mode); }
+    inline void pointSize(GLfloat size) override { glPointSize(size); }
+    inline void lineWidth(GLfloat width) override { glLineWidth(width); }
+    inline void stencilMask(GLuint mask) override { glStencilMask(mask); }
+    inline void depthMask(GLboolean flag) override { glDepthMask(flag); }
+    inline void colorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) override { glColorMask(red, green, blue, alpha); }
+    inline void getIntegerv(GLenum pname, GLint* data) override { glGetIntegerv(pname, data); }
+    inline const GLubyte* getString(GLenum name) override { return glGetString(name); }
+    inline void finish() override { glFinish(); }
+
+    // Draws
+    inline void drawArrays(GLenum mode, GLint first, GLsizei count) override { glDrawArrays(mode, first, count); }
+    inline void drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) override { glDrawElements(mode, count, type, indices); }
+    inline void multiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride) override { glMultiDrawElementsIndirect(mode, type, indirect, drawCount, stride); }
+    void multiDrawElementsIndirectCount(GLenum mode, GLenum type, const void* indirect, GLintptr drawCount, GLsizei maxDrawCount, GLsizei stride) override;
+
+    // Queries and sync objects
+    inline void genQueries(GLsizei n, GLuint* ids) override { glGenQueries(n, ids); }
+    inline void deleteQueries(GLsizei n, const GLuint* ids) override { glDeleteQueries(n, ids); }
+    inline void queryCounter(GLuint id, GLenum target) override { glQueryCounter(id, target); }
+    inline void beginQuery(GLenum target, GLuint id) override { glBeginQuery(target, id); }
+    inline void endQuery(GLenum target) override { glEndQuery(target); }
+    inline void beginConditionalRender(GLuint id, GLenum mode) override { glBeginConditionalRender(id, mode); }
+    inline void endConditionalRender() override { glEndConditionalRender(); }
+    inline void getQueryObjectiv(GLuint id, GLenum pname, GLint* params) override { glGetQueryObjectiv(id, pname, params); }
+    inline void getQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params) override { glGetQueryObjectui64v(id, pname, params); }
+    inline GLsync fenceSync(GLenum condition, GLbitfield flags) override { return glFenceSync(condition, flags); }
+    inline GLenum clientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) override { return glClientWaitSync(sync, flags, timeout); }
+    inline void deleteSync(GLsync sync) override { glDeleteSync(sync); }
+};
\ No newline at end of file
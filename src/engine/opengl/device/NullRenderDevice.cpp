@@ -0,0 +1,564 @@
+#include "NullRenderDevice.h"
+
+#include <string.h>
+#include <cstdint>
+#include <cstdlib>
+
+NullRenderDevice::NullRenderDevice()
+    : recording(true), nextID(1), program(0), vertexArray(0), drawFramebuffer(0) {
+    reset();
+}
+
+void NullRenderDevice::reset() {
+    commands.clear();
+    for(size_t& counter : counters) counter = 0;
+}
+
+void NullRenderDevice::record(CommandType type, GLenum target, GLuint id, size_t count) {
+    counters[type] ++;
+    if(recording) commands.push_back({ type, target, id, count });
+}
+
+void NullRenderDevice::generate(GLsizei n, GLuint* names) {
+    for(GLsizei i = 0; i < n; i ++) {
+        names[i] = nextID ++;
+        record(CREATE, 0, names[i]);
+    }
+}
+
+std::vector<unsigned char>* NullRenderDevice::boundStorage(GLenum target) {
+    auto bound = boundBuffers.find(target);
+    if(bound == boundBuffers.end()) return nullptr;
+    auto storage = buffers.find(bound->second);
+    return storage != buffers.end() ? &storage->second : nullptr;
+}
+
+const char* NullRenderDevice::getCommandName(CommandType type) {
+    switch(type) {
+        case DRAW: return "Draw";
+        case MULTI_DRAW: return "MultiDraw";
+        case DISPATCH: return "Dispatch";
+        case BIND_PROGRAM: return "BindProgram";
+        case BIND_TEXTURE: return "BindTexture";
+        case BIND_BUFFER: return "BindBuffer";
+        case BIND_VERTEX_ARRAY: return "BindVertexArray";
+        case BIND_FRAMEBUFFER: return "BindFramebuffer";
+        case UPLOAD: return "Upload";
+        case COPY: return "Copy";
+        case CLEAR: return "Clear";
+        case UNIFORM: return "Uniform";
+        case STATE: return "State";
+        case CREATE: return "Create";
+        case DESTROY: return "Destroy";
+        default: return "Unknown";
+    }
+}
+
+bool NullRenderDevice::init() {
+    return true;
+}
+
+bool NullRenderDevice::isSupported(Feature feature) {
+    // There is nothing to cache
+    return feature != PROGRAM_BINARY;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Buffers
+
+void NullRenderDevice::genBuffers(GLsizei n, GLuint* names) {
+    generate(n, names);
+    for(GLsizei i = 0; i < n; i ++) buffers[names[i]];
+}
+
+void NullRenderDevice::deleteBuffers(GLsizei n, const GLuint* names) {
+    for(GLsizei i = 0; i < n; i ++) {
+        buffers.erase(names[i]);
+        record(DESTROY, 0, names[i]);
+    }
+}
+
+void NullRenderDevice::bindBuffer(GLenum target, GLuint buffer) {
+    boundBuffers[target] = buffer;
+    record(BIND_BUFFER, target, buffer);
+}
+
+void NullRenderDevice::bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum) {
+    std::vector<unsigned char>* storage = boundStorage(target);
+    if(storage == nullptr) return;
+
+    storage->assign(size, 0);
+    if(data != nullptr) {
+        memcpy(storage->data(), data, size);
+        record(UPLOAD, target, boundBuffers[target], size);
+    }
+}
+
+void NullRenderDevice::bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    std::vector<unsigned char>* storage = boundStorage(target);
+    if(storage == nullptr || offset + size > (GLintptr)storage->size()) return;
+
+    memcpy(storage->data() + offset, data, size);
+    record(UPLOAD, target, boundBuffers[target], size);
+}
+
+void NullRenderDevice::copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) {
+    std::vector<unsigned char>* source = boundStorage(readTarget);
+    std::vector<unsigned char>* destination = boundStorage(writeTarget);
+    if(source == nullptr || destination == nullptr) return;
+    if(readOffset + size > (GLintptr)source->size() || writeOffset + size > (GLintptr)destination->size()) return;
+
+    memmove(destination->data() + writeOffset, source->data() + readOffset, size);
+    record(COPY, writeTarget, boundBuffers[writeTarget], size);
+}
+
+void* NullRenderDevice::mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    std::vector<unsigned char>* storage = boundStorage(target);
+    if(storage == nullptr || offset + length > (GLintptr)storage->size()) return nullptr;
+
+    if(access & GL_MAP_WRITE_BIT) record(UPLOAD, target, boundBuffers[target], length);
+    return storage->data() + offset;
+}
+
+GLboolean NullRenderDevice::unmapBuffer(GLenum) {
+    return GL_TRUE;
+}
+
+void NullRenderDevice::bindBufferBase(GLenum target, GLuint, GLuint buffer) {
+    record(BIND_BUFFER, target, buffer);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Vertex arrays
+
+void NullRenderDevice::genVertexArrays(GLsizei n, GLuint* arrays) {
+    generate(n, arrays);
+}
+
+void NullRenderDevice::deleteVertexArrays(GLsizei n, const GLuint* arrays) {
+    for(GLsizei i = 0; i < n; i ++) record(DESTROY, 0, arrays[i]);
+}
+
+void NullRenderDevice::bindVertexArray(GLuint array) {
+    vertexArray = array;
+    record(BIND_VERTEX_ARRAY, 0, array);
+}
+
+void NullRenderDevice::enableVertexAttribArray(GLuint index) {
+    record(STATE, GL_VERTEX_ATTRIB_ARRAY_ENABLED, index);
+}
+
+void NullRenderDevice::vertexAttribPointer(GLuint index, GLint, GLenum, GLboolean, GLsizei, const void*) {
+    record(STATE, GL_VERTEX_ATTRIB_ARRAY_POINTER, index);
+}
+
+void NullRenderDevice::vertexAttribDivisor(GLuint index, GLuint) {
+    record(STATE, GL_VERTEX_ATTRIB_ARRAY_DIVISOR, index);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Textures
+
+void NullRenderDevice::genTextures(GLsizei n, GLuint* textures) {
+    generate(n, textures);
+}
+
+void NullRenderDevice::deleteTextures(GLsizei n, const GLuint* textures) {
+    for(GLsizei i = 0; i < n; i ++) record(DESTROY, 0, textures[i]);
+}
+
+void NullRenderDevice::bindTexture(GLenum target, GLuint texture) {
+    record(BIND_TEXTURE, target, texture);
+}
+
+void NullRenderDevice::activeTexture(GLenum texture) {
+    record(STATE, GL_ACTIVE_TEXTURE, texture);
+}
+
+void NullRenderDevice::texImage2D(GLenum target, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type, const void* data) {
+    if(data != nullptr) record(UPLOAD, target, 0, getImageSize(width, height, format, type));
+}
+
+void NullRenderDevice::texImage3D(GLenum target, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth, GLint, GLenum format, GLenum type, const void* data) {
+    if(data != nullptr) record(UPLOAD, target, 0, getImageSize(width, height, format, type) * depth);
+}
+
+void NullRenderDevice::texImage2DMultisample(GLenum, GLsizei, GLenum, GLsizei, GLsizei, GLboolean) {
+}
+
+void NullRenderDevice::texParameteri(GLenum, GLenum pname, GLint param) {
+    record(STATE, pname, param);
+}
+
+void NullRenderDevice::texParameterfv(GLenum, GLenum pname, const GLfloat*) {
+    record(STATE, pname);
+}
+
+void NullRenderDevice::generateMipmap(GLenum) {
+}
+
+void NullRenderDevice::texBuffer(GLenum target, GLenum, GLuint buffer) {
+    record(STATE, target, buffer);
+}
+
+void NullRenderDevice::getTexImage(GLenum, GLint, GLenum, GLenum, void*) {
+}
+
+void NullRenderDevice::genSamplers(GLsizei n, GLuint* samplers) {
+    generate(n, samplers);
+}
+
+void NullRenderDevice::deleteSamplers(GLsizei n, const GLuint* samplers) {
+    for(GLsizei i = 0; i < n; i ++) record(DESTROY, 0, samplers[i]);
+}
+
+void NullRenderDevice::bindSampler(GLuint, GLuint sampler) {
+    record(BIND_TEXTURE, GL_SAMPLER_BINDING, sampler);
+}
+
+void NullRenderDevice::samplerParameteri(GLuint, GLenum pname, GLint param) {
+    record(STATE, pname, param);
+}
+
+void NullRenderDevice::samplerParameterfv(GLuint, GLenum pname, const GLfloat*) {
+    record(STATE, pname);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Frame buffers
+
+void NullRenderDevice::genFramebuffers(GLsizei n, GLuint* framebuffers) {
+    generate(n, framebuffers);
+}
+
+void NullRenderDevice::deleteFramebuffers(GLsizei n, const GLuint* framebuffers) {
+    for(GLsizei i = 0; i < n; i ++) record(DESTROY, 0, framebuffers[i]);
+}
+
+void NullRenderDevice::bindFramebuffer(GLenum target, GLuint framebuffer) {
+    if(target != GL_READ_FRAMEBUFFER) drawFramebuffer = framebuffer;
+    record(BIND_FRAMEBUFFER, target, framebuffer);
+}
+
+void NullRenderDevice::framebufferTexture2D(GLenum, GLenum attachment, GLenum, GLuint texture, GLint) {
+    record(STATE, attachment, texture);
+}
+
+void NullRenderDevice::framebufferTextureLayer(GLenum, GLenum attachment, GLuint texture, GLint, GLint) {
+    record(STATE, attachment, texture);
+}
+
+void NullRenderDevice::framebufferTexture(GLenum, GLenum attachment, GLuint texture, GLint) {
+    record(STATE, attachment, texture);
+}
+
+void NullRenderDevice::framebufferRenderbuffer(GLenum, GLenum attachment, GLenum, GLuint renderbuffer) {
+    record(STATE, attachment, renderbuffer);
+}
+
+GLenum NullRenderDevice::checkFramebufferStatus(GLenum) {
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void NullRenderDevice::blitFramebuffer(GLint, GLint, GLint, GLint, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield, GLenum) {
+    record(COPY, GL_DRAW_FRAMEBUFFER, drawFramebuffer, (size_t)std::abs(dstX1 - dstX0) * std::abs(dstY1 - dstY0));
+}
+
+void NullRenderDevice::drawBuffer(GLenum buffer) {
+    record(STATE, GL_DRAW_BUFFER, buffer);
+}
+
+void NullRenderDevice::drawBuffers(GLsizei n, const GLenum*) {
+    record(STATE, GL_DRAW_BUFFER, 0, n);
+}
+
+void NullRenderDevice::readBuffer(GLenum buffer) {
+    record(STATE, GL_READ_BUFFER, buffer);
+}
+
+void NullRenderDevice::genRenderbuffers(GLsizei n, GLuint* renderbuffers) {
+    generate(n, renderbuffers);
+}
+
+void NullRenderDevice::deleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) {
+    for(GLsizei i = 0; i < n; i ++) record(DESTROY, 0, renderbuffers[i]);
+}
+
+void NullRenderDevice::bindRenderbuffer(GLenum, GLuint renderbuffer) {
+    record(STATE, GL_RENDERBUFFER_BINDING, renderbuffer);
+}
+
+void NullRenderDevice::renderbufferStorage(GLenum, GLenum, GLsizei, GLsizei) {
+}
+
+void NullRenderDevice::renderbufferStorageMultisample(GLenum, GLsizei, GLenum, GLsizei, GLsizei) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Shaders
+
+GLuint NullRenderDevice::createShader(GLenum type) {
+    GLuint id = nextID ++;
+    record(CREATE, type, id);
+    return id;
+}
+
+void NullRenderDevice::deleteShader(GLuint shader) {
+    record(DESTROY, 0, shader);
+}
+
+void NullRenderDevice::shaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) {
+}
+
+void NullRenderDevice::compileShader(GLuint) {
+}
+
+void NullRenderDevice::getShaderiv(GLuint, GLenum pname, GLint* params) {
+    *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+
+void NullRenderDevice::getShaderInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+    if(length != nullptr) *length = 0;
+    if(bufSize > 0) infoLog[0] = '\0';
+}
+
+GLuint NullRenderDevice::createProgram() {
+    GLuint id = nextID ++;
+    record(CREATE, 0, id);
+    return id;
+}
+
+void NullRenderDevice::deleteProgram(GLuint program) {
+    record(DESTROY, 0, program);
+}
+
+void NullRenderDevice::attachShader(GLuint, GLuint) {
+}
+
+void NullRenderDevice::detachShader(GLuint, GLuint) {
+}
+
+void NullRenderDevice::linkProgram(GLuint) {
+}
+
+void NullRenderDevice::getProgramiv(GLuint, GLenum pname, GLint* params) {
+    *params = pname == GL_LINK_STATUS ? GL_TRUE : 0;
+}
+
+void NullRenderDevice::getProgramInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+    if(length != nullptr) *length = 0;
+    if(bufSize > 0) infoLog[0] = '\0';
+}
+
+void NullRenderDevice::useProgram(GLuint program) {
+    this->program = program;
+    record(BIND_PROGRAM, 0, program);
+}
+
+void NullRenderDevice::programParameteri(GLuint, GLenum, GLint) {
+}
+
+void NullRenderDevice::getProgramBinary(GLuint, GLsizei, GLsizei* length, GLenum*, void*) {
+    if(length != nullptr) *length = 0;
+}
+
+void NullRenderDevice::programBinary(GLuint, GLenum, const void*, GLsizei) {
+}
+
+GLint NullRenderDevice::getUniformLocation(GLuint, const GLchar* name) {
+    // Same name, same location in every program
+    auto location = uniformLocations.emplace(name, (GLint)uniformLocations.size());
+    return location.first->second;
+}
+
+void NullRenderDevice::uniform1i(GLint location, GLint) {
+    record(UNIFORM, 0, location, 1);
+}
+
+void NullRenderDevice::uniform1f(GLint location, GLfloat) {
+    record(UNIFORM, 0, location, 1);
+}
+
+void NullRenderDevice::uniform3fv(GLint location, GLsizei count, const GLfloat*) {
+    record(UNIFORM, 0, location, count);
+}
+
+void NullRenderDevice::uniform1iv(GLint location, GLsizei count, const GLint*) {
+    record(UNIFORM, 0, location, count);
+}
+
+void NullRenderDevice::uniformMatrix4fv(GLint location, GLsizei count, GLboolean, const GLfloat*) {
+    record(UNIFORM, 0, location, count);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Compute
+
+void NullRenderDevice::dispatchCompute(GLuint numGroupsX, GLuint numGroupsY, GLuint numGroupsZ) {
+    record(DISPATCH, 0, program, (size_t)numGroupsX * numGroupsY * numGroupsZ);
+}
+
+void NullRenderDevice::memoryBarrier(GLbitfield barriers) {
+    record(STATE, barriers);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// State
+
+void NullRenderDevice::enable(GLenum cap) {
+    record(STATE, cap, GL_TRUE);
+}
+
+void NullRenderDevice::disable(GLenum cap) {
+    record(STATE, cap, GL_FALSE);
+}
+
+void NullRenderDevice::viewport(GLint, GLint, GLsizei, GLsizei) {
+    record(STATE, GL_VIEWPORT);
+}
+
+void NullRenderDevice::clear(GLbitfield mask) {
+    record(CLEAR, mask, drawFramebuffer);
+}
+
+void NullRenderDevice::clearColor(GLfloat, GLfloat, GLfloat, GLfloat) {
+    record(STATE, GL_COLOR_CLEAR_VALUE);
+}
+
+void NullRenderDevice::blendFunc(GLenum, GLenum) {
+    record(STATE, GL_BLEND_SRC_RGB);
+}
+
+void NullRenderDevice::blendFuncSeparate(GLenum, GLenum, GLenum, GLenum) {
+    record(STATE, GL_BLEND_SRC_RGB);
+}
+
+void NullRenderDevice::depthFunc(GLenum func) {
+    record(STATE, GL_DEPTH_FUNC, func);
+}
+
+void NullRenderDevice::depthRange(GLdouble, GLdouble) {
+    record(STATE, GL_DEPTH_RANGE);
+}
+
+void NullRenderDevice::cullFace(GLenum mode) {
+    record(STATE, GL_CULL_FACE_MODE, mode);
+}
+
+void NullRenderDevice::frontFace(GLenum mode) {
+    record(STATE, GL_FRONT_FACE, mode);
+}
+
+void NullRenderDevice::polygonMode(GLenum, GLenum mode) {
+    record(STATE, GL_POLYGON_MODE, mode);
+}
+
+void NullRenderDevice::pointSize(GLfloat) {
+    record(STATE, GL_POINT_SIZE);
+}
+
+void NullRenderDevice::lineWidth(GLfloat) {
+    record(STATE, GL_LINE_WIDTH);
+}
+
+void NullRenderDevice::stencilMask(GLuint mask) {
+    record(STATE, GL_STENCIL_WRITEMASK, mask);
+}
+
+void NullRenderDevice::depthMask(GLboolean flag) {
+    record(STATE, GL_DEPTH_WRITEMASK, flag);
+}
+
+void NullRenderDevice::colorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) {
+    record(STATE, GL_COLOR_WRITEMASK, red | green << 1 | blue << 2 | alpha << 3);
+}
+
+void NullRenderDevice::getIntegerv(GLenum pname, GLint* data) {
+    switch(pname) {
+        case GL_VERTEX_ARRAY_BINDING: *data = vertexArray; break;
+        case GL_FRAMEBUFFER_BINDING: *data = drawFramebuffer; break;
+        case GL_CURRENT_PROGRAM: *data = program; break;
+        case GL_MAX_TEXTURE_IMAGE_UNITS: *data = NULL_DEVICE_TEXTURE_UNITS; break;
+        default: *data = 0; break;
+    }
+}
+
+const GLubyte* NullRenderDevice::getString(GLenum name) {
+    switch(name) {
+        case GL_VENDOR: return (const GLubyte*)"RendererGL";
+        case GL_RENDERER: return (const GLubyte*)"Null device";
+        case GL_VERSION: return (const GLubyte*)"4.6 Null";
+        default: return (const GLubyte*)"";
+    }
+}
+
+void NullRenderDevice::finish() {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Draws
+
+void NullRenderDevice::drawArrays(GLenum mode, GLint, GLsizei count) {
+    record(DRAW, mode, program, count);
+}
+
+void NullRenderDevice::drawElements(GLenum mode, GLsizei count, GLenum, const void*) {
+    record(DRAW, mode, program, count);
+}
+
+void NullRenderDevice::multiDrawElementsIndirect(GLenum mode, GLenum, const void*, GLsizei drawCount, GLsizei) {
+    record(MULTI_DRAW, mode, program, drawCount);
+}
+
+void NullRenderDevice::multiDrawElementsIndirectCount(GLenum mode, GLenum, const void*, GLintptr, GLsizei maxDrawCount, GLsizei) {
+    record(MULTI_DRAW, mode, program, maxDrawCount);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Queries and sync objects
+
+void NullRenderDevice::genQueries(GLsizei n, GLuint* ids) {
+    generate(n, ids);
+}
+
+void NullRenderDevice::deleteQueries(GLsizei n, const GLuint* ids) {
+    for(GLsizei i = 0; i < n; i ++) record(DESTROY, 0, ids[i]);
+}
+
+void NullRenderDevice::queryCounter(GLuint, GLenum) {
+}
+
+void NullRenderDevice::beginQuery(GLenum, GLuint) {
+}
+
+void NullRenderDevice::endQuery(GLenum) {
+}
+
+// The draws are recorded anyway, nothing is rendered
+void NullRenderDevice::beginConditionalRender(GLuint id, GLenum mode) {
+    record(STATE, mode, id);
+}
+
+void NullRenderDevice::endConditionalRender() {
+    record(STATE, 0);
+}
+
+// Results are available at once. Occlusion queries find every node visible, they are all queried
+void NullRenderDevice::getQueryObjectiv(GLuint, GLenum pname, GLint* params) {
+    *params = pname == GL_QUERY_RESULT_AVAILABLE || pname == GL_QUERY_RESULT ? 1 : 0;
+}
+
+void NullRenderDevice::getQueryObjectui64v(GLuint, GLenum, GLuint64* params) {
+    *params = 0;
+}
+
+GLsync NullRenderDevice::fenceSync(GLenum, GLbitfield) {
+    return reinterpret_cast<GLsync>((uintptr_t)nextID ++);
+}
+
+GLenum NullRenderDevice::clientWaitSync(GLsync, GLbitfield, GLuint64) {
+    return GL_ALREADY_SIGNALED;
+}
+
+void NullRenderDevice::deleteSync(GLsync) {
+}
\ No newline at end of file
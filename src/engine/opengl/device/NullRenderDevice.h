@@ -0,0 +1,201 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "RenderDevice.h"
+
+#define NULL_DEVICE_TEXTURE_UNITS 32
+
+/**
+ * @brief Executes nothing, it records draws, binds, uploads and state changes with counters.
+ *
+ * Names are unique numbers and buffers are kept in memory, so mapping and copying them works.
+ * Shaders always compile and link. It needs no GL context, the renderer can run on machines
+ * without GPU nor display to measure its own CPU time.
+ */
+class NullRenderDevice : public RenderDevice {
+    GENERATE_PTR(NullRenderDevice)
+public:
+    enum CommandType {
+        DRAW, MULTI_DRAW, DISPATCH, BIND_PROGRAM, BIND_TEXTURE, BIND_BUFFER, BIND_VERTEX_ARRAY, BIND_FRAMEBUFFER,
+        UPLOAD, COPY, CLEAR, UNIFORM, STATE, CREATE, DESTROY, COMMAND_TYPE_COUNT
+    };
+
+    /**
+     * target is the primitive of draws, the GL target of binds and uploads, the capability or
+     * function of state changes. count is vertices or indices, draw commands or bytes
+     */
+    struct Command {
+        CommandType type;
+        GLenum target;
+        GLuint id;
+        size_t count;
+    };
+private:
+    std::vector<Command> commands;
+    size_t counters[COMMAND_TYPE_COUNT];
+    bool recording;
+
+    GLuint nextID;
+    std::unordered_map<GLuint, std::vector<unsigned char>> buffers;
+    std::unordered_map<GLenum, GLuint> boundBuffers;
+    std::unordered_map<std::string, GLint> uniformLocations;
+    GLuint program, vertexArray, drawFramebuffer;
+public:
+    NullRenderDevice();
+    ~NullRenderDevice() = default;
+private:
+    void record(CommandType type, GLenum target = 0, GLuint id = 0, size_t count = 0);
+    void generate(GLsizei n, GLuint* names);
+    std::vector<unsigned char>* boundStorage(GLenum target);
+public:
+    /**
+     * @brief Clears the commands and the counters, call it every frame
+     */
+    void reset();
+
+    static const char* getCommandName(CommandType type);
+public:
+    bool init() override;
+    bool isSupported(Feature feature) override;
+    inline const char* getName() const override { return "Null"; }
+
+    // Buffers
+    void genBuffers(GLsizei n, GLuint* buffers) override;
+    void deleteBuffers(GLsizei n, const GLuint* buffers) override;
+    void bindBuffer(GLenum target, GLuint buffer) override;
+    void bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) override;
+    void bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) override;
+    void copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) override;
+    void* mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) override;
+    GLboolean unmapBuffer(GLenum target) override;
+    void bindBufferBase(GLenum target, GLuint index, GLuint buffer) override;
+
+    // Vertex arrays
+    void genVertexArrays(GLsizei n, GLuint* arrays) override;
+    void deleteVertexArrays(GLsizei n, const GLuint* arrays) override;
+    void bindVertexArray(GLuint array) override;
+    void enableVertexAttribArray(GLuint index) override;
+    void vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) override;
+    void vertexAttribDivisor(GLuint index, GLuint divisor) override;
+
+    // Textures
+    void genTextures(GLsizei n, GLuint* textures) override;
+    void deleteTextures(GLsizei n, const GLuint* textures) override;
+    void bindTexture(GLenum target, GLuint texture) override;
+    void activeTexture(GLenum texture) override;
+    void texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* data) override;
+    void texImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void* data) override;
+    void texImage2DMultisample(GLenum target, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height, GLboolean fixedSampleLocations) override;
+    void texParameteri(GLenum target, GLenum pname, GLint param) override;
+    void texParameterfv(GLenum target, GLenum pname, const GLfloat* params) override;
+    void generateMipmap(GLenum target) override;
+    void texBuffer(GLenum target, GLenum internalFormat, GLuint buffer) override;
+    void getTexImage(GLenum target, GLint level, GLenum format, GLenum type, void* pixels) override;
+    void genSamplers(GLsizei n, GLuint* samplers) override;
+    void deleteSamplers(GLsizei n, const GLuint* samplers) override;
+    void bindSampler(GLuint unit, GLuint sampler) override;
+    void samplerParameteri(GLuint sampler, GLenum pname, GLint param) override;
+    void samplerParameterfv(GLuint sampler, GLenum pname, const GLfloat* params) override;
+
+    // Frame buffers
+    void genFramebuffers(GLsizei n, GLuint* framebuffers) override;
+    void deleteFramebuffers(GLsizei n, const GLuint* framebuffers) override;
+    void bindFramebuffer(GLenum target, GLuint framebuffer) override;
+    void framebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level) override;
+    void framebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer) override;
+    void framebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level) override;
+    void framebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer) override;
+    GLenum checkFramebufferStatus(GLenum target) override;
+    void blitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) override;
+    void drawBuffer(GLenum buffer) override;
+    void drawBuffers(GLsizei n, const GLenum* buffers) override;
+    void readBuffer(GLenum buffer) override;
+    void genRenderbuffers(GLsizei n, GLuint* renderbuffers) override;
+    void deleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) override;
+    void bindRenderbuffer(GLenum target, GLuint renderbuffer) override;
+    void renderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height) override;
+    void renderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height) override;
+
+    // Shaders
+    GLuint createShader(GLenum type) override;
+    void deleteShader(GLuint shader) override;
+    void shaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length) override;
+    void compileShader(GLuint shader) override;
+    void getShaderiv(GLuint shader, GLenum pname, GLint* params) override;
+    void getShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog) override;
+    GLuint createProgram() override;
+    void deleteProgram(GLuint program) override;
+    void attachShader(GLuint program, GLuint shader) override;
+    void detachShader(GLuint program, GLuint shader) override;
+    void linkProgram(GLuint program) override;
+    void getProgramiv(GLuint program, GLenum pname, GLint* params) override;
+    void getProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog) override;
+    void useProgram(GLuint program) override;
+    void programParameteri(GLuint program, GLenum pname, GLint value) override;
+    void getProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary) override;
+    void programBinary(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length) override;
+    GLint getUniformLocation(GLuint program, const GLchar* name) override;
+    void uniform1i(GLint location, GLint v0) override;
+    void uniform1f(GLint location, GLfloat v0) override;
+    void uniform3fv(GLint location, GLsizei count, const GLfloat* value) override;
+    void uniform1iv(GLint location, GLsizei count, const GLint* value) override;
+    void uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) override;
+
+    // Compute
+    void dispatchCompute(GLuint numGroupsX, GLuint numGroupsY, GLuint numGroupsZ) override;
+    void memoryBarrier(GLbitfield barriers) override;
+
+    // State
+    void enable(GLenum cap) override;
+    void disable(GLenum cap) override;
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height) override;
+    void clear(GLbitfield mask) override;
+    void clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) override;
+    void blendFunc(GLenum sfactor, GLenum dfactor) override;
+    void blendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) override;
+    void depthFunc(GLenum func) override;
+    void depthRange(GLdouble nearVal, GLdouble farVal) override;
+    void cullFace(GLenum mode) override;
+    void frontFace(GLenum mode) override;
+    void polygonMode(GLenum face, GLenum mode) override;
+    void pointSize(GLfloat size) override;
+    void lineWidth(GLfloat width) override;
+    void stencilMask(GLuint mask) override;
+    void depthMask(GLboolean flag) override;
+    void colorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) override;
+    void getIntegerv(GLenum pname, GLint* data) override;
+    const GLubyte* getString(GLenum name) override;
+    void finish() override;
+
+    // Draws
+    void drawArrays(GLenum mode, GLint first, GLsizei count) override;
+    void drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) override;
+    void multiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride) override;
+    void multiDrawElementsIndirectCount(GLenum mode, GLenum type, const void* indirect, GLintptr drawCount, GLsizei maxDrawCount, GLsizei stride) override;
+
+    // Queries and sync objects
+    void genQueries(GLsizei n, GLuint* ids) override;
+    void deleteQueries(GLsizei n, const GLuint* ids) override;
+    void queryCounter(GLuint id, GLenum target) override;
+    void beginQuery(GLenum target, GLuint id) override;
+    void endQuery(GLenum target) override;
+    void beginConditionalRender(GLuint id, GLenum mode) override;
+    void endConditionalRender() override;
+    void getQueryObjectiv(GLuint id, GLenum pname, GLint* params) override;
+    void getQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params) override;
+    GLsync fenceSync(GLenum condition, GLbitfield flags) override;
+    GLenum clientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) override;
+    void deleteSync(GLsync sync) override;
+public:
+    inline const std::vector<Command>& getCommands() const { return commands; }
+    inline size_t getCount(CommandType type) const { return counters[type]; }
+
+    /**
+     * @brief Counters only, the command list stays empty
+     */
+    inline void setRecording(bool recording) { this->recording = recording; }
+    inline bool isRecording() const { return recording; }
+};
\ No newline at end of file
@@ -0,0 +1,28 @@
+#include "RenderDevice.h"
+
+#include "GLRenderDevice.h"
+
+RenderDevice::Ptr RenderDevice::device = GLRenderDevice::New();
+
+size_t RenderDevice::getImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type) {
+
+    size_t channels = 4;
+    switch(format) {
+        case GL_RED: case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX: channels = 1; break;
+        case GL_RG: case GL_DEPTH_STENCIL: channels = 2; break;
+        case GL_RGB: case GL_BGR: channels = 3; break;
+    }
+
+    size_t bytes = 1;
+    switch(type) {
+        case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: bytes = 4; break;
+        case GL_HALF_FLOAT: case GL_SHORT: case GL_UNSIGNED_SHORT: bytes = 2; break;
+    }
+
+    size_t row = ((size_t)width * channels * bytes + 3) / 4 * 4;
+    return row * height;
+}
+
+void RenderDevice::set(const RenderDevice::Ptr& renderDevice) {
+    device = renderDevice != nullptr ? renderDevice : GLRenderDevice::New();
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "engine/ptr.h"
+
+/**
+ * @brief Every GL call of the engine goes through the current render device.
+ *
+ * The methods are the GL functions without the gl prefix and with the same parameters.
+ * GLRenderDevice calls OpenGL and it's the default one, NullRenderDevice records the
+ * commands without a GL context. Set the device before creating the renderer, GL objects
+ * made by a device can't be used with another one.
+ */
+class RenderDevice {
+    GENERATE_PTR(RenderDevice)
+public:
+    enum Feature {
+        MULTI_DRAW_INDIRECT, TIMER_QUERY, PROGRAM_BINARY, COMPUTE_SHADER, INDIRECT_COUNT
+    };
+private:
+    static RenderDevice::Ptr device;
+public:
+    RenderDevice() = default;
+    virtual ~RenderDevice() = default;
+public:
+    /**
+     * @brief Loads the GL functions, false if the device can't be used
+     */
+    virtual bool init() = 0;
+    virtual bool isSupported(Feature feature) = 0;
+    virtual const char* getName() const = 0;
+
+    /**
+     * @brief The renderer calls it after every frame
+     */
+    virtual void endFrame() {}
+
+    // Buffers
+    virtual void genBuffers(GLsizei n, GLuint* buffers) = 0;
+    virtual void deleteBuffers(GLsizei n, const GLuint* buffers) = 0;
+    virtual void bindBuffer(GLenum target, GLuint buffer) = 0;
+    virtual void bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) = 0;
+    virtual void bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) = 0;
+    virtual void copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) = 0;
+    virtual void* mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) = 0;
+    virtual GLboolean unmapBuffer(GLenum target) = 0;
+    virtual void bindBufferBase(GLenum target, GLuint index, GLuint buffer) = 0;
+
+    // Vertex arrays
+    virtual void genVertexArrays(GLsizei n, GLuint* arrays) = 0;
+    virtual void deleteVertexArrays(GLsizei n, const GLuint* arrays) = 0;
+    virtual void bindVertexArray(GLuint array) = 0;
+    virtual void enableVertexAttribArray(GLuint index) = 0;
+    virtual void vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) = 0;
+    virtual void vertexAttribDivisor(GLuint index, GLuint divisor) = 0;
+
+    // Textures
+    virtual void genTextures(GLsizei n, GLuint* textures) = 0;
+    virtual void deleteTextures(GLsizei n, const GLuint* textures) = 0;
+    virtual void bindTexture(GLenum target, GLuint texture) = 0;
+    virtual void activeTexture(GLenum texture) = 0;
+    virtual void texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* data) = 0;
+    virtual void texImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void* data) = 0;
+    virtual void texImage2DMultisample(GLenum target, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height, GLboolean fixedSampleLocations) = 0;
+    virtual void texParameteri(GLenum target, GLenum pname, GLint param) = 0;
+    virtual void texParameterfv(GLenum target, GLenum pname, const GLfloat* params) = 0;
+    virtual void generateMipmap(GLenum target) = 0;
+    virtual void texBuffer(GLenum target, GLenum internalFormat, GLuint buffer) = 0;
+    virtual void getTexImage(GLenum target, GLint level, GLenum format, GLenum type, void* pixels) = 0;
+    virtual void genSamplers(GLsizei n, GLuint* samplers) = 0;
+    virtual void deleteSamplers(GLsizei n, const GLuint* samplers) = 0;
+    virtual void bindSampler(GLuint unit, GLuint sampler) = 0;
+    virtual void samplerParameteri(GLuint sampler, GLenum pname, GLint param) = 0;
+    virtual void samplerParameterfv(GLuint sampler, GLenum pname, const GLfloat* params) = 0;
+
+    // Frame buffers
+    virtual void genFramebuffers(GLsizei n, GLuint* framebuffers) = 0;
+    virtual void deleteFramebuffers(GLsizei n, const GLuint* framebuffers) = 0;
+    virtual void bindFramebuffer(GLenum target, GLuint framebuffer) = 0;
+    virtual void framebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level) = 0;
+    virtual void framebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer) = 0;
+    virtual void framebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level) = 0;
+    virtual void framebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer) = 0;
+    virtual GLenum checkFramebufferStatus(GLenum target) = 0;
+    virtual void blitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) = 0;
+    virtual void drawBuffer(GLenum buffer) = 0;
+    virtual void drawBuffers(GLsizei n, const GLenum* buffers) = 0;
+    virtual void readBuffer(GLenum buffer) = 0;
+    virtual void genRenderbuffers(GLsizei n, GLuint* renderbuffers) = 0;
+    virtual void deleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) = 0;
+    virtual void bindRenderbuffer(GLenum target, GLuint renderbuffer) = 0;
+    virtual void renderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height) = 0;
+    virtual void renderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height) = 0;
+
+    // Shaders
+    virtual GLuint createShader(GLenum type) = 0;
+    virtual void deleteShader(GLuint shader) = 0;
+    virtual void shaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length) = 0;
+    virtual void compileShader(GLuint shader) = 0;
+    virtual void getShaderiv(GLuint shader, GLenum pname, GLint* params) = 0;
+    virtual void getShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog) = 0;
+    virtual GLuint createProgram() = 0;
+    virtual void deleteProgram(GLuint program) = 0;
+    virtual void attachShader(GLuint program, GLuint shader) = 0;
+    virtual void detachShader(GLuint program, GLuint shader) = 0;
+    virtual void linkProgram(GLuint program) = 0;
+    virtual void getProgramiv(GLuint program, GLenum pname, GLint* params) = 0;
+    virtual void getProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog) = 0;
+    virtual void useProgram(GLuint program) = 0;
+    virtual void programParameteri(GLuint program, GLenum pname, GLint value) = 0;
+    virtual void getProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary) = 0;
+    virtual void programBinary(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length) = 0;
+    virtual GLint getUniformLocation(GLuint program, const GLchar* name) = 0;
+    virtual void uniform1i(GLint location, GLint v0) = 0;
+    virtual void uniform1f(GLint location, GLfloat v0) = 0;
+    virtual void uniform3fv(GLint location, GLsizei count, const GLfloat* value) = 0;
+    virtual void uniform1iv(GLint location, GLsizei count, const GLint* value) = 0;
+    virtual void uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) = 0;
+
+    // Compute
+    virtual void dispatchCompute(GLuint numGroupsX, GLuint numGroupsY, GLuint numGroupsZ) = 0;
+    virtual void memoryBarrier(GLbitfield barriers) = 0;
+
+    // State
+    virtual void enable(GLenum cap) = 0;
+    virtual void disable(GLenum cap) = 0;
+    virtual void viewport(GLint x, GLint y, GLsizei width, GLsizei height) = 0;
+    virtual void clear(GLbitfield mask) = 0;
+    virtual void clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) = 0;
+    virtual void blendFunc(GLenum sfactor, GLenum dfactor) = 0;
+    virtual void blendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) = 0;
+    virtual void depthFunc(GLenum func) = 0;
+    virtual void depthRange(GLdouble nearVal, GLdouble farVal) = 0;
+    virtual void cullFace(GLenum mode) = 0;
+    virtual void frontFace(GLenum mode) = 0;
+    virtual void polygonMode(GLenum face, GLenum mode) = 0;
+    virtual void pointSize(GLfloat size) = 0;
+    virtual void lineWidth(GLfloat width) = 0;
+    virtual void stencilMask(GLuint mask) = 0;
+    virtual void depthMask(GLboolean flag) = 0;
+    virtual void colorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) = 0;
+    virtual void getIntegerv(GLenum pname, GLint* data) = 0;
+    virtual const GLubyte* getString(GLenum name) = 0;
+    virtual void finish() = 0;
+
+    // Draws
+    virtual void drawArrays(GLenum mode, GLint first, GLsizei count) = 0;
+    virtual void drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) = 0;
+    virtual void multiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride) = 0;
+    virtual void multiDrawElementsIndirectCount(GLenum mode, GLenum type, const void* indirect, GLintptr drawCount, GLsizei maxDrawCount, GLsizei stride) = 0;
+
+    // Queries and sync objects
+    virtual void genQueries(GLsizei n, GLuint* ids) = 0;
+    virtual void deleteQueries(GLsizei n, const GLuint* ids) = 0;
+    virtual void queryCounter(GLuint id, GLenum target) = 0;
+    virtual void beginQuery(GLenum target, GLuint id) = 0;
+    virtual void endQuery(GLenum target) = 0;
+    virtual void beginConditionalRender(GLuint id, GLenum mode) = 0;
+    virtual void endConditionalRender() = 0;
+    virtual void getQueryObjectiv(GLuint id, GLenum pname, GLint* params) = 0;
+    virtual void getQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params) = 0;
+    virtual GLsync fenceSync(GLenum condition, GLbitfield flags) = 0;
+    virtual GLenum clientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) = 0;
+    virtual void deleteSync(GLsync sync) = 0;
+public:
+    inline static RenderDevice* get() { return device.get(); }
+
+    /**
+     * @brief Bytes read by texImage2D, rows aligned to 4 bytes
+     */
+    static size_t getImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type);
+
+    /**
+     * @brief nullptr goes back to the GL device
+     */
+    static void set(const RenderDevice::Ptr& renderDevice);
+};
\ No newline at end of file
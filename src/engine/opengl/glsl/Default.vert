@@ -4,15 +4,23 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
 layout (location = 2) in vec3 aNormal;
 layout (location = 3) in vec2 aTexCoord;
+layout (location = 6) in mat4 aModel;
 
 uniform mat4 mvp;
+uniform mat4 viewProjection;
+uniform bool multiDraw;
+
+// The depth pre-pass computes the same position
+invariant gl_Position;
 
 out vec3 ourColor;
 out vec3 Normal;
 out vec2 TexCoord;
 
 void main() {
-    gl_Position = mvp * vec4(aPos, 1.0);
+    // Multi draw indirect takes the model matrix from the instanced attribute
+    if(multiDraw) gl_Position = viewProjection * aModel * vec4(aPos, 1.0);
+    else gl_Position = mvp * vec4(aPos, 1.0);
     ourColor = aColor;
     Normal = aNormal;
     TexCoord = aTexCoord;
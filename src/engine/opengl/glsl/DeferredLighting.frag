@@ -0,0 +1,205 @@
+#version 330 core
+
+// Same values as LightClusters.h
+#define CLUSTERS_X 16
+#define CLUSTERS_Y 9
+#define CLUSTERS_Z 24
+#define LIGHT_TEXELS 3
+
+struct Light {
+    vec3 position;
+    float radius;
+    vec3 color;
+
+    float constant;
+    float linear;
+    float quadratic;
+
+    bool pointLight;
+};
+
+in vec2 TexCoords;
+
+out vec4 FragColor;
+
+// G-buffer
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gEmission;
+uniform sampler2D gDepth;
+
+// Lights, froxel ranges and light index lists of the clustered lighting
+uniform samplerBuffer lightData;
+uniform usamplerBuffer lightGrid;
+uniform usamplerBuffer lightIndices;
+uniform int nLights;
+uniform bool clustered;
+uniform float clusterScale;
+uniform float clusterBias;
+uniform float clusterTileWidth;
+uniform float clusterTileHeight;
+
+uniform mat4 inverseProjection;
+uniform mat4 inverseView;
+uniform vec3 viewPos;
+
+const float PI = 3.14159265359;
+
+float distributionGGX(vec3 N, vec3 H, float roughness) {
+
+    float a = roughness * roughness;
+    float a2 = a * a;
+    float NdotH = max(dot(N, H), 0.0);
+    float NdotH2 = NdotH*NdotH;
+
+    float nom   = a2;
+    float denom = (NdotH2 * (a2 - 1.0) + 1.0);
+    denom = PI * denom * denom;
+
+    return nom / denom;
+}
+
+float geometrySchlickGGX(float NdotV, float roughness) {
+
+    float r = (roughness + 1.0);
+    float k = (r * r) / 8.0;
+
+    float nom   = NdotV;
+    float denom = NdotV * (1.0 - k) + k;
+
+    return nom / denom;
+}
+
+float geometrySmith(vec3 N, vec3 V, vec3 L, float roughness) {
+
+    float NdotV = max(dot(N, V), 0.0);
+    float NdotL = max(dot(N, L), 0.0);
+    float ggx2 = geometrySchlickGGX(NdotV, roughness);
+    float ggx1 = geometrySchlickGGX(NdotL, roughness);
+
+    return ggx1 * ggx2;
+}
+
+vec3 fresnelSchlick(float cosTheta, vec3 F0) {
+    return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
+}
+
+Light fetchLight(int index) {
+    vec4 positionRadius = texelFetch(lightData, index * LIGHT_TEXELS);
+    vec4 colorType = texelFetch(lightData, index * LIGHT_TEXELS + 1);
+    vec4 attenuation = texelFetch(lightData, index * LIGHT_TEXELS + 2);
+    return Light(positionRadius.xyz, positionRadius.w, colorType.rgb, attenuation.x, attenuation.y, attenuation.z, colorType.a > 0.5);
+}
+
+// Offset and count in the light index list of the froxel at this view space depth
+uvec2 fetchCluster(float depth) {
+    if(!clustered) return uvec2(0);
+    int slice = int(clamp(floor(log(max(depth, 1e-4)) * clusterScale + clusterBias), 0.0, float(CLUSTERS_Z - 1)));
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / vec2(clusterTileWidth, clusterTileHeight)), ivec2(0), ivec2(CLUSTERS_X - 1, CLUSTERS_Y - 1));
+    return texelFetch(lightGrid, tile.x + CLUSTERS_X * (tile.y + CLUSTERS_Y * slice)).xy;
+}
+
+vec3 decodeOctahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if(n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
+void main() {
+
+    // The G-buffer has the size of the viewport, so the fragment is the texel
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, texel, 0).r;
+
+    // Nothing was drawn there, the background stays
+    if(depth == 1.0) discard;
+
+    // The forward pass and the skybox test against the depth of the G-buffer
+    gl_FragDepth = depth;
+
+    // Position from the depth
+    vec4 viewPosition = inverseProjection * vec4(TexCoords * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    viewPosition /= viewPosition.w;
+    vec3 FragPos = vec3(inverseView * viewPosition);
+
+    // Material
+    vec4 albedoAO = texelFetch(gAlbedo, texel, 0);
+    vec4 normalMetallicRoughness = texelFetch(gNormal, texel, 0);
+    vec3 albedo = albedoAO.rgb;
+    float ao = albedoAO.a;
+    vec3 N = decodeOctahedral(normalMetallicRoughness.xy);
+    float metallic = normalMetallicRoughness.z;
+    float roughness = normalMetallicRoughness.w;
+    vec3 emission = texelFetch(gEmission, texel, 0).rgb;
+
+    // V
+    vec3 V = normalize(viewPos - FragPos);
+
+    // calculate reflectance at normal incidence; if dia-electric (like plastic) use F0 
+    // of 0.04 and if it's a metal, use the albedo color as F0 (metallic workflow)    
+    vec3 F0 = vec3(0.04); 
+    F0 = mix(F0, albedo, metallic);
+
+    // reflectance equation: the global lights and the lights of the froxel
+    vec3 Lo = vec3(0.0);
+    uvec2 cluster = fetchCluster(-viewPosition.z);
+    int nClusterLights = int(cluster.y);
+    for(int i = 0; i < nLights + nClusterLights; i ++)  {
+
+        Light light = fetchLight(i < nLights ? i : int(texelFetch(lightIndices, int(cluster.x) + i - nLights).r));
+
+        // calculate per-light radiance
+        vec3 L = normalize(light.position - FragPos);
+        vec3 H = normalize(V + L);
+        
+        vec3 radiance = light.color;
+
+        if(light.pointLight) {
+            float distance = length(light.position - FragPos);
+            float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+
+            // Fade to 0 at the radius, so the froxel edges don't show
+            if(light.radius > 0.0) attenuation *= pow(clamp(1.0 - pow(distance / light.radius, 4.0), 0.0, 1.0), 2.0);
+            radiance *= attenuation;
+        }
+
+        // Cook-Torrance BRDF
+        float NDF = distributionGGX(N, H, roughness);   
+        float G   = geometrySmith(N, V, L, roughness);      
+        vec3 F    = fresnelSchlick(max(dot(H, V), 0.0), F0);
+           
+        vec3 numerator    = NDF * G * F; 
+        float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001; // + 0.0001 to prevent divide by zero
+        vec3 specular = numerator / denominator;
+        
+        // kS is equal to Fresnel
+        vec3 kS = F;
+        // for energy conservation, the diffuse and specular light can't
+        // be above 1.0 (unless the surface emits light); to preserve this
+        // relationship the diffuse component (kD) should equal 1.0 - kS.
+        vec3 kD = vec3(1.0) - kS;
+        // multiply kD by the inverse metalness such that only non-metals 
+        // have diffuse lighting, or a linear blend if partly metal (pure metals
+        // have no diffuse light).
+        kD *= 1.0 - metallic;	  
+
+        // scale light by NdotL
+        float NdotL = max(dot(N, L), 0.0);        
+
+        // add to outgoing radiance Lo
+        Lo += (kD * albedo / PI + specular) * radiance * NdotL;  // note that we already multiplied the BRDF by the Fresnel (kS) so we won't multiply by kS again
+    }   
+
+    // replace this ambient lighting with environment lighting).
+    vec3 ambient = vec3(0.03) * albedo * ao;
+
+    vec3 color = ambient + emission + Lo;
+
+    // HDR tonemapping
+    color = color / (color + vec3(1.0));
+
+    // gamma correct
+    color = pow(color, vec3(1.0/2.2)); 
+
+    FragColor = vec4(color, 1.0);
+}
\ No newline at end of file
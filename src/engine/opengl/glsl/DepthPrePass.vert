@@ -0,0 +1,23 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform mat4 mvp;
+uniform mat4 viewProjection;
+uniform bool lighting;
+uniform bool multiDrawn;
+
+// The color pass tests with GL_EQUAL, the position is computed as in its vertex shader
+invariant gl_Position;
+
+void main() {
+    // Lighting and PBR shaders
+    if(lighting) gl_Position = projection * view * vec4(vec3(model * vec4(aPos, 1.0)), 1.0);
+
+    // Default shader, the model matrix is an attribute when it's multi drawn
+    else if(multiDrawn) gl_Position = viewProjection * model * vec4(aPos, 1.0);
+    else gl_Position = mvp * vec4(aPos, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#version 330 core
+
+out float FragDepth;
+
+uniform sampler2D depthTexture;
+uniform sampler2D depthPyramid;
+uniform bool firstLevel;
+
+void main() {
+
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    if(firstLevel) {
+        FragDepth = texelFetch(depthTexture, texel, 0).r;
+        return;
+    }
+
+    // Only the level below is in the range of the sampler, as its level 0.
+    // A texel covers 2x2 of them, 3 on an odd side
+    ivec2 size = textureSize(depthPyramid, 0);
+    ivec2 levelSize = max(size / 2, ivec2(1));
+    ivec2 first = texel * size / levelSize;
+    ivec2 last = min(((texel + 1) * size + levelSize - 1) / levelSize, size) - 1;
+
+    float farthest = 0.0;
+    for(int y = first.y; y <= last.y; y ++)
+        for(int x = first.x; x <= last.x; x ++)
+            farthest = max(farthest, texelFetch(depthPyramid, ivec2(x, y), 0).r);
+
+    FragDepth = farthest;
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#version 330 core
+
+out float FragDepth;
+
+uniform sampler2DMS depthSamples;
+uniform int samples;
+
+void main() {
+
+    // Farthest sample, a box behind the nearest one can still be seen in the others
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    float farthest = 0.0;
+    for(int i = 0; i < samples; i ++) farthest = max(farthest, texelFetch(depthSamples, texel, i).r);
+
+    FragDepth = farthest;
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+#version 330 core
+
+struct Material {
+    vec3 albedo;
+    float metallic;
+    float roughness;
+    float ao;
+    vec3 emission;
+}; 
+
+struct MaterialMaps {
+   sampler2D albedo;
+   sampler2D metallic;
+   sampler2D roughness;
+   sampler2D normalMap;
+   sampler2D depthMap;
+   sampler2D ao;
+   sampler2D emission;
+};
+
+in vec3 ourColor;
+in vec3 Normal;
+in vec3 FragPos;
+in vec2 TexCoord;
+
+// G-buffer targets, same layout as GBuffer.h
+layout (location = 0) out vec4 gAlbedo;     // albedo, ambient occlusion
+layout (location = 1) out vec4 gNormal;     // octahedral normal, metallic, roughness
+layout (location = 2) out vec3 gEmission;
+
+uniform Material material;
+
+uniform MaterialMaps materialMaps;
+uniform bool hasAlbedo;
+uniform bool hasMetallic;
+uniform bool hasRoughness;
+uniform bool hasNormalMap;
+uniform bool hasDepthMap;
+uniform bool hasAmbientOcclusion;
+uniform bool hasEmission;
+
+uniform float heightScale;
+vec2 texCoord = TexCoord;
+
+uniform vec3 viewPos;
+
+// Unit vector to the [-1, 1] square, two components keep the normal precise enough
+vec2 encodeOctahedral(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.xy;
+    if(n.z < 0.0) e = (1.0 - abs(n.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+    return e;
+}
+
+vec3 getNormalFromMap() {
+
+    vec3 tangentNormal = texture(materialMaps.normalMap, texCoord).xyz * 2.0 - 1.0;
+
+    vec3 Q1  = dFdx(FragPos);
+    vec3 Q2  = dFdy(FragPos);
+    vec2 st1 = dFdx(texCoord);
+    vec2 st2 = dFdy(texCoord);
+
+    vec3 N   = normalize(Normal);
+    vec3 T  = normalize(Q1 * st2.t - Q2 * st1.t);
+    vec3 B  = -normalize(cross(N, T));
+    mat3 TBN = mat3(T, B, N);
+
+    return normalize(TBN * tangentNormal);
+}
+
+vec3 calculateAlbedo() {
+    vec3 albedo = material.albedo;
+    if(hasAlbedo) albedo = pow(texture(materialMaps.albedo, texCoord).rgb, vec3(2.2));
+    albedo *= ourColor;
+    return albedo;
+}
+
+float calculateMetallic() {
+    float metallic = material.metallic;
+    if(hasMetallic) metallic = texture(materialMaps.metallic, texCoord).r;
+    return metallic;
+}
+
+float calculateRoughness() {
+    float roughness = material.roughness;
+    if(hasRoughness) roughness = texture(materialMaps.roughness, texCoord).r;
+    return roughness;
+}
+
+float calculateAmbientOcclusion() {
+    float ao = material.ao;
+    if(hasAmbientOcclusion) ao = texture(materialMaps.ao, texCoord).r;
+    return ao;
+}
+
+vec3 calculateNormal() {
+    vec3 N = normalize(Normal);
+    if(hasNormalMap) N = getNormalFromMap();
+    return N;
+}
+
+vec3 calculateEmission() {
+    vec3 emission = material.emission;
+    if(hasEmission) emission = vec3(texture(materialMaps.emission, texCoord));
+    return emission;
+}
+
+vec2 parallaxMapping(vec2 texCoords) { 
+
+    vec2 uvs = texCoords;
+
+    if(hasDepthMap) {
+
+        // Calculate viewDir 
+        vec3 Q1  = dFdx(FragPos);
+        vec3 Q2  = dFdy(FragPos);
+        vec2 st1 = dFdx(texCoord);
+        vec2 st2 = dFdy(texCoord);
+
+        vec3 N   = normalize(Normal);
+        vec3 T  = normalize(Q1 * st2.t - Q2 * st1.t);
+        vec3 B  = -normalize(cross(N, T));
+        mat3 TBN = mat3(T, B, N);
+
+        vec3 tangentViewPos  = TBN * viewPos;
+        vec3 tangentFragPos  = TBN * FragPos;
+
+        vec3 viewDir = normalize(tangentViewPos - tangentFragPos);
+        
+        // Paralax mapping
+        float height = texture(materialMaps.depthMap, texCoords).r;
+        vec2 offset = viewDir.xy * (height * heightScale);
+        return texCoords - offset; 
+    }
+ 
+    return uvs;
+}
+
+void main() {
+
+    // Paralax mapping
+    texCoord = parallaxMapping(TexCoord);
+    if(texCoord.x > 1.0 || texCoord.y > 1.0 || texCoord.x < 0.0 || texCoord.y < 0.0)
+        discard;
+
+    // Translucent polytopes are drawn forward, what is left of the texture alpha is a cutout
+    if(hasAlbedo && texture(materialMaps.albedo, texCoord).a < 0.5)
+        discard;
+
+    gAlbedo = vec4(calculateAlbedo(), calculateAmbientOcclusion());
+    gNormal = vec4(encodeOctahedral(calculateNormal()), calculateMetallic(), calculateRoughness());
+    gEmission = calculateEmission();
+}
\ No newline at end of file
@@ -1,8 +1,16 @@
 #version 330 core
 
-#define MAX_LIGHTS 64
 #define MAX_TEXTURES 64
 
+// Same values as LightClusters.h
+#define CLUSTERS_X 16
+#define CLUSTERS_Y 9
+#define CLUSTERS_Z 24
+#define LIGHT_TEXELS 3
+
+// Same value as ObjectLights.h
+#define OBJECT_MAX_LIGHTS 8
+
 struct Material {
     vec3 albedo;
     float metallic;
@@ -13,6 +21,7 @@ struct Material {
 
 struct Light {
     vec3 position;
+    float radius;
     vec3 color;
 
     float constant;
@@ -43,8 +52,23 @@ in vec3 TangentFragPos;
 
 out vec4 FragColor;
 
-uniform Light lights[MAX_LIGHTS];
+// Lights, froxel ranges and light index lists of the clustered lighting
+uniform samplerBuffer lightData;
+uniform usamplerBuffer lightGrid;
+uniform usamplerBuffer lightIndices;
 uniform int nLights;
+uniform bool clustered;
+uniform float clusterScale;
+uniform float clusterBias;
+uniform float clusterTileWidth;
+uniform float clusterTileHeight;
+
+// Per object light lists instead of the froxels, indices in the light data
+uniform bool objectLighting;
+uniform int objectLights[OBJECT_MAX_LIGHTS];
+uniform int objectLightCount;
+
+uniform mat4 view;
 
 uniform Material material;
 
@@ -104,6 +128,22 @@ vec3 fresnelSchlick(float cosTheta, vec3 F0) {
     return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
 }
 
+Light fetchLight(int index) {
+    vec4 positionRadius = texelFetch(lightData, index * LIGHT_TEXELS);
+    vec4 colorType = texelFetch(lightData, index * LIGHT_TEXELS + 1);
+    vec4 attenuation = texelFetch(lightData, index * LIGHT_TEXELS + 2);
+    return Light(positionRadius.xyz, positionRadius.w, colorType.rgb, attenuation.x, attenuation.y, attenuation.z, colorType.a > 0.5);
+}
+
+// Offset and count in the light index list of the froxel of this fragment
+uvec2 fetchCluster() {
+    if(!clustered) return uvec2(0);
+    float depth = -(view * vec4(FragPos, 1.0)).z;
+    int slice = int(clamp(floor(log(max(depth, 1e-4)) * clusterScale + clusterBias), 0.0, float(CLUSTERS_Z - 1)));
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / vec2(clusterTileWidth, clusterTileHeight)), ivec2(0), ivec2(CLUSTERS_X - 1, CLUSTERS_Y - 1));
+    return texelFetch(lightGrid, tile.x + CLUSTERS_X * (tile.y + CLUSTERS_Y * slice)).xy;
+}
+
 vec3 getNormalFromMap() {
 
     vec3 tangentNormal = texture(materialMaps.normalMap, texCoord).xyz * 2.0 - 1.0;
@@ -212,19 +252,27 @@ void main() {
     vec3 F0 = vec3(0.04); 
     F0 = mix(F0, albedo, metallic);
 
-    // reflectance equation
+    // reflectance equation: the global lights and the lights of the froxel or the object
     vec3 Lo = vec3(0.0);
-    for(int i = 0; i < nLights; i ++)  {
+    uvec2 cluster = objectLighting ? uvec2(0u, uint(objectLightCount)) : fetchCluster();
+    int nClusterLights = int(cluster.y);
+    for(int i = 0; i < nLights + nClusterLights; i ++)  {
+
+        int index = i < nLights ? i : objectLighting ? objectLights[i - nLights] : int(texelFetch(lightIndices, int(cluster.x) + i - nLights).r);
+        Light light = fetchLight(index);
 
         // calculate per-light radiance
-        vec3 L = normalize(lights[i].position - FragPos);
+        vec3 L = normalize(light.position - FragPos);
         vec3 H = normalize(V + L);
         
-        vec3 radiance = lights[i].color;
+        vec3 radiance = light.color;
+
+        if(light.pointLight) {
+            float distance = length(light.position - FragPos);
+            float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
 
-        if(lights[i].pointLight) {
-            float distance = length(lights[i].position - FragPos);
-            float attenuation = 1.0 / (lights[i].constant + lights[i].linear * distance + lights[i].quadratic * (distance * distance));
+            // Fade to 0 at the radius, so the froxel edges don't show
+            if(light.radius > 0.0) attenuation *= pow(clamp(1.0 - pow(distance / light.radius, 4.0), 0.0, 1.0), 2.0);
             radiance *= attenuation;
         }
 
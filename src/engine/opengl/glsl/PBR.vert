@@ -6,6 +6,7 @@ layout (location = 2) in vec3 aNormal;
 layout (location = 3) in vec2 aTexCoord;
 layout (location = 4) in vec3 aTangent;
 layout (location = 5) in vec3 aBitangent;
+layout (location = 6) in mat4 aModel;
 
 out vec3 FragPos;
 out vec3 ourColor;
@@ -22,16 +23,21 @@ uniform mat4 projection;
 uniform mat4 lightSpaceMatrix;
 uniform vec3 lightPos;
 uniform vec3 viewPos;
+uniform bool multiDraw;
+
+// The depth pre-pass computes the same position
+invariant gl_Position;
 
 void main() {
 
-   FragPos = vec3(model * vec4(aPos, 1.0));
+   mat4 modelMatrix = multiDraw ? aModel : model;
+   FragPos = vec3(modelMatrix * vec4(aPos, 1.0));
    ourColor = aColor;
-   Normal = mat3(transpose(inverse(model))) * aNormal;
+   Normal = mat3(transpose(inverse(modelMatrix))) * aNormal;
    TexCoord = aTexCoord;
    FragPosLightSpace = lightSpaceMatrix * vec4(FragPos, 1.0);
 
-   mat3 normalMatrix = transpose(inverse(mat3(model)));
+   mat3 normalMatrix = transpose(inverse(mat3(modelMatrix)));
    vec3 T = normalize(normalMatrix * aTangent);
    vec3 N = normalize(normalMatrix * aNormal);
    T = normalize(T - dot(T, N) * N);
@@ -1,6 +1,28 @@
 #version 330 core
 
-#define MAX_LIGHTS 64
+// Same values as LightClusters.h
+#define CLUSTERS_X 16
+#define CLUSTERS_Y 9
+#define CLUSTERS_Z 24
+#define LIGHT_TEXELS 3
+
+// Same value as ObjectLights.h
+#define OBJECT_MAX_LIGHTS 8
+
+// Same values as ShadowCascades.h
+#define SHADOW_MAX_CASCADES 4
+#define SHADOW_MAX_SAMPLES 32
+#define SHADOW_HARDWARE 0
+#define SHADOW_POISSON 1
+#define SHADOW_ROTATED_DISK 2
+#define SHADOW_PCSS 3
+
+// Same value as PointShadows.h
+#define POINT_SHADOW_MAX_LIGHTS 8
+#define POINT_SHADOW_NEAR 0.05
+
+// Widest penumbra and blocker search of PCSS, in texels
+#define SHADOW_MAX_PENUMBRA 32.0
 
 out vec4 FragColor;
 
@@ -8,22 +30,20 @@ in VS_OUT {
     vec3 FragPos;
     vec3 Normal;
     vec2 TexCoords;
-    vec4 FragPosLightSpace;
 } fs_in;
 
 struct Light {
     vec3 position;
+    float radius;
     vec3 color;
 
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
     float constant;
     float linear;
     float quadratic;
 
     bool pointLight;
+    // slot of the point shadows, -1 without
+    int shadow;
 };
 
 struct MaterialMaps {
@@ -36,61 +56,245 @@ struct MaterialMaps {
 uniform MaterialMaps materialMaps;
 
 uniform sampler2D diffuseTexture;
-uniform sampler2D shadowMap;
 uniform bool shadowMapping;
 
+// Cascaded shadow maps, a layer per cascade. The same texture with and without depth comparison
+uniform sampler2DArrayShadow shadowMap;
+uniform sampler2DArray shadowDepthMap;
+uniform mat4 lightSpaceMatrices[SHADOW_MAX_CASCADES];
+uniform float cascadeSplits[SHADOW_MAX_CASCADES];
+uniform float cascadeTexelSizes[SHADOW_MAX_CASCADES];
+uniform int cascadeCount;
+uniform float cascadeBlend;
+
+// Filter, PCF lookups per fragment, radius of the disk in texels and light size of PCSS
+uniform int shadowFilter;
+uniform int shadowSamples;
+uniform float shadowRadius;
+uniform float shadowLightSize;
+
+// Every prefix is spread over the disk, the first samples are the kernel of the lower qualities
+const vec2 poissonDisk[SHADOW_MAX_SAMPLES] = vec2[](
+    vec2(-0.3523, -0.6983), vec2(0.2279, 0.4483), vec2(0.5545, -0.4159), vec2(-0.6535, 0.2035),
+    vec2(-0.1004, -0.1120), vec2(0.8179, 0.1569), vec2(-0.3305, 0.7708), vec2(-0.7813, -0.3477),
+    vec2(0.1901, -0.8429), vec2(0.1273, 0.9041), vec2(0.6530, 0.6362), vec2(0.3383, 0.0080),
+    vec2(-0.2021, 0.3613), vec2(-0.7016, 0.6118), vec2(0.1578, -0.4296), vec2(0.9230, -0.2276),
+    vec2(-0.3987, -0.3304), vec2(-0.9592, -0.0264), vec2(0.5598, -0.7943), vec2(-0.1327, -0.9708),
+    vec2(-0.6971, -0.6850), vec2(0.5181, 0.2931), vec2(-0.0429, 0.6363), vec2(-0.3853, 0.0286),
+    vec2(0.0466, 0.1613), vec2(-0.9234, 0.3652), vec2(0.4375, 0.8735), vec2(0.6286, -0.1116),
+    vec2(0.8238, -0.5662), vec2(0.8862, 0.4516), vec2(-0.1346, -0.4840), vec2(-0.6696, -0.0852)
+);
+
+// Point shadows, 6 layers per light in the order of the cube map faces
+uniform sampler2DArrayShadow pointShadowMap;
+uniform float pointShadowFar[POINT_SHADOW_MAX_LIGHTS];
+uniform float pointShadowFaceScale;
+uniform int pointShadowFilter;
+uniform int pointShadowSamples;
+uniform float pointShadowRadius;
+
+const vec3 faceForwards[6] = vec3[](
+    vec3(1.0, 0.0, 0.0), vec3(-1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0), vec3(0.0, -1.0, 0.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 0.0, -1.0)
+);
+const vec3 faceUps[6] = vec3[](
+    vec3(0.0, -1.0, 0.0), vec3(0.0, -1.0, 0.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 0.0, -1.0), vec3(0.0, -1.0, 0.0), vec3(0.0, -1.0, 0.0)
+);
+
 uniform vec3 lightPos;
 
-uniform Light lights[MAX_LIGHTS];
+// Lights, froxel ranges and light index lists of the clustered lighting
+uniform samplerBuffer lightData;
+uniform usamplerBuffer lightGrid;
+uniform usamplerBuffer lightIndices;
 uniform int nLights;
+uniform bool clustered;
+uniform float clusterScale;
+uniform float clusterBias;
+uniform float clusterTileWidth;
+uniform float clusterTileHeight;
+
+// Per object light lists instead of the froxels, indices in the light data
+uniform bool objectLighting;
+uniform int objectLights[OBJECT_MAX_LIGHTS];
+uniform int objectLightCount;
 
+uniform mat4 view;
 uniform vec3 viewPos;
 
-float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir)
+Light fetchLight(int index) {
+    vec4 positionRadius = texelFetch(lightData, index * LIGHT_TEXELS);
+    vec4 colorType = texelFetch(lightData, index * LIGHT_TEXELS + 1);
+    vec4 attenuation = texelFetch(lightData, index * LIGHT_TEXELS + 2);
+    return Light(positionRadius.xyz, positionRadius.w, colorType.rgb, attenuation.x, attenuation.y, attenuation.z, colorType.a > 0.5, int(attenuation.w) - 1);
+}
+
+// Offset and count in the light index list of the froxel of this fragment
+uvec2 fetchCluster() {
+    if(!clustered) return uvec2(0);
+    float depth = -(view * vec4(fs_in.FragPos, 1.0)).z;
+    int slice = int(clamp(floor(log(max(depth, 1e-4)) * clusterScale + clusterBias), 0.0, float(CLUSTERS_Z - 1)));
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / vec2(clusterTileWidth, clusterTileHeight)), ivec2(0), ivec2(CLUSTERS_X - 1, CLUSTERS_Y - 1));
+    return texelFetch(lightGrid, tile.x + CLUSTERS_X * (tile.y + CLUSTERS_Y * slice)).xy;
+}
+
+// Rotation of the disk per pixel, interleaved gradient noise
+mat2 DiskRotation(int shadowFilterMode)
+{
+    if(shadowFilterMode == SHADOW_POISSON) return mat2(1.0);
+    float angle = 6.2831853 * fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+    float s = sin(angle);
+    float c = cos(angle);
+    return mat2(c, s, -s, c);
+}
+
+float CascadeShadow(int cascade, vec3 normal, vec3 lightDir)
 {
+    // offset along the normal by the texels of the cascade, the far cascades have bigger ones
+    vec4 fragPosLightSpace = lightSpaceMatrices[cascade] * vec4(fs_in.FragPos + normal * cascadeTexelSizes[cascade] * 1.5, 1.0);
     // perform perspective divide
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     // transform to [0,1] range
     projCoords = projCoords * 0.5 + 0.5;
-    // get closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
-    float closestDepth = texture(shadowMap, projCoords.xy).r;
-    // get depth of current fragment from light's perspective
-    float currentDepth = projCoords.z;
-    // check whether current frag pos is in shadow
+    // depth of current fragment from light's perspective, biased
     float bias = max(0.003 * (1.0 - dot(normal, lightDir)), 0.0005);
-    float shadow = currentDepth - bias > closestDepth  ? 1.0 : 0.0;
-    //float shadow = currentDepth > closestDepth  ? 1.0 : 0.0;
+    float currentDepth = projCoords.z - bias;
+
+    // the hardware compares and filters the 4 nearest texels, 1.0 when lit
+    if(shadowFilter == SHADOW_HARDWARE) return 1.0 - texture(shadowMap, vec4(projCoords.xy, cascade, currentDepth));
+
+    float size = float(textureSize(shadowMap, 0).x);
+    vec2 texelSize = vec2(1.0 / size);
+    mat2 rotation = DiskRotation(shadowFilter);
+    float radius = shadowRadius;
+
+    if(shadowFilter == SHADOW_PCSS) {
+        // mean depth of the blockers, in the region where they can shadow the fragment
+        float searchRadius = clamp(currentDepth * shadowLightSize * size, 1.0, SHADOW_MAX_PENUMBRA);
+        float blockerDepth = 0.0;
+        int blockers = 0;
+        for(int i = 0; i < shadowSamples / 2; i ++) {
+            vec2 offset = rotation * poissonDisk[i] * searchRadius * texelSize;
+            float depth = texture(shadowDepthMap, vec3(projCoords.xy + offset, cascade)).r;
+            if(depth < currentDepth) {
+                blockerDepth += depth;
+                blockers ++;
+            }
+        }
+        if(blockers == 0) return 0.0;
+        blockerDepth /= float(blockers);
+
+        // the penumbra of the directional light widens with the distance from the blockers
+        radius = clamp((currentDepth - blockerDepth) * shadowLightSize * size, 1.0, SHADOW_MAX_PENUMBRA);
+    }
+
+    float lit = 0.0;
+    for(int i = 0; i < shadowSamples; i ++) {
+        vec2 offset = rotation * poissonDisk[i] * radius * texelSize;
+        lit += texture(shadowMap, vec4(projCoords.xy + offset, cascade, currentDepth));
+    }
+
+    return 1.0 - lit / float(shadowSamples);
+}
+
+float ShadowCalculation(vec3 normal, vec3 lightDir)
+{
+    // cascade of the view depth
+    float depth = -(view * vec4(fs_in.FragPos, 1.0)).z;
+    int cascade = 0;
+    while(cascade < cascadeCount - 1 && depth > cascadeSplits[cascade]) cascade ++;
+
+    float shadow = CascadeShadow(cascade, normal, lightDir);
+
+    // the end of a cascade fades into the next one
+    float splitNear = cascade > 0 ? cascadeSplits[cascade - 1] : 0.0;
+    float blendStart = cascadeSplits[cascade] - (cascadeSplits[cascade] - splitNear) * cascadeBlend;
+    if(cascade < cascadeCount - 1 && depth > blendStart)
+        shadow = mix(shadow, CascadeShadow(cascade + 1, normal, lightDir), (depth - blendStart) / (cascadeSplits[cascade] - blendStart));
 
     return shadow;
 }
 
+float PointShadow(int slot, vec3 lightPosition, vec3 normal)
+{
+    float size = float(textureSize(pointShadowMap, 0).x);
+
+    // offset along the normal by the texels of the face at this distance
+    vec3 direction = fs_in.FragPos - lightPosition;
+    vec3 axes = abs(direction);
+    float texelSize = 2.0 * max(axes.x, max(axes.y, axes.z)) / (size * pointShadowFaceScale);
+    direction += normal * texelSize * 1.5;
+
+    // face of the major axis
+    axes = abs(direction);
+    int face = axes.x >= axes.y && axes.x >= axes.z ? (direction.x > 0.0 ? 0 : 1) : axes.y >= axes.z ? (direction.y > 0.0 ? 2 : 3) : (direction.z > 0.0 ? 4 : 5);
+
+    // view of the face as built by lookAt, then its perspective
+    vec3 forward = faceForwards[face];
+    vec3 side = cross(forward, faceUps[face]);
+    vec3 up = cross(side, forward);
+    float w = dot(direction, forward);
+    vec2 uv = vec2(dot(direction, side), dot(direction, up)) * pointShadowFaceScale / w * 0.5 + 0.5;
+
+    // depth a texel closer to the light, biased
+    float farPlane = pointShadowFar[slot];
+    float nearPlane = POINT_SHADOW_NEAR;
+    float z = max(w - texelSize, nearPlane);
+    float currentDepth = ((farPlane + nearPlane) / (farPlane - nearPlane) - 2.0 * farPlane * nearPlane / ((farPlane - nearPlane) * z)) * 0.5 + 0.5;
+    float layer = float(6 * slot + face);
+
+    if(pointShadowFilter == SHADOW_HARDWARE) return 1.0 - texture(pointShadowMap, vec4(uv, layer, currentDepth));
+
+    vec2 texel = vec2(1.0 / size);
+    mat2 rotation = DiskRotation(pointShadowFilter);
+    float lit = 0.0;
+    for(int i = 0; i < pointShadowSamples; i ++) {
+        vec2 offset = rotation * poissonDisk[i] * pointShadowRadius * texel;
+        lit += texture(pointShadowMap, vec4(uv + offset, layer, currentDepth));
+    }
+
+    return 1.0 - lit / float(pointShadowSamples);
+}
+
 void main()
 {
-    Light light = lights[0];
     //vec3 color = texture(diffuseTexture, fs_in.TexCoords).rgb;
     vec3 color = vec3(1.0);//texture(materialMaps.diffuseMap, fs_in.TexCoords).rgb;
     vec3 normal = normalize(fs_in.Normal);
-    vec3 lightColor = light.color;
-    // ambient
-    vec3 ambient = 0.3 * lightColor;
-    // diffuse
-    //vec3 lightDir = normalize(lightPos - fs_in.FragPos);
-    vec3 lightDir = vec3(1.0);
-    if(shadowMapping) lightDir = normalize(lightPos - fs_in.FragPos);
-    else lightDir = normalize(light.position - fs_in.FragPos);
-    float diff = max(dot(lightDir, normal), 0.0);
-    vec3 diffuse = diff * lightColor;
-    // specular
     vec3 viewDir = normalize(viewPos - fs_in.FragPos);
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = 0.0;
-    vec3 halfwayDir = normalize(lightDir + viewDir);
-    spec = pow(max(dot(normal, halfwayDir), 0.0), 64.0);
-    vec3 specular = spec * lightColor;
-    // calculate shadow
-    float shadow = 0.0;
-    if(shadowMapping) shadow = ShadowCalculation(fs_in.FragPosLightSpace, normal, lightDir);
-    vec3 lighting = (ambient + (1.0 - shadow) * (diffuse + specular)) * color;
-
-    FragColor = vec4(lighting, 1.0);
+    // ambient of the first light
+    vec3 ambient = nLights > 0 ? 0.3 * fetchLight(0).color : vec3(0.0);
+
+    // The first light casts the shadow and doesn't attenuate, then the global lights and the lights of the froxel or the object
+    vec3 lighting = vec3(0.0);
+    uvec2 cluster = objectLighting ? uvec2(0u, uint(objectLightCount)) : fetchCluster();
+    int nClusterLights = int(cluster.y);
+    for(int i = 0; i < nLights + nClusterLights; i ++) {
+
+        int index = i < nLights ? i : objectLighting ? objectLights[i - nLights] : int(texelFetch(lightIndices, int(cluster.x) + i - nLights).r);
+        Light light = fetchLight(index);
+        vec3 lightColor = light.color;
+        // diffuse
+        vec3 lightDir = normalize(light.position - fs_in.FragPos);
+        if(i == 0 && shadowMapping) lightDir = normalize(lightPos - fs_in.FragPos);
+        float diff = max(dot(lightDir, normal), 0.0);
+        vec3 diffuse = diff * lightColor;
+        // specular
+        vec3 halfwayDir = normalize(lightDir + viewDir);
+        float spec = pow(max(dot(normal, halfwayDir), 0.0), 64.0);
+        vec3 specular = spec * lightColor;
+        // attenuation, faded to 0 at the radius so the froxel edges don't show
+        float attenuation = 1.0;
+        if(i > 0 && light.pointLight) {
+            float distance = length(light.position - fs_in.FragPos);
+            attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+            if(light.radius > 0.0) attenuation *= pow(clamp(1.0 - pow(distance / light.radius, 4.0), 0.0, 1.0), 2.0);
+        }
+        // calculate shadow
+        float shadow = 0.0;
+        if(i == 0 && shadowMapping) shadow = ShadowCalculation(normal, lightDir);
+        else if(light.shadow >= 0) shadow = PointShadow(light.shadow, light.position, normal);
+        lighting += (1.0 - shadow) * (diffuse + specular) * attenuation;
+    }
+
+    FragColor = vec4((ambient + lighting) * color, 1.0);
 }
\ No newline at end of file
@@ -2,24 +2,27 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 2) in vec3 aNormal;
 layout (location = 3) in vec2 aTexCoords;
+layout (location = 6) in mat4 aModel;
 
 out VS_OUT {
     vec3 FragPos;
     vec3 Normal;
     vec2 TexCoords;
-    vec4 FragPosLightSpace;
 } vs_out;
 
 uniform mat4 projection;
 uniform mat4 view;
 uniform mat4 model;
-uniform mat4 lightSpaceMatrix;
+uniform bool multiDraw;
+
+// The depth pre-pass computes the same position
+invariant gl_Position;
 
 void main()
 {
-    vs_out.FragPos = vec3(model * vec4(aPos, 1.0));
-    vs_out.Normal = transpose(inverse(mat3(model))) * aNormal;
+    mat4 modelMatrix = multiDraw ? aModel : model;
+    vs_out.FragPos = vec3(modelMatrix * vec4(aPos, 1.0));
+    vs_out.Normal = transpose(inverse(mat3(modelMatrix))) * aNormal;
     vs_out.TexCoords = aTexCoords;
-    vs_out.FragPosLightSpace = lightSpaceMatrix * vec4(vs_out.FragPos, 1.0);
     gl_Position = projection * view * vec4(vs_out.FragPos, 1.0);
 }
\ No newline at end of file
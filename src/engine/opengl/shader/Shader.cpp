@@ -1,10 +1,17 @@
 #include "Shader.h"
 
+#include "engine/opengl/device/RenderDevice.h"
+
 #include <fstream>
 
+#include "engine/profiler/Instrumentation.h"
+
+#ifdef RENDERERGL_EMBED_SHADERS
+#include "engine/opengl/shader/EmbeddedShaders.h"
+#endif
+
 Shader::Shader(const std::string& _code, const ShaderType& _shaderType) 
-    : code(_code), shaderType(_shaderType) {
-    compileShader();
+    : code(_code), shaderType(_shaderType), shaderID(0) {
 }
 
 Shader::Shader() : code(""), filePath(""), shaderID(0), shaderType(ShaderType::None) {}
@@ -28,6 +35,12 @@ Shader& Shader::operator=(const Shader& shader) {
 }
 
 std::string Shader::readFile(const std::string& path) {
+#ifdef RENDERERGL_EMBED_SHADERS
+    // Shaders compiled into the library, looked up by file name
+    std::string fileName = path.substr(path.find_last_of("/\\") + 1);
+    auto it = embeddedShaders.find(fileName);
+    if(it != embeddedShaders.end()) return it->second;
+#endif
     std::ifstream file(path);
     std::string line = "", code = "";
     if(file.is_open()) {
@@ -42,98 +55,176 @@ void Shader::compileShader() {
     std::string debugShader = "";
     switch (shaderType) {
     case ShaderType::Vertex:
-        shaderID = glCreateShader(GL_VERTEX_SHADER);
+        shaderID = RenderDevice::get()->createShader(GL_VERTEX_SHADER);
         debugShader = "Vertex";
         break;
     case ShaderType::Fragment:
-        shaderID = glCreateShader(GL_FRAGMENT_SHADER);
+        shaderID = RenderDevice::get()->createShader(GL_FRAGMENT_SHADER);
         debugShader = "Fragment";
         break;
+    case ShaderType::Geometry:
+        shaderID = RenderDevice::get()->createShader(GL_GEOMETRY_SHADER);
+        debugShader = "Geometry";
+        break;
+    case ShaderType::Compute:
+        shaderID = RenderDevice::get()->createShader(GL_COMPUTE_SHADER);
+        debugShader = "Compute";
+        break;
     default:
         debugShader = "Not implemented yet";
         break;
     }
     const char* chrCode = code.c_str();
-    glShaderSource(shaderID, 1, &chrCode, NULL);
-    glCompileShader(shaderID);
+    RenderDevice::get()->shaderSource(shaderID, 1, &chrCode, NULL);
+    RenderDevice::get()->compileShader(shaderID);
+}
+
+bool Shader::checkCompileStatus() {
     // Show error if any
     int success;
     char infoLog[512];
-    glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+    RenderDevice::get()->getShaderiv(shaderID, GL_COMPILE_STATUS, &success);
     if (!success) {
-        glGetShaderInfoLog(shaderID, 512, NULL, infoLog);
+        RenderDevice::get()->getShaderInfoLog(shaderID, 512, NULL, infoLog);
+        std::string debugShader = shaderType == ShaderType::Vertex ? "Vertex" : shaderType == ShaderType::Geometry ? "Geometry" :
+            shaderType == ShaderType::Compute ? "Compute" : "Fragment";
         std::cout << debugShader << " shader compilation error: " << infoLog << std::endl;
     }
+    return success;
 }
 
 ShaderProgram::ShaderProgram(const Shader& _vertexShader, const Shader& _fragmentShader) 
-    : vertexShader(_vertexShader), fragmentShader(_fragmentShader), shaderProgramID(0) {
+    : vertexShader(_vertexShader), fragmentShader(_fragmentShader), shaderProgramID(0),
+    cacheKey(0), linkPending(false) {
     link();
 }
 
-ShaderProgram::ShaderProgram() : shaderProgramID(0) {}
+ShaderProgram::ShaderProgram(const Shader& _vertexShader, const Shader& _geometryShader, const Shader& _fragmentShader)
+    : vertexShader(_vertexShader), fragmentShader(_fragmentShader), geometryShader(_geometryShader), shaderProgramID(0),
+    cacheKey(0), linkPending(false) {
+    link();
+}
+
+ShaderProgram::ShaderProgram(const Shader& _computeShader)
+    : computeShader(_computeShader), shaderProgramID(0), cacheKey(0), linkPending(false) {
+    link();
+}
+
+ShaderProgram::ShaderProgram() : shaderProgramID(0), cacheKey(0), linkPending(false) {}
 
 ShaderProgram::ShaderProgram(const ShaderProgram& shaderProgram) 
     : vertexShader(shaderProgram.vertexShader), fragmentShader(shaderProgram.fragmentShader),
-    shaderProgramID(shaderProgram.shaderProgramID) {
+    geometryShader(shaderProgram.geometryShader), computeShader(shaderProgram.computeShader), shaderProgramID(shaderProgram.shaderProgramID),
+    cacheKey(shaderProgram.cacheKey), linkPending(shaderProgram.linkPending) {
 }
 
 ShaderProgram::ShaderProgram(ShaderProgram&& shaderProgram) noexcept 
 : vertexShader(std::move(shaderProgram.vertexShader)), fragmentShader(std::move(shaderProgram.fragmentShader)),
-    shaderProgramID(shaderProgram.shaderProgramID) {
+    geometryShader(std::move(shaderProgram.geometryShader)), computeShader(std::move(shaderProgram.computeShader)),
+    shaderProgramID(shaderProgram.shaderProgramID), cacheKey(shaderProgram.cacheKey), linkPending(shaderProgram.linkPending) {
 }
 
 ShaderProgram::~ShaderProgram() {
-    glDeleteProgram(shaderProgramID);
+    RenderDevice::get()->deleteProgram(shaderProgramID);
 }
 
 ShaderProgram& ShaderProgram::operator=(const ShaderProgram& shaderProgram) {
     vertexShader = shaderProgram.vertexShader;
     fragmentShader = shaderProgram.fragmentShader;
+    geometryShader = shaderProgram.geometryShader;
+    computeShader = shaderProgram.computeShader;
     shaderProgramID = shaderProgram.shaderProgramID;
+    cacheKey = shaderProgram.cacheKey;
+    linkPending = shaderProgram.linkPending;
     return *this;
 }
 
 void ShaderProgram::link() {
-    // Link program
-    shaderProgramID = glCreateProgram();
-    glAttachShader(shaderProgramID, vertexShader.getShaderID());
-    glAttachShader(shaderProgramID, fragmentShader.getShaderID());
-    glLinkProgram(shaderProgramID);
+
+    RENDERERGL_ZONE("ShaderProgram::link");
+
+    shaderProgramID = RenderDevice::get()->createProgram();
+
+    // Try the program binary cache first
+    bool compute = computeShader.getShaderType() != Shader::ShaderType::None;
+    bool geometry = geometryShader.getShaderType() != Shader::ShaderType::None;
+    std::vector<std::string> sources = { vertexShader.getCode(), fragmentShader.getCode() };
+    if(geometry) sources.push_back(geometryShader.getCode());
+    if(compute) sources = { computeShader.getCode() };
+    cacheKey = ShaderCache::programKey(sources);
+    if(ShaderCache::loadProgram(shaderProgramID, cacheKey)) return;
+
+    // Compile and link program. Status queries are deferred to finishLink
+    if(compute) {
+        computeShader.compile();
+        RenderDevice::get()->attachShader(shaderProgramID, computeShader.getShaderID());
+    }
+    else {
+        vertexShader.compile();
+        if(geometry) geometryShader.compile();
+        fragmentShader.compile();
+        RenderDevice::get()->attachShader(shaderProgramID, vertexShader.getShaderID());
+        if(geometry) RenderDevice::get()->attachShader(shaderProgramID, geometryShader.getShaderID());
+        RenderDevice::get()->attachShader(shaderProgramID, fragmentShader.getShaderID());
+    }
+    if(ShaderCache::isEnabled() && ShaderCache::isSupported())
+        RenderDevice::get()->programParameteri(shaderProgramID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    RenderDevice::get()->linkProgram(shaderProgramID);
+    linkPending = true;
+}
+
+void ShaderProgram::finishLink() {
+
+    if(!linkPending) return;
+    linkPending = false;
+
     // Check for linking errors
     int success;
     char infoLog[512];
-    glGetProgramiv(shaderProgramID, GL_LINK_STATUS, &success);
+    RenderDevice::get()->getProgramiv(shaderProgramID, GL_LINK_STATUS, &success);
     if (!success) {
-        glGetProgramInfoLog(shaderProgramID, 512, NULL, infoLog);
+        for(Shader* shader : { &vertexShader, &geometryShader, &fragmentShader, &computeShader }) {
+            if(shader->getShaderID() != 0) shader->checkCompileStatus();
+        }
+        RenderDevice::get()->getProgramInfoLog(shaderProgramID, 512, NULL, infoLog);
         std::cout << "Couldn't link shaders\n" << infoLog << std::endl;
     }
+    else ShaderCache::storeProgram(shaderProgramID, cacheKey);
+
     // Delete shaders
-    vertexShader.deleteShader();
-    fragmentShader.deleteShader();
+    for(Shader* shader : { &vertexShader, &geometryShader, &fragmentShader, &computeShader }) {
+        if(shader->getShaderID() == 0) continue;
+        RenderDevice::get()->detachShader(shaderProgramID, shader->getShaderID());
+        shader->deleteShader();
+    }
 }
 
 void ShaderProgram::uniformInt(const std::string& uniform, int value) {
-    int location = glGetUniformLocation(shaderProgramID, uniform.c_str());
-    glUniform1i(location, value); 
+    int location = RenderDevice::get()->getUniformLocation(shaderProgramID, uniform.c_str());
+    RenderDevice::get()->uniform1i(location, value); 
 }
 
 void ShaderProgram::uniformFloat(const std::string& uniform, float value) {
-    int location = glGetUniformLocation(shaderProgramID, uniform.c_str());
-    glUniform1f(location, value); 
+    int location = RenderDevice::get()->getUniformLocation(shaderProgramID, uniform.c_str());
+    RenderDevice::get()->uniform1f(location, value); 
 }
 
 void ShaderProgram::uniformVec3(const std::string& uniform, const glm::vec3& vec) {
-    int location = glGetUniformLocation(shaderProgramID, uniform.c_str());
-    glUniform3fv(location, 1, &vec[0]); 
+    int location = RenderDevice::get()->getUniformLocation(shaderProgramID, uniform.c_str());
+    RenderDevice::get()->uniform3fv(location, 1, &vec[0]); 
 }
 
 void ShaderProgram::uniformMat4(const std::string& uniform, const glm::mat4& mat) {
-    int location = glGetUniformLocation(shaderProgramID, uniform.c_str());
-    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat));
+    int location = RenderDevice::get()->getUniformLocation(shaderProgramID, uniform.c_str());
+    RenderDevice::get()->uniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat));
 }
 
 void ShaderProgram::uniformTextureArray(const std::string& uniform, std::vector<int>& textures) {
-    int location = glGetUniformLocation(shaderProgramID, uniform.c_str());
-    glUniform1iv(location, textures.size(), &textures[0]);
+    int location = RenderDevice::get()->getUniformLocation(shaderProgramID, uniform.c_str());
+    RenderDevice::get()->uniform1iv(location, textures.size(), &textures[0]);
+}
+
+void ShaderProgram::uniformIntArray(const std::string& uniform, const int* values, int count) {
+    int location = RenderDevice::get()->getUniformLocation(shaderProgramID, uniform.c_str());
+    RenderDevice::get()->uniform1iv(location, count, values);
 }
\ No newline at end of file
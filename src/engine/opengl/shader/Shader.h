@@ -13,10 +13,15 @@
 
 #include "engine/ptr.h"
 
+#include "ShaderCache.h"
+
+#include "engine/renderer/RenderStats.h"
+#include "engine/opengl/device/RenderDevice.h"
+
 class Shader {
 public:
     enum class ShaderType {
-        None, Vertex, Fragment
+        None, Vertex, Fragment, Geometry, Compute
     };
 private:
     std::string code, filePath;
@@ -41,7 +46,14 @@ public:
         return Shader(code, shaderType);
     }
 
-    inline void deleteShader() { glDeleteShader(shaderID); }
+    /**
+     * @brief Compiles the shader if it wasn't compiled yet. The compile status is not
+     * queried here, so several shaders can be compiled in parallel by the driver
+     */
+    inline void compile() { if(shaderID == 0) compileShader(); }
+    bool checkCompileStatus();
+
+    inline void deleteShader() { RenderDevice::get()->deleteShader(shaderID); shaderID = 0; }
 public:
     inline std::string& getCode() { return code; }
     inline unsigned int getShaderID() const { return shaderID; }
@@ -53,8 +65,14 @@ class ShaderProgram {
 private:
     unsigned int shaderProgramID;
     Shader vertexShader, fragmentShader;
+    Shader geometryShader;      // ShaderType::None when the program doesn't have one
+    Shader computeShader;       // Compute programs only have this one
+    std::uint64_t cacheKey;
+    bool linkPending;
 public:
     ShaderProgram(const Shader& _vertexShader, const Shader& _fragmentShader);
+    ShaderProgram(const Shader& _vertexShader, const Shader& _geometryShader, const Shader& _fragmentShader);
+    explicit ShaderProgram(const Shader& _computeShader);
     ShaderProgram();
     ShaderProgram(const ShaderProgram& shaderProgram);
     ShaderProgram(ShaderProgram&& shaderProgram) noexcept;
@@ -63,15 +81,24 @@ public:
 private:
     void link();
 public:
+    /**
+     * @brief Waits for the link started in the constructor and checks its status.
+     * It is called on first use, call it earlier to control when the driver may block
+     */
+    void finishLink();
+
     void uniformInt(const std::string& uniform, int value);
     void uniformFloat(const std::string& uniform, float value);
     void uniformVec3(const std::string& uniform, const glm::vec3& vec);
     void uniformMat4(const std::string& uniform, const glm::mat4& mat);
     void uniformTextureArray(const std::string& uniform, std::vector<int>& textures);
+    void uniformIntArray(const std::string& uniform, const int* values, int count);
 public:
-    inline void useProgram() { glUseProgram(shaderProgramID); }
+    inline void useProgram() { if(linkPending) finishLink(); RenderDevice::get()->useProgram(shaderProgramID); RenderStats::countProgramBind(); }
     inline unsigned int getShaderProgramID() const { return shaderProgramID; }
     
     inline Shader& getVertexShader() { return vertexShader; }
     inline Shader& getFragmentShader() { return fragmentShader; }
+    inline Shader& getGeometryShader() { return geometryShader; }
+    inline Shader& getComputeShader() { return computeShader; }
 };
\ No newline at end of file
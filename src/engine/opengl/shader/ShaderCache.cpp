@@ -0,0 +1,144 @@
+#include "ShaderCache.h"
+
+#include "engine/opengl/device/RenderDevice.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+
+#define SHADER_CACHE_MAGIC 0x42474C52 // "RLGB"
+
+std::string ShaderCache::directory = SHADER_CACHE_DIRECTORY;
+bool ShaderCache::enabled = false;
+std::string ShaderCache::driverKey = "";
+unsigned int ShaderCache::hits = 0;
+unsigned int ShaderCache::misses = 0;
+
+std::uint64_t ShaderCache::hash(const std::string& data, std::uint64_t seed) {
+    // FNV-1a
+    std::uint64_t h = seed;
+    for(unsigned char c : data) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+std::uint64_t ShaderCache::programKey(const std::vector<std::string>& sources) {
+    std::uint64_t key = hash(getDriverKey());
+    for(const std::string& source : sources) key = hash(source, key);
+    return key;
+}
+
+const std::string& ShaderCache::getDriverKey() {
+    if(driverKey.empty()) {
+        const char* vendor = reinterpret_cast<const char*>(RenderDevice::get()->getString(GL_VENDOR));
+        const char* renderer = reinterpret_cast<const char*>(RenderDevice::get()->getString(GL_RENDERER));
+        const char* version = reinterpret_cast<const char*>(RenderDevice::get()->getString(GL_VERSION));
+        driverKey = std::string(vendor ? vendor : "") + "|" + (renderer ? renderer : "") + "|" + (version ? version : "");
+    }
+    return driverKey;
+}
+
+std::string ShaderCache::getEntryPath(std::uint64_t key) {
+    std::stringstream ss;
+    ss << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+    return ss.str();
+}
+
+bool ShaderCache::isSupported() {
+    if(!RenderDevice::get()->isSupported(RenderDevice::PROGRAM_BINARY)) return false;
+    int formats = 0;
+    RenderDevice::get()->getIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+bool ShaderCache::loadProgram(unsigned int program, std::uint64_t key) {
+
+    if(!enabled || !isSupported()) return false;
+
+    std::ifstream file(getEntryPath(key), std::ios::binary);
+    if(!file.is_open()) {
+        misses ++;
+        return false;
+    }
+
+    // Header
+    std::uint32_t magic = 0, keyLength = 0;
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&keyLength), sizeof(keyLength));
+
+    std::string storedDriverKey(keyLength, '\0');
+    file.read(&storedDriverKey[0], keyLength);
+
+    if(!file || magic != SHADER_CACHE_MAGIC || storedDriverKey != getDriverKey()) {
+        misses ++;
+        return false;
+    }
+
+    // Binary
+    std::uint32_t format = 0, length = 0;
+    file.read(reinterpret_cast<char*>(&format), sizeof(format));
+    file.read(reinterpret_cast<char*>(&length), sizeof(length));
+
+    std::vector<char> binary(length);
+    file.read(binary.data(), length);
+
+    if(!file) {
+        misses ++;
+        return false;
+    }
+
+    RenderDevice::get()->programBinary(program, format, binary.data(), length);
+
+    // The driver may reject binaries from another build, then we just compile again
+    int success = 0;
+    RenderDevice::get()->getProgramiv(program, GL_LINK_STATUS, &success);
+    if(!success) {
+        misses ++;
+        return false;
+    }
+
+    hits ++;
+    return true;
+}
+
+void ShaderCache::storeProgram(unsigned int program, std::uint64_t key) {
+
+    if(!enabled || !isSupported()) return;
+
+    int length = 0;
+    RenderDevice::get()->getProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if(length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    RenderDevice::get()->getProgramBinary(program, length, nullptr, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    std::ofstream file(getEntryPath(key), std::ios::binary | std::ios::trunc);
+    if(!file.is_open()) {
+        std::cout << "Couldn't write shader cache entry in " << directory << std::endl;
+        return;
+    }
+
+    const std::string& currentDriverKey = getDriverKey();
+    std::uint32_t magic = SHADER_CACHE_MAGIC;
+    std::uint32_t keyLength = currentDriverKey.size();
+    std::uint32_t binaryFormat = format, binaryLength = length;
+
+    file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    file.write(reinterpret_cast<const char*>(&keyLength), sizeof(keyLength));
+    file.write(currentDriverKey.data(), keyLength);
+    file.write(reinterpret_cast<const char*>(&binaryFormat), sizeof(binaryFormat));
+    file.write(reinterpret_cast<const char*>(&binaryLength), sizeof(binaryLength));
+    file.write(binary.data(), binaryLength);
+}
+
+void ShaderCache::clear() {
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include <GL/glew.h>
+
+#define SHADER_CACHE_DIRECTORY "glsl_cache"
+
+/**
+ * @brief On-disk cache of linked program binaries (glGetProgramBinary / glProgramBinary).
+ *
+ * Entries are keyed by a hash of the shader sources plus the vendor, renderer and
+ * version strings of the driver, so a driver update invalidates the cache.
+ *
+ * It's disabled by default, the application enables it and picks the directory (relative
+ * to the working directory unless absolute) before creating the renderer.
+ */
+class ShaderCache {
+private:
+    static std::string directory;
+    static bool enabled;
+    static std::string driverKey;
+    static unsigned int hits, misses;
+private:
+    static const std::string& getDriverKey();
+    static std::string getEntryPath(std::uint64_t key);
+public:
+    static std::uint64_t hash(const std::string& data, std::uint64_t seed = 14695981039346656037ULL);
+    static std::uint64_t programKey(const std::vector<std::string>& sources);
+
+    static bool isSupported();
+
+    /**
+     * @brief Loads the binary stored for key into program.
+     * @return false when there is no valid entry and the program has to be compiled
+     */
+    static bool loadProgram(unsigned int program, std::uint64_t key);
+    static void storeProgram(unsigned int program, std::uint64_t key);
+
+    static void clear();
+public:
+    inline static void setDirectory(const std::string& directory) { ShaderCache::directory = directory; }
+    inline static const std::string& getDirectory() { return directory; }
+
+    inline static void setEnabled(bool enabled) { ShaderCache::enabled = enabled; }
+    inline static void enable(const std::string& directory) { ShaderCache::directory = directory; enabled = true; }
+    inline static bool isEnabled() { return enabled; }
+
+    inline static unsigned int getHits() { return hits; }
+    inline static unsigned int getMisses() { return misses; }
+    inline static void resetStatistics() { hits = misses = 0; }
+};
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "Instrumentation.h"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+std::mutex Instrumentation::mutex;
+std::vector<std::unique_ptr<Instrumentation::ThreadRing>> Instrumentation::rings;
+thread_local Instrumentation::ThreadRing* Instrumentation::ring = nullptr;
+
+std::atomic<bool> Instrumentation::capturing(false);
+std::atomic<unsigned int> Instrumentation::dropped(0);
+uint64_t Instrumentation::frame = 0;
+unsigned int Instrumentation::framesToCapture = 0;
+
+std::vector<Instrumentation::Event> Instrumentation::events;
+std::vector<Instrumentation::FrameMark> Instrumentation::frameMarks;
+
+Instrumentation::Zone::Zone(const char* _name)
+    : name(_name), begin(0) {
+    if(isCapturing()) begin = now();
+    else name = nullptr;
+}
+
+Instrumentation::Zone::~Zone() {
+    if(name != nullptr) record(name, begin, now());
+}
+
+uint64_t Instrumentation::now() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+Instrumentation::ThreadRing* Instrumentation::getRing() {
+    if(ring == nullptr) {
+        std::lock_guard<std::mutex> lock(mutex);
+        rings.push_back(std::make_unique<ThreadRing>());
+        ring = rings.back().get();
+        ring->head = ring->tail = 0;
+        ring->thread = rings.size() - 1;
+    }
+    return ring;
+}
+
+void Instrumentation::record(const char* name, uint64_t begin, uint64_t end) {
+
+    ThreadRing* threadRing = getRing();
+    unsigned int head = threadRing->head.load(std::memory_order_relaxed);
+    unsigned int tail = threadRing->tail.load(std::memory_order_acquire);
+
+    if(head - tail >= INSTRUMENTATION_RING_SIZE) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    threadRing->events[head & (INSTRUMENTATION_RING_SIZE - 1)] = { name, begin, end, threadRing->thread };
+    threadRing->head.store(head + 1, std::memory_order_release);
+}
+
+void Instrumentation::drain() {
+    // The mutex is held, drain is the only consumer
+    for(auto& threadRing : rings) {
+        unsigned int tail = threadRing->tail.load(std::memory_order_relaxed);
+        unsigned int head = threadRing->head.load(std::memory_order_acquire);
+        for(; tail != head; tail ++) events.push_back(threadRing->events[tail & (INSTRUMENTATION_RING_SIZE - 1)]);
+        threadRing->tail.store(head, std::memory_order_release);
+    }
+}
+
+void Instrumentation::frameMark() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    frame ++;
+
+    if(isCapturing()) {
+        drain();
+        frameMarks.push_back({ frame, now() });
+        if(-- framesToCapture == 0) capturing = false;
+    }
+    else if(framesToCapture > 0) {
+        // Zones left in the rings from a previous capture don't belong to this one
+        drain();
+        events.clear();
+        frameMarks.clear();
+        dropped = 0;
+
+        frameMarks.push_back({ frame, now() });
+        capturing = true;
+    }
+}
+
+void Instrumentation::captureFrames(unsigned int frames) {
+    std::lock_guard<std::mutex> lock(mutex);
+    capturing = false;
+    framesToCapture = frames;
+    events.clear();
+    frameMarks.clear();
+}
+
+void Instrumentation::stopCapture() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(isCapturing()) {
+        drain();
+        frameMarks.push_back({ frame, now() });
+    }
+    capturing = false;
+    framesToCapture = 0;
+}
+
+std::vector<Instrumentation::Event> Instrumentation::getEvents() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return events;
+}
+
+static void writeEscaped(std::ostream& stream, const char* text) {
+    for(; *text != '\0'; text ++) {
+        if(*text == '"' || *text == '\\') stream << '\\';
+        stream << *text;
+    }
+}
+
+std::string Instrumentation::toChromeTrace() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::ostringstream trace;
+    trace.precision(3);
+    trace << std::fixed;
+
+    // Timestamps are in microseconds
+    trace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    for(auto& mark : frameMarks) {
+        trace << (first ? "\n" : ",\n");
+        trace << "{\"name\":\"Frame " << mark.frame << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":" << mark.time / 1000.0 << "}";
+        first = false;
+    }
+
+    for(auto& event : events) {
+        trace << (first ? "\n" : ",\n");
+        trace << "{\"name\":\"";
+        writeEscaped(trace, event.name);
+        trace << "\",\"cat\":\"RendererGL\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+            << ",\"ts\":" << event.begin / 1000.0 << ",\"dur\":" << (event.end - event.begin) / 1000.0 << "}";
+        first = false;
+    }
+
+    trace << "\n]}\n";
+    return trace.str();
+}
+
+bool Instrumentation::writeChromeTrace(const std::string& path) {
+
+    std::ofstream file(path);
+    if(!file.is_open()) {
+        std::cout << "Couldn't write the trace " << path << std::endl;
+        return false;
+    }
+
+    file << toChromeTrace();
+    return true;
+}
\ No newline at end of file
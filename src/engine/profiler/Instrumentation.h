@@ -0,0 +1,101 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+#define INSTRUMENTATION_RING_SIZE 16384     // zones per thread, power of two
+
+/**
+ * @brief CPU zones of every thread, exported as Chrome trace events (chrome://tracing, Perfetto).
+ *
+ * Each thread writes the zones it closes into its own ring, a single producer single consumer
+ * queue, so recording takes no lock. Nothing is recorded unless a capture is running:
+ * captureFrames starts one on the next frame mark and the rings are drained into it on every
+ * frame mark until the frames are done. Zones that don't fit in a full ring are dropped.
+ *
+ * Zones are placed with RENDERERGL_ZONE("name"), the name must be a string literal. The macros
+ * compile to nothing when RENDERERGL_INSTRUMENTATION isn't defined.
+ */
+class Instrumentation {
+public:
+    struct Event {
+        const char* name;
+        uint64_t begin, end;        // ns
+        unsigned int thread;
+    };
+
+    struct FrameMark {
+        uint64_t frame;
+        uint64_t time;              // ns
+    };
+
+    class Zone {
+    private:
+        const char* name;
+        uint64_t begin;
+    public:
+        Zone(const char* _name);
+        ~Zone();
+    };
+private:
+    struct ThreadRing {
+        Event events[INSTRUMENTATION_RING_SIZE];
+        std::atomic<unsigned int> head, tail;      // written by the thread / by drain
+        unsigned int thread;
+    };
+private:
+    static std::mutex mutex;        // rings and capture
+    static std::vector<std::unique_ptr<ThreadRing>> rings;
+    static thread_local ThreadRing* ring;
+
+    static std::atomic<bool> capturing;
+    static std::atomic<unsigned int> dropped;
+    static uint64_t frame;
+    static unsigned int framesToCapture;
+
+    static std::vector<Event> events;
+    static std::vector<FrameMark> frameMarks;
+private:
+    static ThreadRing* getRing();
+    static void drain();
+    static void record(const char* name, uint64_t begin, uint64_t end);
+public:
+    /**
+     * @brief ns since the first call
+     */
+    static uint64_t now();
+
+    /**
+     * @brief Call it once per frame from the render thread, Renderer::render and Renderer::draw do it
+     */
+    static void frameMark();
+
+    /**
+     * @brief Captures the zones of the next frames, the previous capture is discarded
+     */
+    static void captureFrames(unsigned int frames);
+    static void stopCapture();
+
+    static std::string toChromeTrace();
+    static bool writeChromeTrace(const std::string& path);
+
+    static std::vector<Event> getEvents();
+public:
+    inline static bool isCapturing() { return capturing.load(std::memory_order_relaxed); }
+    inline static unsigned int getDroppedEvents() { return dropped.load(std::memory_order_relaxed); }
+};
+
+#ifdef RENDERERGL_INSTRUMENTATION
+#define RENDERERGL_CONCAT_IMPL(a, b) a##b
+#define RENDERERGL_CONCAT(a, b) RENDERERGL_CONCAT_IMPL(a, b)
+#define RENDERERGL_ZONE(name) Instrumentation::Zone RENDERERGL_CONCAT(rendererglZone, __LINE__)(name)
+#define RENDERERGL_FRAME_MARK() Instrumentation::frameMark()
+#else
+#define RENDERERGL_ZONE(name)
+#define RENDERERGL_FRAME_MARK()
+#endif
\ No newline at end of file
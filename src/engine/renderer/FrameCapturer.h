@@ -9,6 +9,7 @@
 #include "engine/opengl/buffer/FrameBuffer.h"
 #include "engine/opengl/buffer/MultiSampleRenderBuffer.h"
 #include "engine/texture/MultiSampleTexture.h"
+#include "engine/opengl/device/RenderDevice.h"
 
 class FrameCapturer {
     GENERATE_PTR(FrameCapturer)
@@ -73,15 +74,15 @@ public:
 
     void startCapturing() {
 
-        glDisable(GL_DEPTH_TEST);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        RenderDevice::get()->disable(GL_DEPTH_TEST);
+        RenderDevice::get()->enable(GL_BLEND);
+        RenderDevice::get()->blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        RenderDevice::get()->blendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
         frameBuffer->bind();
-        glClearColor(backgroundColor.r, backgroundColor.g, backgroundColor.b, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glEnable(GL_DEPTH_TEST);
+        RenderDevice::get()->clearColor(backgroundColor.r, backgroundColor.g, backgroundColor.b, 1.0f);
+        RenderDevice::get()->clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        RenderDevice::get()->enable(GL_DEPTH_TEST);
     }
 
     void finishCapturing() {
@@ -89,9 +90,9 @@ public:
         intermediateFrameBuffer->blitFrom(frameBuffer, width, height);
         intermediateFrameBuffer->unbind();
 
-        glClearColor(backgroundColor.r, backgroundColor.g, backgroundColor.b, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-        glDisable(GL_DEPTH_TEST);
+        RenderDevice::get()->clearColor(backgroundColor.r, backgroundColor.g, backgroundColor.b, 1.0f);
+        RenderDevice::get()->clear(GL_COLOR_BUFFER_BIT);
+        RenderDevice::get()->disable(GL_DEPTH_TEST);
     }
 
     void setBackgroundColor(float r, float g, float b) {
@@ -102,5 +103,9 @@ public:
 
     inline Texture::Ptr& getTexture() { return screenTexture; }
 
+    // Multisampled target of the frame and its depth and stencil (GL_DEPTH24_STENCIL8)
+    inline FrameBuffer::Ptr& getFrameBuffer() { return frameBuffer; }
+    inline MultiSampleRenderBuffer::Ptr& getDepthBuffer() { return rbo; }
+
     inline glm::vec3& getBackgroundColor() { return backgroundColor; }
 };
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "GBuffer.h"
+
+#include "engine/opengl/device/RenderDevice.h"
+
+GBuffer::GBuffer(unsigned int _width, unsigned int _height) 
+    : width(_width), height(_height) {
+
+    frameBuffer = FrameBuffer::New();
+
+    albedoTexture = ColorBufferTexture::New(width, height, GL_RGBA8);
+    normalTexture = ColorBufferTexture::New(width, height, GL_RGBA16F);
+    emissionTexture = ColorBufferTexture::New(width, height, GL_R11F_G11F_B10F);
+    depthTexture = DepthTexture::New(width, height);
+
+    frameBuffer->bind();
+    frameBuffer->toTexture(GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedoTexture->getID());
+    frameBuffer->toTexture(GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normalTexture->getID());
+    frameBuffer->toTexture(GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, emissionTexture->getID());
+    frameBuffer->toTexture(GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture->getID());
+
+    const GLenum attachments[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    RenderDevice::get()->drawBuffers(3, attachments);
+
+    if(!frameBuffer->isComplete()) std::cout << "G-buffer is not complete!" << std::endl;
+
+    frameBuffer->unbind();
+}
+
+void GBuffer::bind() {
+    frameBuffer->bind();
+}
+
+void GBuffer::unbind() {
+    frameBuffer->unbind();
+}
+
+void GBuffer::bindTextures(ShaderProgram::Ptr& shaderProgram) {
+
+    albedoTexture->bind();
+    shaderProgram->uniformInt("gAlbedo", albedoTexture->getSlot() - GL_TEXTURE0);
+
+    normalTexture->bind();
+    shaderProgram->uniformInt("gNormal", normalTexture->getSlot() - GL_TEXTURE0);
+
+    emissionTexture->bind();
+    shaderProgram->uniformInt("gEmission", emissionTexture->getSlot() - GL_TEXTURE0);
+
+    depthTexture->bind();
+    shaderProgram->uniformInt("gDepth", depthTexture->getSlot() - GL_TEXTURE0);
+}
+
+void GBuffer::unbindTextures() {
+    for(Texture* texture : { (Texture*)albedoTexture.get(), (Texture*)normalTexture.get(), (Texture*)emissionTexture.get(), (Texture*)depthTexture.get() }) {
+        RenderDevice::get()->activeTexture(texture->getSlot());
+        texture->unbind();
+    }
+}
\ No newline at end of file
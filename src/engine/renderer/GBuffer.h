@@ -0,0 +1,51 @@
+#pragma once
+
+#include <iostream>
+
+#include <GL/glew.h>
+
+#include "engine/opengl/buffer/FrameBuffer.h"
+#include "engine/opengl/shader/Shader.h"
+#include "engine/texture/ColorBufferTexture.h"
+#include "engine/texture/DepthTexture.h"
+
+#include "engine/ptr.h"
+
+/**
+ * @brief Render targets of the deferred shading geometry pass.
+ *
+ * Albedo and ambient occlusion (RGBA8), octahedral normal, metallic and roughness (RGBA16F),
+ * emission (R11F_G11F_B10F) and depth: 16 bytes per pixel. There is no position target,
+ * the lighting pass reconstructs it from the depth.
+ */
+class GBuffer {
+    GENERATE_PTR(GBuffer)
+private:
+    unsigned int width, height;
+
+    FrameBuffer::Ptr frameBuffer;
+    ColorBufferTexture::Ptr albedoTexture, normalTexture, emissionTexture;
+    DepthTexture::Ptr depthTexture;
+public:
+    GBuffer(unsigned int _width, unsigned int _height);
+    GBuffer() = default;
+    ~GBuffer() = default;
+public:
+    /**
+     * @brief Binds the frame buffer with its three color attachments as draw buffers
+     */
+    void bind();
+    void unbind();
+
+    /**
+     * @brief Binds the targets as textures and sets the gAlbedo, gNormal, gEmission and gDepth samplers
+     */
+    void bindTextures(ShaderProgram::Ptr& shaderProgram);
+    void unbindTextures();
+public:
+    inline unsigned int getWidth() const { return width; }
+    inline unsigned int getHeight() const { return height; }
+
+    inline FrameBuffer::Ptr& getFrameBuffer() { return frameBuffer; }
+    inline DepthTexture::Ptr& getDepthTexture() { return depthTexture; }
+};
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "GPUCulling.h"
+
+#include "engine/opengl/device/RenderDevice.h"
+
+#include <algorithm>
+
+GPUCulling::GPUCulling()
+    : drawBufferID(0), countBufferID(0), drawCapacity(0), drawOffset(0), batchCapacity(CULLING_BATCH_CAPACITY), batches(0),
+    submittedDraws(0), viewProjection(1.f), previousViewProjection(1.f), occlusion(true), compaction(false),
+    depthFrameBuffer(nullptr), pyramidFrameBuffer(nullptr), depthTexture(nullptr), depthSamples(nullptr), depthFormat(GL_NONE), samples(0),
+    depthPyramid(nullptr), pyramidReady(false) {
+
+    Shader computeShader = Shader::fromFile("glsl/GPUCulling.comp", Shader::ShaderType::Compute);
+    shaderProgramCulling = ShaderProgram::New(computeShader);
+
+    // Same vertex shader as the deferred lighting, a quad over the screen
+    Shader vertexPyramidShader = Shader::fromFile("glsl/HDR.vert", Shader::ShaderType::Vertex);
+    Shader fragmentPyramidShader = Shader::fromFile("glsl/DepthPyramid.frag", Shader::ShaderType::Fragment);
+    shaderProgramPyramid = ShaderProgram::New(vertexPyramidShader, fragmentPyramidShader);
+
+    Shader fragmentResolveShader = Shader::fromFile("glsl/DepthResolve.frag", Shader::ShaderType::Fragment);
+    shaderProgramResolve = ShaderProgram::New(vertexPyramidShader, fragmentResolveShader);
+
+    compaction = RenderDevice::get()->isSupported(RenderDevice::INDIRECT_COUNT);
+
+    RenderDevice::get()->genBuffers(1, &drawBufferID);
+    RenderDevice::get()->genBuffers(1, &countBufferID);
+    reserveDraws(CULLING_DRAW_CAPACITY);
+    orphanCounts();
+}
+
+GPUCulling::~GPUCulling() {
+    RenderDevice::get()->deleteBuffers(1, &drawBufferID);
+    RenderDevice::get()->deleteBuffers(1, &countBufferID);
+}
+
+bool GPUCulling::isSupported() {
+    return RenderDevice::get()->isSupported(RenderDevice::COMPUTE_SHADER) && RenderDevice::get()->isSupported(RenderDevice::MULTI_DRAW_INDIRECT);
+}
+
+void GPUCulling::reserveDraws(unsigned int count) {
+    if(count <= drawCapacity) return;
+    drawCapacity = std::max(drawCapacity * 2, count);
+    orphanDraws();
+}
+
+void GPUCulling::orphanDraws() {
+    RenderDevice::get()->bindBuffer(GL_SHADER_STORAGE_BUFFER, drawBufferID);
+    RenderDevice::get()->bufferData(GL_SHADER_STORAGE_BUFFER, drawCapacity * sizeof(Draw), nullptr, GL_STREAM_DRAW);
+    RenderDevice::get()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    drawOffset = 0;
+}
+
+void GPUCulling::orphanCounts() {
+
+    // The shader counts from 0
+    std::vector<unsigned int> zeros(batchCapacity, 0);
+    RenderDevice::get()->bindBuffer(GL_SHADER_STORAGE_BUFFER, countBufferID);
+    RenderDevice::get()->bufferData(GL_SHADER_STORAGE_BUFFER, batchCapacity * sizeof(unsigned int), zeros.data(), GL_STREAM_DRAW);
+    RenderDevice::get()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    batches = 0;
+}
+
+void GPUCulling::beginFrame(const glm::mat4& viewProjection) {
+
+    // Room for the batches of the last frame
+    if(batches * 2 > batchCapacity) batchCapacity = batches * 2;
+    orphanCounts();
+    orphanDraws();
+
+    this->viewProjection = viewProjection;
+    submittedDraws = 0;
+}
+
+void GPUCulling::cull(const std::vector<Draw>& draws, unsigned int modelBufferID, unsigned int indirectBufferID, unsigned int firstCommand, bool ordered) {
+
+    unsigned int count = draws.size();
+    if(count == 0) return;
+
+    reserveDraws(count);
+    if(drawOffset + count > drawCapacity) orphanDraws();
+
+    // The counts of the frame so far are lost, only the statistics read them
+    if(batches == batchCapacity) {
+        batchCapacity *= 2;
+        orphanCounts();
+    }
+
+    RenderDevice::get()->bindBuffer(GL_SHADER_STORAGE_BUFFER, drawBufferID);
+    RenderDevice::get()->bufferSubData(GL_SHADER_STORAGE_BUFFER, drawOffset * sizeof(Draw), count * sizeof(Draw), draws.data());
+    RenderDevice::get()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    RenderStats::countUpload(count * sizeof(Draw));
+
+    bool compact = compaction && !ordered;
+    bool tested = occlusion && pyramidReady;
+
+    shaderProgramCulling->useProgram();
+    shaderProgramCulling->uniformInt("drawCount", count);
+    shaderProgramCulling->uniformInt("firstDraw", drawOffset);
+    shaderProgramCulling->uniformInt("firstCommand", firstCommand);
+    shaderProgramCulling->uniformInt("batch", batches);
+    shaderProgramCulling->uniformInt("compaction", compact);
+    shaderProgramCulling->uniformMat4("viewProjection", viewProjection);
+    shaderProgramCulling->uniformInt("occlusion", tested);
+    if(tested) {
+        depthPyramid->bind();
+        shaderProgramCulling->uniformInt("depthPyramid", depthPyramid->getUnit());
+        shaderProgramCulling->uniformInt("pyramidLevels", depthPyramid->getLevels());
+        shaderProgramCulling->uniformMat4("previousViewProjection", previousViewProjection);
+    }
+
+    RenderDevice::get()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, drawBufferID);
+    RenderDevice::get()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, modelBufferID);
+    RenderDevice::get()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, indirectBufferID);
+    RenderDevice::get()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, countBufferID);
+
+    RenderDevice::get()->dispatchCompute((count + CULLING_GROUP_SIZE - 1) / CULLING_GROUP_SIZE, 1, 1);
+
+    // The commands and their count are read by the draw
+    RenderDevice::get()->memoryBarrier(GL_COMMAND_BARRIER_BIT);
+}
+
+void GPUCulling::drawVisible(unsigned int primitive, unsigned int count, unsigned int firstCommand, bool ordered) {
+
+    if(count == 0) return;
+
+    void* offset = (void*)(firstCommand * sizeof(GeometryArena::DrawElementsIndirectCommand));
+    if(compaction && !ordered) {
+        RenderDevice::get()->bindBuffer(GL_PARAMETER_BUFFER, countBufferID);
+        RenderDevice::get()->multiDrawElementsIndirectCount(primitive, GL_UNSIGNED_INT, offset, batches * sizeof(unsigned int), count, 0);
+        RenderDevice::get()->bindBuffer(GL_PARAMETER_BUFFER, 0);
+    }
+    else RenderDevice::get()->multiDrawElementsIndirect(primitive, GL_UNSIGNED_INT, offset, count, 0);
+
+    drawOffset += count;
+    batches ++;
+    submittedDraws += count;
+}
+
+void GPUCulling::allocatePyramid(unsigned int width, unsigned int height, GLenum depthFormat, unsigned int samples) {
+
+    this->depthFormat = depthFormat;
+    this->samples = samples;
+
+    // The blit copies a multisampled depth to as many samples only
+    depthFrameBuffer = FrameBuffer::New();
+    GLenum attachment = depthFormat == GL_DEPTH24_STENCIL8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+    if(samples > 1) {
+        depthTexture = nullptr;
+        depthSamples = MultiSampleTexture::New(width, height, samples, depthFormat);
+        depthFrameBuffer->toTexture(attachment, GL_TEXTURE_2D_MULTISAMPLE, depthSamples->getID());
+    }
+    else {
+        depthSamples = nullptr;
+        depthTexture = DepthTexture::New(width, height, depthFormat);
+        depthFrameBuffer->toTexture(attachment, GL_TEXTURE_2D, depthTexture->getID());
+    }
+    RenderDevice::get()->drawBuffer(GL_NONE);
+    RenderDevice::get()->readBuffer(GL_NONE);
+    if(!depthFrameBuffer->isComplete()) std::cout << "Depth copy framebuffer not complete!" << std::endl;
+
+    depthPyramid = DepthPyramidTexture::New(width, height);
+    pyramidFrameBuffer = FrameBuffer::New();
+    pyramidFrameBuffer->toTexture(GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, depthPyramid->getID());
+    if(!pyramidFrameBuffer->isComplete()) std::cout << "Depth pyramid framebuffer not complete!" << std::endl;
+
+    pyramidFrameBuffer->unbind();
+}
+
+void GPUCulling::buildDepthPyramid(unsigned int frameBufferID, GLenum depthFormat, unsigned int samples, unsigned int width, unsigned int height,
+    VertexArray::Ptr& quad) {
+
+    if(depthPyramid == nullptr || depthPyramid->getWidth() != (int)width || depthPyramid->getHeight() != (int)height ||
+        this->depthFormat != depthFormat || this->samples != samples)
+        allocatePyramid(width, height, depthFormat, samples);
+
+    // Copy of the depth
+    RenderDevice::get()->bindFramebuffer(GL_READ_FRAMEBUFFER, frameBufferID);
+    RenderDevice::get()->bindFramebuffer(GL_DRAW_FRAMEBUFFER, depthFrameBuffer->getID());
+    RenderDevice::get()->blitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    RenderDevice::get()->disable(GL_DEPTH_TEST);
+    RenderDevice::get()->disable(GL_BLEND);
+    RenderDevice::get()->disable(GL_CULL_FACE);
+    RenderDevice::get()->polygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    pyramidFrameBuffer->bind();
+    quad->bind();
+
+    // Level 0: the farthest sample of every pixel
+    RenderDevice::get()->framebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, depthPyramid->getID(), 0);
+    RenderDevice::get()->viewport(0, 0, width, height);
+    if(depthSamples != nullptr) {
+        shaderProgramResolve->useProgram();
+        depthSamples->bind();
+        shaderProgramResolve->uniformInt("depthSamples", depthSamples->getUnit());
+        shaderProgramResolve->uniformInt("samples", samples);
+    }
+    else {
+        shaderProgramPyramid->useProgram();
+        depthTexture->bind();
+        shaderProgramPyramid->uniformInt("depthTexture", depthTexture->getUnit());
+        shaderProgramPyramid->uniformInt("firstLevel", true);
+    }
+    RenderDevice::get()->drawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    RenderStats::countDraw(GL_TRIANGLE_STRIP, 4);
+
+    // Every level reads the one below, the only one the sampler sees
+    shaderProgramPyramid->useProgram();
+    depthPyramid->bind();
+    shaderProgramPyramid->uniformInt("depthPyramid", depthPyramid->getUnit());
+    shaderProgramPyramid->uniformInt("firstLevel", false);
+    for(int level = 1; level < depthPyramid->getLevels(); level ++) {
+        RenderDevice::get()->framebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, depthPyramid->getID(), level);
+        RenderDevice::get()->viewport(0, 0, DepthPyramidTexture::getLevelSize(width, level), DepthPyramidTexture::getLevelSize(height, level));
+        depthPyramid->setLevelRange(level - 1, level - 1);
+
+        RenderDevice::get()->drawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        RenderStats::countDraw(GL_TRIANGLE_STRIP, 4);
+    }
+    quad->unbind();
+    depthPyramid->setLevelRange(0, depthPyramid->getLevels() - 1);
+
+    RenderDevice::get()->bindFramebuffer(GL_FRAMEBUFFER, frameBufferID);
+    RenderDevice::get()->viewport(0, 0, width, height);
+    RenderDevice::get()->enable(GL_DEPTH_TEST);
+    RenderDevice::get()->enable(GL_BLEND);
+
+    previousViewProjection = viewProjection;
+    pyramidReady = true;
+}
+
+unsigned int GPUCulling::readVisibleDraws() {
+
+    // The counts were written by the shader atomics
+    RenderDevice::get()->memoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    unsigned int visible = 0;
+    RenderDevice::get()->bindBuffer(GL_SHADER_STORAGE_BUFFER, countBufferID);
+    const unsigned int* counts = (const unsigned int*)RenderDevice::get()->mapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, batches * sizeof(unsigned int), GL_MAP_READ_BIT);
+    if(counts != nullptr) {
+        for(unsigned int i = 0; i < batches; i ++) visible += counts[i];
+        RenderDevice::get()->unmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    }
+    RenderDevice::get()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    return visible;
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "engine/opengl/shader/Shader.h"
+#include "engine/opengl/buffer/FrameBuffer.h"
+#include "engine/opengl/buffer/VertexArray.h"
+#include "engine/texture/DepthTexture.h"
+#include "engine/texture/MultiSampleTexture.h"
+#include "engine/texture/DepthPyramidTexture.h"
+
+#include "GeometryArena.h"
+
+#include "engine/ptr.h"
+
+// Same value in GPUCulling.comp
+#define CULLING_GROUP_SIZE 64
+
+#define CULLING_DRAW_CAPACITY 1024
+#define CULLING_BATCH_CAPACITY 256
+
+/**
+ * @brief Frustum and occlusion culling of the geometry arena draws in a compute shader (GL 4.3).
+ *
+ * The bounds and the indirect command of every draw of a batch go into a storage buffer, the
+ * model matrices are the ones of the arena. The shader tests the world box of each draw against
+ * the planes of the camera and against the depth pyramid of the previous frame, projected with
+ * the camera of that frame, and writes the commands of the visible draws to the indirect buffer.
+ * With GL 4.6 or ARB_indirect_parameters they're compacted and their count stays in a GPU
+ * buffer for glMultiDrawElementsIndirectCount. Blended batches keep their order instead: the
+ * hidden draws get 0 instances, and so does every batch without indirect counts.
+ *
+ * A draw hidden in the previous frame which comes into view is drawn a frame late. The pyramid
+ * is made of every depth of the frame, the transparent polytopes write them too.
+ */
+class GPUCulling {
+    GENERATE_PTR(GPUCulling)
+public:
+    // A draw of the batch, std430 layout of GPUCulling.comp
+    struct Draw {
+        glm::vec4 boundsMin, boundsMax;     // object space, w unused
+        GeometryArena::DrawElementsIndirectCommand command;
+        unsigned int padding[3];
+    };
+private:
+    ShaderProgram::Ptr shaderProgramCulling;
+    ShaderProgram::Ptr shaderProgramPyramid;
+    ShaderProgram::Ptr shaderProgramResolve;
+
+    // Draws of this frame and the visible count of every batch
+    unsigned int drawBufferID, countBufferID;
+    unsigned int drawCapacity, drawOffset;
+    unsigned int batchCapacity, batches;
+    unsigned int submittedDraws;
+
+    glm::mat4 viewProjection, previousViewProjection;
+    bool occlusion;
+    bool compaction;
+
+    // Depths of the last frame, copied from the frame buffer and reduced. A multisampled one is copied with its samples
+    FrameBuffer::Ptr depthFrameBuffer, pyramidFrameBuffer;
+    DepthTexture::Ptr depthTexture;
+    MultiSampleTexture::Ptr depthSamples;
+    GLenum depthFormat;
+    unsigned int samples;
+    DepthPyramidTexture::Ptr depthPyramid;
+    bool pyramidReady;
+public:
+    GPUCulling();
+    ~GPUCulling();
+private:
+    void reserveDraws(unsigned int count);
+    void orphanDraws();
+    void orphanCounts();
+    void allocatePyramid(unsigned int width, unsigned int height, GLenum depthFormat, unsigned int samples);
+public:
+    static bool isSupported();
+
+    /**
+     * @brief Starts a new frame seen through viewProjection, the per frame buffers are orphaned
+     */
+    void beginFrame(const glm::mat4& viewProjection);
+
+    /**
+     * @brief Writes the commands of the visible draws to indirectBuffer from firstCommand, the model of a draw
+     * is at its baseInstance in modelBuffer. Ordered batches aren't compacted. The culling program stays bound
+     */
+    void cull(const std::vector<Draw>& draws, unsigned int modelBufferID, unsigned int indirectBufferID, unsigned int firstCommand, bool ordered);
+
+    /**
+     * @brief Draws the commands of the last cull, the indirect buffer and the VAO must be bound
+     */
+    void drawVisible(unsigned int primitive, unsigned int count, unsigned int firstCommand, bool ordered);
+
+    /**
+     * @brief Copies the depth of the frame buffer and reduces it to the pyramid the next frame is tested against,
+     * the farthest sample of a multisampled one. depthFormat and samples are the ones of its depth attachment, the
+     * copy needs the same. The frame buffer is bound again at the end, the quad is the one of HDR.vert
+     */
+    void buildDepthPyramid(unsigned int frameBufferID, GLenum depthFormat, unsigned int samples, unsigned int width, unsigned int height,
+        VertexArray::Ptr& quad);
+
+    /**
+     * @brief Visible draws of the last frame, read back from the GPU: it waits for the frame to finish
+     */
+    unsigned int readVisibleDraws();
+
+    /**
+     * @brief The next frame is only frustum culled, for a cut in the camera
+     */
+    inline void invalidate() { pyramidReady = false; }
+public:
+    // Draws submitted to the culling this frame
+    inline unsigned int getSubmittedDraws() const { return submittedDraws; }
+
+    // Off: frustum culling only
+    inline void setOcclusion(bool occlusion) { this->occlusion = occlusion; }
+    inline bool isOcclusion() const { return occlusion; }
+
+    // Compacted commands and glMultiDrawElementsIndirectCount, when the GL has it
+    inline bool isCompaction() const { return compaction; }
+
+    inline DepthPyramidTexture::Ptr& getDepthPyramid() { return depthPyramid; }
+};
\ No newline at end of file
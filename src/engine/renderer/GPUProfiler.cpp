@@ -0,0 +1,162 @@
+#include "GPUProfiler.h"
+
+#include "engine/opengl/device/RenderDevice.h"
+
+GPUProfiler::ScopeGuard::ScopeGuard(GPUProfiler* _profiler, const std::string& name)
+    : profiler(_profiler) {
+    if(profiler != nullptr) profiler->beginScope(name);
+}
+
+GPUProfiler::ScopeGuard::ScopeGuard(const GPUProfiler::Ptr& _profiler, const std::string& name)
+    : ScopeGuard(_profiler.get(), name) {
+}
+
+GPUProfiler::ScopeGuard::~ScopeGuard() {
+    if(profiler != nullptr) profiler->endScope();
+}
+
+GPUProfiler::GPUProfiler(float _smoothing)
+    : frameIndex(0), started(false), smoothing(_smoothing), droppedFrames(0), enabled(true) {
+
+    supported = isSupported();
+    if(!supported) std::cout << "Timer queries are not supported, GPU times won't be measured" << std::endl;
+
+    for(auto& frame : frames) {
+        frame.used = 0;
+        frame.pending = false;
+    }
+}
+
+GPUProfiler::~GPUProfiler() {
+    for(auto& frame : frames)
+        if(!frame.queries.empty()) RenderDevice::get()->deleteQueries(frame.queries.size(), &frame.queries[0]);
+}
+
+bool GPUProfiler::isSupported() {
+    return RenderDevice::get()->isSupported(RenderDevice::TIMER_QUERY);
+}
+
+unsigned int GPUProfiler::newQuery(FrameQueries& frame) {
+    if(frame.used == frame.queries.size()) {
+        unsigned int query;
+        RenderDevice::get()->genQueries(1, &query);
+        frame.queries.push_back(query);
+    }
+    return frame.used ++;
+}
+
+bool GPUProfiler::isAvailable(const FrameQueries& frame) const {
+    // Queries finish in order, the last one is enough
+    int available = 0;
+    RenderDevice::get()->getQueryObjectiv(frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    return available != 0;
+}
+
+void GPUProfiler::readFrame(FrameQueries& frame) {
+
+    scopes.clear();
+    std::map<std::string, unsigned int> indices;
+
+    for(auto& record : frame.records) {
+        GLuint64 begin = 0, end = 0;
+        RenderDevice::get()->getQueryObjectui64v(frame.queries[record.begin], GL_QUERY_RESULT, &begin);
+        RenderDevice::get()->getQueryObjectui64v(frame.queries[record.end], GL_QUERY_RESULT, &end);
+        double time = end > begin ? (end - begin) / 1e6 : 0.0;
+
+        // A scope that began several times in the frame adds up
+        auto it = indices.find(record.name);
+        if(it != indices.end()) scopes[it->second].time += time;
+        else {
+            indices[record.name] = scopes.size();
+            scopes.push_back({ record.name, record.depth, time, time });
+        }
+    }
+
+    for(auto& scope : scopes) {
+        auto it = averages.find(scope.name);
+        if(it != averages.end()) it->second += (scope.time - it->second) * smoothing;
+        else averages[scope.name] = scope.time;
+        scope.average = averages[scope.name];
+    }
+
+    frame.pending = false;
+}
+
+void GPUProfiler::collect() {
+    // From the oldest frame to the newest, stopping at the first one not available yet
+    for(unsigned int i = 1; i < GPU_PROFILER_FRAMES; i ++) {
+        FrameQueries& frame = frames[(frameIndex + i) % GPU_PROFILER_FRAMES];
+        if(!frame.pending) continue;
+        if(!isAvailable(frame)) break;
+        readFrame(frame);
+    }
+}
+
+void GPUProfiler::beginFrame() {
+
+    if(!enabled || !supported) {
+        started = false;
+        return;
+    }
+
+    if(started) endFrame();
+
+    frameIndex = (frameIndex + 1) % GPU_PROFILER_FRAMES;
+    FrameQueries& frame = frames[frameIndex];
+
+    // Its queries are reused now, whatever wasn't available is lost
+    if(frame.pending) droppedFrames ++;
+
+    frame.used = 0;
+    frame.records.clear();
+    frame.pending = false;
+    stack.clear();
+    started = true;
+}
+
+void GPUProfiler::endFrame() {
+
+    if(!started) return;
+
+    while(!stack.empty()) endScope();
+
+    FrameQueries& frame = frames[frameIndex];
+    frame.pending = !frame.records.empty();
+
+    collect();
+}
+
+void GPUProfiler::beginScope(const std::string& name) {
+
+    if(!started) return;
+
+    FrameQueries& frame = frames[frameIndex];
+
+    std::string path = stack.empty() ? name : frame.records[stack.back()].name + "/" + name;
+    Record record = { path, (unsigned int)stack.size(), newQuery(frame), 0 };
+    RenderDevice::get()->queryCounter(frame.queries[record.begin], GL_TIMESTAMP);
+
+    stack.push_back(frame.records.size());
+    frame.records.push_back(record);
+
+    // A frame being recorded again can't be read
+    frame.pending = false;
+}
+
+void GPUProfiler::endScope() {
+
+    if(!started || stack.empty()) return;
+
+    FrameQueries& frame = frames[frameIndex];
+
+    Record& record = frame.records[stack.back()];
+    record.end = newQuery(frame);
+    RenderDevice::get()->queryCounter(frame.queries[record.end], GL_TIMESTAMP);
+
+    stack.pop_back();
+}
+
+double GPUProfiler::getTime(const std::string& name) const {
+    auto it = averages.find(name);
+    return it != averages.end() ? it->second : 0.0;
+}
\ No newline at end of file
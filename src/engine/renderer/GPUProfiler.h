@@ -0,0 +1,105 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+
+#include <GL/glew.h>
+
+#include "engine/ptr.h"
+
+#define GPU_PROFILER_FRAMES 4           // frames of queries in flight
+#define GPU_PROFILER_SMOOTHING 0.1f     // weight of a new time in the averages
+
+/**
+ * @brief GPU time of the render passes and of user scopes, measured with timestamp queries.
+ *
+ * Every scope writes a GL_TIMESTAMP when it begins and another one when it ends, so scopes can
+ * be nested (GL_TIME_ELAPSED queries can't). The queries of a frame are only read once the GPU
+ * has them available, up to GPU_PROFILER_FRAMES - 1 frames later, so the CPU never waits on them;
+ * a frame still not available when its queries are needed again is dropped.
+ *
+ * Scopes are named by their path ("Scene/Terrain") and their times smoothed with an exponential
+ * moving average. Scopes opened between two beginFrame calls belong to the first of them.
+ */
+class GPUProfiler {
+    GENERATE_PTR(GPUProfiler)
+public:
+    struct Scope {
+        std::string name;       // path, parents separated by '/'
+        unsigned int depth;
+        double time;            // ms, last frame read
+        double average;         // ms, smoothed
+    };
+
+    // Begins a scope on construction and ends it on destruction
+    class ScopeGuard {
+    private:
+        GPUProfiler* profiler;
+    public:
+        ScopeGuard(GPUProfiler* _profiler, const std::string& name);
+        ScopeGuard(const GPUProfiler::Ptr& _profiler, const std::string& name);
+        ~ScopeGuard();
+    };
+private:
+    struct Record {
+        std::string name;
+        unsigned int depth;
+        unsigned int begin, end;        // indices of the queries of the frame
+    };
+
+    struct FrameQueries {
+        std::vector<unsigned int> queries;
+        unsigned int used;
+        std::vector<Record> records;
+        bool pending;
+    };
+private:
+    FrameQueries frames[GPU_PROFILER_FRAMES];
+    unsigned int frameIndex;
+    bool started;
+    std::vector<unsigned int> stack;    // open records of the current frame
+
+    std::vector<Scope> scopes;
+    std::map<std::string, double> averages;
+    float smoothing;
+    unsigned int droppedFrames;
+
+    bool enabled, supported;
+public:
+    GPUProfiler(float _smoothing = GPU_PROFILER_SMOOTHING);
+    ~GPUProfiler();
+private:
+    unsigned int newQuery(FrameQueries& frame);
+    bool isAvailable(const FrameQueries& frame) const;
+    void readFrame(FrameQueries& frame);
+    void collect();
+public:
+    void beginFrame();
+    void endFrame();
+
+    void beginScope(const std::string& name);
+    void endScope();
+
+    /**
+     * @brief Smoothed time of a scope in ms, 0 if it hasn't been measured
+     */
+    double getTime(const std::string& name) const;
+
+    /**
+     * @brief Timer queries are core since GL 3.3, Mesa llvmpipe has them too
+     */
+    static bool isSupported();
+public:
+    // Scopes of the last frame read, in the order they began
+    inline const std::vector<Scope>& getScopes() const { return scopes; }
+
+    inline void setSmoothing(float smoothing) { this->smoothing = smoothing; }
+    inline float getSmoothing() const { return smoothing; }
+
+    inline void setEnabled(bool enabled) { this->enabled = enabled; }
+    inline bool isEnabled() const { return enabled; }
+
+    inline unsigned int getDroppedFrames() const { return droppedFrames; }
+};
\ No newline at end of file
@@ -0,0 +1,280 @@
+#include "GeometryArena.h"
+
+#include "GPUCulling.h"
+
+#include "engine/opengl/device/RenderDevice.h"
+
+#include <algorithm>
+
+#define VERTEX_SIZE (17 * sizeof(float))
+
+GeometryArena::GeometryArena(unsigned int vertexCapacity, unsigned int indexCapacity)
+    : vertexAllocator(vertexCapacity), indexAllocator(indexCapacity),
+    modelBufferID(0), indirectBufferID(0), drawCapacity(0), drawOffset(0), drawCalls(0) {
+
+    // The VAO keeps the vertex format, the index buffer and the per draw model matrices
+    vertexArray = VertexArray::New();
+    vertexBuffer = VertexBuffer::New(vertexCapacity);
+    indexBuffer = IndexBuffer::New(indexCapacity);
+
+    RenderDevice::get()->genBuffers(1, &modelBufferID);
+    RenderDevice::get()->genBuffers(1, &indirectBufferID);
+    reserveDraws(ARENA_DRAW_CAPACITY);
+
+    // mat4 attribute takes four consecutive locations
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, modelBufferID);
+    for(int i = 0; i < 4; i ++) {
+        RenderDevice::get()->enableVertexAttribArray(ARENA_MODEL_ATTRIBUTE + i);
+        RenderDevice::get()->vertexAttribPointer(ARENA_MODEL_ATTRIBUTE + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(i * sizeof(glm::vec4)));
+        RenderDevice::get()->vertexAttribDivisor(ARENA_MODEL_ATTRIBUTE + i, 1);
+    }
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    vertexArray->unbind();
+}
+
+GeometryArena::~GeometryArena() {
+    RenderDevice::get()->deleteBuffers(1, &modelBufferID);
+    RenderDevice::get()->deleteBuffers(1, &indirectBufferID);
+}
+
+bool GeometryArena::isSupported() {
+    return RenderDevice::get()->isSupported(RenderDevice::MULTI_DRAW_INDIRECT);
+}
+
+void GeometryArena::growVertices(unsigned int minCapacity) {
+
+    unsigned int capacity = std::max(vertexAllocator.getCapacity() * 2, minCapacity);
+
+    // New VBO gets attached to the arena VAO by its vertex attributes
+    vertexArray->bind();
+    VertexBuffer::Ptr newVertexBuffer = VertexBuffer::New(capacity);
+    vertexArray->unbind();
+
+    RenderDevice::get()->bindBuffer(GL_COPY_READ_BUFFER, vertexBuffer->getID());
+    RenderDevice::get()->bindBuffer(GL_COPY_WRITE_BUFFER, newVertexBuffer->getID());
+    RenderDevice::get()->copyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, vertexBuffer->getOffset(), newVertexBuffer->getOffset(), vertexAllocator.getCapacity() * VERTEX_SIZE);
+    RenderDevice::get()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+    RenderDevice::get()->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    vertexBuffer = newVertexBuffer;
+    vertexAllocator.grow(capacity);
+}
+
+void GeometryArena::growIndices(unsigned int minCapacity) {
+
+    unsigned int capacity = std::max(indexAllocator.getCapacity() * 2, minCapacity);
+
+    // Unbind the VAO before the old buffer is released, its destructor
+    // would detach the element buffer from the VAO otherwise
+    vertexArray->bind();
+    IndexBuffer::Ptr newIndexBuffer = IndexBuffer::New(capacity);
+    vertexArray->unbind();
+
+    RenderDevice::get()->bindBuffer(GL_COPY_READ_BUFFER, indexBuffer->getID());
+    RenderDevice::get()->bindBuffer(GL_COPY_WRITE_BUFFER, newIndexBuffer->getID());
+    RenderDevice::get()->copyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, indexBuffer->getOffset(), newIndexBuffer->getOffset(), indexAllocator.getCapacity() * sizeof(unsigned int));
+    RenderDevice::get()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+    RenderDevice::get()->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    indexBuffer = newIndexBuffer;
+    indexAllocator.grow(capacity);
+}
+
+void GeometryArena::reserveDraws(unsigned int count) {
+    if(count <= drawCapacity) return;
+    drawCapacity = std::max(drawCapacity * 2, count);
+    orphanDraws();
+}
+
+void GeometryArena::orphanDraws() {
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, modelBufferID);
+    RenderDevice::get()->bufferData(GL_ARRAY_BUFFER, drawCapacity * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    RenderDevice::get()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBufferID);
+    RenderDevice::get()->bufferData(GL_DRAW_INDIRECT_BUFFER, drawCapacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW);
+    RenderDevice::get()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    // Draws already submitted keep the old storage
+    drawOffset = 0;
+}
+
+bool GeometryArena::contains(const Polytope::Ptr& polytope) const {
+    auto it = ranges.find(polytope.get());
+    return it != ranges.end() && !it->second.owner.expired();
+}
+
+bool GeometryArena::add(const Polytope::Ptr& polytope) {
+
+    // Also the range of a destroyed polytope that had the same address
+    auto it = ranges.find(polytope.get());
+    if(it != ranges.end()) release(it);
+
+    unsigned int vertexCount = polytope->getVertexLength();
+    unsigned int indexCount = polytope->getIndicesLength();
+    bool indexed = indexCount > 0 && polytope->getIndexBuffer() != nullptr;
+    if(!indexed) indexCount = vertexCount;
+    if(vertexCount == 0) return false;
+
+    Range range = { 0, vertexCount, 0, indexCount };
+    range.baseVertex = vertexAllocator.allocate(vertexCount);
+    if(range.baseVertex == TLSFAllocator::INVALID_OFFSET) {
+        growVertices(vertexAllocator.getCapacity() + vertexCount);
+        range.baseVertex = vertexAllocator.allocate(vertexCount);
+    }
+    range.firstIndex = indexAllocator.allocate(indexCount);
+    if(range.firstIndex == TLSFAllocator::INVALID_OFFSET) {
+        growIndices(indexAllocator.getCapacity() + indexCount);
+        range.firstIndex = indexAllocator.allocate(indexCount);
+    }
+
+    // Vertices are copied in the GPU, the layout is the same
+    VertexBuffer::Ptr& source = polytope->getVertexBuffer();
+    RenderDevice::get()->bindBuffer(GL_COPY_READ_BUFFER, source->getID());
+    RenderDevice::get()->bindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer->getID());
+    RenderDevice::get()->copyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, source->getOffset(), 
+        vertexBuffer->getOffset() + range.baseVertex * VERTEX_SIZE, vertexCount * VERTEX_SIZE);
+
+    // Indices are relative to the polytope, baseVertex does the rest
+    size_t indexOffset = indexBuffer->getOffset() + range.firstIndex * sizeof(unsigned int);
+    if(indexed) {
+        RenderDevice::get()->bindBuffer(GL_COPY_READ_BUFFER, polytope->getIndexBuffer()->getID());
+        RenderDevice::get()->bindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer->getID());
+        RenderDevice::get()->copyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, polytope->getIndexBuffer()->getOffset(), indexOffset, indexCount * sizeof(unsigned int));
+    }
+    else {
+        std::vector<unsigned int> indices(indexCount);
+        for(unsigned int i = 0; i < indexCount; i ++) indices[i] = i;
+        RenderDevice::get()->bindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer->getID());
+        RenderDevice::get()->bufferSubData(GL_COPY_WRITE_BUFFER, indexOffset, indexCount * sizeof(unsigned int), indices.data());
+        RenderStats::countUpload(indexCount * sizeof(unsigned int));
+    }
+
+    RenderDevice::get()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+    RenderDevice::get()->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    ranges[polytope.get()] = { polytope, range };
+    return true;
+}
+
+void GeometryArena::add(const Group::Ptr& group) {
+    for(auto& polytope : group->getDrawPolytopes()) add(polytope);
+}
+
+std::unordered_map<const Polytope*, GeometryArena::Entry>::iterator GeometryArena::release(std::unordered_map<const Polytope*, Entry>::iterator it) {
+    vertexAllocator.free(it->second.range.baseVertex);
+    indexAllocator.free(it->second.range.firstIndex);
+    return ranges.erase(it);
+}
+
+void GeometryArena::remove(const Polytope::Ptr& polytope) {
+    auto it = ranges.find(polytope.get());
+    if(it != ranges.end()) release(it);
+}
+
+void GeometryArena::remove(const Group::Ptr& group) {
+    for(auto& polytope : group->getDrawPolytopes()) remove(polytope);
+}
+
+void GeometryArena::clear() {
+    ranges.clear();
+    vertexAllocator.reset();
+    indexAllocator.reset();
+}
+
+void GeometryArena::beginFrame() {
+    orphanDraws();
+    drawCalls = 0;
+
+    for(auto it = ranges.begin(); it != ranges.end();) {
+        if(it->second.owner.expired()) it = release(it);
+        else ++it;
+    }
+}
+
+unsigned int GeometryArena::prepareDraws(const std::vector<Polytope::Ptr>& polytopes, const std::vector<glm::mat4>& models,
+    std::vector<DrawElementsIndirectCommand>& commands) {
+
+    unsigned int count = polytopes.size();
+    reserveDraws(count);
+    if(drawOffset + count > drawCapacity) orphanDraws();
+
+    // baseInstance selects the model matrix of each command
+    unsigned int indexBase = indexBuffer->getOffset() / sizeof(unsigned int);
+    unsigned int indexCount = 0;
+    commands.resize(count);
+    for(unsigned int i = 0; i < count; i ++) {
+        const Range& range = ranges[polytopes[i].get()].range;
+        commands[i] = { range.indexCount, 1, indexBase + range.firstIndex, (int)range.baseVertex, drawOffset + i };
+        indexCount += range.indexCount;
+    }
+
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, modelBufferID);
+    RenderDevice::get()->bufferSubData(GL_ARRAY_BUFFER, drawOffset * sizeof(glm::mat4), count * sizeof(glm::mat4), models.data());
+    RenderDevice::get()->bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return indexCount;
+}
+
+void GeometryArena::multiDraw(unsigned int primitive, const std::vector<Polytope::Ptr>& polytopes, const std::vector<glm::mat4>& models) {
+
+    unsigned int count = polytopes.size();
+    if(count == 0) return;
+
+    std::vector<DrawElementsIndirectCommand> commands;
+    unsigned int indexCount = prepareDraws(polytopes, models, commands);
+
+    vertexArray->bind();
+    RenderDevice::get()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBufferID);
+    RenderDevice::get()->bufferSubData(GL_DRAW_INDIRECT_BUFFER, drawOffset * sizeof(DrawElementsIndirectCommand), count * sizeof(DrawElementsIndirectCommand), commands.data());
+
+    RenderDevice::get()->multiDrawElementsIndirect(primitive, GL_UNSIGNED_INT, (void*)(drawOffset * sizeof(DrawElementsIndirectCommand)), count, 0);
+    RenderStats::countMultiDraw(primitive, count, indexCount);
+    RenderStats::countVertexFetch((size_t)indexCount * 17 * sizeof(float));
+    RenderStats::countUpload(count * (sizeof(glm::mat4) + sizeof(DrawElementsIndirectCommand)));
+
+    RenderDevice::get()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    vertexArray->unbind();
+
+    drawOffset += count;
+    drawCalls ++;
+}
+
+void GeometryArena::multiDraw(unsigned int primitive, const std::vector<Polytope::Ptr>& polytopes, const std::vector<glm::mat4>& models,
+    GPUCulling& culling, ShaderProgram::Ptr& program) {
+
+    unsigned int count = polytopes.size();
+    if(count == 0) return;
+
+    std::vector<DrawElementsIndirectCommand> commands;
+    unsigned int indexCount = prepareDraws(polytopes, models, commands);
+
+    // The culling writes the commands, blended polytopes keep their order
+    bool ordered = false;
+    std::vector<GPUCulling::Draw> draws(count);
+    for(unsigned int i = 0; i < count; i ++) {
+        draws[i].boundsMin = glm::vec4(polytopes[i]->getBoundsMin(), 1.f);
+        draws[i].boundsMax = glm::vec4(polytopes[i]->getBoundsMax(), 1.f);
+        draws[i].command = commands[i];
+        ordered = ordered || polytopes[i]->isTransparent();
+    }
+    culling.cull(draws, modelBufferID, indirectBufferID, drawOffset, ordered);
+    program->useProgram();
+
+    vertexArray->bind();
+    RenderDevice::get()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBufferID);
+
+    culling.drawVisible(primitive, count, drawOffset, ordered);
+
+    // Upper bounds, the GPU knows the visible draws
+    RenderStats::countMultiDraw(primitive, count, indexCount);
+    RenderStats::countVertexFetch((size_t)indexCount * 17 * sizeof(float));
+    RenderStats::countUpload(count * sizeof(glm::mat4));
+
+    RenderDevice::get()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    vertexArray->unbind();
+
+    drawOffset += count;
+    drawCalls ++;
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+
+#include <glm/mat4x4.hpp>
+
+#include "engine/opengl/buffer/VertexArray.h"
+#include "engine/opengl/buffer/VertexBuffer.h"
+#include "engine/opengl/buffer/IndexBuffer.h"
+#include "engine/opengl/buffer/TLSFAllocator.h"
+#include "engine/opengl/shader/Shader.h"
+
+#include "engine/group/Group.h"
+
+#include "engine/ptr.h"
+
+#define ARENA_VERTEX_CAPACITY (1 << 16)
+#define ARENA_INDEX_CAPACITY (1 << 18)
+#define ARENA_DRAW_CAPACITY 1024
+
+#define ARENA_MODEL_ATTRIBUTE 6
+
+class GPUCulling;
+
+/**
+ * @brief Shared vertex and index storage for polytopes, drawn with glMultiDrawElementsIndirect.
+ *
+ * Polytopes added to the arena are copied into one big VBO/IBO pair behind a single VAO
+ * and become (baseVertex, firstIndex, count) ranges handed out by a TLSF allocator. The model matrix of each draw goes
+ * through an instanced attribute, picked by the baseInstance of its indirect command.
+ * The arena keeps a copy, so a polytope whose vertices change has to be added again.
+ * The ranges of destroyed polytopes are released at the next beginFrame.
+ */
+class GeometryArena {
+    GENERATE_PTR(GeometryArena)
+public:
+    struct Range {
+        unsigned int baseVertex, vertexCount;
+        unsigned int firstIndex, indexCount;
+    };
+
+    // Layout defined by the GL spec
+    struct DrawElementsIndirectCommand {
+        unsigned int count;
+        unsigned int instanceCount;
+        unsigned int firstIndex;
+        int baseVertex;
+        unsigned int baseInstance;
+    };
+private:
+    VertexArray::Ptr vertexArray;
+    VertexBuffer::Ptr vertexBuffer;
+    IndexBuffer::Ptr indexBuffer;
+    TLSFAllocator vertexAllocator, indexAllocator;     // in vertices and indices
+
+    // The owner tells a polytope from a new one created at the same address
+    struct Entry {
+        std::weak_ptr<Polytope> owner;
+        Range range;
+    };
+    std::unordered_map<const Polytope*, Entry> ranges;
+
+    // Per frame draw data
+    unsigned int modelBufferID, indirectBufferID;
+    unsigned int drawCapacity, drawOffset;
+    unsigned int drawCalls;
+public:
+    GeometryArena(unsigned int vertexCapacity = ARENA_VERTEX_CAPACITY, unsigned int indexCapacity = ARENA_INDEX_CAPACITY);
+    ~GeometryArena();
+private:
+    void growVertices(unsigned int minCapacity);
+    void growIndices(unsigned int minCapacity);
+    void reserveDraws(unsigned int count);
+    void orphanDraws();
+    std::unordered_map<const Polytope*, Entry>::iterator release(std::unordered_map<const Polytope*, Entry>::iterator it);
+    unsigned int prepareDraws(const std::vector<Polytope::Ptr>& polytopes, const std::vector<glm::mat4>& models, std::vector<DrawElementsIndirectCommand>& commands);
+public:
+    static bool isSupported();
+
+    bool add(const Polytope::Ptr& polytope);
+    void add(const Group::Ptr& group);
+    void remove(const Polytope::Ptr& polytope);
+    void remove(const Group::Ptr& group);
+    void clear();
+
+    /**
+     * @brief Starts a new frame, the per draw buffers are orphaned so the driver doesn't stall and
+     * the ranges of the destroyed polytopes are freed
+     */
+    void beginFrame();
+
+    /**
+     * @brief Draws all the polytopes with one glMultiDrawElementsIndirect call
+     *
+     * Every polytope must be in the arena, models[i] is the model matrix of polytopes[i]
+     */
+    void multiDraw(unsigned int primitive, const std::vector<Polytope::Ptr>& polytopes, const std::vector<glm::mat4>& models);
+
+    /**
+     * @brief Same draw, the commands of the polytopes outside the frustum or hidden go away on the GPU.
+     * The culling uses its own program, program is the one of the draw and is bound again
+     */
+    void multiDraw(unsigned int primitive, const std::vector<Polytope::Ptr>& polytopes, const std::vector<glm::mat4>& models,
+        GPUCulling& culling, ShaderProgram::Ptr& program);
+public:
+    bool contains(const Polytope::Ptr& polytope) const;
+    inline const Range& getRange(const Polytope::Ptr& polytope) { return ranges[polytope.get()].range; }
+    inline size_t getPolytopesCount() const { return ranges.size(); }
+
+    inline const TLSFAllocator& getVertexAllocator() const { return vertexAllocator; }
+    inline const TLSFAllocator& getIndexAllocator() const { return indexAllocator; }
+
+    inline unsigned int getDrawCalls() const { return drawCalls; }
+    inline VertexArray::Ptr& getVertexArray() { return vertexArray; }
+};
\ No newline at end of file
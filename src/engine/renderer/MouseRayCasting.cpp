@@ -1,10 +1,12 @@
 #include "MouseRayCasting.h"
 
+#include <limits>
+
 MouseRayCasting::MouseRayCasting(const Camera::Ptr& _camera, unsigned int _width, unsigned int _height)
     : camera(_camera), width(_width), height(_height) {
 }
 
-glm::vec2 MouseRayCasting::getNormalizedDeviceCoords(const glm::vec2& mousePosition) {
+glm::vec2 MouseRayCasting::getNormalizedDeviceCoords(const glm::vec2& mousePosition, unsigned int width, unsigned int height) {
     float x = (2.0f * mousePosition.x) / width - 1.0f;
     float y = (2.0f * mousePosition.y) / height - 1.0f;
     return glm::vec2(x, y);
@@ -14,23 +16,89 @@ glm::vec4 MouseRayCasting::getHomogeneousClipCoords(const glm::vec2& normalizedD
     return glm::vec4(normalizedDeviceCoords.x, normalizedDeviceCoords.y, -1.f, 1.f);
 }
 
-glm::vec4 MouseRayCasting::getEyeCoords(const glm::vec4& clipCoords) {
-    glm::vec4 eyeCoords = camera->getInverseProjectionMatrix() * clipCoords;
+glm::vec4 MouseRayCasting::getEyeCoords(const glm::vec4& clipCoords, const glm::mat4& inverseProjection) {
+    glm::vec4 eyeCoords = inverseProjection * clipCoords;
     eyeCoords = glm::vec4(eyeCoords.x, eyeCoords.y, -1.0, 0.0);
     return eyeCoords;
 }
 
-glm::vec3 MouseRayCasting::getWorldCoords(const glm::vec4& eyeCoords) {
-    glm::vec4 worldCoordinates = camera->getInverseViewMatrix() * eyeCoords;
+glm::vec3 MouseRayCasting::getWorldCoords(const glm::vec4& eyeCoords, const glm::mat4& inverseView) {
+    glm::vec4 worldCoordinates = inverseView * eyeCoords;
     glm::vec3 worldCoords(worldCoordinates.x, worldCoordinates.y, worldCoordinates.z);
     worldCoords = glm::normalize(worldCoords);
     return worldCoords;
 }
 
 MouseRayCasting::Ray MouseRayCasting::getRay(int mouseX, int mouseY) {
-    glm::vec2 normalizedDeviceCoords = getNormalizedDeviceCoords(glm::vec2(mouseX, mouseY));
+    return getRay(camera->getInverseProjectionMatrix(), camera->getInverseViewMatrix(), camera->getEye(), width, height, mouseX, mouseY);
+}
+
+MouseRayCasting::Ray MouseRayCasting::getRay(const glm::mat4& inverseProjection, const glm::mat4& inverseView, const glm::vec3& eye, 
+    unsigned int width, unsigned int height, int mouseX, int mouseY) {
+
+    glm::vec2 normalizedDeviceCoords = getNormalizedDeviceCoords(glm::vec2(mouseX, mouseY), width, height);
     glm::vec4 clipCoords = getHomogeneousClipCoords(normalizedDeviceCoords);
-    glm::vec4 eyeCoords = getEyeCoords(clipCoords);
-    glm::vec3 worldCoords = getWorldCoords(eyeCoords);
-    return Ray(camera->getEye(), worldCoords);
+    glm::vec4 eyeCoords = getEyeCoords(clipCoords, inverseProjection);
+    glm::vec3 worldCoords = getWorldCoords(eyeCoords, inverseView);
+    return Ray(eye, worldCoords);
+}
+
+bool MouseRayCasting::intersectTriangle(const Ray& ray, const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, float& distance) {
+
+    const float epsilon = 1e-7f;
+
+    glm::vec3 edge1 = p1 - p0;
+    glm::vec3 edge2 = p2 - p0;
+    glm::vec3 h = glm::cross(ray.rayDirection, edge2);
+    float a = glm::dot(edge1, h);
+
+    // Parallel to the triangle
+    if(a > -epsilon && a < epsilon) return false;
+
+    float f = 1.0f / a;
+    glm::vec3 s = ray.origin - p0;
+    float u = f * glm::dot(s, h);
+    if(u < 0.0f || u > 1.0f) return false;
+
+    glm::vec3 q = glm::cross(s, edge1);
+    float v = f * glm::dot(ray.rayDirection, q);
+    if(v < 0.0f || u + v > 1.0f) return false;
+
+    float t = f * glm::dot(edge2, q);
+    if(t <= epsilon) return false;
+
+    distance = t;
+    return true;
+}
+
+bool MouseRayCasting::intersect(const Ray& ray, const std::vector<Vec3f>& vertices, const std::vector<unsigned int>& indices, 
+    const glm::mat4& model, float& distance) {
+
+    // The ray goes to model space instead of transforming every vertex
+    glm::mat4 inverseModel = glm::inverse(model);
+    glm::vec3 origin = glm::vec3(inverseModel * glm::vec4(ray.origin, 1.0f));
+    glm::vec3 direction = glm::vec3(inverseModel * glm::vec4(ray.rayDirection, 0.0f));
+    Ray localRay(origin, direction);
+
+    float closest = std::numeric_limits<float>::max();
+    bool hit = false;
+
+    auto test = [&](const Vec3f& a, const Vec3f& b, const Vec3f& c) {
+        float t;
+        if(intersectTriangle(localRay, glm::vec3(a.x, a.y, a.z), glm::vec3(b.x, b.y, b.z), glm::vec3(c.x, c.y, c.z), t) && t < closest) {
+            closest = t;
+            hit = true;
+        }
+    };
+
+    if(indices.empty()) {
+        for(size_t i = 0; i + 2 < vertices.size(); i += 3) test(vertices[i], vertices[i + 1], vertices[i + 2]);
+    }
+    else {
+        for(size_t i = 0; i + 2 < indices.size(); i += 3) test(vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]]);
+    }
+
+    // Same lambda in world space, the direction wasn't normalized again
+    if(hit) distance = closest;
+    return hit;
 }
\ No newline at end of file
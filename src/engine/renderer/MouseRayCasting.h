@@ -1,8 +1,12 @@
 // Thanks to: https://antongerdelan.net/opengl/raycasting.html
 #pragma once
 
+#include <vector>
+
 #include "Camera.h"
 
+#include "engine/Vec3.h"
+
 class MouseRayCasting {
 public:
     /**
@@ -44,10 +48,25 @@ public:
     MouseRayCasting() = default;
     ~MouseRayCasting() = default;
 private:
-    glm::vec2 getNormalizedDeviceCoords(const glm::vec2& mousePosition);
-    glm::vec4 getHomogeneousClipCoords(const glm::vec2& normalizedDeviceCoords);
-    glm::vec4 getEyeCoords(const glm::vec4& clipCoords);
-    glm::vec3 getWorldCoords(const glm::vec4& eyeCoords);
+    static glm::vec2 getNormalizedDeviceCoords(const glm::vec2& mousePosition, unsigned int width, unsigned int height);
+    static glm::vec4 getHomogeneousClipCoords(const glm::vec2& normalizedDeviceCoords);
+    static glm::vec4 getEyeCoords(const glm::vec4& clipCoords, const glm::mat4& inverseProjection);
+    static glm::vec3 getWorldCoords(const glm::vec4& eyeCoords, const glm::mat4& inverseView);
 public:
     Ray getRay(int mouseX, int mouseY);
+
+    // CPU only, they don't need a GL context
+    static Ray getRay(const glm::mat4& inverseProjection, const glm::mat4& inverseView, const glm::vec3& eye, 
+        unsigned int width, unsigned int height, int mouseX, int mouseY);
+
+    /**
+     * @brief Moller-Trumbore ray triangle intersection, distance is the lambda of the hit point
+     */
+    static bool intersectTriangle(const Ray& ray, const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, float& distance);
+
+    /**
+     * @brief Closest triangle of the mesh hit by the ray, indices can be empty for non indexed meshes
+     */
+    static bool intersect(const Ray& ray, const std::vector<Vec3f>& vertices, const std::vector<unsigned int>& indices, 
+        const glm::mat4& model, float& distance);
 };
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "OcclusionQueries.h"
+
+#include "engine/opengl/device/RenderDevice.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+OcclusionQueries::OcclusionQueries()
+    : frame(0), viewProjection(1.f), issued(0), conditional(0), occluded(0) {
+
+    // Only the depth of the boxes is tested, nothing is written
+    Shader vertexShader = Shader::fromFile("glsl/SimpleDepth.vert", Shader::ShaderType::Vertex);
+    Shader fragmentShader = Shader::fromFile("glsl/SimpleDepth.frag", Shader::ShaderType::Fragment);
+    shaderProgramBox = ShaderProgram::New(vertexShader, fragmentShader);
+
+    // Unit cube, 12 triangles
+    const int faces[6][4][3] = {
+        {{0, 0, 0}, {0, 1, 0}, {1, 1, 0}, {1, 0, 0}}, {{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}},
+        {{0, 0, 0}, {0, 0, 1}, {0, 1, 1}, {0, 1, 0}}, {{1, 0, 0}, {1, 1, 0}, {1, 1, 1}, {1, 0, 1}},
+        {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}}, {{0, 1, 0}, {0, 1, 1}, {1, 1, 1}, {1, 1, 0}}
+    };
+    std::vector<Vec3f> boxVertices;
+    for(auto& face : faces) {
+        for(int corner : { 0, 1, 2, 0, 2, 3 }) {
+            boxVertices.push_back(Vec3f(face[corner][0], face[corner][1], face[corner][2]));
+        }
+    }
+    boxVAO = VertexArray::New();
+    boxVBO = VertexBuffer::New(boxVertices);
+    boxVAO->unbind();
+}
+
+OcclusionQueries::~OcclusionQueries() {
+    for(auto& [key, node] : nodes) releaseQueries(node);
+    if(!freeQueries.empty()) RenderDevice::get()->deleteQueries(freeQueries.size(), &freeQueries[0]);
+}
+
+OcclusionQueries::Node& OcclusionQueries::getNode(const void* node) {
+    auto it = nodes.find(node);
+    if(it == nodes.end()) it = nodes.emplace(node, Node{ {}, true, false, frame }).first;
+    it->second.lastFrame = frame;
+    return it->second;
+}
+
+unsigned int OcclusionQueries::newQuery(Node& node) {
+    unsigned int query;
+    if(freeQueries.empty()) RenderDevice::get()->genQueries(1, &query);
+    else {
+        query = freeQueries.back();
+        freeQueries.pop_back();
+    }
+    node.queries.push_back(query);
+    issued++;
+    return query;
+}
+
+void OcclusionQueries::releaseQueries(Node& node) {
+    // They may still be in flight, so they aren't reused
+    for(unsigned int query : node.queries) RenderDevice::get()->deleteQueries(1, &query);
+    node.queries.clear();
+}
+
+void OcclusionQueries::beginFrame(const glm::mat4& viewProjection) {
+    this->viewProjection = viewProjection;
+    frame++;
+    issued = 0;
+    conditional = 0;
+    occluded = 0;
+
+    for(auto it = nodes.begin(); it != nodes.end();) {
+        Node& node = it->second;
+
+        // Removed from the tree or out of the traversal for a while
+        if(frame - node.lastFrame > OCCLUSION_NODE_LIFETIME) {
+            releaseQueries(node);
+            it = nodes.erase(it);
+            continue;
+        }
+
+        // Queries finish in order, the first one not available ends the reading
+        while(!node.queries.empty()) {
+            unsigned int query = node.queries.front();
+            GLint available = 0;
+            RenderDevice::get()->getQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if(!available) break;
+
+            GLint result = 0;
+            RenderDevice::get()->getQueryObjectiv(query, GL_QUERY_RESULT, &result);
+            if(result != 0 && !node.visible) node.revealed = true;
+            if(result == 0) occluded++;
+            node.visible = result != 0;
+
+            node.queries.pop_front();
+            freeQueries.push_back(query);
+        }
+        ++it;
+    }
+}
+
+bool OcclusionQueries::isHidden(const void* node) {
+    return !getNode(node).visible;
+}
+
+bool OcclusionQueries::isRevealed(const void* node) {
+    Node& state = getNode(node);
+    bool revealed = state.revealed;
+    state.revealed = false;
+    return revealed;
+}
+
+void OcclusionQueries::setVisible(const void* node, bool visible) {
+    getNode(node).visible = visible;
+}
+
+bool OcclusionQueries::beginQuery(const void* node) {
+    Node& state = getNode(node);
+    if(!state.queries.empty()) return false;
+
+    RenderDevice::get()->beginQuery(GL_ANY_SAMPLES_PASSED, newQuery(state));
+    return true;
+}
+
+void OcclusionQueries::endQuery() {
+    RenderDevice::get()->endQuery(GL_ANY_SAMPLES_PASSED);
+}
+
+bool OcclusionQueries::beginConditionalRender(const void* node, const glm::vec3& low, const glm::vec3& high) {
+    Node& state = getNode(node);
+
+    // A corner in front of the near plane: the camera may be inside, the box is no proof
+    for(int i = 0; i < 8; i++) {
+        glm::vec4 corner = viewProjection * glm::vec4(i & 1 ? high.x : low.x, i & 2 ? high.y : low.y, i & 4 ? high.z : low.z, 1.f);
+        if(corner.w <= 0.f || corner.z < -corner.w) {
+            state.visible = true;
+            state.revealed = true;
+            return false;
+        }
+    }
+
+    glm::mat4 model = glm::translate(glm::mat4(1.f), low) * glm::scale(glm::mat4(1.f), glm::max(high - low, glm::vec3(1e-4f)));
+
+    shaderProgramBox->useProgram();
+    shaderProgramBox->uniformMat4("lightSpaceMatrix", viewProjection);
+    shaderProgramBox->uniformMat4("model", model);
+
+    // Faces on the visible surfaces of a depth pre-pass pass too
+    RenderDevice::get()->colorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    RenderDevice::get()->depthMask(GL_FALSE);
+    RenderDevice::get()->enable(GL_DEPTH_TEST);
+    RenderDevice::get()->depthFunc(GL_LEQUAL);
+    RenderDevice::get()->disable(GL_CULL_FACE);
+    RenderDevice::get()->polygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    unsigned int query = newQuery(state);
+    RenderDevice::get()->beginQuery(GL_ANY_SAMPLES_PASSED, query);
+    boxVAO->bind();
+    RenderDevice::get()->drawArrays(GL_TRIANGLES, 0, 36);
+    boxVAO->unbind();
+    RenderDevice::get()->endQuery(GL_ANY_SAMPLES_PASSED);
+
+    RenderDevice::get()->colorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    RenderDevice::get()->depthMask(GL_TRUE);
+    RenderDevice::get()->depthFunc(GL_LESS);
+
+    RenderDevice::get()->beginConditionalRender(query, GL_QUERY_NO_WAIT);
+    conditional++;
+    return true;
+}
+
+void OcclusionQueries::endConditionalRender() {
+    RenderDevice::get()->endConditionalRender();
+}
+
+void OcclusionQueries::expandBounds(const glm::mat4& model, const glm::vec3& boundsMin, const glm::vec3& boundsMax, glm::vec3& low, glm::vec3& high) {
+    for(int i = 0; i < 8; i++) {
+        glm::vec3 corner = glm::vec3(model * glm::vec4(i & 1 ? boundsMax.x : boundsMin.x, i & 2 ? boundsMax.y : boundsMin.y,
+            i & 4 ? boundsMax.z : boundsMin.z, 1.f));
+        low = glm::min(low, corner);
+        high = glm::max(high, corner);
+    }
+}
\ No newline at end of file
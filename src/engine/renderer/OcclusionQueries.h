@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <unordered_map>
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "engine/opengl/shader/Shader.h"
+#include "engine/opengl/buffer/VertexArray.h"
+#include "engine/opengl/buffer/VertexBuffer.h"
+
+#include "engine/ptr.h"
+
+// Frames a node can go unvisited before its state and queries are released
+#define OCCLUSION_NODE_LIFETIME 60
+
+/**
+ * @brief Hardware occlusion queries reused from frame to frame, after CHC++ (GL 3.3).
+ *
+ * The nodes are the scenes, the groups and the polytopes of the tree, keyed by their address.
+ * A node visible in the last frame is drawn right away inside a GL_ANY_SAMPLES_PASSED query,
+ * a hidden one waits until the visible ones are drawn: its world box is queried against their
+ * depth and the node is drawn in a conditional render of that query with GL_QUERY_NO_WAIT, so
+ * the GPU skips it when the box is occluded and the CPU never waits for a result. Results are
+ * read at the next frame, only when available.
+ *
+ * A scene or a group is hidden when all its children are, its children are visible again once
+ * its box is. A box cut by the near plane can't be queried, its node is drawn as visible.
+ */
+class OcclusionQueries {
+    GENERATE_PTR(OcclusionQueries)
+private:
+    struct Node {
+        std::deque<unsigned int> queries;   // in flight, oldest first
+        bool visible;
+        bool revealed;                      // hidden until a result of the last frames
+        unsigned int lastFrame;
+    };
+private:
+    std::unordered_map<const void*, Node> nodes;
+    std::vector<unsigned int> freeQueries;
+    unsigned int frame;
+
+    glm::mat4 viewProjection;
+    ShaderProgram::Ptr shaderProgramBox;
+    VertexArray::Ptr boxVAO;
+    VertexBuffer::Ptr boxVBO;
+
+    // Queries issued, nodes drawn conditionally and box results found hidden this frame
+    unsigned int issued, conditional, occluded;
+public:
+    OcclusionQueries();
+    ~OcclusionQueries();
+private:
+    Node& getNode(const void* node);
+    unsigned int newQuery(Node& node);
+    void releaseQueries(Node& node);
+public:
+    /**
+     * @brief Reads the available results of the last frames and releases the nodes not visited for
+     * OCCLUSION_NODE_LIFETIME frames. The boxes of this frame are seen through viewProjection
+     */
+    void beginFrame(const glm::mat4& viewProjection);
+
+    /**
+     * @brief State of the node from the last results, a new one is visible
+     */
+    bool isHidden(const void* node);
+
+    /**
+     * @brief Whether the node became visible since the last call, its children have to be tested again
+     */
+    bool isRevealed(const void* node);
+
+    /**
+     * @brief Visibility of an inner node, from the ones of its children
+     */
+    void setVisible(const void* node, bool visible);
+
+    /**
+     * @brief Queries the samples of the draws until endQuery. Returns false when the last query of
+     * the node is still in flight, no query is made then
+     */
+    bool beginQuery(const void* node);
+    void endQuery();
+
+    /**
+     * @brief Queries the world box of the node and starts drawing conditionally on it. Returns false
+     * when the box is cut by the near plane: the node is visible and drawn without condition.
+     * Leaves the depth test on, the color and depth writes on and the face culling off
+     */
+    bool beginConditionalRender(const void* node, const glm::vec3& low, const glm::vec3& high);
+    void endConditionalRender();
+
+    /**
+     * @brief Grows the box low-high by the box boundsMin-boundsMax, in the space of the model
+     */
+    static void expandBounds(const glm::mat4& model, const glm::vec3& boundsMin, const glm::vec3& boundsMax, glm::vec3& low, glm::vec3& high);
+public:
+    inline unsigned int getQueries() const { return issued; }
+    inline unsigned int getConditionalNodes() const { return conditional; }
+    inline unsigned int getOccludedNodes() const { return occluded; }
+    inline unsigned int getNodeCount() const { return nodes.size(); }
+};
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "RenderStats.h"
+
+RenderStats* RenderStats::active = nullptr;
+
+RenderStats::Counters::Counters() {
+    reset();
+}
+
+void RenderStats::Counters::reset() {
+    drawCalls = instances = 0;
+    triangles = lines = points = 0;
+    programBinds = textureBinds = 0;
+    culledObjects = 0;
+    uploadedBytes = 0;
+    vertexBytes = 0;
+}
+
+RenderStats::Counters& RenderStats::Counters::operator+=(const Counters& counters) {
+    drawCalls += counters.drawCalls;
+    instances += counters.instances;
+    triangles += counters.triangles;
+    lines += counters.lines;
+    points += counters.points;
+    programBinds += counters.programBinds;
+    textureBinds += counters.textureBinds;
+    culledObjects += counters.culledObjects;
+    uploadedBytes += counters.uploadedBytes;
+    vertexBytes += counters.vertexBytes;
+    return *this;
+}
+
+RenderStats::AverageCounters::AverageCounters()
+    : drawCalls(0), instances(0), triangles(0), lines(0), points(0),
+      programBinds(0), textureBinds(0), culledObjects(0), uploadedBytes(0), vertexBytes(0) {
+}
+
+RenderStats::AverageCounters& RenderStats::AverageCounters::operator+=(const Counters& counters) {
+    drawCalls += counters.drawCalls;
+    instances += counters.instances;
+    triangles += counters.triangles;
+    lines += counters.lines;
+    points += counters.points;
+    programBinds += counters.programBinds;
+    textureBinds += counters.textureBinds;
+    culledObjects += counters.culledObjects;
+    uploadedBytes += counters.uploadedBytes;
+    vertexBytes += counters.vertexBytes;
+    return *this;
+}
+
+RenderStats::AverageCounters& RenderStats::AverageCounters::operator/=(double n) {
+    drawCalls /= n;
+    instances /= n;
+    triangles /= n;
+    lines /= n;
+    points /= n;
+    programBinds /= n;
+    textureBinds /= n;
+    culledObjects /= n;
+    uploadedBytes /= n;
+    vertexBytes /= n;
+    return *this;
+}
+
+RenderStats::RenderStats(size_t _historySize)
+    : historySize(_historySize), pass(OTHER) {
+}
+
+RenderStats::~RenderStats() {
+    if(active == this) active = nullptr;
+}
+
+void RenderStats::beginFrame() {
+    pass = OTHER;
+    active = this;
+}
+
+void RenderStats::endFrame() {
+
+    for(int i = 0; i < PASS_COUNT; i ++) frame.total += frame.passes[i];
+
+    lastFrame = frame;
+    history.push_back(frame);
+    while(history.size() > historySize) history.pop_front();
+
+    // Still active, uploads between frames (loading models, textures...) go to the next one
+    frame = Frame();
+    pass = OTHER;
+}
+
+RenderStats::AverageFrame RenderStats::getAverage() const {
+
+    AverageFrame average;
+    if(history.empty()) return average;
+
+    for(auto& f : history) {
+        average.total += f.total;
+        for(int i = 0; i < PASS_COUNT; i ++) average.passes[i] += f.passes[i];
+    }
+
+    double n = (double)history.size();
+    average.total /= n;
+    for(int i = 0; i < PASS_COUNT; i ++) average.passes[i] /= n;
+
+    return average;
+}
+
+const char* RenderStats::getPassName(Pass pass) {
+    switch(pass) {
+        case SHADOW: return "Shadow";
+        case GBUFFER: return "G-buffer";
+        case LIGHTING: return "Lighting";
+        case DEPTH_PREPASS: return "Depth pre-pass";
+        case SCENE: return "Scene";
+        case SKYBOX: return "SkyBox";
+        case POST_PROCESS: return "Post process";
+        default: return "Other";
+    }
+}
+
+void RenderStats::countDraw(unsigned int primitive, unsigned int count, unsigned int instances) {
+
+    Counters* c = counters();
+    if(c == nullptr) return;
+
+    c->drawCalls ++;
+    c->instances += instances;
+
+    switch(primitive) {
+        case GL_TRIANGLES: c->triangles += count / 3 * instances; break;
+        case GL_TRIANGLE_STRIP:
+        case GL_TRIANGLE_FAN: c->triangles += (count > 2 ? count - 2 : 0) * instances; break;
+        case GL_LINES: c->lines += count / 2 * instances; break;
+        case GL_LINE_STRIP: c->lines += (count > 1 ? count - 1 : 0) * instances; break;
+        case GL_LINE_LOOP: c->lines += count * instances; break;
+        case GL_POINTS: c->points += count * instances; break;
+    }
+}
+
+void RenderStats::countMultiDraw(unsigned int primitive, unsigned int commands, unsigned int count) {
+
+    Counters* c = counters();
+    if(c == nullptr) return;
+
+    // One call, but every command is an instance of its own
+    countDraw(primitive, count);
+    c->instances += commands - 1;
+}
+
+void RenderStats::countProgramBind() {
+    if(Counters* c = counters()) c->programBinds ++;
+}
+
+void RenderStats::countTextureBind() {
+    if(Counters* c = counters()) c->textureBinds ++;
+}
+
+void RenderStats::countUpload(size_t bytes) {
+    if(Counters* c = counters()) c->uploadedBytes += bytes;
+}
+
+void RenderStats::countVertexFetch(size_t bytes) {
+    if(Counters* c = counters()) c->vertexBytes += bytes;
+}
+
+void RenderStats::countCulled(unsigned int objects) {
+    if(Counters* c = counters()) c->culledObjects += objects;
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <iostream>
+#include <deque>
+#include <cstddef>
+
+#include <GL/glew.h>
+
+#include "engine/ptr.h"
+
+#define RENDER_STATS_HISTORY 120
+
+/**
+ * @brief What a frame costs: draws, primitives, state changes and uploads, per pass and in total.
+ *
+ * The renderer makes its stats the active ones while it renders. Polytopes, buffers, textures
+ * and shader programs report through the static count functions, which do nothing when no
+ * stats are active. The stats stay active after endFrame, what is counted between two frames
+ * goes to the next one. The last RENDER_STATS_HISTORY frames are kept.
+ */
+class RenderStats {
+    GENERATE_PTR(RenderStats)
+public:
+    enum Pass {
+        SHADOW, GBUFFER, LIGHTING, DEPTH_PREPASS, SCENE, SKYBOX, POST_PROCESS, OTHER, PASS_COUNT
+    };
+
+    struct Counters {
+        unsigned int drawCalls;
+        unsigned int instances;
+        unsigned int triangles, lines, points;
+        unsigned int programBinds;
+        unsigned int textureBinds;
+        unsigned int culledObjects;
+        size_t uploadedBytes;
+        size_t vertexBytes;     // vertex attributes read by the polytope draws, without the post-transform cache
+
+        Counters();
+        void reset();
+        Counters& operator+=(const Counters& counters);
+    };
+
+    struct Frame {
+        Counters total;
+        Counters passes[PASS_COUNT];
+    };
+
+    // Same counters averaged over frames, not truncated
+    struct AverageCounters {
+        double drawCalls;
+        double instances;
+        double triangles, lines, points;
+        double programBinds;
+        double textureBinds;
+        double culledObjects;
+        double uploadedBytes;
+        double vertexBytes;
+
+        AverageCounters();
+        AverageCounters& operator+=(const Counters& counters);
+        AverageCounters& operator/=(double n);
+    };
+
+    struct AverageFrame {
+        AverageCounters total;
+        AverageCounters passes[PASS_COUNT];
+    };
+private:
+    Frame frame;
+    Frame lastFrame;
+    std::deque<Frame> history;
+    size_t historySize;
+    Pass pass;
+
+    static RenderStats* active;
+public:
+    RenderStats(size_t _historySize = RENDER_STATS_HISTORY);
+    ~RenderStats();
+private:
+    inline static Counters* counters() { return active != nullptr ? &active->frame.passes[active->pass] : nullptr; }
+public:
+    void beginFrame();
+    void endFrame();
+
+    /**
+     * @brief Average of the frames in the history
+     */
+    AverageFrame getAverage() const;
+
+    static const char* getPassName(Pass pass);
+
+    static void countDraw(unsigned int primitive, unsigned int count, unsigned int instances = 1);
+    static void countMultiDraw(unsigned int primitive, unsigned int commands, unsigned int count);
+    static void countProgramBind();
+    static void countTextureBind();
+    static void countUpload(size_t bytes);
+    static void countVertexFetch(size_t bytes);
+    static void countCulled(unsigned int objects = 1);
+public:
+    inline void setPass(Pass pass) { this->pass = pass; }
+    inline Pass getPass() const { return pass; }
+
+    // Last finished frame
+    inline const Frame& getFrame() const { return lastFrame; }
+    inline const Counters& getPassCounters(Pass pass) const { return lastFrame.passes[pass]; }
+    inline const std::deque<Frame>& getHistory() const { return history; }
+
+    inline void setHistorySize(size_t historySize) { this->historySize = historySize; }
+    inline size_t getHistorySize() const { return historySize; }
+
+    inline static RenderStats* getActive() { return active; }
+};
\ No newline at end of file
@@ -1,15 +1,22 @@
 #include "Renderer.h"
 
+#include "engine/opengl/device/RenderDevice.h"
+
 #include <cmath>
+#include <map>
+#include <algorithm>
+#include <tuple>
+#include <limits>
 
 #include "TrackballCamera.h"
 
-#define SHADOW_MAP_WIDTH 2048*4
-#define SHADOW_MAP_HEIGHT 2048*4
+#include "engine/profiler/Instrumentation.h"
 
 #define NEAR_PLANE 0.1
 #define FAR_PLANE 100.0
 
+#define HEAP_COMPACTION_BUDGET 256 * 1024
+
 Renderer::Renderer(unsigned int _viewportWidth, unsigned int _viewportHeight) 
     : camera(nullptr), 
     hasCamera(false),
@@ -19,17 +26,29 @@ Renderer::Renderer(unsigned int _viewportWidth, unsigned int _viewportHeight)
     nLights(0),
     projection(glm::mat4(1.f)), 
     view(glm::mat4(1.f)), 
-    depthMapFBO(nullptr),
-    depthMap(nullptr),
     viewportWidth(_viewportWidth), 
     viewportHeight(_viewportHeight),
     shadowLightPos(0, 0, 0), 
     shadowMapping(false), 
+    pointShadowMapping(false),
     exposure(1.0f), 
     hdr(false), 
     gammaCorrection(false), 
     pbr(false), 
-    backgroundColor(0.1f) 
+    backgroundColor(0.1f),
+    geometryArena(nullptr),
+    multiDrawIndirect(false),
+    gpuCulling(nullptr),
+    gpuDrivenCulling(false),
+    sceneQueries(nullptr),
+    gBufferQueries(nullptr),
+    occlusionCulling(false),
+    softwareOcclusion(nullptr),
+    softwareCulling(false),
+    deferred(false),
+    gBufferPass(false),
+    depthPrePass(false),
+    objectLighting(false)
 {
     loadFunctionsGL();
     initShaders();
@@ -40,6 +59,10 @@ Renderer::Renderer(unsigned int _viewportWidth, unsigned int _viewportHeight)
     initTextureQuad();
 
     frameCapturer = FrameCapturer::New(viewportWidth, viewportHeight);
+    stats = RenderStats::New();
+    gpuProfiler = GPUProfiler::New();
+    lightClusters = LightClusters::New();
+    objectLights = ObjectLights::New();
 }
 
 Renderer::Renderer() 
@@ -47,10 +70,8 @@ Renderer::Renderer()
 }
 
 void Renderer::loadFunctionsGL() {
-    if (glewInit() != GLEW_OK) {
-        std::cout << "Couldn't initialize GLEW" << std::endl;
-        return;
-    }
+    if(!RenderDevice::get()->init())
+        std::cout << "Couldn't initialize the " << RenderDevice::get()->getName() << " render device" << std::endl;
 }
 
 void Renderer::initShaders() {
@@ -73,11 +94,14 @@ void Renderer::initShaders() {
     // Depth Map shader program
     Shader vertexDepthMapShader = Shader::fromFile("glsl/SimpleDepth.vert", Shader::ShaderType::Vertex);
     Shader fragmentDepthMapShader = Shader::fromFile("glsl/SimpleDepth.frag", Shader::ShaderType::Fragment);
-    shaderProgramDepthMap = ShaderProgram::New(vertexDepthMapShader, fragmentDepthMapShader);
+    shaderProgramDepthMapSimple = ShaderProgram::New(vertexDepthMapShader, fragmentDepthMapShader);
+    shaderProgramDepthMap = shaderProgramDepthMapSimple;
 
-    /*Shader vertexDepthMapShaderCSM = Shader::fromFile("glsl/CSMDepth.vert", Shader::ShaderType::Vertex);
+    // Cascaded Shadow Mapping shader program
+    Shader vertexDepthMapShaderCSM = Shader::fromFile("glsl/CSMDepth.vert", Shader::ShaderType::Vertex);
     Shader fragmentDepthMapShaderCSM = Shader::fromFile("glsl/CSMDepth.frag", Shader::ShaderType::Fragment);
-    shaderProgramDepthMapCSM = ShaderProgram::New(vertexDepthMapShaderCSM, fragmentDepthMapShaderCSM);*/
+    shaderProgramDepthMapCSM = ShaderProgram::New(vertexDepthMapShaderCSM, fragmentDepthMapShaderCSM);
+    shaderProgramDepthMap = shaderProgramDepthMapCSM;
 
     // HDR shader program
     Shader vertexHDRShader = Shader::fromFile("glsl/HDR.vert", Shader::ShaderType::Vertex);
@@ -94,10 +118,40 @@ void Renderer::initShaders() {
     Shader fragmentSelectionShader = Shader::fromFile("glsl/Selection.frag", Shader::ShaderType::Fragment);
     shaderProgramSelection = ShaderProgram::New(vertexSelectionShader, fragmentSelectionShader);
 
+    // G-buffer shader program, same vertex shader as PBR
+    Shader vertexGBufferShader = Shader::fromFile("glsl/PBR.vert", Shader::ShaderType::Vertex);
+    Shader fragmentGBufferShader = Shader::fromFile("glsl/GBuffer.frag", Shader::ShaderType::Fragment);
+    shaderProgramGBuffer = ShaderProgram::New(vertexGBufferShader, fragmentGBufferShader);
+
+    // Deferred lighting shader program, a quad over the screen
+    Shader vertexDeferredLightingShader = Shader::fromFile("glsl/HDR.vert", Shader::ShaderType::Vertex);
+    Shader fragmentDeferredLightingShader = Shader::fromFile("glsl/DeferredLighting.frag", Shader::ShaderType::Fragment);
+    shaderProgramDeferredLighting = ShaderProgram::New(vertexDeferredLightingShader, fragmentDeferredLightingShader);
+
+    // Depth pre-pass shader program, only the position
+    Shader vertexDepthPrePassShader = Shader::fromFile("glsl/DepthPrePass.vert", Shader::ShaderType::Vertex);
+    Shader fragmentDepthPrePassShader = Shader::fromFile("glsl/SimpleDepth.frag", Shader::ShaderType::Fragment);
+    shaderProgramDepthPrePass = ShaderProgram::New(vertexDepthPrePassShader, fragmentDepthPrePassShader);
+
+    // Point shadows shader program, the geometry shader draws the 6 faces of the light
+    Shader vertexPointShadowShader = Shader::fromFile("glsl/PointShadowDepth.vert", Shader::ShaderType::Vertex);
+    Shader geometryPointShadowShader = Shader::fromFile("glsl/PointShadowDepth.geom", Shader::ShaderType::Geometry);
+    Shader fragmentPointShadowShader = Shader::fromFile("glsl/SimpleDepth.frag", Shader::ShaderType::Fragment);
+    shaderProgramPointShadow = ShaderProgram::New(vertexPointShadowShader, geometryPointShadowShader, fragmentPointShadowShader);
+
     // Textured quad shader program
     Shader vertexTexturedQuadShader = Shader::fromFile("glsl/TexturedQuad.vert", Shader::ShaderType::Vertex);
     Shader fragmentTexturedQuadShader = Shader::fromFile("glsl/TexturedQuad.frag", Shader::ShaderType::Fragment);
     shaderProgramTexturedQuad = ShaderProgram::New(vertexTexturedQuadShader, fragmentTexturedQuadShader);
+
+    // All the programs were submitted, now wait for them. This way the compilations overlap
+    // when the driver supports parallel shader compilation
+    for(ShaderProgram::Ptr* program : { &shaderProgram, &shaderProgramLighting, &shaderProgramPBR, 
+        &shaderProgramDepthMapSimple, &shaderProgramDepthMapCSM, &shaderProgramHDR, &shaderProgramSkyBox, 
+        &shaderProgramSelection, &shaderProgramTexturedQuad, &shaderProgramGBuffer, &shaderProgramDeferredLighting,
+        &shaderProgramDepthPrePass, &shaderProgramPointShadow }) {
+        (*program)->finishLink();
+    }
 }
 
 void Renderer::initTextureQuad() {
@@ -263,73 +317,45 @@ void Renderer::textureUniform(ShaderProgram::Ptr& shaderProgram, std::shared_ptr
 }
 
 void Renderer::primitiveSettings(Group::Ptr& group) {
-    glPointSize(group->getPointSize());
-    glLineWidth(group->getLineWidth());
+    RenderDevice::get()->pointSize(group->getPointSize());
+    RenderDevice::get()->lineWidth(group->getLineWidth());
 }
 
 void Renderer::defaultPrimitiveSettings() {
-    glPointSize(1.0f);
-    glLineWidth(1.0f);
+    RenderDevice::get()->pointSize(1.0f);
+    RenderDevice::get()->lineWidth(1.0f);
 }
 
 void Renderer::lightShaderUniforms() {
 
-    shaderProgramLighting->uniformInt("nLights", nLights);
-    for(int i = 0; i < nLights; i ++) {
-
-        float intensity = hdr ? lights[i]->getIntensity() : 1.0f;
-
-        // Directional Light
-        std::string lightUniform = "lights[" + std::to_string(i) + "]";
-        shaderProgramLighting->uniformVec3(lightUniform + ".position", lights[i]->getPosition());
-        shaderProgramLighting->uniformVec3(lightUniform + ".color", lights[i]->getColor() * intensity);
-        shaderProgramLighting->uniformVec3(lightUniform + ".ambient", lights[i]->getAmbient());
-        shaderProgramLighting->uniformVec3(lightUniform + ".diffuse", lights[i]->getDiffuse());
-        shaderProgramLighting->uniformVec3(lightUniform + ".specular", lights[i]->getSpecular());
+    lightClusters->uniforms(shaderProgramLighting, viewportWidth, viewportHeight);
 
-        // Point Light
-        if(instanceof<PointLight>(lights[i])) {
-            PointLight* pointLight = dynamic_cast<PointLight*>(lights[i]);
-            shaderProgramLighting->uniformInt(lightUniform + ".pointLight", true);
-            shaderProgramLighting->uniformFloat(lightUniform + ".constant", pointLight->getConstant());
-            shaderProgramLighting->uniformFloat(lightUniform + ".linear", pointLight->getLinear());
-            shaderProgramLighting->uniformFloat(lightUniform + ".quadratic", pointLight->getQuadratic());
-        }else shaderProgramLighting->uniformInt(lightUniform + ".pointLight", false);
-
-    }
-    
     shaderProgramLighting->uniformInt("blinn", Light::blinn);
     shaderProgramLighting->uniformVec3("viewPos", camera->getEye());
     shaderProgramLighting->uniformInt("shadowMapping", shadowMapping);
+    shaderProgramLighting->uniformInt("objectLighting", objectLighting);
 }
 
 void Renderer::pbrShaderUniforms() {
 
-    shaderProgramPBR->uniformInt("nLights", nLights);
-
-    for(int i = 0; i < nLights; i ++) {
-
-        float intensity = hdr ? lights[i]->getIntensity() : 1.0f;
-
-        // Directional Light
-        std::string lightUniform = "lights[" + std::to_string(i) + "]";
-        shaderProgramPBR->uniformVec3(lightUniform + ".position", lights[i]->getPosition());
-        shaderProgramPBR->uniformVec3(lightUniform + ".color", lights[i]->getColor() * intensity);
+    lightClusters->uniforms(shaderProgramPBR, viewportWidth, viewportHeight);
 
-        // Point Light
-        if(instanceof<PointLight>(lights[i])) {
-            PointLight* pointLight = dynamic_cast<PointLight*>(lights[i]);
-            shaderProgramPBR->uniformInt(lightUniform + ".pointLight", true);
-            shaderProgramPBR->uniformFloat(lightUniform + ".constant", pointLight->getConstant());
-            shaderProgramPBR->uniformFloat(lightUniform + ".linear", pointLight->getLinear());
-            shaderProgramPBR->uniformFloat(lightUniform + ".quadratic", pointLight->getQuadratic());
-        }else shaderProgramPBR->uniformInt(lightUniform + ".pointLight", false);
-    }
-    
     shaderProgramPBR->uniformVec3("viewPos", camera->getEye());
+    shaderProgramPBR->uniformInt("objectLighting", objectLighting);
     //shaderProgramPBR->uniformInt("shadowMapping", shadowMapping);
 }
 
+void Renderer::objectLightUniforms(ShaderProgram::Ptr& shaderProgram, const int* lights, unsigned int count) {
+    shaderProgram->uniformInt("objectLightCount", count);
+    if(count > 0) shaderProgram->uniformIntArray("objectLights", lights, count);
+}
+
+void Renderer::objectLightUniforms(ShaderProgram::Ptr& shaderProgram, const glm::mat4& model, const std::shared_ptr<Polytope>& polytope) {
+    int lights[OBJECT_MAX_LIGHTS];
+    unsigned int count = objectLights->query(model, polytope->getBoundsMin(), polytope->getBoundsMax(), lights);
+    objectLightUniforms(shaderProgram, lights, count);
+}
+
 void Renderer::lightMaterialUniforms(const std::shared_ptr<Polytope>& polytope) {
 
     Material::Ptr material = polytope->getMaterial();
@@ -347,7 +373,7 @@ void Renderer::lightMaterialUniforms(const std::shared_ptr<Polytope>& polytope)
     shaderProgramLighting->uniformFloat("emissionStrength", polytope->getEmissionStrength());
 }
 
-void Renderer::pbrMaterialUniforms(const std::shared_ptr<Polytope>& polytope) {
+void Renderer::pbrMaterialUniforms(ShaderProgram::Ptr& shaderProgram, const std::shared_ptr<Polytope>& polytope) {
 
     Material::Ptr material = polytope->getMaterial();
 
@@ -356,10 +382,10 @@ void Renderer::pbrMaterialUniforms(const std::shared_ptr<Polytope>& polytope) {
         
         PBRMaterial* pbrMaterial = dynamic_cast<PBRMaterial*>(material.get()); 
 
-        shaderProgramPBR->uniformVec3("material.albedo", pbrMaterial->getAlbedo());
-        shaderProgramPBR->uniformFloat("material.metallic", pbrMaterial->getMetallic());
-        shaderProgramPBR->uniformFloat("material.roughness", pbrMaterial->getRoughness());
-        shaderProgramPBR->uniformFloat("material.ao", pbrMaterial->getAmbientOcclusion());
+        shaderProgram->uniformVec3("material.albedo", pbrMaterial->getAlbedo());
+        shaderProgram->uniformFloat("material.metallic", pbrMaterial->getMetallic());
+        shaderProgram->uniformFloat("material.roughness", pbrMaterial->getRoughness());
+        shaderProgram->uniformFloat("material.ao", pbrMaterial->getAmbientOcclusion());
     }
 }
 
@@ -378,10 +404,9 @@ void Renderer::pbrMVPuniform(const glm::mat4& model) {
 }
 
 void Renderer::shadowMappingUniforms() {
+    if(pointShadowMapping) pointShadows->uniforms(shaderProgramLighting);
     if(!shadowMapping) return;
-    depthMap->bind();
-    shaderProgramLighting->uniformInt("shadowMap", depthMap->getID() - 1);
-    shaderProgramLighting->uniformMat4("lightSpaceMatrix", lightSpaceMatrix);
+    shadowCascades->uniforms(shaderProgramLighting);
     shaderProgramLighting->uniformVec3("lightPos", shadowLightPos);
 }
 
@@ -406,22 +431,10 @@ void Renderer::setViewport(unsigned int viewportWidth, unsigned int viewportHeig
 }
 
 void Renderer::initShadowMapping() {
- 
-    depthMapFBO = FrameBuffer::New();
-
-    depthMap = DepthTexture::New(SHADOW_MAP_WIDTH, SHADOW_MAP_WIDTH);
-    depthMap->bind();
-
-    depthMapFBO->bind();
-    depthMapFBO->toTexture(GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMap->getID());
-
-    glDrawBuffer(GL_NONE);
-    glReadBuffer(GL_NONE);
-    
-    depthMapFBO->unbind();
-
-    shaderProgramLighting->useProgram();
-    shaderProgramLighting->uniformInt("shadowMap", depthMap->getID() - 1);
+    // The depth textures are created the first time the shadows are rendered
+    shadowCascades = ShadowCascades::New();
+    shadowAtlas = ShadowAtlas::New();
+    pointShadows = PointShadows::New();
 }
 
 void Renderer::initHDR() {
@@ -444,7 +457,7 @@ void Renderer::initHDR() {
     hdrFBO->unbind();
 }
 
-void Renderer::renderScenesToDepthMap(std::vector<Scene::Ptr>& scenes) {
+void Renderer::renderScenesToDepthMap(std::vector<Scene::Ptr>& scenes, unsigned int cascade, ShadowCasters casters) {
 
     for(auto& scene : scenes) {
 
@@ -454,26 +467,79 @@ void Renderer::renderScenesToDepthMap(std::vector<Scene::Ptr>& scenes) {
                 for(auto& group : scene->getGroups()) {
 
                     if(!group->isVisible()) continue;
+                    if(casters != ALL_CASTERS && group->isDynamicShadow() != (casters == DYNAMIC_CASTERS)) continue;
 
-                    for(auto& polytope : group->getPolytopes()) {
+                    for(auto& polytope : group->getDrawPolytopes()) {
                         
                         glm::mat4 model = scene->getModelMatrix() * group->getModelMatrix() * polytope->getModelMatrix();
 
-                        shaderProgramDepthMap->uniformMat4("model", model);
+                        // Casters outside of the cascade or behind the receivers
+                        if(!shadowCascades->isCaster(cascade, model, polytope->getBoundsMin(), polytope->getBoundsMax())) {
+                            RenderStats::countCulled();
+                            continue;
+                        }
+
+                        // Quantized positions are decoded by the model matrix
+                        shaderProgramDepthMap->uniformMat4("model", model * polytope->getPositionDecode());
 
-                        glCullFace(GL_BACK);
-                        polytope->draw(group->getPrimitive(), group->isShowWire());
-                        glCullFace(GL_FRONT);
+                        RenderDevice::get()->cullFace(GL_BACK);
+                        polytope->drawPositions(group->getPrimitive(), group->isShowWire());
+                        RenderDevice::get()->cullFace(GL_FRONT);
                     }
                 }
 
                 // Render child scenes
-                renderScenesToDepthMap(scene->getScenes());
+                renderScenesToDepthMap(scene->getScenes(), cascade, casters);
             }
         }
 }
 
+// FNV-1a over 32 bits words
+static inline void hashWords(uint64_t& hash, const void* data, size_t size) {
+    const uint32_t* words = (const uint32_t*)data;
+    for(size_t i = 0; i < size / sizeof(uint32_t); i ++) {
+        hash ^= words[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+void Renderer::shadowCasterSignature(std::vector<Scene::Ptr>& scenes, uint64_t& signature, bool& dynamicCasters) {
+
+    for(auto& scene : scenes) {
+
+        if(!scene->isVisible()) continue;
+
+        hashWords(signature, &scene->getModelMatrix(), sizeof(glm::mat4));
+
+        for(auto& group : scene->getGroups()) {
+
+            if(!group->isVisible()) continue;
+            if(group->isDynamicShadow()) {
+                dynamicCasters = true;
+                continue;
+            }
+
+            // Transforms, bounds (they change with the vertices) and the ids of the polytopes themselves,
+            // an address can be reused by a new one
+            uint64_t groupID = group->getID();
+            hashWords(signature, &groupID, sizeof(groupID));
+            hashWords(signature, &group->getModelMatrix(), sizeof(glm::mat4));
+
+            for(auto& polytope : group->getDrawPolytopes()) {
+                uint64_t polytopeID = polytope->getID();
+                hashWords(signature, &polytopeID, sizeof(polytopeID));
+                hashWords(signature, &polytope->getModelMatrix(), sizeof(glm::mat4));
+                hashWords(signature, &polytope->getBoundsMin(), sizeof(glm::vec3));
+                hashWords(signature, &polytope->getBoundsMax(), sizeof(glm::vec3));
+            }
+        }
+
+        shadowCasterSignature(scene->getScenes(), signature, dynamicCasters);
+    }
+}
+
 void Renderer::renderScenes(std::vector<Scene::Ptr>& scenes) {
+    RENDERERGL_ZONE("Renderer::renderScenes");
     for(auto& scene : scenes) {
         if(scene->isVisible()) {
             // Draw groups
@@ -486,103 +552,641 @@ void Renderer::renderScenes(std::vector<Scene::Ptr>& scenes) {
     }
 }
 
+void Renderer::renderScenesOccluded(std::vector<Scene::Ptr>& scenes) {
+    RENDERERGL_ZONE("Renderer::renderScenesOccluded");
+
+    OcclusionQueries::Ptr& queries = gBufferPass ? gBufferQueries : sceneQueries;
+    queries->beginFrame(projection * view);
+
+    // The nodes visible in the last frame are drawn first, the hidden ones are tested against their depth.
+    // The blended ones come last, the depth they write doesn't hide what is behind them
+    for(auto& scene : scenes) {
+        if(scene->isVisible()) queryScene(scene);
+    }
+    for(auto& node : hiddenNodes) drawDeferredNode(node, true);
+    for(auto& node : blendedNodes) drawDeferredNode(node, false);
+    hiddenNodes.clear();
+    blendedNodes.clear();
+}
+
+bool Renderer::queryScene(Scene::Ptr& scene) {
+    OcclusionQueries::Ptr& queries = gBufferPass ? gBufferQueries : sceneQueries;
+
+    if(queries->isHidden(scene.get()) && !isPinned(scene)) {
+        hiddenNodes.push_back({ scene, nullptr, nullptr });
+        return false;
+    }
+
+    // The children hidden with their scene are tested again once it is visible
+    bool revealed = queries->isRevealed(scene.get());
+    bool visible = false;
+    for(auto& group : scene->getGroups()) {
+        if(!group->isVisible()) continue;
+        if(revealed) queries->setVisible(group.get(), true);
+        if(queryGroup(scene, group)) visible = true;
+    }
+    for(auto& child : scene->getScenes()) {
+        if(!child->isVisible()) continue;
+        if(revealed) queries->setVisible(child.get(), true);
+        if(queryScene(child)) visible = true;
+    }
+
+    queries->setVisible(scene.get(), visible);
+    return visible;
+}
+
+bool Renderer::queryGroup(Scene::Ptr& scene, Group::Ptr& group) {
+    OcclusionQueries::Ptr& queries = gBufferPass ? gBufferQueries : sceneQueries;
+
+    // The batches of a multi drawn group are queried together
+    if(multiDrawIndirect && !group->isShowWire()) {
+        if(isBlended(group)) {
+            blendedNodes.push_back({ scene, group, nullptr });
+            return true;
+        }
+        if(queries->isHidden(group.get()) && !isPinned(group)) {
+            hiddenNodes.push_back({ scene, group, nullptr });
+            return false;
+        }
+        bool query = queries->beginQuery(group.get());
+        drawGroup(scene, group);
+        if(query) queries->endQuery();
+        return true;
+    }
+
+    // Every polytope was hidden, one query of the group box instead of one per polytope
+    if(queries->isHidden(group.get()) && !isPinned(group)) {
+        hiddenNodes.push_back({ scene, group, nullptr });
+        return false;
+    }
+
+    bool revealed = queries->isRevealed(group.get());
+    bool visible = false, drawn = false;
+
+    groupSettings(group);
+
+    for(auto& polytope : group->getDrawPolytopes()) {
+
+        // Drawn by the other pass
+        bool shade = drawsDeferred(group, polytope) == gBufferPass;
+        if(!shade && (gBufferPass || !polytope->isSelected())) continue;
+        drawn = true;
+
+        // Transparent polytopes are drawn last and selected ones keep their outline, they aren't queried
+        if(polytope->isTransparent()) {
+            blendedNodes.push_back({ scene, group, polytope });
+            visible = true;
+            continue;
+        }
+        if(polytope->isSelected()) {
+            drawPolytope(scene, group, polytope);
+            visible = true;
+            continue;
+        }
+
+        if(revealed) queries->setVisible(polytope.get(), true);
+        if(queries->isHidden(polytope.get())) {
+            hiddenNodes.push_back({ scene, group, polytope });
+            continue;
+        }
+
+        bool query = queries->beginQuery(polytope.get());
+        drawPolytope(scene, group, polytope);
+        if(query) queries->endQuery();
+        visible = true;
+    }
+
+    drawBakedSelection(scene, group);
+    defaultPrimitiveSettings();
+
+    // A group with nothing in this pass isn't hidden, its box would be queried for nothing
+    queries->setVisible(group.get(), visible || !drawn);
+    return visible;
+}
+
+void Renderer::drawDeferredNode(DeferredNode& node, bool occluded) {
+    OcclusionQueries::Ptr& queries = gBufferPass ? gBufferQueries : sceneQueries;
+
+    if(!occluded) {
+        if(node.polytope == nullptr) drawGroup(node.scene, node.group);
+        else {
+            groupSettings(node.group);
+            drawPolytope(node.scene, node.group, node.polytope);
+            defaultPrimitiveSettings();
+        }
+        return;
+    }
+
+    glm::vec3 low(std::numeric_limits<float>::max()), high(-std::numeric_limits<float>::max());
+    const void* key;
+    if(node.group == nullptr) {
+        sceneBounds(node.scene, low, high);
+        key = node.scene.get();
+    }
+    else if(node.polytope == nullptr) {
+        groupBounds(node.scene->getModelMatrix() * node.group->getModelMatrix(), node.group, low, high);
+        key = node.group.get();
+    }
+    else {
+        glm::mat4 model = node.scene->getModelMatrix() * node.group->getModelMatrix() * node.polytope->getModelMatrix();
+        OcclusionQueries::expandBounds(model, node.polytope->getBoundsMin(), node.polytope->getBoundsMax(), low, high);
+        key = node.polytope.get();
+    }
+
+    // Nothing to draw
+    if(low.x > high.x) return;
+
+    bool conditional = queries->beginConditionalRender(key, low, high);
+
+    // No queries inside, conditional renders can't be nested
+    if(node.group == nullptr) {
+        for(auto& group : node.scene->getGroups()) drawGroup(node.scene, group);
+        renderScenes(node.scene->getScenes());
+    }
+    else if(node.polytope == nullptr) drawGroup(node.scene, node.group);
+    else {
+        groupSettings(node.group);
+        drawPolytope(node.scene, node.group, node.polytope);
+        defaultPrimitiveSettings();
+    }
+
+    if(conditional) queries->endConditionalRender();
+}
+
+bool Renderer::isBlended(Group::Ptr& group) {
+    for(auto& polytope : group->getDrawPolytopes()) {
+        if(polytope->isTransparent()) return true;
+    }
+    return false;
+}
+
+bool Renderer::isPinned(Group::Ptr& group) {
+    for(auto& polytope : group->getDrawPolytopes()) {
+        if(polytope->isTransparent() || polytope->isSelected()) return true;
+    }
+    if(group->isBaked()) {
+        for(auto& polytope : group->getPolytopes()) {
+            if(polytope->isSelected()) return true;
+        }
+    }
+    return false;
+}
+
+bool Renderer::isPinned(Scene::Ptr& scene) {
+    for(auto& group : scene->getGroups()) {
+        if(group->isVisible() && isPinned(group)) return true;
+    }
+    for(auto& child : scene->getScenes()) {
+        if(child->isVisible() && isPinned(child)) return true;
+    }
+    return false;
+}
+
+void Renderer::groupBounds(const glm::mat4& model, Group::Ptr& group, glm::vec3& low, glm::vec3& high) {
+    for(auto& polytope : group->getDrawPolytopes()) {
+        OcclusionQueries::expandBounds(model * polytope->getModelMatrix(), polytope->getBoundsMin(), polytope->getBoundsMax(), low, high);
+    }
+}
+
+void Renderer::sceneBounds(Scene::Ptr& scene, glm::vec3& low, glm::vec3& high) {
+    for(auto& group : scene->getGroups()) {
+        if(group->isVisible()) groupBounds(scene->getModelMatrix() * group->getModelMatrix(), group, low, high);
+    }
+    for(auto& child : scene->getScenes()) {
+        if(child->isVisible()) sceneBounds(child, low, high);
+    }
+}
+
+void Renderer::collectOccluders(std::vector<Scene::Ptr>& scenes) {
+
+    for(auto& scene : scenes) {
+
+        if(!scene->isVisible()) continue;
+
+        for(auto& group : scene->getGroups()) {
+
+            if(!group->isVisible() || group->isShowWire() || group->getPrimitive() != GL_TRIANGLES) continue;
+
+            // The originals of a baked group keep their occluders
+            for(auto& polytope : group->getPolytopes()) {
+                if(!polytope->isOccluder() || polytope->isTransparent()) continue;
+
+                glm::mat4 model = scene->getModelMatrix() * group->getModelMatrix() * polytope->getModelMatrix();
+                softwareOcclusion->addOccluder(model, *polytope->getOccluder(), polytope->getFaceCulling());
+            }
+        }
+
+        collectOccluders(scene->getScenes());
+    }
+}
+
+bool Renderer::isSoftwareOccluded(Scene::Ptr& scene, Group::Ptr& group, Polytope::Ptr& polytope, const glm::mat4& model) {
+
+    // Selected polytopes keep their outline
+    if(!softwareCulling || polytope->isSelected()) return false;
+
+    // Tested and counted by the depth pre-pass of this frame
+    if(drawsDepthPrePass(group, polytope)) return softwareOccludedDraws.count(DrawKey(scene.get(), group.get(), polytope.get())) > 0;
+
+    if(softwareOcclusion->isVisible(model, polytope->getBoundsMin(), polytope->getBoundsMax())) return false;
+
+    RenderStats::countCulled();
+    return true;
+}
+
 void Renderer::renderToDepthMap() {
 
     if(!hasLight) return;
 
-    loadPreviousFBO();
+    // Splits and light space matrices of the camera frustum
+    shadowCascades->update(camera->getProjectionMatrix(), camera->getViewMatrix(), shadowLightPos, cameraNearPlane, cameraFarPlane);
 
-    glViewport(0, 0, SHADOW_MAP_WIDTH, SHADOW_MAP_WIDTH);
-    depthMapFBO->bind();
+    // The static casters are drawn again only when they or the cascade change
+    uint64_t signature = 14695981039346656037ull;
+    bool dynamicCasters = false;
+    {
+        RENDERERGL_ZONE("Renderer::shadowCasterSignature");
+        shadowCasterSignature(scenes, signature, dynamicCasters);
+    }
+    shadowCascades->setCasters(signature, dynamicCasters);
+
+    bool cachedCascades = !dynamicCasters;
+    for(unsigned int i = 0; i < shadowCascades->getCascadeCount(); i ++) cachedCascades &= shadowCascades->isCached(i);
+    if(cachedCascades) return;
 
-    // Shaders
-    lightSpaceMatrix = getLightSpaceMatrix(cameraNearPlane, cameraFarPlane);
+    loadPreviousFBO();
 
     shaderProgramDepthMap->useProgram();
-    shaderProgramDepthMap->uniformMat4("lightSpaceMatrix", lightSpaceMatrix);
 
-    // Draw
-    glClear(GL_DEPTH_BUFFER_BIT);
+    // Casters between the light and a cascade are clamped to its near plane instead of clipped
+    RenderDevice::get()->enable(GL_DEPTH_CLAMP);
+
+    for(unsigned int i = 0; i < shadowCascades->getCascadeCount(); i ++) {
+
+        bool cached = shadowCascades->isCached(i);
+        if(cached && !dynamicCasters) continue;
+
+        shaderProgramDepthMap->uniformMat4("lightSpaceMatrix", shadowCascades->getCascade(i).lightSpaceMatrix);
 
-    renderScenesToDepthMap(scenes);
+        if(!cached) {
+            shadowCascades->bindStaticCascade(i);
+            RenderDevice::get()->clear(GL_DEPTH_BUFFER_BIT);
+            renderScenesToDepthMap(scenes, i, dynamicCasters ? STATIC_CASTERS : ALL_CASTERS);
+        }
+
+        // Static shadows and the dynamic casters over them
+        if(dynamicCasters) {
+            shadowCascades->restoreCascade(i);
+            renderScenesToDepthMap(scenes, i, DYNAMIC_CASTERS);
+        }
+    }
 
-    // Save the texture to an image file
-    /*if (depthMap->saveDepthTextureToImage(SHADOW_MAP_WIDTH, SHADOW_MAP_HEIGHT, "depth_map.png")) {
-        std::cout << "Image saved successfully!" << std::endl;
-    } else {
-        std::cerr << "Failed to save image." << std::endl;
-    }*/
+    RenderDevice::get()->disable(GL_DEPTH_CLAMP);
 
     bindPreviousFBO();
 }
 
-void Renderer::drawGroup(Scene::Ptr& scene, Group::Ptr& group) {
-    
-    if(!group->isVisible()) return;
+void Renderer::collectPointShadowCasters(std::vector<Scene::Ptr>& scenes, unsigned int slot, uint64_t* signatures, unsigned int& dynamicFaces) {
+
+    for(auto& scene : scenes) {
+
+        if(!scene->isVisible()) continue;
+
+        for(auto& group : scene->getGroups()) {
+
+            // The geometry shader takes triangles
+            unsigned int primitive = group->getPrimitive();
+            if(!group->isVisible()) continue;
+            if(primitive != GL_TRIANGLES && primitive != GL_TRIANGLE_STRIP && primitive != GL_TRIANGLE_FAN) continue;
+
+            for(auto& polytope : group->getDrawPolytopes()) {
+
+                glm::mat4 model = scene->getModelMatrix() * group->getModelMatrix() * polytope->getModelMatrix();
+
+                // Faces of the light the caster can shadow
+                unsigned int faces = pointShadows->getCasterFaces(slot, model, polytope->getBoundsMin(), polytope->getBoundsMax());
+                if(faces == 0) {
+                    RenderStats::countCulled();
+                    continue;
+                }
+
+                if(group->isDynamicShadow()) dynamicFaces |= faces;
+                else {
+                    uint64_t polytopeID = polytope->getID();
+                    for(unsigned int face = 0; face < 6; face ++) {
+                        if((faces & (1u << face)) == 0) continue;
+                        hashWords(signatures[face], &polytopeID, sizeof(polytopeID));
+                        hashWords(signatures[face], &model, sizeof(glm::mat4));
+                        hashWords(signatures[face], &polytope->getBoundsMin(), sizeof(glm::vec3));
+                        hashWords(signatures[face], &polytope->getBoundsMax(), sizeof(glm::vec3));
+                    }
+                }
+
+                pointShadowDraws.push_back({ model, group, polytope, faces });
+            }
+        }
+
+        collectPointShadowCasters(scene->getScenes(), slot, signatures, dynamicFaces);
+    }
+}
+
+void Renderer::renderPointShadows() {
+
+    bool bound = false;
+
+    for(unsigned int slot = 0; slot < pointShadows->getBudget(); slot ++) {
+
+        if(pointShadows->getSlotData(slot).light == nullptr) continue;
 
-    glViewport(0, 0, viewportWidth, viewportHeight);
+        // Casters and signatures of the faces, only the faces which changed are drawn again
+        uint64_t signatures[6];
+        std::fill(signatures, signatures + 6, 14695981039346656037ull);
+        unsigned int dynamicFaces = 0;
+        {
+            RENDERERGL_ZONE("Renderer::collectPointShadowCasters");
+            pointShadowDraws.clear();
+            collectPointShadowCasters(scenes, slot, signatures, dynamicFaces);
+        }
+
+        unsigned int faces = pointShadows->setCasters(slot, signatures, dynamicFaces);
+        if(faces == 0) continue;
+
+        if(!bound) {
+            loadPreviousFBO();
+            shaderProgramPointShadow->useProgram();
+            bound = true;
+        }
+
+        pointShadows->bindFaces(slot, faces, dynamicFaces);
+        pointShadows->depthUniforms(shaderProgramPointShadow, slot);
+
+        for(auto& draw : pointShadowDraws) {
+
+            if((draw.faces & faces) == 0) continue;
+
+            // Quantized positions are decoded by the model matrix
+            shaderProgramPointShadow->uniformInt("faceMask", draw.faces & faces);
+            shaderProgramPointShadow->uniformMat4("model", draw.model * draw.polytope->getPositionDecode());
+
+            RenderDevice::get()->cullFace(GL_BACK);
+            draw.polytope->drawPositions(draw.group->getPrimitive(), draw.group->isShowWire());
+            RenderDevice::get()->cullFace(GL_FRONT);
+        }
+    }
+
+    // Don't keep the polytopes alive until the next frame
+    pointShadowDraws.clear();
+
+    if(bound) bindPreviousFBO();
+}
+
+void Renderer::groupSettings(Group::Ptr& group) {
+
+    RenderDevice::get()->viewport(0, 0, viewportWidth, viewportHeight);
 
     primitiveSettings(group);
 
     enableBlending();
-    glEnable(GL_DEPTH_TEST);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    RenderDevice::get()->enable(GL_DEPTH_TEST);
+    RenderDevice::get()->blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // The G-buffer targets aren't blended, the alpha of the albedo is the ambient occlusion
+    if(gBufferPass) RenderDevice::get()->disable(GL_BLEND);
+}
+
+void Renderer::drawGroup(Scene::Ptr& scene, Group::Ptr& group) {
+
+    RENDERERGL_ZONE("Renderer::drawGroup");
+
+    if(!group->isVisible()) return;
+
+    groupSettings(group);
+
+    // Polytopes in the geometry arena are drawn in batches, the rest one by one
+    std::vector<Polytope::Ptr>* polytopes = &group->getDrawPolytopes();
+    std::vector<Polytope::Ptr> remaining;
+    if(multiDrawIndirect && !group->isShowWire()) {
+        multiDrawGroup(scene, group, remaining);
+        polytopes = &remaining;
+    }
     
-    for(auto& polytope : group->getPolytopes()) {
+    for(auto& polytope : *polytopes) drawPolytope(scene, group, polytope);
+
+    drawBakedSelection(scene, group);
+
+    // Set default primitive settings
+    defaultPrimitiveSettings();
+}
+
+void Renderer::drawPolytope(Scene::Ptr& scene, Group::Ptr& group, Polytope::Ptr& polytope) {
 
-        // Compute model matrix from polytope, group and scene
-        glm::mat4 model = scene->getModelMatrix() * group->getModelMatrix() * polytope->getModelMatrix();
-        glm::mat4 mvp = projection * view * model;
+    // The G-buffer pass draws the deferred polytopes, the forward pass the rest
+    bool shade = drawsDeferred(group, polytope) == gBufferPass;
+    if(!shade && (gBufferPass || !polytope->isSelected())) return;
 
-        // PBR 
-        if(pbr) {
+    // Compute model matrix from polytope, group and scene
+    glm::mat4 model = scene->getModelMatrix() * group->getModelMatrix() * polytope->getModelMatrix();
+    glm::mat4 mvp = projection * view * model;
+
+    if(isSoftwareOccluded(scene, group, polytope, model)) return;
+
+    // Deferred polytopes only get their selection outline in the forward pass
+    if(!shade) {
+        drawSelection(mvp, group, polytope);
+        return;
+    }
+
+    // G-buffer
+    if(gBufferPass) {
+        shaderProgramGBuffer->useProgram();
+        shaderProgramGBuffer->uniformVec3("viewPos", camera->getEye());
+        pbrMaterialUniforms(shaderProgramGBuffer, polytope);
+        textureUniform(shaderProgramGBuffer, polytope);
+        mvpUniform(shaderProgramGBuffer, model);
+    }
+
+    // PBR 
+    else if(pbr) {
+        shaderProgramPBR->useProgram();
+        pbrShaderUniforms();
+        pbrMaterialUniforms(shaderProgramPBR, polytope);
+        textureUniform(shaderProgramPBR, polytope);
+        pbrMVPuniform(model);
+        //shadowMappingUniforms();
+        if(objectLighting) objectLightUniforms(shaderProgramPBR, model, polytope);
+    }
+        
+    // Phong lighting
+    else if(hasLight) {
+        shaderProgramLighting->useProgram();
+        lightShaderUniforms();
+        lightMaterialUniforms(polytope);
+        textureUniform(shaderProgramLighting, polytope);
+        lightMVPuniform(model);
+        shadowMappingUniforms();
+        if(objectLighting) objectLightUniforms(shaderProgramLighting, model, polytope);
+    }
+
+    // Default  
+    else {
+        shaderProgram->useProgram();
+        shaderProgram->uniformMat4("mvp", mvp);
+        textureUniform(shaderProgram, polytope);
+    }
+    
+    // Set face culling
+    setFaceCulling(polytope);
+
+    // The depth pre-pass already wrote the depth, only the visible fragments are shaded
+    bool prePassed = drawsDepthPrePass(group, polytope);
+    if(prePassed) {
+        RenderDevice::get()->depthFunc(GL_EQUAL);
+        RenderDevice::get()->depthMask(GL_FALSE);
+    }
+
+    // Draw polytope
+    polytope->draw(group->getPrimitive(), group->isShowWire());
+
+    if(prePassed) {
+        RenderDevice::get()->depthFunc(GL_LESS);
+        RenderDevice::get()->depthMask(GL_TRUE);
+    }
+
+    // Draw selected polytope if selected
+    if(polytope->isSelected() && !gBufferPass) drawSelection(mvp, group, polytope);
+
+    // unbind textures
+    for(auto& texture : polytope->getTextures()) texture->unbind();
+}
+
+void Renderer::drawBakedSelection(Scene::Ptr& scene, Group::Ptr& group) {
+
+    // Baked polytopes don't know about selection, the selected originals are drawn on top
+    if(group->isBaked() && !gBufferPass) {
+        for(auto& polytope : group->getPolytopes()) {
+            if(!polytope->isSelected() || !group->isBakedSource(polytope)) continue;
+
+            glm::mat4 mvp = projection * view * scene->getModelMatrix() * group->getModelMatrix() * polytope->getModelMatrix();
+            drawSelection(mvp, group, polytope);
+        }
+    }
+}
+
+void Renderer::multiDrawGroup(Scene::Ptr& scene, Group::Ptr& group, std::vector<Polytope::Ptr>& remaining) {
+
+    // Draws sharing material, textures, face culling, emission, depth pre-pass and lights can go in the same command buffer
+    typedef std::tuple<Material*, std::vector<Texture*>, int, float, bool, std::vector<int>> BatchKey;
+    std::map<BatchKey, std::vector<Polytope::Ptr>> batches;
+    std::vector<BatchKey> order;    // first seen, the keys hold addresses
+
+    bool lit = objectLighting && !gBufferPass && (pbr || hasLight);
+    glm::mat4 groupModel = scene->getModelMatrix() * group->getModelMatrix();
+
+    for(auto& polytope : group->getDrawPolytopes()) {
+        // Selected polytopes need the outline pass
+        if(!geometryArena->contains(polytope) || polytope->isSelected()) {
+            remaining.push_back(polytope);
+            continue;
+        }
+
+        // Drawn by the other pass
+        if(drawsDeferred(group, polytope) != gBufferPass) continue;
+
+        if(isSoftwareOccluded(scene, group, polytope, groupModel * polytope->getModelMatrix())) continue;
+
+        std::vector<Texture*> textures;
+        for(auto& texture : polytope->getTextures()) textures.push_back(texture.get());
+
+        // Polytopes in the same lights share them
+        std::vector<int> lights;
+        if(lit) {
+            int indices[OBJECT_MAX_LIGHTS];
+            unsigned int count = objectLights->query(groupModel * polytope->getModelMatrix(), polytope->getBoundsMin(), polytope->getBoundsMax(), indices);
+            lights.assign(indices, indices + count);
+        }
+
+        BatchKey key(polytope->getMaterial().get(), textures, (int)polytope->getFaceCulling(), polytope->getEmissionStrength(),
+            drawsDepthPrePass(group, polytope), lights);
+
+        if(batches.find(key) == batches.end()) order.push_back(key);
+        batches[key].push_back(polytope);
+    }
+
+    RenderDevice::get()->polygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    for(auto& key : order) {
+
+        std::vector<Polytope::Ptr>& batch = batches[key];
+        std::vector<glm::mat4> models;
+        models.reserve(batch.size());
+        for(auto& polytope : batch) models.push_back(groupModel * polytope->getModelMatrix());
+
+        // Uniforms are taken from the first polytope, they are the same for the whole batch
+        Polytope::Ptr& polytope = batch.front();
+        ShaderProgram::Ptr* program;
+
+        // G-buffer
+        if(gBufferPass) {
+            program = &shaderProgramGBuffer;
+            shaderProgramGBuffer->useProgram();
+            shaderProgramGBuffer->uniformVec3("viewPos", camera->getEye());
+            pbrMaterialUniforms(shaderProgramGBuffer, polytope);
+            textureUniform(shaderProgramGBuffer, polytope);
+            mvpUniform(shaderProgramGBuffer, glm::mat4(1.f));
+        }
+
+        // PBR
+        else if(pbr) {
+            program = &shaderProgramPBR;
             shaderProgramPBR->useProgram();
             pbrShaderUniforms();
-            pbrMaterialUniforms(polytope);
+            pbrMaterialUniforms(shaderProgramPBR, polytope);
             textureUniform(shaderProgramPBR, polytope);
-            pbrMVPuniform(model);
-            //shadowMappingUniforms();
+            pbrMVPuniform(glm::mat4(1.f));
         }
-            
+
         // Phong lighting
         else if(hasLight) {
+            program = &shaderProgramLighting;
             shaderProgramLighting->useProgram();
             lightShaderUniforms();
             lightMaterialUniforms(polytope);
             textureUniform(shaderProgramLighting, polytope);
-            lightMVPuniform(model);
+            lightMVPuniform(glm::mat4(1.f));
             shadowMappingUniforms();
         }
 
-        // Default  
+        // Default
         else {
+            program = &shaderProgram;
             shaderProgram->useProgram();
-            shaderProgram->uniformMat4("mvp", mvp);
+            shaderProgram->uniformMat4("viewProjection", projection * view);
             textureUniform(shaderProgram, polytope);
         }
-        
-        // Set face culling
+
+        if(lit) objectLightUniforms(*program, std::get<5>(key).data(), std::get<5>(key).size());
+
         setFaceCulling(polytope);
 
-        // Draw polytope
-        polytope->draw(group->getPrimitive(), group->isShowWire());
+        bool prePassed = std::get<4>(key);
+        if(prePassed) {
+            RenderDevice::get()->depthFunc(GL_EQUAL);
+            RenderDevice::get()->depthMask(GL_FALSE);
+        }
 
-        // Draw selected polytope if selected
-        if(polytope->isSelected()) {
-            shaderProgramSelection->useProgram();
-            shaderProgramSelection->uniformMat4("mvp", mvp);
+        (*program)->uniformInt("multiDraw", true);
+        if(gpuDrivenCulling) geometryArena->multiDraw(group->getPrimitive(), batch, models, *gpuCulling, *program);
+        else geometryArena->multiDraw(group->getPrimitive(), batch, models);
+        (*program)->uniformInt("multiDraw", false);
 
-            glDisable(GL_DEPTH_TEST);
-            polytope->draw(group->getPrimitive(), group->isShowWire());
-            glEnable(GL_DEPTH_TEST);
+        if(prePassed) {
+            RenderDevice::get()->depthFunc(GL_LESS);
+            RenderDevice::get()->depthMask(GL_TRUE);
         }
 
         // unbind textures
         for(auto& texture : polytope->getTextures()) texture->unbind();
     }
-
-    // Set default primitive settings
-    defaultPrimitiveSettings();
 }
 
 void Renderer::drawSkyBox() {
@@ -601,13 +1205,176 @@ void Renderer::drawSkyBox() {
     shaderProgramSkyBox->uniformMat4("projection", projection);
 
     // Draw call
-    glDepthRange(0.999,1.0);
+    RenderDevice::get()->depthRange(0.999,1.0);
     skyBox->bind();
     skyBox->draw();
-    glDepthRange(0.0,1.0);
+    RenderDevice::get()->depthRange(0.0,1.0);
 
     // set depth function back to default
-    glDepthFunc(GL_LESS);
+    RenderDevice::get()->depthFunc(GL_LESS);
+}
+
+void Renderer::drawSelection(const glm::mat4& mvp, Group::Ptr& group, Polytope::Ptr& polytope) {
+
+    shaderProgramSelection->useProgram();
+    shaderProgramSelection->uniformMat4("mvp", mvp * polytope->getPositionDecode());
+
+    RenderDevice::get()->disable(GL_DEPTH_TEST);
+    polytope->drawPositions(group->getPrimitive(), group->isShowWire());
+    RenderDevice::get()->enable(GL_DEPTH_TEST);
+}
+
+bool Renderer::drawsDeferred(Group::Ptr& group, Polytope::Ptr& polytope) {
+
+    if(!deferred || !pbr || group->isShowWire() || polytope->isTransparent()) return false;
+
+    unsigned int primitive = group->getPrimitive();
+    return primitive == GL_TRIANGLES || primitive == GL_TRIANGLE_STRIP || primitive == GL_TRIANGLE_FAN;
+}
+
+void Renderer::renderGBuffer() {
+
+    RENDERERGL_ZONE("Renderer::renderGBuffer");
+
+    if(gBuffer == nullptr || gBuffer->getWidth() != viewportWidth || gBuffer->getHeight() != viewportHeight)
+        gBuffer = GBuffer::New(viewportWidth, viewportHeight);
+
+    // Frame buffer of the lighting and forward passes
+    GLint targetFBO;
+    RenderDevice::get()->getIntegerv(GL_FRAMEBUFFER_BINDING, &targetFBO);
+
+    // Pixels without geometry keep the depth 1, the color isn't read there
+    gBuffer->bind();
+    RenderDevice::get()->viewport(0, 0, viewportWidth, viewportHeight);
+    RenderDevice::get()->clear(GL_DEPTH_BUFFER_BIT);
+
+    gBufferPass = true;
+    if(occlusionCulling) renderScenesOccluded(scenes);
+    else renderScenes(scenes);
+    gBufferPass = false;
+
+    RenderDevice::get()->enable(GL_BLEND);
+    RenderDevice::get()->bindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+}
+
+void Renderer::renderDeferredLighting() {
+
+    RENDERERGL_ZONE("Renderer::renderDeferredLighting");
+
+    shaderProgramDeferredLighting->useProgram();
+    lightClusters->uniforms(shaderProgramDeferredLighting, viewportWidth, viewportHeight);
+    shaderProgramDeferredLighting->uniformMat4("inverseProjection", glm::inverse(projection));
+    shaderProgramDeferredLighting->uniformMat4("inverseView", glm::inverse(view));
+    shaderProgramDeferredLighting->uniformVec3("viewPos", camera->getEye());
+    gBuffer->bindTextures(shaderProgramDeferredLighting);
+
+    // The quad writes the depth of the G-buffer, the forward pass and the skybox test against it
+    RenderDevice::get()->viewport(0, 0, viewportWidth, viewportHeight);
+    RenderDevice::get()->enable(GL_DEPTH_TEST);
+    RenderDevice::get()->depthFunc(GL_ALWAYS);
+    RenderDevice::get()->disable(GL_BLEND);
+    disableFaceCulling();
+
+    quadVAO->bind();
+    RenderDevice::get()->polygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    RenderDevice::get()->drawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    RenderStats::countDraw(GL_TRIANGLE_STRIP, 4);
+    quadVAO->unbind();
+
+    RenderDevice::get()->depthFunc(GL_LESS);
+    RenderDevice::get()->enable(GL_BLEND);
+    gBuffer->unbindTextures();
+}
+
+bool Renderer::drawsDepthPrePass(Group::Ptr& group, Polytope::Ptr& polytope) {
+
+    if(!depthPrePass || !group->isDepthPrePass() || group->isShowWire() || polytope->isTransparent()) return false;
+    if(drawsDeferred(group, polytope)) return false;
+
+    // Parallax mapping discards fragments the pre-pass would have written
+    for(auto& texture : polytope->getTextures())
+        if(texture->getType() == Texture::Type::TextureHeight) return false;
+
+    unsigned int primitive = group->getPrimitive();
+    return primitive == GL_TRIANGLES || primitive == GL_TRIANGLE_STRIP || primitive == GL_TRIANGLE_FAN;
+}
+
+void Renderer::collectDepthPrePass(std::vector<Scene::Ptr>& scenes) {
+
+    for(auto& scene : scenes) {
+
+        if(!scene->isVisible()) continue;
+
+        for(auto& group : scene->getGroups()) {
+
+            if(!group->isVisible()) continue;
+
+            for(auto& polytope : group->getDrawPolytopes()) {
+
+                if(!drawsDepthPrePass(group, polytope)) continue;
+
+                glm::mat4 model = scene->getModelMatrix() * group->getModelMatrix() * polytope->getModelMatrix();
+
+                // The scene pass takes the result from here, the box is tested once
+                if(softwareCulling && !polytope->isSelected() && !softwareOcclusion->isVisible(model, polytope->getBoundsMin(), polytope->getBoundsMax())) {
+                    softwareOccludedDraws.insert(DrawKey(scene.get(), group.get(), polytope.get()));
+                    RenderStats::countCulled();
+                    continue;
+                }
+
+                float depth = -(view * model * glm::vec4(polytope->getBoundsCenter(), 1.f)).z;
+
+                // Same condition as drawGroup, the default shader transforms batched polytopes differently
+                bool multiDrawn = multiDrawIndirect && !group->isShowWire() && geometryArena->contains(polytope) && !polytope->isSelected();
+
+                depthPrePassDraws.push_back({ depth, model, group, polytope, multiDrawn });
+            }
+        }
+
+        collectDepthPrePass(scene->getScenes());
+    }
+}
+
+void Renderer::renderDepthPrePass() {
+
+    RENDERERGL_ZONE("Renderer::renderDepthPrePass");
+
+    depthPrePassDraws.clear();
+    softwareOccludedDraws.clear();
+    collectDepthPrePass(scenes);
+
+    // Front to back, the occluded fragments fail the depth test early
+    std::sort(depthPrePassDraws.begin(), depthPrePassDraws.end(), [](const DepthPrePassDraw& a, const DepthPrePassDraw& b) {
+        return a.depth < b.depth;
+    });
+
+    shaderProgramDepthPrePass->useProgram();
+    shaderProgramDepthPrePass->uniformMat4("view", view);
+    shaderProgramDepthPrePass->uniformMat4("projection", projection);
+    shaderProgramDepthPrePass->uniformMat4("viewProjection", projection * view);
+    shaderProgramDepthPrePass->uniformInt("lighting", pbr || hasLight);
+
+    RenderDevice::get()->viewport(0, 0, viewportWidth, viewportHeight);
+    RenderDevice::get()->enable(GL_DEPTH_TEST);
+    RenderDevice::get()->depthFunc(GL_LESS);
+    RenderDevice::get()->colorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+    for(auto& draw : depthPrePassDraws) {
+        shaderProgramDepthPrePass->uniformMat4("model", draw.model);
+        shaderProgramDepthPrePass->uniformMat4("mvp", projection * view * draw.model);
+        shaderProgramDepthPrePass->uniformInt("multiDrawn", draw.multiDrawn);
+
+        setFaceCulling(draw.polytope);
+
+        // The color pass tests the exact depths, quantized positions would move them
+        if(draw.polytope->getPositionStream() == Polytope::PositionStream::FLOAT) draw.polytope->drawPositions(draw.group->getPrimitive());
+        else draw.polytope->draw(draw.group->getPrimitive());
+    }
+
+    RenderDevice::get()->colorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    // Don't keep the polytopes alive until the next frame
+    depthPrePassDraws.clear();
 }
 
 void Renderer::renderQuad() {
@@ -622,12 +1389,13 @@ void Renderer::renderQuad() {
     shaderProgramHDR->uniformInt("hdrBuffer", colorBufferTexture->getID() - 1);
 
     quadVAO->bind();
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    RenderDevice::get()->polygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    RenderDevice::get()->drawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    RenderStats::countDraw(GL_TRIANGLE_STRIP, 4);
     quadVAO->unbind();
 }
 
-void Renderer::render() {
+void Renderer::renderFrame() {
 
     frameCapturer->startCapturing();
 
@@ -639,43 +1407,157 @@ void Renderer::render() {
         view = camera->getViewMatrix();
     }
 
-    if(shadowMapping) renderToDepthMap();
+    // Assign the lights to the froxels of this frame
+    if(hasLight) {
+        RENDERERGL_ZONE("LightClusters::build");
+
+        // Lights of the point shadow budget, the first light is the one of the cascades
+        if(pointShadowMapping) pointShadows->update(lights, projection, view, glm::vec3(glm::inverse(view)[3]), hdr, lights.empty() ? nullptr : lights[0]);
+
+        // The per object lights don't need the froxels, except for the deferred lighting
+        lightClusters->setClustering(!objectLighting || (deferred && pbr));
+        lightClusters->build(lights, projection, view, hdr, pointShadowMapping ? pointShadows.get() : nullptr);
+        lightClusters->upload();
+        if(objectLighting) objectLights->build(lightClusters->getLocalLights(), lightClusters->getGlobalLights());
+    }
+
+    if(multiDrawIndirect) geometryArena->beginFrame();
+    if(multiDrawIndirect && gpuDrivenCulling) gpuCulling->beginFrame(projection * view);
+
+    // The occluders go to the software depth buffer before any draw is submitted
+    if(softwareCulling) {
+        RENDERERGL_ZONE("SoftwareOcclusion::rasterize");
+        softwareOcclusion->begin(projection * view);
+        collectOccluders(scenes);
+        softwareOcclusion->rasterize();
+    }
+
+    if(shadowMapping) {
+        stats->setPass(RenderStats::SHADOW);
+        gpuProfiler->beginScope("Shadow");
+        renderToDepthMap();
+        gpuProfiler->endScope();
+    }
+
+    if(pointShadowMapping && hasLight) {
+        stats->setPass(RenderStats::SHADOW);
+        gpuProfiler->beginScope("PointShadows");
+        renderPointShadows();
+        gpuProfiler->endScope();
+    }
 
     // FBO HDR
     if(hdr) {
         loadPreviousFBO();
         hdrFBO->bind();
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        RenderDevice::get()->clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    // Deferred shading: opaque PBR polytopes to the G-buffer, then the lights over the screen
+    if(deferred && pbr) {
+        stats->setPass(RenderStats::GBUFFER);
+        gpuProfiler->beginScope("GBuffer");
+        renderGBuffer();
+        gpuProfiler->endScope();
+
+        stats->setPass(RenderStats::LIGHTING);
+        gpuProfiler->beginScope("Lighting");
+        renderDeferredLighting();
+        gpuProfiler->endScope();
+    }
+
+    // Depth pre-pass: the scene pass shades the visible fragments only
+    if(depthPrePass) {
+        stats->setPass(RenderStats::DEPTH_PREPASS);
+        gpuProfiler->beginScope("DepthPrePass");
+        renderDepthPrePass();
+        gpuProfiler->endScope();
     }
 
     // Draw scenes
-    renderScenes(scenes);
+    stats->setPass(RenderStats::SCENE);
+    gpuProfiler->beginScope("Scene");
+    if(occlusionCulling) renderScenesOccluded(scenes);
+    else renderScenes(scenes);
+    gpuProfiler->endScope();
+
+    // Depths the next frame is culled against
+    if(multiDrawIndirect && gpuDrivenCulling) {
+        stats->setPass(RenderStats::OTHER);
+        gpuProfiler->beginScope("DepthPyramid");
+        if(hdr) gpuCulling->buildDepthPyramid(hdrFBO->getID(), rboDepth->getInternalFormat(), 1, viewportWidth, viewportHeight, quadVAO);
+        else {
+            MultiSampleRenderBuffer::Ptr& depthBuffer = frameCapturer->getDepthBuffer();
+            gpuCulling->buildDepthPyramid(frameCapturer->getFrameBuffer()->getID(), depthBuffer->getInternalFormat(), depthBuffer->getSamples(),
+                viewportWidth, viewportHeight, quadVAO);
+        }
+        gpuProfiler->endScope();
+    }
 
     // Draw skybox
+    stats->setPass(RenderStats::SKYBOX);
+    gpuProfiler->beginScope("SkyBox");
     drawSkyBox();
+    gpuProfiler->endScope();
 
     // Draw HDR texture to quad
+    stats->setPass(RenderStats::POST_PROCESS);
     if(hdr) {
+        gpuProfiler->beginScope("HDR");
         bindPreviousFBO();
         renderQuad();
+        gpuProfiler->endScope();
     }
 
+    gpuProfiler->beginScope("FrameCapturer");
     frameCapturer->finishCapturing();
+    gpuProfiler->endScope();
+
+    // Release the buffer heap ranges the GPU is done with and defragment a bit every frame
+    for(BufferHeap::Ptr heap : { VertexBuffer::getHeap(), IndexBuffer::getHeap() }) {
+        if(heap == nullptr) continue;
+        heap->collect();
+        heap->compact(HEAP_COMPACTION_BUDGET);
+    }
+}
+
+void Renderer::render() {
+    RENDERERGL_FRAME_MARK();
+    RENDERERGL_ZONE("Renderer::render");
+    stats->beginFrame();
+    gpuProfiler->beginFrame();
+    renderFrame();
+    gpuProfiler->endFrame();
+    stats->endFrame();
+    RenderDevice::get()->endFrame();
 }
 
 void Renderer::draw() {
 
-    render();
+    RENDERERGL_FRAME_MARK();
+    RENDERERGL_ZONE("Renderer::draw");
+
+    stats->beginFrame();
+    gpuProfiler->beginFrame();
+    renderFrame();
 
+    stats->setPass(RenderStats::POST_PROCESS);
+    gpuProfiler->beginScope("Quad");
     shaderProgramTexturedQuad->useProgram();
 
     frameCapturer->getTexture()->bind();
     shaderProgramTexturedQuad->uniformInt("tex", frameCapturer->getTexture()->getID() - 1);
 
     quadVAO->bind();
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    RenderDevice::get()->polygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    RenderDevice::get()->drawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    RenderStats::countDraw(GL_TRIANGLE_STRIP, 4);
     quadVAO->unbind();
+    gpuProfiler->endScope();
+
+    gpuProfiler->endFrame();
+    stats->endFrame();
+    RenderDevice::get()->endFrame();
 }
 
 void Renderer::setBackgroundColor(float r, float g, float b) {
@@ -699,64 +1581,77 @@ void Renderer::addLight(Light& light) {
 }
 
 void Renderer::clear() {
-    glStencilMask(0xFF);
-    glClearColor(backgroundColor.r, backgroundColor.g, backgroundColor.b, 1);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    RenderDevice::get()->stencilMask(0xFF);
+    RenderDevice::get()->clearColor(backgroundColor.r, backgroundColor.g, backgroundColor.b, 1);
+    RenderDevice::get()->clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 }
 
 void Renderer::enableBlending() {
-    glEnable(GL_BLEND & GL_DEPTH_TEST);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-    glDepthFunc(GL_LESS);
+    RenderDevice::get()->enable(GL_BLEND & GL_DEPTH_TEST);
+    RenderDevice::get()->blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    RenderDevice::get()->blendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    RenderDevice::get()->depthFunc(GL_LESS);
 }
 
 void Renderer::enableAntialiasing() {
-    glEnable(GL_MULTISAMPLE);
+    RenderDevice::get()->enable(GL_MULTISAMPLE);
 }
 
 void Renderer::enableBackFaceCulling() {
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glFrontFace(GL_CCW); 
+    RenderDevice::get()->enable(GL_CULL_FACE);
+    RenderDevice::get()->cullFace(GL_BACK);
+    RenderDevice::get()->frontFace(GL_CCW); 
 }
 
 void Renderer::enableFrontFaceCulling() {
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_FRONT);
-    glFrontFace(GL_CCW); 
+    RenderDevice::get()->enable(GL_CULL_FACE);
+    RenderDevice::get()->cullFace(GL_FRONT);
+    RenderDevice::get()->frontFace(GL_CCW); 
 }
 
 void Renderer::disableFaceCulling() {
-    glDisable(GL_CULL_FACE);
+    RenderDevice::get()->disable(GL_CULL_FACE);
 }
 
 void Renderer::loadPreviousFBO() {
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFBO);
+    RenderDevice::get()->getIntegerv(GL_FRAMEBUFFER_BINDING, &previousFBO);
 }
 
 void Renderer::bindPreviousFBO() {
-    glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+    RenderDevice::get()->bindFramebuffer(GL_FRAMEBUFFER, previousFBO);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Functions for cascaded shadow mapping
 
+void Renderer::setShadowMapping(bool shadowMapping) {
+    this->shadowMapping = shadowMapping;
+
+    // Nothing is kept on the GPU without shadows
+    if(!shadowMapping) {
+        shadowCascades->release();
+        shadowAtlas->release();
+    }
+}
+
+void Renderer::setPointShadowMapping(bool pointShadowMapping) {
+    this->pointShadowMapping = pointShadowMapping;
+    if(!pointShadowMapping) pointShadows->release();
+}
+
 void Renderer::setShadowMappingProcedure(int procedure) {
     switch (procedure) {
         // BASE
         case 0 : {
-            Shader vertexDepthMapShader = Shader::fromFile("glsl/SimpleDepth.vert", Shader::ShaderType::Vertex);
-            Shader fragmentDepthMapShader = Shader::fromFile("glsl/SimpleDepth.frag", Shader::ShaderType::Fragment);
-            shaderProgramDepthMap = ShaderProgram::New(vertexDepthMapShader,fragmentDepthMapShader);
+            shaderProgramDepthMap = shaderProgramDepthMapSimple;
+            shadowCascades->setCascadeCount(1);
             std::cerr << "Switched to BASE" << std::endl;
             break;
         }
         // CSM
         case 1 : {
-            Shader vertexDepthMapShaderCSM = Shader::fromFile("glsl/CSMDepth.vert", Shader::ShaderType::Vertex);
-            Shader fragmentDepthMapShaderCSM = Shader::fromFile("glsl/CSMDepth.frag", Shader::ShaderType::Fragment);
-            shaderProgramDepthMap = ShaderProgram::New(vertexDepthMapShaderCSM,fragmentDepthMapShaderCSM);
+            shaderProgramDepthMap = shaderProgramDepthMapCSM;
+            shadowCascades->setCascadeCount(SHADOW_MAX_CASCADES);
             std::cerr << "Switched to CSM" << std::endl;
             break;
         }
@@ -784,93 +1679,55 @@ void Renderer::setShadowMappingProcedure(int procedure) {
     }
 }
 
-std::vector<glm::vec4> Renderer::getFrustumCornersWorldSpace(const glm::mat4& proj, const glm::mat4& view) {
-    const auto inv = glm::inverse(proj * view);
-
-    std::vector<glm::vec4> frustumCorners;
-    for(int x = 0; x < 2; ++x) {
-        for(int y = 0; y < 2; ++y) {
-            for(int z = 0; z < 2; ++z) {
-                const glm::vec4 pt =
-                    inv * glm::vec4(
-                    2.0f * x - 1.0f,
-                    2.0f * y - 1.0f,
-                    2.0f * z - 1.0f,
-                    1.0f);
-                    frustumCorners.push_back(pt/pt.w);
-            }
-        }
+void Renderer::setMultiDrawIndirect(bool multiDrawIndirect) {
+    if(multiDrawIndirect && !GeometryArena::isSupported()) {
+        std::cout << "Multi draw indirect is not supported" << std::endl;
+        return;
     }
-    return frustumCorners;
+    if(multiDrawIndirect && geometryArena == nullptr) geometryArena = GeometryArena::New();
+    this->multiDrawIndirect = multiDrawIndirect;
 }
 
-// get frustum corners from camera-frustum
-std::vector<glm::vec4> Renderer::getFrustumCornersWorldSpace() {
-    return getFrustumCornersWorldSpace(camera->getProjectionMatrix(), camera->getViewMatrix());
-}
-
-glm::mat4 Renderer::getLightSpaceMatrix(const float nearPlane, const float farPlane) {
-    // Calculate field of view from camera-perspective-matrix
-    auto cameraFovy = 2.0f * std::atan(1.0f/camera->getProjectionMatrix()[1][1]);
-    const auto proj = glm::perspective(
-        cameraFovy,
-            (float) getViewportWidth()/(float) getViewportHeight(),
-            nearPlane,
-            farPlane);
-    std::vector<glm::vec4> corners = getFrustumCornersWorldSpace(proj, camera->getViewMatrix());
-    //calculating lightView-Matrix
-    glm::vec3 center = glm::vec3(0,0,0);
-
-    for(const auto& v: corners) {
-        center += glm::vec3(v);
+void Renderer::setGPUCulling(bool gpuDrivenCulling) {
+    if(gpuDrivenCulling && !GPUCulling::isSupported()) {
+        std::cout << "GPU culling is not supported" << std::endl;
+        return;
     }
-    center /= corners.size();
-    const auto lightView = glm::lookAt(center + glm::normalize(shadowLightPos), center, glm::vec3(0.0,1.0,0.0));
+    if(gpuDrivenCulling && gpuCulling == nullptr) gpuCulling = GPUCulling::New();
 
-    //calculating lightProjection-Matrix
-    float minX = std::numeric_limits<float>::max();
-    float maxX = std::numeric_limits<float>::lowest();
-    float minY = std::numeric_limits<float>::max();
-    float maxY = std::numeric_limits<float>::lowest();
-    float minZ = std::numeric_limits<float>::max();
-    float maxZ = std::numeric_limits<float>::lowest();
+    // The depths of an old frame are of no use
+    if(gpuDrivenCulling && !this->gpuDrivenCulling) gpuCulling->invalidate();
+    this->gpuDrivenCulling = gpuDrivenCulling;
+}
 
-    for(const auto& v: corners) {
-        const auto trf = lightView * v;
-        minX = std::min(minX, trf.x);
-        maxX = std::max(maxX, trf.x);
-        minY = std::min(minY, trf.y);
-        maxY = std::max(maxY, trf.y);
-        minZ = std::min(minZ, trf.z);
-        maxZ = std::max(maxZ, trf.z);
+void Renderer::setOcclusionCulling(bool occlusionCulling) {
+    if(occlusionCulling && sceneQueries == nullptr) {
+        sceneQueries = OcclusionQueries::New();
+        gBufferQueries = OcclusionQueries::New();
     }
+    this->occlusionCulling = occlusionCulling;
+}
 
-    constexpr float zMult = 1.0f;
-    if(minZ < 0) minZ *= zMult;
-    else minZ /= zMult;
-    if(maxZ < 0) maxZ /= zMult;
-    else maxZ *= zMult;
-
-    //std::cout << "minX: " << minX << "\tmaxX: " << maxX << std::endl;
-    //std::cout << "minY: " << minY << "\tmaxY: " << maxY << std::endl;
-    //std::cout << "minZ: " << minZ << "\tmaxZ: " << maxZ << std::endl;
-
-    const glm::mat4 lightProjection = glm::ortho(minX,maxX,minY,maxY,minZ,maxZ);
-
-    return lightProjection * lightView;
+void Renderer::setSoftwareOcclusion(bool softwareCulling) {
+    if(softwareCulling && softwareOcclusion == nullptr) softwareOcclusion = SoftwareOcclusion::New();
+    this->softwareCulling = softwareCulling;
 }
 
 void Renderer::takeSnapshot() {
 
-    std::string filename = "depth_map_ssm.png";
-    if (depthMap->saveDepthTextureToImage(SHADOW_MAP_WIDTH, SHADOW_MAP_HEIGHT, filename.c_str())) {
-        std::cout << "Image saved successfully!" << std::endl;
-    } else {
-        std::cerr << "Failed to save image." << std::endl;
+    DepthArrayTexture::Ptr& depthTexture = shadowCascades->getDepthTexture();
+    if(depthTexture == nullptr) {
+        std::cerr << "No shadow map rendered yet." << std::endl;
+        return;
     }
 
-    for(int i = 0; i < 1; ++i) {
-        // Save the texture to an image file
-
+    // A depth image per cascade
+    for(unsigned int i = 0; i < shadowCascades->getCascadeCount(); ++i) {
+        std::string filename = "depth_map_csm_" + std::to_string(i) + ".png";
+        if (depthTexture->saveLayerToImage(i, filename.c_str())) {
+            std::cout << "Image saved successfully!" << std::endl;
+        } else {
+            std::cerr << "Failed to save image." << std::endl;
+        }
     }
 }
\ No newline at end of file
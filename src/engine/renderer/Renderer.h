@@ -2,6 +2,8 @@
 
 #include <iostream>
 #include <vector>
+#include <set>
+#include <tuple>
 
 #define GLEW_STATIC
 #include <GL/glew.h>
@@ -14,6 +16,11 @@
 #include "engine/lighting/Light.h"
 #include "engine/lighting/DirectionalLight.h"
 #include "engine/lighting/PointLight.h"
+#include "engine/lighting/LightClusters.h"
+#include "engine/lighting/ObjectLights.h"
+#include "engine/lighting/ShadowCascades.h"
+#include "engine/lighting/ShadowAtlas.h"
+#include "engine/lighting/PointShadows.h"
 
 #include "engine/lighting/PBRMaterial.h"
 
@@ -27,6 +34,13 @@
 
 #include "FrameCapturer.h"
 #include "TrackballCamera.h"
+#include "GeometryArena.h"
+#include "GPUCulling.h"
+#include "OcclusionQueries.h"
+#include "SoftwareOcclusion.h"
+#include "RenderStats.h"
+#include "GPUProfiler.h"
+#include "GBuffer.h"
 
 class Renderer {
     GENERATE_PTR(Renderer)
@@ -36,10 +50,16 @@ private:
     ShaderProgram::Ptr shaderProgramLighting;
     ShaderProgram::Ptr shaderProgramPBR;
     ShaderProgram::Ptr shaderProgramDepthMap;
+    ShaderProgram::Ptr shaderProgramDepthMapSimple;
+    ShaderProgram::Ptr shaderProgramDepthMapCSM;
     ShaderProgram::Ptr shaderProgramHDR;
     ShaderProgram::Ptr shaderProgramSkyBox;
     ShaderProgram::Ptr shaderProgramSelection;
     ShaderProgram::Ptr shaderProgramTexturedQuad;
+    ShaderProgram::Ptr shaderProgramGBuffer;
+    ShaderProgram::Ptr shaderProgramDeferredLighting;
+    ShaderProgram::Ptr shaderProgramDepthPrePass;
+    ShaderProgram::Ptr shaderProgramPointShadow;
 
     // Scenes visualization
     glm::mat4 projection;
@@ -56,6 +76,9 @@ private:
     std::vector<Light*> lights;
     unsigned int nLights;
     bool hasLight;
+    LightClusters::Ptr lightClusters;
+    ObjectLights::Ptr objectLights;
+    bool objectLighting;
 
     bool pbr;
 
@@ -63,15 +86,26 @@ private:
     int previousFBO;
 
     // Shadow Mapping
-    FrameBuffer::Ptr depthMapFBO;
-    DepthTexture::Ptr depthMap;
-    //FrameBuffer::Ptr depthMapFBOs[];
-    //DepthTexture::Ptr depthMaps[];
+    ShadowCascades::Ptr shadowCascades;
+    ShadowAtlas::Ptr shadowAtlas;
+
+    // Casters drawn in the shadow maps, static ones are cached
+    enum ShadowCasters { ALL_CASTERS, STATIC_CASTERS, DYNAMIC_CASTERS };
 
-    glm::mat4 lightSpaceMatrix;
     glm::vec3 shadowLightPos;
     bool shadowMapping;
 
+    // Point light shadows, the casters of a light and the faces they touch
+    PointShadows::Ptr pointShadows;
+    struct PointShadowDraw {
+        glm::mat4 model;
+        Group::Ptr group;
+        Polytope::Ptr polytope;
+        unsigned int faces;
+    };
+    std::vector<PointShadowDraw> pointShadowDraws;
+    bool pointShadowMapping;
+
     // HDR
     FrameBuffer::Ptr hdrFBO;
     ColorBufferTexture::Ptr colorBufferTexture;
@@ -94,6 +128,52 @@ private:
     // Frame capturer
     FrameCapturer::Ptr frameCapturer;
 
+    // Statistics
+    RenderStats::Ptr stats;
+    GPUProfiler::Ptr gpuProfiler;
+
+    // Multi draw indirect
+    GeometryArena::Ptr geometryArena;
+    bool multiDrawIndirect;
+
+    // Culling of the multi draw batches on the GPU
+    GPUCulling::Ptr gpuCulling;
+    bool gpuDrivenCulling;
+
+    // Occlusion queries of the forward and the G-buffer pass, their depths differ
+    struct DeferredNode {
+        Scene::Ptr scene;
+        Group::Ptr group;           // the whole scene when null
+        Polytope::Ptr polytope;     // the whole group when null
+    };
+    OcclusionQueries::Ptr sceneQueries, gBufferQueries;
+    std::vector<DeferredNode> hiddenNodes, blendedNodes;
+    bool occlusionCulling;
+
+    // Culling against the occluders rasterized on the CPU
+    SoftwareOcclusion::Ptr softwareOcclusion;
+    bool softwareCulling;
+
+    // Deferred shading
+    GBuffer::Ptr gBuffer;
+    bool deferred;
+    bool gBufferPass;
+
+    // Depth pre-pass
+    struct DepthPrePassDraw {
+        float depth;
+        glm::mat4 model;
+        Group::Ptr group;
+        Polytope::Ptr polytope;
+        bool multiDrawn;
+    };
+    std::vector<DepthPrePassDraw> depthPrePassDraws;
+    bool depthPrePass;
+
+    // Draws of the pre-pass found occluded on the CPU, the scene pass skips them without testing again
+    typedef std::tuple<const Scene*, const Group*, const Polytope*> DrawKey;
+    std::set<DrawKey> softwareOccludedDraws;
+
 public:
     Renderer(unsigned int _viewportWidth, unsigned int _viewportHeight);
     Renderer();
@@ -116,29 +196,50 @@ private:
     void lightShaderUniforms();
 
     void pbrShaderUniforms();
+    void objectLightUniforms(ShaderProgram::Ptr& shaderProgram, const int* lights, unsigned int count);
+    void objectLightUniforms(ShaderProgram::Ptr& shaderProgram, const glm::mat4& model, const Polytope::Ptr& polytope);
     void lightMaterialUniforms(const Polytope::Ptr& polytope);
-    void pbrMaterialUniforms(const Polytope::Ptr& polytope);
+    void pbrMaterialUniforms(ShaderProgram::Ptr& shaderProgram, const Polytope::Ptr& polytope);
     void mvpUniform(ShaderProgram::Ptr& shaderProgram, const glm::mat4& model);
     void lightMVPuniform(const glm::mat4& model);
     void pbrMVPuniform(const glm::mat4& model);
     void shadowMappingUniforms();
 
-    void renderScenesToDepthMap(std::vector<Scene::Ptr>& scenes);
+    void renderScenesToDepthMap(std::vector<Scene::Ptr>& scenes, unsigned int cascade, ShadowCasters casters);
+    void shadowCasterSignature(std::vector<Scene::Ptr>& scenes, uint64_t& signature, bool& dynamicCasters);
     void renderScenes(std::vector<Scene::Ptr>& scenes);
+    void renderScenesOccluded(std::vector<Scene::Ptr>& scenes);
+    bool queryScene(Scene::Ptr& scene);
+    bool queryGroup(Scene::Ptr& scene, Group::Ptr& group);
+    void drawDeferredNode(DeferredNode& node, bool occluded);
+    bool isBlended(Group::Ptr& group);
+    bool isPinned(Group::Ptr& group);
+    bool isPinned(Scene::Ptr& scene);
+    void groupBounds(const glm::mat4& model, Group::Ptr& group, glm::vec3& low, glm::vec3& high);
+    void sceneBounds(Scene::Ptr& scene, glm::vec3& low, glm::vec3& high);
+    void collectOccluders(std::vector<Scene::Ptr>& scenes);
+    bool isSoftwareOccluded(Scene::Ptr& scene, Group::Ptr& group, Polytope::Ptr& polytope, const glm::mat4& model);
     void renderToDepthMap();
+    void collectPointShadowCasters(std::vector<Scene::Ptr>& scenes, unsigned int slot, uint64_t* signatures, unsigned int& dynamicFaces);
+    void renderPointShadows();
     void renderQuad();
+    void groupSettings(Group::Ptr& group);
     void drawGroup(Scene::Ptr& scene, Group::Ptr& group);
+    void drawPolytope(Scene::Ptr& scene, Group::Ptr& group, Polytope::Ptr& polytope);
+    void drawBakedSelection(Scene::Ptr& scene, Group::Ptr& group);
+    void multiDrawGroup(Scene::Ptr& scene, Group::Ptr& group, std::vector<Polytope::Ptr>& remaining);
     void drawSkyBox();
+    void drawSelection(const glm::mat4& mvp, Group::Ptr& group, Polytope::Ptr& polytope);
+    bool drawsDeferred(Group::Ptr& group, Polytope::Ptr& polytope);
+    void renderGBuffer();
+    void renderDeferredLighting();
+    bool drawsDepthPrePass(Group::Ptr& group, Polytope::Ptr& polytope);
+    void collectDepthPrePass(std::vector<Scene::Ptr>& scenes);
+    void renderDepthPrePass();
+    void renderFrame();
 
     void loadPreviousFBO();
     void bindPreviousFBO();
-
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // Functions for Cascaded Shadow Mapping
-    std::vector<glm::vec4> getFrustumCornersWorldSpace(const glm::mat4& proj, const glm::mat4& view);
-    std::vector<glm::vec4> getFrustumCornersWorldSpace();
-    glm::mat4 getLightSpaceMatrix(float nearPlane, float farPlane);
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 public:
     void removeScene(Scene::Ptr& scene);
     void removeLight(Light& light);
@@ -173,6 +274,30 @@ public:
     void setViewport(unsigned int viewportWidth, unsigned int viewportHeight);
 
     void takeSnapshot();
+
+    /**
+     * Polytopes added to the geometry arena are drawn in batches with glMultiDrawElementsIndirect.
+     * The arena is created the first time it is enabled, it needs GL 4.3 or ARB_multi_draw_indirect
+    */
+    void setMultiDrawIndirect(bool multiDrawIndirect);
+
+    /**
+     * The batches of the geometry arena are culled by a compute shader, against the frustum and the depth
+     * of the previous frame. Only with multi draw indirect, it needs GL 4.3 or ARB_compute_shader
+    */
+    void setGPUCulling(bool gpuDrivenCulling);
+
+    /**
+     * Scenes, groups and polytopes hidden in the last frame are drawn after the rest, conditionally on an
+     * occlusion query of their box. Nothing is skipped on the CPU, the GPU skips the occluded draws
+    */
+    void setOcclusionCulling(bool occlusionCulling);
+
+    /**
+     * The occluder polytopes (see Polytope::setOccluder) are rasterized on the CPU before the passes, the
+     * polytopes behind them aren't submitted. Shadows aren't culled
+    */
+    void setSoftwareOcclusion(bool softwareCulling);
 public:
     inline void addScene(Scene::Ptr& scene) { scenes.push_back(scene); }
     inline void removeScene(int index) { scenes.erase(scenes.begin() + index); }
@@ -196,12 +321,39 @@ public:
     inline void disablePBR() { pbr = false; }
     inline void setPBREnabled(bool enable) { pbr = enable; }
 
+    /**
+     * Forward lighting with a light list per draw instead of the froxels: the point lights whose
+     * attenuation sphere touches the polytope bounds, up to OBJECT_MAX_LIGHTS. The deferred
+     * lighting keeps the froxels
+    */
+    inline void setObjectLighting(bool objectLighting) { this->objectLighting = objectLighting; }
+    inline bool isObjectLighting() const { return objectLighting; }
+    inline ObjectLights::Ptr& getObjectLights() { return objectLights; }
+
+    /**
+     * With PBR, opaque polytopes are rendered to a G-buffer and lit in a single pass over the
+     * screen, so the lighting cost depends on the pixels and not on the overdraw. Transparent
+     * polytopes, points, lines and wireframes are still drawn forward after it
+    */
+    inline void setDeferred(bool deferred) { this->deferred = deferred; }
+    inline bool isDeferred() const { return deferred; }
+
+    inline GBuffer::Ptr& getGBuffer() { return gBuffer; }
+
+    /**
+     * Opaque triangles of the forward pass are drawn to the depth buffer first, front to back, and
+     * then shaded with GL_EQUAL and no depth writes, so each pixel runs the fragment shader once.
+     * Groups can be left out with Group::setDepthPrePass
+    */
+    inline void setDepthPrePass(bool depthPrePass) { this->depthPrePass = depthPrePass; }
+    inline bool isDepthPrePass() const { return depthPrePass; }
+
     inline void setShadowLightPos(const glm::vec3& shadowLightPos) { this->shadowLightPos = shadowLightPos; }
     inline glm::vec3& getShadowLightPos() { return shadowLightPos; }
 
-    inline void setShadowMapping(bool shadowMapping) { this->shadowMapping = shadowMapping; }
+    void setShadowMapping(bool shadowMapping);
     inline bool isShadowMapping() const { return shadowMapping; }
-    void setShadowMappingProcedure(int);    // setting the shaders for different procedures 0:simple shadow mapping 1:cascaded shadow mapping 2:Parallel Split Shadow Mappint 3: Trapezoid Shadow Mapping
+    void setShadowMappingProcedure(int);    // setting the shaders for different procedures 0:simple shadow mapping (one cascade) 1:cascaded shadow mapping 2:Parallel Split Shadow Mappint 3: Trapezoid Shadow Mapping
 
     inline ShaderProgram::Ptr& getShaderProgram() { return shaderProgram; }
 
@@ -215,7 +367,18 @@ public:
     inline void setViewportHeight(unsigned int viewportHeight) { this->viewportHeight = viewportHeight; }
     inline unsigned int getViewportHeight() const { return viewportHeight; }
 
-    inline DepthTexture::Ptr& getDepthMap() { return depthMap; }
+    // Cascades of the shadow light, the split scheme and the blending can be changed there
+    inline ShadowCascades::Ptr& getShadowCascades() { return shadowCascades; }
+    // Tiles for the shadow maps rendered by the application, the renderer doesn't use it
+    inline ShadowAtlas::Ptr& getShadowAtlas() { return shadowAtlas; }
+
+    /**
+     * Cube shadows of the point lights other than the first one, the budget, the filter and the caching
+     * are set on getPointShadows. PointLight::setShadowCaster and setShadowPriority choose the lights
+    */
+    void setPointShadowMapping(bool pointShadowMapping);
+    inline bool isPointShadowMapping() const { return pointShadowMapping; }
+    inline PointShadows::Ptr& getPointShadows() { return pointShadows; }
 
     inline void setHDR(bool hdr) { this->hdr = hdr; }
     inline bool isHDR() const { return hdr; }
@@ -227,4 +390,23 @@ public:
     inline bool isGammaCorrection() const { return gammaCorrection; }
 
     inline FrameCapturer::Ptr getFrameCapturer() { return frameCapturer; }
+
+    // Draw calls, primitives, binds and uploads of the last frame and the previous ones
+    inline RenderStats::Ptr& getStats() { return stats; }
+
+    // GPU time of the passes ("Shadow", "PointShadows", "GBuffer", "Lighting", "DepthPrePass", "Scene", "DepthPyramid", "SkyBox", "HDR", "FrameCapturer", "Quad"), user scopes can be added
+    inline GPUProfiler::Ptr& getGPUProfiler() { return gpuProfiler; }
+
+    inline bool isMultiDrawIndirect() const { return multiDrawIndirect; }
+    inline GeometryArena::Ptr& getGeometryArena() { return geometryArena; }
+
+    inline bool isGPUCulling() const { return gpuDrivenCulling; }
+    inline GPUCulling::Ptr& getGPUCulling() { return gpuCulling; }
+
+    inline bool isOcclusionCulling() const { return occlusionCulling; }
+    inline OcclusionQueries::Ptr& getOcclusionQueries() { return sceneQueries; }
+    inline OcclusionQueries::Ptr& getGBufferOcclusionQueries() { return gBufferQueries; }
+
+    inline bool isSoftwareOcclusion() const { return softwareCulling; }
+    inline SoftwareOcclusion::Ptr& getSoftwareOcclusion() { return softwareOcclusion; }
 };
@@ -1,5 +1,6 @@
 #include "SkyBox.h"
 
+#include "engine/opengl/device/RenderDevice.h"
 #include "engine/texture/Texture.h"
 
 #include "engine/Vec3.h"
@@ -45,7 +46,8 @@ void SkyBox::unbind() {
 }
 
 void SkyBox::draw() {
-    glDepthFunc(GL_LEQUAL);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
-    glDepthFunc(GL_LESS);
+    RenderDevice::get()->depthFunc(GL_LEQUAL);
+    RenderDevice::get()->drawArrays(GL_TRIANGLES, 0, 36);
+    RenderStats::countDraw(GL_TRIANGLES, 36);
+    RenderDevice::get()->depthFunc(GL_LESS);
 }
\ No newline at end of file
@@ -0,0 +1,356 @@
+#include "SoftwareOcclusion.h"
+
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#include "engine/Float4.h"
+
+#define FULL_ROW 0xFFFFFFFFu
+
+SoftwareOcclusion::SoftwareOcclusion(unsigned int _width, unsigned int _height)
+    : width(_width), height(_height), viewProjection(1.f), generation(0), pending(0), bands(1), rowsPerBand(0), stopping(false),
+    tested(0), culled(0), rasterizeTime(0.0) {
+
+    tilesX = (width + SOFTWARE_OCCLUSION_TILE_WIDTH - 1) / SOFTWARE_OCCLUSION_TILE_WIDTH;
+    tilesY = (height + SOFTWARE_OCCLUSION_TILE_HEIGHT - 1) / SOFTWARE_OCCLUSION_TILE_HEIGHT;
+    width = tilesX * SOFTWARE_OCCLUSION_TILE_WIDTH;
+    height = tilesY * SOFTWARE_OCCLUSION_TILE_HEIGHT;
+    tiles.resize(tilesX * tilesY);
+
+    threads = std::max(1u, std::min((unsigned int)SOFTWARE_OCCLUSION_MAX_THREADS, std::thread::hardware_concurrency()));
+}
+
+SoftwareOcclusion::~SoftwareOcclusion() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    started.notify_all();
+    for(auto& worker : workers) worker.join();
+}
+
+void SoftwareOcclusion::begin(const glm::mat4& viewProjection) {
+    this->viewProjection = viewProjection;
+
+    Tile empty = { { 0 }, 1.f, 0.f };
+    std::fill(tiles.begin(), tiles.end(), empty);
+    triangles.clear();
+    tested = 0;
+    culled = 0;
+}
+
+glm::vec3 SoftwareOcclusion::toWindow(const glm::vec4& clip) const {
+    // Window coordinates, y up, and depth in [0, 1]
+    float w = std::max(clip.w, 1e-6f);
+    return glm::vec3((clip.x / w * 0.5f + 0.5f) * width, (clip.y / w * 0.5f + 0.5f) * height, clip.z / w * 0.5f + 0.5f);
+}
+
+void SoftwareOcclusion::addOccluder(const glm::mat4& model, const Polytope::Occluder& occluder, Polytope::FaceCulling faceCulling) {
+
+    // Every vertex is projected once, the ones behind the near plane are left to the clipping
+    glm::mat4 mvp = viewProjection * model;
+    clip.resize(occluder.positions.size());
+    window.resize(occluder.positions.size());
+    glm::vec3 low(1e30f), high(-1e30f);
+    bool crossing = false;
+    for(size_t i = 0; i < occluder.positions.size(); i++) {
+        clip[i] = mvp * glm::vec4(occluder.positions[i], 1.f);
+        if(clip[i].z + clip[i].w <= 0.f) {
+            crossing = true;
+            continue;
+        }
+        window[i] = toWindow(clip[i]);
+        low = glm::min(low, window[i]);
+        high = glm::max(high, window[i]);
+    }
+
+    // Off the screen or beyond the far plane
+    if(!crossing && (high.x < 0.f || low.x > width || high.y < 0.f || low.y > height || low.z > 1.f)) return;
+
+    for(size_t i = 0; i + 2 < occluder.indices.size(); i += 3) {
+        const unsigned int* vertices = &occluder.indices[i];
+
+        // Distances to the near plane, z = -w
+        float distances[3];
+        unsigned int inside = 0;
+        for(int v = 0; v < 3; v++) {
+            distances[v] = clip[vertices[v]].z + clip[vertices[v]].w;
+            if(distances[v] > 0.f) inside++;
+        }
+        if(inside == 0) continue;
+        if(inside == 3) {
+            addTriangle(window[vertices[0]], window[vertices[1]], window[vertices[2]], faceCulling);
+            continue;
+        }
+
+        // The part in front of the plane is a triangle or a quad
+        glm::vec3 polygon[4];
+        unsigned int count = 0;
+        for(int v = 0; v < 3; v++) {
+            int next = (v + 1) % 3;
+            if(distances[v] > 0.f) polygon[count++] = window[vertices[v]];
+            if((distances[v] > 0.f) != (distances[next] > 0.f)) {
+                float t = distances[v] / (distances[v] - distances[next]);
+                polygon[count++] = toWindow(clip[vertices[v]] + (clip[vertices[next]] - clip[vertices[v]]) * t);
+            }
+        }
+        for(unsigned int v = 2; v < count; v++) addTriangle(polygon[0], polygon[v - 1], polygon[v], faceCulling);
+    }
+}
+
+void SoftwareOcclusion::addTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, Polytope::FaceCulling faceCulling) {
+
+    glm::vec3 screen[3] = { a, b, c };
+
+    // Counter-clockwise faces are the front ones
+    float area = (screen[1].x - screen[0].x) * (screen[2].y - screen[0].y) - (screen[2].x - screen[0].x) * (screen[1].y - screen[0].y);
+    if(std::abs(area) < 1e-8f) return;
+    if(area > 0.f && faceCulling == Polytope::FaceCulling::FRONT) return;
+    if(area < 0.f) {
+        if(faceCulling == Polytope::FaceCulling::BACK) return;
+        std::swap(screen[1], screen[2]);
+        area = -area;
+    }
+
+    Triangle triangle;
+    float minX = std::min({ screen[0].x, screen[1].x, screen[2].x }), maxX = std::max({ screen[0].x, screen[1].x, screen[2].x });
+    float minY = std::min({ screen[0].y, screen[1].y, screen[2].y }), maxY = std::max({ screen[0].y, screen[1].y, screen[2].y });
+
+    // Pixels whose center is inside the box
+    triangle.minX = std::max(0, (int)std::ceil(minX - 0.5f));
+    triangle.maxX = std::min((int)width - 1, (int)std::floor(maxX - 0.5f));
+    triangle.minY = std::max(0, (int)std::ceil(minY - 0.5f));
+    triangle.maxY = std::min((int)height - 1, (int)std::floor(maxY - 0.5f));
+    if(triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) return;
+
+    triangle.zMax = std::max({ screen[0].z, screen[1].z, screen[2].z });
+    if(std::min({ screen[0].z, screen[1].z, screen[2].z }) > 1.f) return;
+
+    // Plane of the depths, from the normal of the triangle in window space
+    glm::vec3 normal = glm::cross(screen[1] - screen[0], screen[2] - screen[0]);
+    triangle.plane.x = -normal.x / normal.z;
+    triangle.plane.y = -normal.y / normal.z;
+    triangle.plane.z = screen[0].z - triangle.plane.x * screen[0].x - triangle.plane.y * screen[0].y;
+
+    for(int v = 0; v < 3; v++) triangle.vertices[v] = glm::vec2(screen[v]);
+    triangles.push_back(triangle);
+}
+
+void SoftwareOcclusion::rasterize() {
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // The bands don't share tiles, every thread goes through all the triangles
+    std::unique_lock<std::mutex> lock(mutex);
+    bands = std::min({ threads, tilesY, 1 + (unsigned int)triangles.size() / SOFTWARE_OCCLUSION_THREAD_TRIANGLES });
+    rowsPerBand = (tilesY + bands - 1) / bands;
+    pending = bands - 1;
+    generation++;
+    lock.unlock();
+
+    if(bands > 1) {
+        while(workers.size() + 1 < bands) workers.emplace_back(&SoftwareOcclusion::work, this, (unsigned int)workers.size() + 1);
+        started.notify_all();
+    }
+    rasterizeBand(0, std::min(rowsPerBand, tilesY));
+
+    lock.lock();
+    finished.wait(lock, [this] { return pending == 0; });
+    lock.unlock();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    rasterizeTime = std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void SoftwareOcclusion::work(unsigned int band) {
+
+    // Started by rasterize, which waits for it: the generation is the one it has to do
+    std::unique_lock<std::mutex> lock(mutex);
+    unsigned int done = generation - 1;
+    while(true) {
+        started.wait(lock, [this, done] { return stopping || generation != done; });
+        if(stopping) return;
+        done = generation;
+        if(band >= bands) continue;
+
+        unsigned int first = band * rowsPerBand, last = std::min(first + rowsPerBand, tilesY);
+        lock.unlock();
+        rasterizeBand(first, last);
+        lock.lock();
+
+        if(--pending == 0) finished.notify_one();
+    }
+}
+
+void SoftwareOcclusion::rasterizeBand(unsigned int firstTileRow, unsigned int lastTileRow) {
+    for(auto& triangle : triangles) {
+        if(triangle.maxY < (int)(firstTileRow * SOFTWARE_OCCLUSION_TILE_HEIGHT)) continue;
+        if(triangle.minY >= (int)(lastTileRow * SOFTWARE_OCCLUSION_TILE_HEIGHT)) continue;
+        rasterizeTriangle(triangle, firstTileRow, lastTileRow);
+    }
+}
+
+void SoftwareOcclusion::rasterizeTriangle(const Triangle& triangle, unsigned int firstTileRow, unsigned int lastTileRow) {
+
+    unsigned int firstRow = std::max(firstTileRow, (unsigned int)triangle.minY / SOFTWARE_OCCLUSION_TILE_HEIGHT);
+    unsigned int lastRow = std::min(lastTileRow - 1, (unsigned int)triangle.maxY / SOFTWARE_OCCLUSION_TILE_HEIGHT);
+
+    for(unsigned int tileY = firstRow; tileY <= lastRow; tileY++) {
+
+        // Span of the pixel rows between the edges, a row of the tile in every lane. Pixel centers
+        // on the edges are covered
+        int y0 = tileY * SOFTWARE_OCCLUSION_TILE_HEIGHT;
+        Float4 center = Float4::set((float)y0) + Float4::set(0.5f, 1.5f, 2.5f, 3.5f);
+        Float4 left = Float4::set(triangle.minX - 0.5f), right = Float4::set(triangle.maxX + 0.5f);
+        Float4 empty = Float4::set(0.f);
+        for(int edge = 0; edge < 3; edge++) {
+            const glm::vec2& from = triangle.vertices[edge];
+            const glm::vec2& to = triangle.vertices[(edge + 1) % 3];
+            float dx = to.x - from.x, dy = to.y - from.y;
+
+            // Inside: dy * (x - from.x) <= dx * (center - from.y)
+            Float4 offset = Float4::set(dx) * (center - Float4::set(from.y));
+            if(dy == 0.f) empty = empty | (offset < Float4::set(0.f));
+            else {
+                Float4 x = Float4::set(from.x) + offset / Float4::set(dy);
+                if(dy > 0.f) right = Float4::min(right, x);
+                else left = Float4::max(left, x);
+            }
+        }
+
+        // Kept next to the box so that the edges of thin triangles fit an int, past it the span is empty anyway
+        left = Float4::min(left, Float4::set(triangle.maxX + 1.f));
+        right = Float4::max(right, Float4::set(triangle.minX - 1.f));
+
+        int spanMin[SOFTWARE_OCCLUSION_TILE_HEIGHT], spanMax[SOFTWARE_OCCLUSION_TILE_HEIGHT];
+        Float4::ceil(left - Float4::set(0.5f)).toInt(spanMin);
+        Float4::floor(right - Float4::set(0.5f)).toInt(spanMax);
+        int emptyRows = empty.mask();
+
+        int tileMin = tilesX, tileMax = -1;
+        for(int row = 0; row < SOFTWARE_OCCLUSION_TILE_HEIGHT; row++) {
+            int y = y0 + row;
+            if(y < triangle.minY || y > triangle.maxY || (emptyRows & (1 << row)) != 0) {
+                spanMin[row] = 0;
+                spanMax[row] = -1;
+                continue;
+            }
+
+            spanMin[row] = std::max(triangle.minX, spanMin[row]);
+            spanMax[row] = std::min(triangle.maxX, spanMax[row]);
+            if(spanMin[row] > spanMax[row]) continue;
+
+            tileMin = std::min(tileMin, spanMin[row] / SOFTWARE_OCCLUSION_TILE_WIDTH);
+            tileMax = std::max(tileMax, spanMax[row] / SOFTWARE_OCCLUSION_TILE_WIDTH);
+        }
+
+        for(int tileX = tileMin; tileX <= tileMax; tileX++) {
+            int x0 = tileX * SOFTWARE_OCCLUSION_TILE_WIDTH;
+
+            // A row of the tile at once
+            uint32_t mask[SOFTWARE_OCCLUSION_TILE_HEIGHT];
+            uint32_t any = 0, full = FULL_ROW;
+            for(int row = 0; row < SOFTWARE_OCCLUSION_TILE_HEIGHT; row++) {
+                int first = std::max(spanMin[row] - x0, 0);
+                int last = std::min(spanMax[row] - x0, SOFTWARE_OCCLUSION_TILE_WIDTH - 1);
+                mask[row] = 0;
+                if(first <= last) {
+                    uint32_t upTo = last == 31 ? FULL_ROW : (1u << (last + 1)) - 1u;
+                    mask[row] = upTo & ~((1u << first) - 1u);
+                }
+                any |= mask[row];
+                full &= mask[row];
+            }
+            if(any == 0) continue;
+
+            // Farthest depth of the triangle in the tile, from the corners of the tile
+            float x1 = (float)(x0 + SOFTWARE_OCCLUSION_TILE_WIDTH);
+            float top = (float)y0, bottom = top + SOFTWARE_OCCLUSION_TILE_HEIGHT;
+            float depth = triangle.plane.z + std::max(triangle.plane.x * x0, triangle.plane.x * x1) + std::max(triangle.plane.y * top, triangle.plane.y * bottom);
+            depth = std::min(depth, triangle.zMax);
+
+            Tile& tile = tiles[tileY * tilesX + tileX];
+            if(depth >= tile.zMax0) continue;
+
+            // Alone it covers the tile
+            if(full == FULL_ROW) {
+                tile.zMax0 = depth;
+                continue;
+            }
+
+            // Merged with the working layer, which replaces the reference once it covers the tile
+            tile.zMax1 = std::max(tile.zMax1, depth);
+            uint32_t covered = FULL_ROW;
+            for(int row = 0; row < SOFTWARE_OCCLUSION_TILE_HEIGHT; row++) {
+                tile.mask[row] |= mask[row];
+                covered &= tile.mask[row];
+            }
+            if(covered == FULL_ROW) {
+                tile.zMax0 = std::min(tile.zMax0, tile.zMax1);
+                tile.zMax1 = 0.f;
+                for(int row = 0; row < SOFTWARE_OCCLUSION_TILE_HEIGHT; row++) tile.mask[row] = 0;
+            }
+        }
+    }
+}
+
+bool SoftwareOcclusion::isVisible(const glm::mat4& model, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+
+    tested++;
+    glm::mat4 mvp = viewProjection * model;
+
+    // The corners 4 at a time, the near face then the far one. Same products and sums as mvp * corner
+    Float4 x = Float4::set(boundsMin.x, boundsMax.x, boundsMin.x, boundsMax.x);
+    Float4 y = Float4::set(boundsMin.y, boundsMin.y, boundsMax.y, boundsMax.y);
+    Float4 lows[3], highs[3];
+    for(int axis = 0; axis < 3; axis++) {
+        lows[axis] = Float4::set(1e30f);
+        highs[axis] = Float4::set(-1e30f);
+    }
+    int behind = 0;
+    for(int face = 0; face < 2; face++) {
+        Float4 z = Float4::set(face == 0 ? boundsMin.z : boundsMax.z);
+        Float4 corner[4];
+        for(int axis = 0; axis < 4; axis++) {
+            corner[axis] = (Float4::set(mvp[0][axis]) * x + Float4::set(mvp[1][axis]) * y) + (Float4::set(mvp[2][axis]) * z + Float4::set(mvp[3][axis]));
+        }
+
+        // The corners behind the near plane are left out of the bounds
+        Float4 zero = Float4::set(0.f);
+        Float4 out = (corner[3] <= zero) | (corner[2] < zero - corner[3]);
+        behind += out.count();
+        for(int axis = 0; axis < 3; axis++) {
+            Float4 ndc = corner[axis] / corner[3];
+            lows[axis] = Float4::min(lows[axis], Float4::select(out, Float4::set(1e30f), ndc));
+            highs[axis] = Float4::max(highs[axis], Float4::select(out, Float4::set(-1e30f), ndc));
+        }
+    }
+    glm::vec3 low(lows[0].horizontalMin(), lows[1].horizontalMin(), lows[2].horizontalMin());
+    glm::vec3 high(highs[0].horizontalMax(), highs[1].horizontalMax(), highs[2].horizontalMax());
+
+    // Cut by the near plane
+    if(behind > 0 && behind < 8) return true;
+
+    // Out of the frustum
+    if(behind == 8 || high.x < -1.f || low.x > 1.f || high.y < -1.f || low.y > 1.f || low.z > 1.f) {
+        culled++;
+        return false;
+    }
+
+    int minX = std::max(0, (int)std::floor((low.x * 0.5f + 0.5f) * width));
+    int maxX = std::min((int)width - 1, (int)std::floor((high.x * 0.5f + 0.5f) * width));
+    int minY = std::max(0, (int)std::floor((low.y * 0.5f + 0.5f) * height));
+    int maxY = std::min((int)height - 1, (int)std::floor((high.y * 0.5f + 0.5f) * height));
+    float depth = low.z * 0.5f + 0.5f;
+
+    for(int tileY = minY / SOFTWARE_OCCLUSION_TILE_HEIGHT; tileY <= maxY / SOFTWARE_OCCLUSION_TILE_HEIGHT; tileY++) {
+        for(int tileX = minX / SOFTWARE_OCCLUSION_TILE_WIDTH; tileX <= maxX / SOFTWARE_OCCLUSION_TILE_WIDTH; tileX++) {
+            if(depth <= tiles[tileY * tilesX + tileX].zMax0) return true;
+        }
+    }
+
+    culled++;
+    return false;
+}
\ No newline at end of file
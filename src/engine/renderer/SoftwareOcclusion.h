@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "engine/group/Polytope.h"
+
+#include "engine/ptr.h"
+
+// Size of the depth buffer, a multiple of the tile size. Every screen gets the same, the pixels aren't square
+#define SOFTWARE_OCCLUSION_WIDTH 256
+#define SOFTWARE_OCCLUSION_HEIGHT 144
+
+// Pixels of a tile, a row of its coverage mask is a 32 bit word
+#define SOFTWARE_OCCLUSION_TILE_WIDTH 32
+#define SOFTWARE_OCCLUSION_TILE_HEIGHT 4
+
+#define SOFTWARE_OCCLUSION_MAX_THREADS 4
+#define SOFTWARE_OCCLUSION_THREAD_TRIANGLES 1024     // occluder triangles worth starting a thread
+
+/**
+ * @brief Occlusion culling on the CPU against a small masked depth buffer, no GPU readback.
+ *
+ * The occluders (see Polytope::setOccluder) are rasterized every frame, the buffer is split in
+ * bands of tile rows rasterized by worker threads, kept from a frame to the next. Like masked software occlusion culling, a
+ * tile doesn't keep a depth per pixel: the reference layer is the farthest depth of the whole
+ * tile, the working layer the farthest depth of the pixels of its coverage mask. Once the mask
+ * covers the tile, the working layer becomes the reference. A row of 32 pixels is covered by a
+ * triangle in one operation on its mask, from the span between its edges.
+ *
+ * The world box of an object is visible when its nearest depth is in front of the reference
+ * layer of a tile it covers. Boxes out of the frustum aren't visible, the ones cut by the
+ * near plane are. The test is conservative: the occluders must be inside the objects they
+ * stand for.
+ */
+class SoftwareOcclusion {
+    GENERATE_PTR(SoftwareOcclusion)
+private:
+    struct Tile {
+        uint32_t mask[SOFTWARE_OCCLUSION_TILE_HEIGHT];
+        float zMax0, zMax1;     // reference and working layer
+    };
+
+    // Screen space triangle, counter-clockwise
+    struct Triangle {
+        glm::vec2 vertices[3];
+        glm::vec3 plane;        // depth = plane.x * x + plane.y * y + plane.z
+        float zMax;
+        int minX, maxX, minY, maxY;
+    };
+private:
+    unsigned int width, height, tilesX, tilesY;
+    std::vector<Tile> tiles;
+    std::vector<Triangle> triangles;
+    std::vector<glm::vec4> clip;        // vertices of the occluder being added
+    std::vector<glm::vec3> window;
+    glm::mat4 viewProjection;
+    unsigned int threads;
+
+    // Worker i rasterizes band i + 1 of a generation, the calling thread the first one
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable started, finished;
+    unsigned int generation, pending, bands, rowsPerBand;
+    bool stopping;
+
+    // Objects tested and culled since begin, time of the last rasterize
+    unsigned int tested, culled;
+    double rasterizeTime;
+public:
+    SoftwareOcclusion(unsigned int _width = SOFTWARE_OCCLUSION_WIDTH, unsigned int _height = SOFTWARE_OCCLUSION_HEIGHT);
+    ~SoftwareOcclusion();
+private:
+    void work(unsigned int band);
+    glm::vec3 toWindow(const glm::vec4& clip) const;
+    void addTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, Polytope::FaceCulling faceCulling);
+    void rasterizeBand(unsigned int firstTileRow, unsigned int lastTileRow);
+    void rasterizeTriangle(const Triangle& triangle, unsigned int firstTileRow, unsigned int lastTileRow);
+public:
+    /**
+     * @brief Clears the buffer and the occluders for a frame seen through viewProjection
+     */
+    void begin(const glm::mat4& viewProjection);
+
+    /**
+     * @brief Clips the triangles of the occluder to the near plane and sets them up, the faces the
+     * culling of the polytope hides are dropped
+     */
+    void addOccluder(const glm::mat4& model, const Polytope::Occluder& occluder, Polytope::FaceCulling faceCulling);
+
+    /**
+     * @brief Rasterizes the occluders of the frame, on the worker threads
+     */
+    void rasterize();
+
+    /**
+     * @brief Whether the box boundsMin-boundsMax in the space of the model may be seen
+     */
+    bool isVisible(const glm::mat4& model, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+public:
+    // Bands of the buffer rasterized in parallel at most, 1: on the calling thread
+    inline void setThreads(unsigned int threads) { this->threads = threads < 1 ? 1 : threads; }
+    inline unsigned int getThreads() const { return threads; }
+
+    inline unsigned int getWidth() const { return width; }
+    inline unsigned int getHeight() const { return height; }
+
+    inline unsigned int getTriangleCount() const { return triangles.size(); }
+    inline unsigned int getTested() const { return tested; }
+    inline unsigned int getCulled() const { return culled; }
+    inline double getRasterizeTime() const { return rasterizeTime; }    // ms
+};
\ No newline at end of file
@@ -12,60 +12,38 @@ Sphere::Sphere(float radius, int latitudes, int longitudes)
     : Shape(createSphere(radius, latitudes, longitudes)) {
 }
 
-Polytope::Ptr Sphere::createSphere(float radius, int latitudes, int longitudes) {
-
-    Polytope::Ptr polytope = nullptr;
-
-    std::vector<unsigned int> sphereIndices;
+void Sphere::createSphereGeometry(float radius, int latitudes, int longitudes, std::vector<Vec3f>& vertices, std::vector<unsigned int>& indices) {
 
     if(longitudes < 3) longitudes = 3;
     if(latitudes < 2) latitudes = 2;
 
-    std::vector<glm::vec3> vertices;
-    std::vector<glm::vec3> normals;
-    std::vector<glm::vec2> uv;
-    std::vector<unsigned int> indices;
-    std::vector<Vec3f> vert;
-
-    float nx, ny, nz, lengthInv = 1.0f / radius;
+    vertices.clear();
+    indices.clear();
+    vertices.reserve((latitudes + 1) * (longitudes + 1));
+    indices.reserve((latitudes - 1) * longitudes * 6);
 
-    struct Vertex {
-        float x, y, z, s, t;
-    };
+    float lengthInv = 1.0f / radius;
 
     float deltaLatitude = M_PI / latitudes;
     float deltaLongitude = 2 * M_PI / longitudes;
-    float latitudeAngle;
-    float longitudeAngle;
 
     for (int i = 0; i <= latitudes; ++i) {
         
-        latitudeAngle = M_PI / 2 - i * deltaLatitude;
+        float latitudeAngle = M_PI / 2 - i * deltaLatitude;
         float xy = radius * cosf(latitudeAngle);
         float z = radius * sinf(latitudeAngle);
 
         for (int j = 0; j <= longitudes; ++j) {
             
-            longitudeAngle = j * deltaLongitude;
-
-            Vertex vertex;
-            vertex.x = xy * cosf(longitudeAngle);
-            vertex.y = xy * sinf(longitudeAngle);
-            vertex.z = z;
+            float longitudeAngle = j * deltaLongitude;
 
-            vertex.s = (float) j / longitudes;
-            vertex.t = (float) i / latitudes;
+            float x = xy * cosf(longitudeAngle);
+            float y = xy * sinf(longitudeAngle);
 
-            vertices.push_back(glm::vec3(vertex.x, vertex.y, vertex.z));
-            uv.push_back(glm::vec2(vertex.s, vertex.t));
+            float s = (float) j / longitudes;
+            float t = (float) i / latitudes;
 
-            nx = vertex.x * lengthInv;
-            ny = vertex.y * lengthInv;
-            nz = vertex.z * lengthInv;
-            normals.push_back(glm::vec3(nx, ny, nz));
-
-            Vec3f v(vertex.x, vertex.y, vertex.z, 1.0f, 1.0f, 1.0f, nx, ny, nz, vertex.s, vertex.t);
-            vert.push_back(v);
+            vertices.emplace_back(x, y, z, 1.0f, 1.0f, 1.0f, x * lengthInv, y * lengthInv, z * lengthInv, s, t);
         }
     }
 
@@ -90,7 +68,13 @@ Polytope::Ptr Sphere::createSphere(float radius, int latitudes, int longitudes)
             }
         }
     }
+}
+
+Polytope::Ptr Sphere::createSphere(float radius, int latitudes, int longitudes) {
+
+    std::vector<Vec3f> vertices;
+    std::vector<unsigned int> indices;
+    createSphereGeometry(radius, latitudes, longitudes, vertices, indices);
 
-    polytope = Polytope::New(vert, indices);
-    return polytope;
+    return Polytope::New(vertices, indices);
 }
\ No newline at end of file
@@ -10,4 +10,9 @@ public:
     virtual ~Sphere() = default;
 private:
     Polytope::Ptr createSphere(float radius, int latitudes, int longitudes);
+public:
+    /**
+     * @brief Vertices and indices of the sphere, CPU only
+     */
+    static void createSphereGeometry(float radius, int latitudes, int longitudes, std::vector<Vec3f>& vertices, std::vector<unsigned int>& indices);
 };
\ No newline at end of file
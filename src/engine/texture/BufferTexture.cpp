@@ -0,0 +1,57 @@
+#include "BufferTexture.h"
+
+#include <algorithm>
+
+#include "engine/opengl/device/RenderDevice.h"
+
+BufferTexture::BufferTexture(GLenum _internalFormat)
+    : Texture(), buffer(0), internalFormat(_internalFormat), capacity(0) {
+    type = Type::TextureBuffer;
+    generateTexture();
+}
+
+BufferTexture::~BufferTexture() {
+    if(freeGPU) RenderDevice::get()->deleteBuffers(1, &buffer);
+}
+
+void BufferTexture::generateTexture() {
+
+    RenderDevice::get()->genBuffers(1, &buffer);
+    RenderDevice::get()->genTextures(1, &id);
+
+    // A texture buffer needs storage before it's attached
+    RenderDevice::get()->bindBuffer(GL_TEXTURE_BUFFER, buffer);
+    RenderDevice::get()->bufferData(GL_TEXTURE_BUFFER, 16, NULL, GL_STREAM_DRAW);
+    RenderDevice::get()->bindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    RenderDevice::get()->bindTexture(GL_TEXTURE_BUFFER, id);
+    RenderDevice::get()->texBuffer(GL_TEXTURE_BUFFER, internalFormat, buffer);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_BUFFER, 0);
+
+    capacity = 16;
+    slot = 0x84C0 + count;
+    count ++;
+}
+
+void BufferTexture::update(const void* data, size_t size) {
+
+    RenderDevice::get()->bindBuffer(GL_TEXTURE_BUFFER, buffer);
+
+    // Orphan the old storage, the GPU may still be reading it
+    capacity = std::max(capacity, size);
+    RenderDevice::get()->bufferData(GL_TEXTURE_BUFFER, capacity, NULL, GL_STREAM_DRAW);
+    if(size > 0) RenderDevice::get()->bufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+    RenderDevice::get()->bindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    RenderStats::countUpload(size);
+}
+
+void BufferTexture::bind() {
+    RenderDevice::get()->activeTexture(slot);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_BUFFER, id);
+    RenderStats::countTextureBind();
+}
+
+void BufferTexture::unbind() {
+    RenderDevice::get()->bindTexture(GL_TEXTURE_BUFFER, 0);
+}
\ No newline at end of file
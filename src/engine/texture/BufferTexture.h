@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Texture.h"
+
+/**
+ * @brief Texture whose texels are a GL buffer (GL_TEXTURE_BUFFER), read with texelFetch.
+ *
+ * It's a big 1D array for the shaders, for data which changes every frame and doesn't fit in
+ * uniforms. update replaces the whole buffer, so the driver doesn't wait for the previous frame.
+ */
+class BufferTexture : public Texture {
+    GENERATE_PTR(BufferTexture)
+private:
+    unsigned int buffer;
+    GLenum internalFormat;
+    size_t capacity;
+public:
+    BufferTexture(GLenum _internalFormat);
+    BufferTexture() = default;
+    ~BufferTexture();
+private:
+    void generateTexture() override;
+public:
+    void update(const void* data, size_t size);
+
+    void bind() override;
+    void unbind() override;
+public:
+    // Texture unit for the sampler uniform
+    inline int getUnit() const { return slot - GL_TEXTURE0; }
+    inline unsigned int getBuffer() const { return buffer; }
+};
\ No newline at end of file
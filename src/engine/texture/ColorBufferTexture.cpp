@@ -1,7 +1,9 @@
 #include "ColorBufferTexture.h"
 
-ColorBufferTexture::ColorBufferTexture(int _width, int _height) 
-    : Texture() {
+#include "engine/opengl/device/RenderDevice.h"
+
+ColorBufferTexture::ColorBufferTexture(int _width, int _height, GLenum _internalFormat) 
+    : Texture(), internalFormat(_internalFormat) {
     width = _width;
     height = _height;
     bpp = 3;
@@ -11,13 +13,13 @@ ColorBufferTexture::ColorBufferTexture(int _width, int _height)
 
 void ColorBufferTexture::generateTexture() {
     
-    glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
+    RenderDevice::get()->genTextures(1, &id);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D, id);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+    RenderDevice::get()->texImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
     slot = 0x84C0 + count;
     count ++;
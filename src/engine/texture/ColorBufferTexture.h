@@ -4,10 +4,14 @@
 
 class ColorBufferTexture : public Texture {
     GENERATE_PTR(ColorBufferTexture)
+private:
+    GLenum internalFormat;
 public:
-    ColorBufferTexture(int _width, int _height);
+    ColorBufferTexture(int _width, int _height, GLenum _internalFormat = GL_RGBA16F);
     ColorBufferTexture() = default;
     ~ColorBufferTexture() = default;
 private:
     void generateTexture() override;
+public:
+    inline GLenum getInternalFormat() const { return internalFormat; }
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "CubeMapTexture.h"
 
+#include "engine/opengl/device/RenderDevice.h"
+
 CubeMapTexture::CubeMapTexture(const std::vector<std::string>& _faces) 
     : Texture(), faces(_faces) {
     type = Type::TextureCubeMap;
@@ -7,34 +9,37 @@ CubeMapTexture::CubeMapTexture(const std::vector<std::string>& _faces)
 }
 
 void CubeMapTexture::generateTexture() {
-    glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, id);
+    RenderDevice::get()->genTextures(1, &id);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_CUBE_MAP, id);
 
     for (unsigned int i = 0; i < faces.size(); i++) {
         Image image = readImage(faces[i]);
-        if (image.data)
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.data);
+        if (image.data) {
+            RenderDevice::get()->texImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.data);
+            RenderStats::countUpload((size_t)image.width * image.height * 3);
+        }
         else {
             std::cout << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
             return;
         }
     }
 
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
     
     slot = 0x84C0 + count;
     count ++;
 }
 
 void CubeMapTexture::bind() {
-    glActiveTexture(slot);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, id);
+    RenderDevice::get()->activeTexture(slot);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_CUBE_MAP, id);
+    RenderStats::countTextureBind();
 }
 
 void CubeMapTexture::unbind() {
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_CUBE_MAP, 0);
 }
\ No newline at end of file
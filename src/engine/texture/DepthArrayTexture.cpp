@@ -0,0 +1,107 @@
+#include "DepthArrayTexture.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "engine/opengl/device/RenderDevice.h"
+
+#include "vendor/stb_image_write.h"
+
+DepthArrayTexture::DepthArrayTexture(int _width, int _height, int _layers, GLenum _format, bool _compare)
+    : Texture(), layers(_layers), format(_format), compare(_compare), depthSlot(0), depthSampler(0) {
+    width = _width;
+    height = _height;
+    bpp = 1;
+    type = Type::TextureDepth;
+    generateTexture();
+}
+
+DepthArrayTexture::~DepthArrayTexture() {
+    if(depthSampler != 0) RenderDevice::get()->deleteSamplers(1, &depthSampler);
+}
+
+void DepthArrayTexture::generateTexture() {
+    RenderDevice::get()->genTextures(1, &id);
+
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D_ARRAY, id);
+    RenderDevice::get()->texImage3D(GL_TEXTURE_2D_ARRAY, 0, format, width, height, layers, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+
+    // Linear filtering of the comparisons is the hardware PCF
+    GLint filter = compare ? GL_LINEAR : GL_NEAREST;
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, filter);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, filter);
+    if(compare) {
+        RenderDevice::get()->texParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        RenderDevice::get()->texParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    }
+
+    // Outside of the cascade nothing is in shadow
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+
+    float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    RenderDevice::get()->texParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    slot = 0x84C0 + count;
+    count ++;
+
+    if(!compare) return;
+
+    RenderDevice::get()->genSamplers(1, &depthSampler);
+    RenderDevice::get()->samplerParameteri(depthSampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    RenderDevice::get()->samplerParameteri(depthSampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    RenderDevice::get()->samplerParameteri(depthSampler, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+    RenderDevice::get()->samplerParameteri(depthSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    RenderDevice::get()->samplerParameteri(depthSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    RenderDevice::get()->samplerParameterfv(depthSampler, GL_TEXTURE_BORDER_COLOR, borderColor);
+
+    depthSlot = 0x84C0 + count;
+    count ++;
+}
+
+void DepthArrayTexture::bind() {
+    RenderDevice::get()->activeTexture(slot);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D_ARRAY, id);
+    RenderStats::countTextureBind();
+
+    if(!compare) return;
+
+    RenderDevice::get()->activeTexture(depthSlot);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D_ARRAY, id);
+    RenderDevice::get()->bindSampler(getDepthUnit(), depthSampler);
+    RenderStats::countTextureBind();
+}
+
+void DepthArrayTexture::unbind() {
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+bool DepthArrayTexture::saveLayerToImage(int layer, const char* filename) {
+
+    if(layer < 0 || layer >= layers) return false;
+
+    // glGetTexImage reads every layer
+    std::vector<float> depthData((size_t)width * height * layers);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D_ARRAY, id);
+    RenderDevice::get()->getTexImage(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT, GL_FLOAT, depthData.data());
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    float* depth = depthData.data() + (size_t)width * height * layer;
+    float minDepth = *std::min_element(depth, depth + width * height);
+    float maxDepth = *std::max_element(depth, depth + width * height);
+    float range = maxDepth > minDepth ? maxDepth - minDepth : 1.0f;
+
+    // Normalized to [0, 255]
+    std::vector<unsigned char> image((size_t)width * height);
+    for(int i = 0; i < width * height; i ++)
+        image[i] = static_cast<unsigned char>((depth[i] - minDepth) / range * 255.0f);
+
+    if(!stbi_write_png(filename, width, height, 1, image.data(), width)) {
+        std::cerr << "Failed to write image file " << filename << std::endl;
+        return false;
+    }
+
+    return true;
+}
\ No newline at end of file
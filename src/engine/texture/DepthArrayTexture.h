@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Texture.h"
+
+/**
+ * @brief Depth texture with layers (GL_TEXTURE_2D_ARRAY), a layer per shadow cascade.
+ *
+ * With depth comparison the shaders read it with a sampler2DArrayShadow: the hardware compares
+ * and filters the 4 nearest texels (PCF). The depths themselves are read on a second texture
+ * unit, through a sampler object without comparison (sampler2DArray).
+ * The layer is the third texture coordinate.
+ */
+class DepthArrayTexture : public Texture {
+    GENERATE_PTR(DepthArrayTexture)
+private:
+    int layers;
+    GLenum format;
+
+    // Depths without comparison
+    bool compare;
+    int depthSlot;
+    unsigned int depthSampler;
+public:
+    DepthArrayTexture(int _width, int _height, int _layers, GLenum _format = GL_DEPTH_COMPONENT24, bool _compare = true);
+    DepthArrayTexture() = default;
+    ~DepthArrayTexture();
+private:
+    void generateTexture() override;
+public:
+    void bind() override;
+    void unbind() override;
+
+    bool saveLayerToImage(int layer, const char* filename);
+public:
+    // Texture unit for the sampler uniform
+    inline int getUnit() const { return slot - GL_TEXTURE0; }
+    // Texture unit of the depths without comparison
+    inline int getDepthUnit() const { return depthSlot - GL_TEXTURE0; }
+    inline bool isCompare() const { return compare; }
+    inline int getLayers() const { return layers; }
+    inline GLenum getFormat() const { return format; }
+    inline int getWidth() const { return width; }
+    inline int getHeight() const { return height; }
+};
\ No newline at end of file
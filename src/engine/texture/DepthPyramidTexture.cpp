@@ -0,0 +1,43 @@
+#include "DepthPyramidTexture.h"
+
+#include "engine/opengl/device/RenderDevice.h"
+
+DepthPyramidTexture::DepthPyramidTexture(int _width, int _height)
+    : Texture(), levels(1) {
+    width = _width;
+    height = _height;
+    bpp = 1;
+    type = Type::TextureDepth;
+    generateTexture();
+}
+
+void DepthPyramidTexture::generateTexture() {
+
+    // Down to 1x1
+    levels = 1;
+    while((width >> levels) > 0 || (height >> levels) > 0) levels ++;
+
+    RenderDevice::get()->genTextures(1, &id);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D, id);
+
+    for(int level = 0; level < levels; level ++) {
+        RenderDevice::get()->texImage2D(GL_TEXTURE_2D, level, GL_R32F, getLevelSize(width, level), getLevelSize(height, level),
+            0, GL_RED, GL_FLOAT, NULL);
+    }
+
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    setLevelRange(0, levels - 1);
+
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D, 0);
+
+    slot = 0x84C0 + count;
+    count ++;
+}
+
+void DepthPyramidTexture::setLevelRange(int baseLevel, int maxLevel) {
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel);
+}
\ No newline at end of file
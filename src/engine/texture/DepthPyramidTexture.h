@@ -0,0 +1,38 @@
+#pragma once
+
+#include <algorithm>
+
+#include "Texture.h"
+
+/**
+ * @brief Mip chain of the farthest depths of the screen (R32F), for the occlusion tests.
+ *
+ * A texel of a level holds the maximum of the texels it overlaps in the level below, odd sizes
+ * included, so a box whose nearest depth is behind the texels it covers is hidden. The shaders
+ * read it with texelFetch. While a level is rendered, only the level below it can be read.
+ */
+class DepthPyramidTexture : public Texture {
+    GENERATE_PTR(DepthPyramidTexture)
+private:
+    int levels;
+public:
+    DepthPyramidTexture(int _width, int _height);
+    DepthPyramidTexture() = default;
+    ~DepthPyramidTexture() = default;
+private:
+    void generateTexture() override;
+public:
+    /**
+     * @brief Levels the shaders can read, the texture must be bound
+     */
+    void setLevelRange(int baseLevel, int maxLevel);
+public:
+    // Texture unit for the sampler uniform
+    inline int getUnit() const { return slot - GL_TEXTURE0; }
+    inline int getLevels() const { return levels; }
+    inline int getWidth() const { return width; }
+    inline int getHeight() const { return height; }
+
+    // Size of a level, the GL rounds it down
+    static inline int getLevelSize(int size, int level) { return std::max(1, size >> level); }
+};
\ No newline at end of file
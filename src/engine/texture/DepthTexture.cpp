@@ -1,12 +1,14 @@
 #include "DepthTexture.h"
 
+#include "engine/opengl/device/RenderDevice.h"
+
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <algorithm>
 
 #include "vendor/stb_image_write.h"
 
-DepthTexture::DepthTexture(int _width, int _height) 
-    : Texture() {
+DepthTexture::DepthTexture(int _width, int _height, GLenum _format) 
+    : Texture(), format(_format) {
     width = _width;
     height = _height;
     bpp = 1;
@@ -15,19 +17,20 @@ DepthTexture::DepthTexture(int _width, int _height)
 }
 
 void DepthTexture::generateTexture() {
-    glGenTextures(1, &id);
+    RenderDevice::get()->genTextures(1, &id);
     
-    glBindTexture(GL_TEXTURE_2D, id);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D, id);
+    if(format == GL_DEPTH24_STENCIL8) RenderDevice::get()->texImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+    else RenderDevice::get()->texImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
     
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
 
     float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+    RenderDevice::get()->texParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
     
     slot = 0x84C0 + count;
     count ++;
@@ -37,13 +40,13 @@ void DepthTexture::generateTexture() {
 // Gernated with ChatGPT 4.0 in July 2024
 bool DepthTexture::saveDepthTextureToImage(int width, int height, const char* filename) {
     // Bind the texture
-    glBindTexture(GL_TEXTURE_2D, id);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D, id);
 
     // Allocate memory to read the depth data
     float* depthData = new float[width * height];
 
     // Read the depth data from the texture
-    glGetTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_FLOAT, depthData);
+    RenderDevice::get()->getTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_FLOAT, depthData);
 
     // Find min and max depth values
     float minDepth = *std::min_element(depthData, depthData + width * height);
@@ -4,11 +4,25 @@
 
 class DepthTexture : public Texture {
     GENERATE_PTR(DepthTexture)
+private:
+    GLenum format;
 public:
-    DepthTexture(int _width, int _height);
+    DepthTexture(int _width, int _height, GLenum _format = GL_DEPTH_COMPONENT);
     DepthTexture() = default;
     ~DepthTexture() = default;
     bool saveDepthTextureToImage(int width, int height, const char* filename);
 private:
     void generateTexture() override;
+public:
+    // Texture unit for the sampler uniform
+    inline int getUnit() const { return slot - GL_TEXTURE0; }
+    inline GLenum getFormat() const { return format; }
+
+    // Sized formats of shadow maps: 16 bits, 24 bits and 32 bits float
+    static inline bool isShadowFormat(GLenum format) {
+        return format == GL_DEPTH_COMPONENT16 || format == GL_DEPTH_COMPONENT24 || format == GL_DEPTH_COMPONENT32F;
+    }
+
+    inline int getWidth() const { return width; }
+    inline int getHeight() const { return height; }
 };
\ No newline at end of file
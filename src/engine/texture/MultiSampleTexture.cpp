@@ -1,26 +1,30 @@
 #include "MultiSampleTexture.h"
 
-MultiSampleTexture::MultiSampleTexture(unsigned int width, unsigned int height, unsigned int _samples) 
-    : Texture(), samples(_samples) {
+#include "engine/opengl/device/RenderDevice.h"
+
+MultiSampleTexture::MultiSampleTexture(unsigned int width, unsigned int height, unsigned int _samples, GLenum _internalFormat) 
+    : Texture(), samples(_samples), internalFormat(_internalFormat) {
     this->width = width;
     this->height = height;
     generateTexture();
 }
 
 void MultiSampleTexture::generateTexture() {
-    glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, id);
-    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, samples, GL_RGBA, width, height, GL_TRUE);
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+    RenderDevice::get()->genTextures(1, &id);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D_MULTISAMPLE, id);
+    RenderDevice::get()->texImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, samples, internalFormat, width, height, GL_TRUE);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
 
     slot = 0x84C0 + count;
     count ++;
 }
 
 void MultiSampleTexture::bind() {
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, id);
+    RenderDevice::get()->activeTexture(slot);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D_MULTISAMPLE, id);
+    RenderStats::countTextureBind();
 }
 
 void MultiSampleTexture::unbind() {
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
 }
\ No newline at end of file
@@ -6,8 +6,9 @@ class MultiSampleTexture : public Texture {
     GENERATE_PTR(MultiSampleTexture)
 protected:
     unsigned int samples;
+    GLenum internalFormat;
 public:
-    MultiSampleTexture(unsigned int width, unsigned int height, unsigned int _samples = 4);
+    MultiSampleTexture(unsigned int width, unsigned int height, unsigned int _samples = 4, GLenum _internalFormat = GL_RGBA);
     MultiSampleTexture() = default;
     ~MultiSampleTexture() = default;
 protected:
@@ -17,4 +18,8 @@ public:
     void unbind() override;
 public:
     inline unsigned int getSamples() const { return samples; }
+    inline GLenum getInternalFormat() const { return internalFormat; }
+
+    // Texture unit for the sampler2DMS uniform
+    inline int getUnit() const { return slot - GL_TEXTURE0; }
 };
\ No newline at end of file
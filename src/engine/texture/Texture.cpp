@@ -1,8 +1,12 @@
 #include "Texture.h"
 
+#include "engine/opengl/device/RenderDevice.h"
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "vendor/stb_image.h"
 
+#include "engine/profiler/Instrumentation.h"
+
 unsigned int Texture::count = 0;
 int Texture::textureUnits = 0;
 
@@ -54,8 +58,8 @@ Texture::Texture(Texture&& texture) noexcept
 
 Texture::~Texture() {
 	unbind();
-	glActiveTexture(0);
-	if(freeGPU) glDeleteTextures(1, &id);
+	RenderDevice::get()->activeTexture(0);
+	if(freeGPU) RenderDevice::get()->deleteTextures(1, &id);
 }
 
 Texture& Texture::operator=(const Texture& texture) {
@@ -72,37 +76,39 @@ Texture& Texture::operator=(const Texture& texture) {
 
 void Texture::generateTexture() {
 	
-	glGenTextures(1, &id);
-	glBindTexture(GL_TEXTURE_2D, id);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	RenderDevice::get()->genTextures(1, &id);
+	RenderDevice::get()->bindTexture(GL_TEXTURE_2D, id);
+	RenderDevice::get()->texImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 	slot = 0x84C0 + count;
 	count++;
 }
 
 void Texture::loadTexture(unsigned char* buffer) {
-	glBindTexture(GL_TEXTURE_2D, id);
+	RenderDevice::get()->bindTexture(GL_TEXTURE_2D, id);
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	RenderDevice::get()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
-	glGenerateMipmap(GL_TEXTURE_2D);
+	RenderDevice::get()->texImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
+	RenderDevice::get()->generateMipmap(GL_TEXTURE_2D);
+	if(buffer) RenderStats::countUpload((size_t)width * height * 4);
 }
 
 void Texture::generateTextureFromBuffer(unsigned char* buffer) {
-	glGenTextures(1, &id);
+	RenderDevice::get()->genTextures(1, &id);
 	loadTexture(buffer);
 	slot = 0x84C0 + count;
 	count++;
 }
 
 void Texture::generateTextureFromFile(const std::string& path) {
+	RENDERERGL_ZONE("Texture::generateTextureFromFile");
 	stbi_set_flip_vertically_on_load(flip);
 	unsigned char* data = stbi_load(path.c_str(), &width, &height, &bpp, STBI_rgb_alpha);
 	generateTextureFromBuffer(data);
@@ -110,12 +116,13 @@ void Texture::generateTextureFromFile(const std::string& path) {
 }
 
 void Texture::bind() {
-    glActiveTexture(slot);
-	glBindTexture(GL_TEXTURE_2D, id);
+    RenderDevice::get()->activeTexture(slot);
+	RenderDevice::get()->bindTexture(GL_TEXTURE_2D, id);
+	RenderStats::countTextureBind();
 }
 
 void Texture::unbind() {
-    glBindTexture(GL_TEXTURE_2D, 0);
+    RenderDevice::get()->bindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Texture::changeTexture(const std::string& path) {
@@ -7,6 +7,9 @@
 
 #include "engine/ptr.h"
 
+#include "engine/renderer/RenderStats.h"
+#include "engine/opengl/device/RenderDevice.h"
+
 struct Image {
     unsigned char* data;
     int width, height, bpp;
@@ -38,7 +41,9 @@ public:
         TextureAlbedo = 9,
         TextureMetallic = 10,
         TextureRoughness = 11,
-        TextureAmbientOcclusion = 12
+        TextureAmbientOcclusion = 12,
+
+        TextureBuffer = 13
     };
     static int textureUnits;
     static unsigned int count;
@@ -60,7 +65,7 @@ public:
     virtual ~Texture();
     Texture& operator=(const Texture& texture);
 protected:
-    inline void initTextureUnits() { glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &Texture::textureUnits); }
+    inline void initTextureUnits() { RenderDevice::get()->getIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &Texture::textureUnits); }
     void loadTexture(unsigned char* buffer);
     void generateTextureFromBuffer(unsigned char* buffer);
     void generateTextureFromFile(const std::string& path);
@@ -17,6 +17,7 @@
 #include <engine/renderer/FPSCamera.h>
 #include <engine/renderer/MouseRayCasting.h>
 #include <engine/model/Model.h>
+#include <engine/profiler/Instrumentation.h>
 
 #include "ImguiStyles.h"
 
@@ -673,6 +674,60 @@ int main(void) {
 
                 ImGui::End();
             }
+
+            // Statistics window
+            {
+                ImGui::Begin("Statistics");
+
+                const RenderStats::Ptr& stats = renderer->getStats();
+                const RenderStats::Counters& total = stats->getFrame().total;
+
+                ImGui::TextColored(ImColor(200, 150, 255), "Last frame");
+                ImGui::Text("Draw calls: %u", total.drawCalls);
+                ImGui::Text("Instances: %u", total.instances);
+                ImGui::Text("Triangles: %u  Lines: %u  Points: %u", total.triangles, total.lines, total.points);
+                ImGui::Text("Program binds: %u  Texture binds: %u", total.programBinds, total.textureBinds);
+                ImGui::Text("Uploaded: %.2f KB", total.uploadedBytes / 1024.0);
+                ImGui::Text("Vertex fetch: %.2f MB", total.vertexBytes / (1024.0 * 1024.0));
+                ImGui::Text("Culled objects: %u", total.culledObjects);
+
+                ImGui::Separator();
+
+                ImGui::TextColored(ImColor(200, 150, 255), "Passes");
+                for(int i = 0; i < RenderStats::PASS_COUNT; i ++) {
+                    const RenderStats::Counters& pass = stats->getPassCounters((RenderStats::Pass)i);
+                    ImGui::Text("%-12s draws %4u  triangles %8u", RenderStats::getPassName((RenderStats::Pass)i), pass.drawCalls, pass.triangles);
+                }
+
+                ImGui::Separator();
+
+                ImGui::TextColored(ImColor(200, 150, 255), "GPU time");
+                for(auto& scope : renderer->getGPUProfiler()->getScopes())
+                    ImGui::Text("%*s%-14s %6.3f ms", scope.depth * 2, "", scope.name.c_str(), scope.average);
+
+                ImGui::Separator();
+
+                // Chrome trace of the CPU zones, open it in chrome://tracing or Perfetto
+                static bool traceRequested = false;
+                if(ImGui::Button("Capture trace (60 frames)")) {
+                    Instrumentation::captureFrames(60);
+                    traceRequested = true;
+                }
+                if(traceRequested && !Instrumentation::isCapturing()) {
+                    if(!Instrumentation::getEvents().empty()) {
+                        Instrumentation::writeChromeTrace("trace.json");
+                        traceRequested = false;
+                    }
+                }
+
+                ImGui::Separator();
+
+                std::vector<float> drawCalls;
+                for(auto& frame : stats->getHistory()) drawCalls.push_back(frame.total.drawCalls);
+                if(!drawCalls.empty()) ImGui::PlotLines("Draw calls", drawCalls.data(), drawCalls.size(), 0, nullptr, 0.f, FLT_MAX, ImVec2(0, 60));
+
+                ImGui::End();
+            }
             // Render window
             static bool windowFocus = false;
             { 
@@ -145,6 +145,9 @@ int main() {
                 ImGui::Checkbox("Enable", &enable);
                 renderer->setLightEnabled(enable);
 
+                static bool objectLighting = renderer->isObjectLighting();
+                if(ImGui::Checkbox("Per object lights", &objectLighting)) renderer->setObjectLighting(objectLighting);
+
                 /*ImGui::SameLine();
 
                 static bool enablePointLight = false;
@@ -227,22 +230,41 @@ int main() {
                 ImGui::Checkbox("Shadow mapping", &shadowMapping);
                 renderer->setShadowMapping(shadowMapping);
 
-                static int shadowProcedure = 0;
-                static bool previousShadowMapping = true;
-                if(previousShadowMapping != shadowMapping) {
-                    if(!shadowMapping) {
-                        shadowProcedure = 0;
-                        renderer->setShadowMappingProcedure(shadowProcedure);
-                    }
-                    previousShadowMapping = shadowMapping;
+                static int shadowProcedure = 1;
+                if(ImGui::RadioButton("Single map", shadowProcedure == 0)) {
+                    shadowProcedure = 0;
+                    renderer->setShadowMappingProcedure(shadowProcedure);
                 }
-
-                /*if(ImGui::RadioButton("CSM", shadowProcedure == 1)) {
+                if(ImGui::RadioButton("CSM", shadowProcedure == 1)) {
                     shadowProcedure = 1;
                     // activate CSM, deactivate other procedures
                     renderer->setShadowMappingProcedure(shadowProcedure);
                 }
-                if(ImGui::RadioButton("PSSM", shadowProcedure == 2)) {
+
+                ShadowCascades::Ptr& shadowCascades = renderer->getShadowCascades();
+                static float splitLambda = shadowCascades->getSplitLambda();
+                if(ImGui::SliderFloat("Split lambda", &splitLambda, 0.f, 1.f)) shadowCascades->setSplitLambda(splitLambda);
+                static float cascadeBlend = shadowCascades->getBlend();
+                if(ImGui::SliderFloat("Cascade blend", &cascadeBlend, 0.f, 0.5f)) shadowCascades->setBlend(cascadeBlend);
+                static bool shadowCache = shadowCascades->isCaching();
+                if(ImGui::Checkbox("Cache static shadows", &shadowCache)) shadowCascades->setCaching(shadowCache);
+                static int shadowFilter = shadowCascades->getFilter();
+                if(ImGui::Combo("Shadow filter", &shadowFilter, "Hardware\0Poisson\0Rotated disk\0PCSS\0"))
+                    shadowCascades->setFilter((ShadowCascades::Filter)shadowFilter);
+                static int shadowQuality = shadowCascades->getQuality();
+                if(ImGui::Combo("Shadow quality", &shadowQuality, "Low\0Medium\0High\0Ultra\0"))
+                    shadowCascades->setQuality((ShadowCascades::Quality)shadowQuality);
+                static float lightSize = shadowCascades->getLightSize();
+                if(shadowFilter == ShadowCascades::PCSS && ImGui::SliderFloat("Light size", &lightSize, 0.f, 0.1f))
+                    shadowCascades->setLightSize(lightSize);
+
+                static bool pointShadows = renderer->isPointShadowMapping();
+                if(ImGui::Checkbox("Point light shadows", &pointShadows)) renderer->setPointShadowMapping(pointShadows);
+                static int pointShadowBudget = renderer->getPointShadows()->getBudget();
+                if(pointShadows && ImGui::SliderInt("Point shadow budget", &pointShadowBudget, 1, POINT_SHADOW_MAX_LIGHTS))
+                    renderer->getPointShadows()->setBudget(pointShadowBudget);
+
+                /*if(ImGui::RadioButton("PSSM", shadowProcedure == 2)) {
                     shadowProcedure = 2;
                     // activate PSSM, deactivate other procedures
                     renderer->setShadowMappingProcedure(shadowProcedure);
@@ -0,0 +1,184 @@
+#include <vector>
+#include <cstring>
+
+#include <engine/opengl/buffer/BufferHeap.h>
+#include <engine/opengl/buffer/VertexBuffer.h>
+#include <engine/opengl/buffer/IndexBuffer.h>
+#include <engine/opengl/device/NullRenderDevice.h>
+
+#include "UnitTest.h"
+
+// Fences signal only when the test says the GPU is done
+class FencedDevice : public NullRenderDevice {
+public:
+    bool signaled = false;
+
+    GLenum clientWaitSync(GLsync, GLbitfield, GLuint64) override {
+        return signaled ? GL_ALREADY_SIGNALED : GL_TIMEOUT_EXPIRED;
+    }
+};
+
+static std::vector<unsigned char> readBack(const BufferHeap::Allocation& allocation, unsigned int offset, unsigned int size) {
+    RenderDevice::get()->bindBuffer(GL_COPY_READ_BUFFER, allocation.buffer);
+    unsigned char* data = static_cast<unsigned char*>(RenderDevice::get()->mapBufferRange(GL_COPY_READ_BUFFER, offset, size, GL_MAP_READ_BIT));
+    std::vector<unsigned char> bytes = data != nullptr ? std::vector<unsigned char>(data, data + size) : std::vector<unsigned char>();
+    RenderDevice::get()->unmapBuffer(GL_COPY_READ_BUFFER);
+    RenderDevice::get()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+    return bytes;
+}
+
+TEST(BufferHeap, AllocateAndUpload) {
+    RenderDevice::set(NullRenderDevice::New());
+    BufferHeap heap(1024, 16);
+
+    BufferHeap::Allocation a = heap.allocate(100);
+    BufferHeap::Allocation b = heap.allocate(10);
+    REQUIRE(a.isValid() && b.isValid());
+    CHECK_EQUAL(a.size, 112u);
+    CHECK_EQUAL(b.offset, 112u);
+    CHECK_EQUAL(heap.getPagesCount(), (size_t)1);
+
+    std::vector<unsigned char> data(10, 7);
+    heap.upload(b, data.data(), data.size());
+    CHECK(readBack(b, b.offset, 10) == data);
+
+    // Bigger than a page, it gets its own
+    BufferHeap::Allocation big = heap.allocate(3000);
+    CHECK(big.isValid());
+    CHECK_EQUAL(big.page, 1u);
+    CHECK_EQUAL(heap.getStats().capacity, (size_t)(1024 + 3008));
+
+    CHECK(!heap.allocate(0).isValid());
+}
+
+TEST(BufferHeap, FencedFree) {
+    std::shared_ptr<FencedDevice> device = std::make_shared<FencedDevice>();
+    RenderDevice::set(device);
+    BufferHeap heap(1024, 16);
+
+    BufferHeap::Allocation a = heap.allocate(256);
+    heap.free(a);
+    CHECK_EQUAL(heap.getStats().pendingFree, (size_t)256);
+
+    // The GPU may still read it, the range isn't reused
+    BufferHeap::Allocation b = heap.allocate(256);
+    CHECK_EQUAL(b.offset, 256u);
+
+    // Not signaled yet, the rest of the page is used around it
+    heap.collect();
+    CHECK_EQUAL(heap.getStats().pendingFree, (size_t)256);
+    CHECK_EQUAL(heap.allocate(512).offset, 512u);
+    CHECK_EQUAL(heap.getStats().free, (size_t)0);
+
+    device->signaled = true;
+    heap.collect();
+    CHECK_EQUAL(heap.getStats().pendingFree, (size_t)0);
+    CHECK_EQUAL(heap.getStats().used, (size_t)768);
+
+    BufferHeap::Allocation c = heap.allocate(256);
+    CHECK_EQUAL(c.page, 0u);
+    CHECK_EQUAL(c.offset, 0u);
+}
+
+TEST(BufferHeap, CompactMovesRelocatable) {
+    RenderDevice::set(NullRenderDevice::New());
+    BufferHeap heap(1024, 16);
+
+    std::vector<std::pair<unsigned int, unsigned int>> moves;
+    BufferHeap::RelocationCallback onRelocate = [&moves](const BufferHeap::Allocation& from, const BufferHeap::Allocation& to) {
+        moves.push_back({ from.offset, to.offset });
+    };
+
+    BufferHeap::Allocation a = heap.allocate(256, onRelocate);
+    BufferHeap::Allocation b = heap.allocate(256, onRelocate);
+    BufferHeap::Allocation c = heap.allocate(256, onRelocate);
+
+    std::vector<unsigned char> data(256);
+    for(unsigned int i = 0; i < data.size(); i ++) data[i] = (unsigned char)i;
+    heap.upload(c, data.data(), data.size());
+
+    // Holes at 0 and at the end
+    heap.free(a);
+    heap.collect();
+    CHECK_EQUAL(heap.getStats().fragmented, (size_t)256);
+
+    CHECK_EQUAL(heap.compact(0), 0u);
+
+    // c goes down to the hole, b would only go up
+    CHECK_EQUAL(heap.compact(1 << 20), 256u);
+    REQUIRE(moves.size() == 1);
+    CHECK_EQUAL(moves[0].first, c.offset);
+    CHECK_EQUAL(moves[0].second, 0u);
+    CHECK(readBack(c, 0, 256) == data);
+
+    // Its old range waits for the fence like any free
+    CHECK_EQUAL(heap.getStats().pendingFree, (size_t)256);
+    heap.collect();
+    CHECK_EQUAL(heap.getStats().fragmented, (size_t)0);
+    CHECK_EQUAL(heap.getStats().free, (size_t)512);
+
+    // Freed at its new offset
+    heap.free({ c.buffer, c.page, 0, 256 });
+    heap.free(b);
+    heap.collect();
+    CHECK_EQUAL(heap.getStats().used, (size_t)0);
+}
+
+TEST(BufferHeap, CompactSkipsFixed) {
+    RenderDevice::set(NullRenderDevice::New());
+    BufferHeap heap(1024, 16);
+
+    BufferHeap::Allocation a = heap.allocate(256);
+    heap.allocate(256);
+    heap.free(a);
+    heap.collect();
+
+    CHECK_EQUAL(heap.getStats().fragmented, (size_t)256);
+    CHECK_EQUAL(heap.compact(1 << 20), 0u);
+}
+
+TEST(BufferHeap, MovedBufferOwnsItsRange) {
+    RenderDevice::set(NullRenderDevice::New());
+    BufferHeap::Ptr heap = BufferHeap::New(4096, 16);
+    VertexBuffer::setHeap(heap);
+    IndexBuffer::setHeap(heap);
+
+    std::vector<Vec3f> vertices(4, Vec3f(1.f, 2.f, 3.f));
+    {
+        VertexBuffer::Ptr first = VertexBuffer::New(vertices);
+        VertexBuffer second(vertices);
+        size_t offset = second.getOffset();
+
+        // The source is left empty, only one of them frees the range
+        VertexBuffer moved(std::move(second));
+        CHECK_EQUAL(second.getID(), 0u);
+        CHECK_EQUAL(moved.getOffset(), offset);
+        CHECK_EQUAL(heap->getStats().allocations, 2u);
+
+        // Compaction updates the new owner
+        first = nullptr;
+        heap->collect();
+        CHECK(heap->compact(1 << 20) > 0u);
+        CHECK_EQUAL(moved.getOffset(), (size_t)0);
+        CHECK_EQUAL(moved.getVertices()[3].z, 3.f);
+
+        // Assigned, the range it had goes back to the heap
+        VertexBuffer assigned(vertices);
+        assigned = std::move(moved);
+        CHECK_EQUAL(moved.getID(), 0u);
+        CHECK_EQUAL(assigned.getOffset(), (size_t)0);
+        heap->collect();
+        CHECK_EQUAL(heap->getStats().allocations, 1u);
+
+        IndexBuffer indices({ 0, 1, 2, 2, 3, 0 });
+        IndexBuffer movedIndices(std::move(indices));
+        CHECK_EQUAL(indices.getID(), 0u);
+        CHECK(movedIndices.getIndices() == std::vector<unsigned int>({ 0, 1, 2, 2, 3, 0 }));
+    }
+    heap->collect();
+    CHECK_EQUAL(heap->getStats().used, (size_t)0);
+    CHECK_EQUAL(heap->getStats().allocations, 0u);
+
+    VertexBuffer::setHeap(nullptr);
+    IndexBuffer::setHeap(nullptr);
+}
\ No newline at end of file
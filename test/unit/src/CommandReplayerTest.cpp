@@ -0,0 +1,151 @@
+#include <vector>
+#include <map>
+#include <cstdio>
+
+#include <engine/renderer/Renderer.h>
+#include <engine/renderer/TrackballCamera.h>
+#include <engine/lighting/PhongMaterial.h>
+#include <engine/shapes/Cube.h>
+#include <engine/opengl/device/NullRenderDevice.h>
+#include <engine/opengl/device/CaptureRenderDevice.h>
+#include <engine/opengl/device/CommandReplayer.h>
+
+#include "UnitTest.h"
+
+#define CAPTURE_PATH "replayer_test.capture"
+#define CAPTURED_FRAMES 3
+
+// Cubes in front of the camera, a light and the depth pre-pass for a few more passes
+static Renderer::Ptr createRenderer(PointLight::Ptr& light) {
+    Renderer::Ptr renderer = Renderer::New(320, 240);
+    renderer->setDepthPrePass(true);
+
+    Group::Ptr group = Group::New();
+    Material::Ptr material = PhongMaterial::New(MATERIAL_DIFFUSE, MATERIAL_SPECULAR, MATERIAL_SHININESS);
+    for(int i = 0; i < 4; i ++) {
+        Polytope::Ptr cube = Cube::New();
+        cube->setMaterial(material);
+        cube->translate(glm::vec3(i * 1.5f - 3.f, 0.f, 0.f));
+        group->add(cube);
+    }
+    Scene::Ptr scene = Scene::New();
+    scene->addGroup(group);
+    renderer->addScene(scene);
+
+    light = PointLight::New(glm::vec3(0.f, 3.f, 0.f), glm::vec3(1.f));
+    renderer->addLight(*light);
+
+    TrackballCamera::Ptr camera = TrackballCamera::perspectiveCamera(glm::radians(45.0f), 320.0 / 240.0, 0.1, 100);
+    camera->zoom(-10.f);
+    renderer->setCamera(std::dynamic_pointer_cast<Camera>(camera));
+    return renderer;
+}
+
+// Same commands in the same order, the names and locations may differ but always map to the same ones.
+// The ids of the state changes are units, enums or names, they aren't compared
+static void checkSameCommands(const std::vector<NullRenderDevice::Command>& captured, const std::vector<NullRenderDevice::Command>& replayed,
+    std::map<GLuint, GLuint>& names, std::map<GLuint, GLuint>& locations) {
+
+    REQUIRE(captured.size() == replayed.size());
+    for(size_t i = 0; i < captured.size(); i ++) {
+        REQUIRE(captured[i].type == replayed[i].type);
+        CHECK_EQUAL(replayed[i].target, captured[i].target);
+        CHECK_EQUAL(replayed[i].count, captured[i].count);
+
+        if(captured[i].type == NullRenderDevice::STATE) continue;
+        std::map<GLuint, GLuint>& mapping = captured[i].type == NullRenderDevice::UNIFORM ? locations : names;
+        auto mapped = mapping.emplace(captured[i].id, replayed[i].id);
+        CHECK_EQUAL(replayed[i].id, mapped.first->second);
+    }
+}
+
+TEST(CommandReplayer, RoundTrip) {
+    NullRenderDevice::Ptr device = NullRenderDevice::New();
+    CaptureRenderDevice::Ptr capture = CaptureRenderDevice::New(device, CAPTURE_PATH);
+    REQUIRE(capture->isOpen());
+    RenderDevice::set(capture);
+
+    // The first frame creates the resources, the commands of the next ones are kept
+    std::vector<std::vector<NullRenderDevice::Command>> capturedFrames;
+    {
+        PointLight::Ptr light;
+        Renderer::Ptr renderer = createRenderer(light);
+        renderer->render();
+        for(int i = 1; i < CAPTURED_FRAMES; i ++) {
+            device->reset();
+            light->setPosition(glm::vec3(i, 3.f, 0.f));
+            renderer->render();
+            capturedFrames.push_back(device->getCommands());
+        }
+    }
+    CHECK_EQUAL(capture->getFrames(), (size_t)CAPTURED_FRAMES);
+    capture = nullptr;
+
+    // Names and uniform locations of the new device start elsewhere
+    NullRenderDevice::Ptr replayDevice = NullRenderDevice::New();
+    RenderDevice::set(replayDevice);
+    GLuint taken[16];
+    replayDevice->genBuffers(16, taken);
+    replayDevice->getUniformLocation(0, "taken");
+
+    CommandReplayer replayer;
+    REQUIRE(replayer.load(CAPTURE_PATH));
+    REQUIRE(replayer.replayFrame());
+
+    std::map<GLuint, GLuint> names, locations;
+    std::vector<std::vector<NullRenderDevice::Command>> replayedFrames;
+    for(int i = 1; i < CAPTURED_FRAMES; i ++) {
+        replayDevice->reset();
+        REQUIRE(replayer.replayFrame());
+        replayedFrames.push_back(replayDevice->getCommands());
+        checkSameCommands(capturedFrames[i - 1], replayedFrames.back(), names, locations);
+
+        for(int type = 0; type < NullRenderDevice::COMMAND_TYPE_COUNT; type ++) {
+            NullRenderDevice::CommandType commandType = static_cast<NullRenderDevice::CommandType>(type);
+            size_t captured = 0;
+            for(auto& command : capturedFrames[i - 1]) captured += command.type == commandType ? 1 : 0;
+            CHECK_EQUAL(replayDevice->getCount(commandType), captured);
+        }
+    }
+    CHECK(!replayer.replayFrame());
+    CHECK(!replayer.hasFailed());
+    CHECK_EQUAL(replayer.getFrame(), (size_t)CAPTURED_FRAMES);
+
+    // Everything was remapped, nothing kept the number of the capture
+    CHECK(!names.empty() && !locations.empty());
+    size_t sameName = 0, sameLocation = 0;
+    for(auto& name : names) sameName += name.first != 0 && name.first == name.second ? 1 : 0;
+    for(auto& location : locations) sameLocation += location.first == location.second ? 1 : 0;
+    CHECK_EQUAL(sameName, (size_t)0);
+    CHECK_EQUAL(sameLocation, (size_t)0);
+
+    // Rewound, the second frame gives the same commands again. What it creates is made again with new names
+    replayer.rewind(1);
+    CHECK_EQUAL(replayer.getFrame(), (size_t)1);
+    replayDevice->reset();
+    REQUIRE(replayer.replayFrame());
+    std::map<GLuint, GLuint> rewoundNames, rewoundLocations;
+    checkSameCommands(capturedFrames[0], replayDevice->getCommands(), rewoundNames, rewoundLocations);
+    CHECK(rewoundLocations == locations);
+
+    // Frames not replayed yet can't be reached
+    replayer.rewind(CAPTURED_FRAMES + 1);
+    CHECK_EQUAL(replayer.getFrame(), (size_t)2);
+
+    std::remove(CAPTURE_PATH);
+}
+
+TEST(CommandReplayer, NotAStream) {
+    RenderDevice::set(NullRenderDevice::New());
+    {
+        std::FILE* file = std::fopen(CAPTURE_PATH, "wb");
+        REQUIRE(file != nullptr);
+        std::fputs("not a capture", file);
+        std::fclose(file);
+    }
+
+    CommandReplayer replayer;
+    CHECK(!replayer.load(CAPTURE_PATH));
+    CHECK(!replayer.load("missing.capture"));
+    std::remove(CAPTURE_PATH);
+}
\ No newline at end of file
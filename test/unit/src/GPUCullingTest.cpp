@@ -0,0 +1,154 @@
+#include <map>
+#include <vector>
+
+#include <engine/renderer/GPUCulling.h>
+#include <engine/opengl/device/NullRenderDevice.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "UnitTest.h"
+
+// Keeps the storage bindings, the dispatches and the arguments of the indirect draws
+class CullingDevice : public NullRenderDevice {
+public:
+    struct IndirectDraw {
+        size_t offset;
+        GLuint parameterBuffer;
+        GLintptr drawCount;
+        GLsizei maxDrawCount;
+        bool count;
+    };
+
+    bool indirectCount = true;
+    std::map<GLuint, GLuint> storageBindings;
+    std::vector<size_t> dispatches;
+    std::vector<IndirectDraw> draws;
+    GLuint parameterBuffer = 0;
+
+    bool isSupported(Feature feature) override {
+        return feature == INDIRECT_COUNT ? indirectCount : NullRenderDevice::isSupported(feature);
+    }
+
+    void bindBuffer(GLenum target, GLuint buffer) override {
+        if(target == GL_PARAMETER_BUFFER) parameterBuffer = buffer;
+        NullRenderDevice::bindBuffer(target, buffer);
+    }
+
+    void bindBufferBase(GLenum target, GLuint index, GLuint buffer) override {
+        if(target == GL_SHADER_STORAGE_BUFFER) storageBindings[index] = buffer;
+        NullRenderDevice::bindBufferBase(target, index, buffer);
+    }
+
+    void dispatchCompute(GLuint numGroupsX, GLuint numGroupsY, GLuint numGroupsZ) override {
+        dispatches.push_back((size_t)numGroupsX * numGroupsY * numGroupsZ);
+        NullRenderDevice::dispatchCompute(numGroupsX, numGroupsY, numGroupsZ);
+    }
+
+    void multiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride) override {
+        draws.push_back({ (size_t)indirect, 0, 0, drawCount, false });
+        NullRenderDevice::multiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+    }
+
+    void multiDrawElementsIndirectCount(GLenum mode, GLenum type, const void* indirect, GLintptr drawCount, GLsizei maxDrawCount, GLsizei stride) override {
+        draws.push_back({ (size_t)indirect, parameterBuffer, drawCount, maxDrawCount, true });
+        NullRenderDevice::multiDrawElementsIndirectCount(mode, type, indirect, drawCount, maxDrawCount, stride);
+    }
+};
+
+static std::vector<GPUCulling::Draw> makeDraws(unsigned int count, unsigned int firstInstance) {
+    std::vector<GPUCulling::Draw> draws(count);
+    for(unsigned int i = 0; i < count; i ++) {
+        draws[i].boundsMin = glm::vec4(-1.f, -1.f, -1.f, 0.f);
+        draws[i].boundsMax = glm::vec4(1.f, 1.f, 1.f, 0.f);
+        draws[i].command = { 36, 1, i * 36, 0, firstInstance + i };
+    }
+    return draws;
+}
+
+static glm::mat4 viewProjection() {
+    return glm::perspective(glm::radians(60.f), 1.f, 0.1f, 100.f) * glm::lookAt(glm::vec3(0.f, 0.f, 5.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+}
+
+TEST(GPUCulling, DispatchPerBatch) {
+    std::shared_ptr<CullingDevice> device = std::make_shared<CullingDevice>();
+    RenderDevice::set(device);
+    GPUCulling culling;
+    REQUIRE(culling.isCompaction());
+
+    const GLuint modelBuffer = 1000, indirectBuffer = 1001;
+    culling.beginFrame(viewProjection());
+
+    // A group of the shader per 64 draws
+    std::vector<GPUCulling::Draw> first = makeDraws(100, 0);
+    culling.cull(first, modelBuffer, indirectBuffer, 0, false);
+    REQUIRE(device->dispatches.size() == 1);
+    CHECK_EQUAL(device->dispatches[0], (size_t)2);
+
+    // The draws, the models, the commands written and their count
+    CHECK_EQUAL(device->storageBindings[1], modelBuffer);
+    CHECK_EQUAL(device->storageBindings[2], indirectBuffer);
+    GLuint drawBuffer = device->storageBindings[0], countBuffer = device->storageBindings[3];
+    CHECK(drawBuffer != 0 && countBuffer != 0 && drawBuffer != countBuffer);
+
+    // The draws went to the storage buffer as they are
+    device->bindBuffer(GL_SHADER_STORAGE_BUFFER, drawBuffer);
+    const GPUCulling::Draw* uploaded = (const GPUCulling::Draw*)device->mapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, first.size() * sizeof(GPUCulling::Draw), GL_MAP_READ_BIT);
+    REQUIRE(uploaded != nullptr);
+    CHECK_EQUAL(uploaded[99].command.firstIndex, 99u * 36u);
+    CHECK_EQUAL(uploaded[99].command.baseInstance, 99u);
+    device->unmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    device->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    culling.drawVisible(GL_TRIANGLES, first.size(), 0, false);
+
+    std::vector<GPUCulling::Draw> second = makeDraws(10, 100);
+    culling.cull(second, modelBuffer, indirectBuffer, 100, false);
+    culling.drawVisible(GL_TRIANGLES, second.size(), 100, false);
+    REQUIRE(device->dispatches.size() == 2);
+    CHECK_EQUAL(device->dispatches[1], (size_t)1);
+
+    // Compacted, every batch reads its own count
+    REQUIRE(device->draws.size() == 2);
+    CHECK(device->draws[0].count);
+    CHECK_EQUAL(device->draws[0].parameterBuffer, countBuffer);
+    CHECK_EQUAL(device->draws[0].drawCount, (GLintptr)0);
+    CHECK_EQUAL(device->draws[0].maxDrawCount, 100);
+    CHECK_EQUAL(device->draws[1].offset, 100 * sizeof(GeometryArena::DrawElementsIndirectCommand));
+    CHECK_EQUAL(device->draws[1].drawCount, (GLintptr)sizeof(unsigned int));
+    CHECK_EQUAL(device->draws[1].maxDrawCount, 10);
+    CHECK_EQUAL(device->parameterBuffer, 0u);
+
+    CHECK_EQUAL(culling.getSubmittedDraws(), 110u);
+
+    // An empty batch isn't dispatched nor drawn
+    culling.cull({}, modelBuffer, indirectBuffer, 110, false);
+    culling.drawVisible(GL_TRIANGLES, 0, 110, false);
+    CHECK_EQUAL(device->dispatches.size(), (size_t)2);
+    CHECK_EQUAL(device->draws.size(), (size_t)2);
+}
+
+TEST(GPUCulling, OrderedAndWithoutIndirectCount) {
+    std::shared_ptr<CullingDevice> device = std::make_shared<CullingDevice>();
+    RenderDevice::set(device);
+    GPUCulling culling;
+    culling.beginFrame(viewProjection());
+
+    // Blended batches keep their order, all the commands are drawn
+    std::vector<GPUCulling::Draw> draws = makeDraws(5, 0);
+    culling.cull(draws, 1000, 1001, 0, true);
+    culling.drawVisible(GL_TRIANGLES, draws.size(), 0, true);
+    REQUIRE(device->draws.size() == 1);
+    CHECK(!device->draws[0].count);
+    CHECK_EQUAL(device->draws[0].maxDrawCount, 5);
+
+    // Same without the extension
+    device->indirectCount = false;
+    GPUCulling fallback;
+    CHECK(!fallback.isCompaction());
+    fallback.beginFrame(viewProjection());
+    fallback.cull(draws, 1000, 1001, 0, false);
+    fallback.drawVisible(GL_TRIANGLES, draws.size(), 0, false);
+    REQUIRE(device->draws.size() == 2);
+    CHECK(!device->draws[1].count);
+    CHECK_EQUAL(device->dispatches.size(), (size_t)2);
+}
\ No newline at end of file
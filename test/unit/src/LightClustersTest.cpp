@@ -0,0 +1,125 @@
+#include <engine/lighting/LightClusters.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "UnitTest.h"
+
+static glm::mat4 projection() {
+    return glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 100.f);
+}
+
+static bool hasLight(const LightClusters& clusters, unsigned int x, unsigned int y, unsigned int z, unsigned int light) {
+    const glm::uvec2& cluster = clusters.getCluster(x, y, z);
+    for(unsigned int i = cluster.x; i < cluster.x + cluster.y; i ++) {
+        if(clusters.getIndices()[i] == light) return true;
+    }
+    return false;
+}
+
+// Froxels which have the light, and their tile and slice bounds
+static unsigned int froxels(const LightClusters& clusters, unsigned int light, glm::ivec3& min, glm::ivec3& max) {
+    unsigned int count = 0;
+    min = glm::ivec3(CLUSTERS_X, CLUSTERS_Y, CLUSTERS_Z);
+    max = glm::ivec3(-1);
+    for(int z = 0; z < CLUSTERS_Z; z ++) {
+        for(int y = 0; y < CLUSTERS_Y; y ++) {
+            for(int x = 0; x < CLUSTERS_X; x ++) {
+                if(!hasLight(clusters, x, y, z, light)) continue;
+                min = glm::min(min, glm::ivec3(x, y, z));
+                max = glm::max(max, glm::ivec3(x, y, z));
+                count ++;
+            }
+        }
+    }
+    return count;
+}
+
+TEST(LightClusters, FirstAndUnattenuatedLightsAreGlobal) {
+    Light sun(glm::vec3(0.f, 10.f, 0.f));
+    PointLight point(glm::vec3(0.f, 0.f, -10.f), glm::vec3(1.f), 1.f, 0.7f, 1.8f);
+    PointLight infinite(glm::vec3(0.f, 0.f, -10.f), glm::vec3(1.f), 1.f, 0.f, 0.f);
+
+    LightClusters clusters;
+    clusters.build({ &sun, &point, &infinite }, projection(), glm::mat4(1.f), false);
+
+    CHECK(clusters.isClustered());
+    CHECK_EQUAL(clusters.getLightCount(), 3u);
+    CHECK_EQUAL(clusters.getGlobalLights(), 2u);
+    REQUIRE(clusters.getLocalLights().size() == 1);
+    CHECK(clusters.getLocalLights()[0].w > 0.f);
+
+    // The point light is the only one in the lists, after the global ones
+    for(unsigned int index : clusters.getIndices()) CHECK_EQUAL(index, 2u);
+    CHECK(clusters.getIndexCount() > 0);
+}
+
+TEST(LightClusters, LightInTheCenterOfTheView) {
+    Light sun(glm::vec3(0.f, 10.f, 0.f));
+    PointLight point(glm::vec3(0.f, 0.f, -10.f), glm::vec3(0.2f), 1.f, 0.7f, 1.8f);
+    float radius = point.getRadius(0.2f);
+    REQUIRE(radius > 1.f && radius < 3.f);
+
+    LightClusters clusters;
+    clusters.build({ &sun, &point }, projection(), glm::mat4(1.f), false);
+
+    glm::ivec3 min, max;
+    unsigned int count = froxels(clusters, 1, min, max);
+    CHECK(count > 0);
+    CHECK_EQUAL(clusters.getIndexCount(), (size_t)count);
+
+    // Around the central tiles, in the slices of its depth range only
+    CHECK(min.x <= CLUSTERS_X / 2 - 1 && max.x >= CLUSTERS_X / 2);
+    CHECK(min.y <= CLUSTERS_Y / 2 && max.y >= CLUSTERS_Y / 2);
+    CHECK(min.x > 0 && max.x < CLUSTERS_X - 1);
+    CHECK(min.z > 0 && max.z < CLUSTERS_Z - 1);
+    CHECK(hasLight(clusters, CLUSTERS_X / 2, CLUSTERS_Y / 2, (min.z + max.z) / 2, 1));
+
+    // The offsets of the froxels follow each other
+    unsigned int offset = 0;
+    for(int z = 0; z < CLUSTERS_Z; z ++) {
+        for(int y = 0; y < CLUSTERS_Y; y ++) {
+            for(int x = 0; x < CLUSTERS_X; x ++) {
+                CHECK_EQUAL(clusters.getCluster(x, y, z).x, offset);
+                offset += clusters.getCluster(x, y, z).y;
+            }
+        }
+    }
+}
+
+TEST(LightClusters, ViewMovesTheLight) {
+    Light sun(glm::vec3(0.f, 10.f, 0.f));
+    PointLight point(glm::vec3(0.f, 0.f, -10.f), glm::vec3(0.2f), 1.f, 0.7f, 1.8f);
+    LightClusters clusters;
+
+    // To the right of the view, and behind the camera
+    glm::mat4 right = glm::lookAt(glm::vec3(0.f), glm::vec3(-1.f, 0.f, -2.f), glm::vec3(0.f, 1.f, 0.f));
+    clusters.build({ &sun, &point }, projection(), right, false);
+    glm::ivec3 min, max;
+    CHECK(froxels(clusters, 1, min, max) > 0);
+    CHECK(min.x >= CLUSTERS_X / 2);
+
+    glm::mat4 behind = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec3(0.f, 1.f, 0.f));
+    clusters.build({ &sun, &point }, projection(), behind, false);
+    CHECK_EQUAL(clusters.getIndexCount(), (size_t)0);
+    CHECK_EQUAL(clusters.getLightCount(), 2u);
+}
+
+TEST(LightClusters, OrthographicAndNoClustering) {
+    Light sun(glm::vec3(0.f, 10.f, 0.f));
+    PointLight point(glm::vec3(0.f, 0.f, -10.f), glm::vec3(1.f), 1.f, 0.7f, 1.8f);
+    LightClusters clusters;
+
+    // Every light is global
+    clusters.build({ &sun, &point }, glm::ortho(-10.f, 10.f, -10.f, 10.f, 0.1f, 100.f), glm::mat4(1.f), false);
+    CHECK(!clusters.isClustered());
+    CHECK_EQUAL(clusters.getGlobalLights(), 2u);
+    CHECK_EQUAL(clusters.getIndexCount(), (size_t)0);
+
+    // The spheres are kept for the objects
+    clusters.setClustering(false);
+    clusters.build({ &sun, &point }, projection(), glm::mat4(1.f), false);
+    CHECK(!clusters.isClustered());
+    CHECK_EQUAL(clusters.getGlobalLights(), 1u);
+    CHECK_EQUAL(clusters.getLocalLights().size(), (size_t)1);
+    CHECK_EQUAL(clusters.getIndexCount(), (size_t)0);
+}
\ No newline at end of file
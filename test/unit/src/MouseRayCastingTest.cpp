@@ -0,0 +1,102 @@
+#include <vector>
+
+#include <engine/renderer/MouseRayCasting.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "UnitTest.h"
+
+// Square of side 2 on the plane z, as two triangles
+static std::vector<Vec3f> square(float z) {
+    return {
+        Vec3f(-1.f, -1.f, z), Vec3f(1.f, -1.f, z), Vec3f(1.f, 1.f, z),
+        Vec3f(-1.f, -1.f, z), Vec3f(1.f, 1.f, z), Vec3f(-1.f, 1.f, z)
+    };
+}
+
+TEST(MouseRayCasting, IntersectTriangle) {
+    glm::vec3 p0(-1.f, -1.f, 0.f), p1(1.f, -1.f, 0.f), p2(0.f, 1.f, 0.f);
+    float distance = -1.f;
+
+    MouseRayCasting::Ray ray(glm::vec3(0.f, 0.f, 5.f), glm::vec3(0.f, 0.f, -1.f));
+    CHECK(MouseRayCasting::intersectTriangle(ray, p0, p1, p2, distance));
+    CHECK_NEAR(distance, 5.f, 1e-5f);
+
+    // The lambda of the hit, the direction isn't normalized
+    MouseRayCasting::Ray longRay(glm::vec3(0.f, 0.f, 5.f), glm::vec3(0.f, 0.f, -2.f));
+    CHECK(MouseRayCasting::intersectTriangle(longRay, p0, p1, p2, distance));
+    CHECK_NEAR(distance, 2.5f, 1e-5f);
+
+    // Both faces are hit
+    MouseRayCasting::Ray below(glm::vec3(0.f, 0.f, -5.f), glm::vec3(0.f, 0.f, 1.f));
+    CHECK(MouseRayCasting::intersectTriangle(below, p0, p1, p2, distance));
+    CHECK_NEAR(distance, 5.f, 1e-5f);
+
+    // On an edge
+    MouseRayCasting::Ray edge(glm::vec3(0.f, -1.f, 5.f), glm::vec3(0.f, 0.f, -1.f));
+    CHECK(MouseRayCasting::intersectTriangle(edge, p0, p1, p2, distance));
+
+    // Beside the triangle, behind the origin and parallel to it, distance isn't touched
+    distance = -1.f;
+    MouseRayCasting::Ray beside(glm::vec3(0.9f, 0.9f, 5.f), glm::vec3(0.f, 0.f, -1.f));
+    MouseRayCasting::Ray away(glm::vec3(0.f, 0.f, 5.f), glm::vec3(0.f, 0.f, 1.f));
+    MouseRayCasting::Ray parallel(glm::vec3(-5.f, 0.f, 0.f), glm::vec3(1.f, 0.f, 0.f));
+    CHECK(!MouseRayCasting::intersectTriangle(beside, p0, p1, p2, distance));
+    CHECK(!MouseRayCasting::intersectTriangle(away, p0, p1, p2, distance));
+    CHECK(!MouseRayCasting::intersectTriangle(parallel, p0, p1, p2, distance));
+    CHECK_EQUAL(distance, -1.f);
+}
+
+TEST(MouseRayCasting, Intersect) {
+    MouseRayCasting::Ray ray(glm::vec3(0.5f, 0.f, 10.f), glm::vec3(0.f, 0.f, -1.f));
+    float distance = -1.f;
+
+    // The closest of two squares, in any order
+    std::vector<Vec3f> vertices = square(-2.f), front = square(3.f);
+    vertices.insert(vertices.end(), front.begin(), front.end());
+    CHECK(MouseRayCasting::intersect(ray, vertices, {}, glm::mat4(1.f), distance));
+    CHECK_NEAR(distance, 7.f, 1e-5f);
+
+    // Indexed, the vertices of the front square are shared
+    std::vector<Vec3f> shared = { Vec3f(-1.f, -1.f, 3.f), Vec3f(1.f, -1.f, 3.f), Vec3f(1.f, 1.f, 3.f), Vec3f(-1.f, 1.f, 3.f) };
+    CHECK(MouseRayCasting::intersect(ray, shared, { 0, 1, 2, 0, 2, 3 }, glm::mat4(1.f), distance));
+    CHECK_NEAR(distance, 7.f, 1e-5f);
+
+    // Only the triangle the indices give
+    CHECK(!MouseRayCasting::intersect(ray, shared, { 0, 2, 3 }, glm::mat4(1.f), distance));
+
+    // Moved and scaled by the model, the distance stays in world space
+    glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, -5.f)), glm::vec3(2.f));
+    CHECK(MouseRayCasting::intersect(ray, square(0.f), {}, model, distance));
+    CHECK_NEAR(distance, 15.f, 1e-4f);
+
+    // Out of the way
+    glm::mat4 aside = glm::translate(glm::mat4(1.f), glm::vec3(5.f, 0.f, 0.f));
+    CHECK(!MouseRayCasting::intersect(ray, square(0.f), {}, aside, distance));
+    CHECK(!MouseRayCasting::intersect(ray, {}, {}, glm::mat4(1.f), distance));
+}
+
+TEST(MouseRayCasting, GetRay) {
+    glm::vec3 eye(0.f, 0.f, 5.f);
+    glm::mat4 projection = glm::perspective(glm::radians(60.f), 4.f / 3.f, 0.1f, 100.f);
+    glm::mat4 view = glm::lookAt(eye, glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+    glm::mat4 inverseProjection = glm::inverse(projection), inverseView = glm::inverse(view);
+
+    // The center of the screen looks at the target, from the eye
+    MouseRayCasting::Ray center = MouseRayCasting::getRay(inverseProjection, inverseView, eye, 640, 480, 320, 240);
+    CHECK(center.origin == eye);
+    CHECK_NEAR(center.rayDirection.x, 0.f, 1e-5f);
+    CHECK_NEAR(center.rayDirection.y, 0.f, 1e-5f);
+    CHECK_NEAR(center.rayDirection.z, -1.f, 1e-5f);
+
+    // A corner is at half the field of view vertically, the direction is normalized
+    MouseRayCasting::Ray corner = MouseRayCasting::getRay(inverseProjection, inverseView, eye, 640, 480, 640, 480);
+    CHECK_NEAR(glm::length(corner.rayDirection), 1.f, 1e-5f);
+    CHECK_NEAR(corner.rayDirection.y / -corner.rayDirection.z, std::tan(glm::radians(30.f)), 1e-4f);
+    CHECK_NEAR(corner.rayDirection.x / corner.rayDirection.y, 4.f / 3.f, 1e-4f);
+
+    // Picks the square in front of the camera
+    float distance;
+    CHECK(MouseRayCasting::intersect(center, square(0.f), {}, glm::mat4(1.f), distance));
+    CHECK_NEAR(distance, 5.f, 1e-4f);
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include <vector>
+
+#include <engine/lighting/ObjectLights.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "UnitTest.h"
+
+static const glm::vec3 boxMin(-0.5f), boxMax(0.5f);
+
+static std::vector<int> query(ObjectLights& lights, const glm::mat4& model, const glm::vec3& boundsMin = boxMin, const glm::vec3& boundsMax = boxMax) {
+    int indices[OBJECT_MAX_LIGHTS];
+    unsigned int count = lights.query(model, boundsMin, boundsMax, indices);
+    return std::vector<int>(indices, indices + count);
+}
+
+TEST(ObjectLights, TouchOrMiss) {
+    ObjectLights lights;
+    lights.build({
+        glm::vec4(1.4f, 0.f, 0.f, 1.f),     // overlaps the box
+        glm::vec4(1.6f, 0.f, 0.f, 1.f),     // 0.1 short
+        glm::vec4(0.f, -1.5f, 0.f, 1.f),    // touches a face
+        glm::vec4(1.25f, 1.25f, 0.f, 1.f),  // 1.06 from the corner
+        glm::vec4(0.f, 0.f, 0.f, 0.1f)      // inside
+    }, 3);
+    CHECK_EQUAL(lights.getLightCount(), 5u);
+
+    CHECK(query(lights, glm::mat4(1.f)) == std::vector<int>({ 3, 5, 7 }));
+
+    // Far away, nothing
+    CHECK(query(lights, glm::translate(glm::mat4(1.f), glm::vec3(50.f, 0.f, 0.f))).empty());
+
+    CHECK_EQUAL(lights.getQueries(), 2u);
+    CHECK_EQUAL(lights.getAssigned(), 3u);
+
+    // Built again, the stats start over
+    lights.build({}, 0);
+    CHECK(query(lights, glm::mat4(1.f)).empty());
+    CHECK_EQUAL(lights.getQueries(), 1u);
+    CHECK_EQUAL(lights.getAssigned(), 0u);
+}
+
+TEST(ObjectLights, ClosestEight) {
+    // Every light reaches the box, at distance / radius out of order
+    std::vector<float> distances = { 5.f, 0.5f, 9.f, 1.f, 7.f, 2.f, 8.f, 3.f, 6.f, 4.f, 9.5f, 0.f };
+    std::vector<glm::vec4> spheres;
+    for(float distance : distances) spheres.push_back(glm::vec4(0.5f + distance, 0.f, 0.f, 10.f));
+
+    // Further but bigger, 15 / 40 is closer than 4 / 10
+    spheres.push_back(glm::vec4(15.5f, 0.f, 0.f, 40.f));
+
+    ObjectLights lights;
+    lights.build(spheres, 2);
+
+    // The 8 closest relative to their radius, sorted by index
+    CHECK(query(lights, glm::mat4(1.f)) == std::vector<int>({ 2, 3, 5, 7, 9, 11, 13, 14 }));
+    CHECK_EQUAL(lights.getAssigned(), (unsigned int)OBJECT_MAX_LIGHTS);
+}
+
+TEST(ObjectLights, LargeLight) {
+    // Small lights set cells of 10, the big one spans more than OBJECT_LIGHTS_MAX_CELLS of them
+    std::vector<glm::vec4> spheres;
+    for(int i = 0; i < 10; i ++) spheres.push_back(glm::vec4(i * 2.f, 0.f, 0.f, 0.5f));
+    spheres.push_back(glm::vec4(0.f, 0.f, 0.f, 50.f));
+    ObjectLights lights;
+    lights.build(spheres, 0);
+
+    // Away from the small lights, in the sphere of the big one
+    CHECK(query(lights, glm::translate(glm::mat4(1.f), glm::vec3(0.f, 30.f, 0.f))) == std::vector<int>({ 10 }));
+    CHECK(query(lights, glm::translate(glm::mat4(1.f), glm::vec3(4.f, 0.f, 0.f))) == std::vector<int>({ 2, 10 }));
+    CHECK(query(lights, glm::translate(glm::mat4(1.f), glm::vec3(0.f, 60.f, 0.f))).empty());
+}
+
+TEST(ObjectLights, LargeBox) {
+    // Cells of 1, a box of 21 on each side spans more than OBJECT_LIGHTS_MAX_CELLS and tests every light
+    ObjectLights lights;
+    lights.build({
+        glm::vec4(0.f, 0.f, 0.f, 0.5f),
+        glm::vec4(9.f, -9.f, 9.f, 0.5f),
+        glm::vec4(20.f, 0.f, 0.f, 0.5f),
+        glm::vec4(-10.4f, 0.f, 0.f, 0.5f)
+    }, 1);
+
+    glm::mat4 big = glm::scale(glm::mat4(1.f), glm::vec3(20.f));
+    CHECK(query(lights, big) == std::vector<int>({ 1, 2, 4 }));
+    CHECK(query(lights, big, glm::vec3(0.f), glm::vec3(0.5f)) == std::vector<int>({ 1 }));
+}
+
+TEST(ObjectLights, ScaledAndRotated) {
+    ObjectLights lights;
+    lights.build({
+        glm::vec4(2.7f, 0.f, 0.f, 1.f),
+        glm::vec4(0.f, 2.7f, 0.f, 1.f)
+    }, 0);
+
+    CHECK(query(lights, glm::mat4(1.f)).empty());
+
+    // 4 long along x, it reaches the first light
+    glm::mat4 scaled = glm::scale(glm::mat4(1.f), glm::vec3(4.f, 1.f, 1.f));
+    CHECK(query(lights, scaled) == std::vector<int>({ 0 }));
+
+    // Turned to y, the second one
+    glm::mat4 rotated = glm::rotate(glm::mat4(1.f), glm::radians(90.f), glm::vec3(0.f, 0.f, 1.f)) * scaled;
+    CHECK(query(lights, rotated) == std::vector<int>({ 1 }));
+
+    // At 45 degrees the box around it is 3.54 wide, it reaches both
+    glm::mat4 diagonal = glm::rotate(glm::mat4(1.f), glm::radians(45.f), glm::vec3(0.f, 0.f, 1.f)) * scaled;
+    CHECK(query(lights, diagonal) == std::vector<int>({ 0, 1 }));
+
+    // Moved with the translation of the model
+    glm::mat4 moved = glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, 3.f)) * scaled;
+    CHECK(query(lights, moved).empty());
+}
\ No newline at end of file
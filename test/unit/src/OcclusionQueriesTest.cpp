@@ -0,0 +1,104 @@
+#include <engine/renderer/OcclusionQueries.h>
+#include <engine/opengl/device/NullRenderDevice.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "UnitTest.h"
+
+// Results the test gives to the queries
+class QueryDevice : public NullRenderDevice {
+public:
+    bool available = true;
+    GLint samples = 0;
+
+    void getQueryObjectiv(GLuint, GLenum pname, GLint* params) override {
+        *params = pname == GL_QUERY_RESULT_AVAILABLE ? (available ? 1 : 0) : samples;
+    }
+};
+
+static glm::mat4 viewProjection() {
+    return glm::perspective(glm::radians(60.f), 1.f, 0.1f, 100.f) * glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+}
+
+TEST(OcclusionQueries, HiddenUntilAResultSaysVisible) {
+    std::shared_ptr<QueryDevice> device = std::make_shared<QueryDevice>();
+    RenderDevice::set(device);
+    OcclusionQueries queries;
+    int node;
+
+    // New nodes are visible and queried with their draws
+    queries.beginFrame(viewProjection());
+    CHECK(!queries.isHidden(&node));
+    CHECK(queries.beginQuery(&node));
+    queries.endQuery();
+    CHECK_EQUAL(queries.getQueries(), 1u);
+
+    // Not available: the state is kept and no other query is made while it's in flight
+    device->available = false;
+    queries.beginFrame(viewProjection());
+    CHECK(!queries.isHidden(&node));
+    CHECK(!queries.beginQuery(&node));
+    CHECK_EQUAL(queries.getQueries(), 0u);
+
+    // No sample passed
+    device->available = true;
+    queries.beginFrame(viewProjection());
+    CHECK(queries.isHidden(&node));
+    CHECK(!queries.isRevealed(&node));
+    CHECK_EQUAL(queries.getOccludedNodes(), 1u);
+
+    // Its box is queried, the draws wait for it on the GPU
+    CHECK(queries.beginConditionalRender(&node, glm::vec3(-1.f, -1.f, -12.f), glm::vec3(1.f, 1.f, -10.f)));
+    queries.endConditionalRender();
+    CHECK_EQUAL(queries.getConditionalNodes(), 1u);
+
+    device->samples = 8;
+    queries.beginFrame(viewProjection());
+    CHECK(!queries.isHidden(&node));
+    CHECK(queries.isRevealed(&node));
+    CHECK(!queries.isRevealed(&node));
+    CHECK_EQUAL(queries.getOccludedNodes(), 0u);
+}
+
+TEST(OcclusionQueries, BoxCutByTheNearPlaneIsVisible) {
+    std::shared_ptr<QueryDevice> device = std::make_shared<QueryDevice>();
+    RenderDevice::set(device);
+    OcclusionQueries queries;
+    int node;
+
+    queries.beginFrame(viewProjection());
+    queries.setVisible(&node, false);
+    CHECK(queries.isHidden(&node));
+
+    // The camera is inside, the box would be clipped
+    CHECK(!queries.beginConditionalRender(&node, glm::vec3(-1.f), glm::vec3(1.f)));
+    CHECK(!queries.isHidden(&node));
+    CHECK(queries.isRevealed(&node));
+    CHECK_EQUAL(queries.getQueries(), 0u);
+    CHECK_EQUAL(queries.getConditionalNodes(), 0u);
+}
+
+TEST(OcclusionQueries, InnerNodesAndLifetime) {
+    RenderDevice::set(std::make_shared<QueryDevice>());
+    OcclusionQueries queries;
+    int group, polytope;
+
+    queries.beginFrame(viewProjection());
+    queries.setVisible(&group, false);
+    CHECK(queries.isHidden(&group));
+    queries.setVisible(&group, true);
+    CHECK(!queries.isHidden(&group));
+    queries.beginQuery(&polytope);
+    queries.endQuery();
+    CHECK_EQUAL(queries.getNodeCount(), 2u);
+
+    // The polytope stays in the traversal, the group leaves it
+    for(int i = 0; i < OCCLUSION_NODE_LIFETIME; i ++) {
+        queries.beginFrame(viewProjection());
+        queries.isHidden(&polytope);
+    }
+    CHECK_EQUAL(queries.getNodeCount(), 2u);
+
+    queries.beginFrame(viewProjection());
+    CHECK_EQUAL(queries.getNodeCount(), 1u);
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include <vector>
+
+#include <engine/lighting/PointShadows.h>
+#include <engine/opengl/device/NullRenderDevice.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "UnitTest.h"
+
+// The camera at the origin looks down -z, the lights 10 in front of it are inside their range
+static const glm::mat4 projection = glm::perspective(glm::radians(60.f), 1.f, 0.1f, 100.f);
+static const glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+
+static PointLight::Ptr createLight(const glm::vec3& position, float priority) {
+    PointLight::Ptr light = PointLight::New(position, glm::vec3(1.f));
+    light->setShadowCaster(true);
+    light->setShadowPriority(priority);
+    return light;
+}
+
+static void update(PointShadows& shadows, const std::vector<PointLight::Ptr>& pointLights, const Light* excluded = nullptr) {
+    std::vector<Light*> lights;
+    for(auto& light : pointLights) lights.push_back(light.get());
+    shadows.update(lights, projection, view, glm::vec3(0.f), false, excluded);
+}
+
+TEST(PointShadows, BudgetAndPriority) {
+    PointShadows shadows(2);
+
+    std::vector<PointLight::Ptr> lights = {
+        createLight(glm::vec3(-3.f, 0.f, -10.f), 1.f),
+        createLight(glm::vec3(-1.f, 0.f, -10.f), 3.f),
+        createLight(glm::vec3(1.f, 0.f, -10.f), 2.f),
+        createLight(glm::vec3(3.f, 0.f, -10.f), 4.f),
+        createLight(glm::vec3(0.f, 0.f, -10.f), 10.f),  // no shadows
+        createLight(glm::vec3(0.f, 0.f, 200.f), 10.f),  // behind the camera, out of its range
+        createLight(glm::vec3(0.f, 2.f, -10.f), 10.f)   // the light of the cascades
+    };
+    lights[4]->setShadowCaster(false);
+
+    // The best two, in free slots in the order of their scores
+    update(shadows, lights, lights[6].get());
+    CHECK_EQUAL(shadows.getSlot(lights[3].get()), 0);
+    CHECK_EQUAL(shadows.getSlot(lights[1].get()), 1);
+    for(int i : { 0, 2, 4, 5, 6 }) CHECK_EQUAL(shadows.getSlot(lights[i].get()), -1);
+
+    const PointShadows::Slot& slot = shadows.getSlotData(0);
+    CHECK(slot.position == lights[3]->getPosition());
+    CHECK_NEAR(slot.farPlane, lights[3]->getRadius(1.f), 1e-4f);
+    CHECK(slot.faceMatrices[0] == PointShadows::computeFaceMatrix(0, slot.position, slot.farPlane, shadows.getFaceScale()));
+
+    // The score also depends on the size of the light sphere on screen, far away a higher priority isn't enough
+    lights[0]->setPosition(glm::vec3(0.f, 0.f, -60.f));
+    lights[0]->setShadowPriority(5.f);
+    update(shadows, lights, lights[6].get());
+    CHECK_EQUAL(shadows.getSlot(lights[1].get()), 1);
+    CHECK_EQUAL(shadows.getSlot(lights[0].get()), -1);
+
+    lights[0]->setPosition(glm::vec3(0.f, 0.f, -10.f));
+    update(shadows, lights, lights[6].get());
+    CHECK_EQUAL(shadows.getSlot(lights[3].get()), 0);
+    CHECK_EQUAL(shadows.getSlot(lights[0].get()), 1);
+    CHECK_EQUAL(shadows.getSlot(lights[1].get()), -1);
+
+    // A priority of 0 is no shadows either
+    lights[3]->setShadowPriority(0.f);
+    update(shadows, lights, lights[6].get());
+    CHECK_EQUAL(shadows.getSlot(lights[3].get()), -1);
+    CHECK_EQUAL(shadows.getSlot(lights[0].get()), 1);
+    CHECK_EQUAL(shadows.getSlot(lights[1].get()), 0);
+}
+
+TEST(PointShadows, HysteresisAndSlotReuse) {
+    PointShadows shadows(2);
+
+    std::vector<PointLight::Ptr> lights = {
+        createLight(glm::vec3(-2.f, 0.f, -10.f), 1.f),
+        createLight(glm::vec3(0.f, 0.f, -10.f), 1.5f),
+        createLight(glm::vec3(2.f, 0.f, -10.f), 0.5f)
+    };
+    update(shadows, lights);
+    CHECK_EQUAL(shadows.getSlot(lights[1].get()), 0);
+    CHECK_EQUAL(shadows.getSlot(lights[0].get()), 1);
+
+    // A bit better than a light with shadows isn't enough to take its slot
+    lights[2]->setShadowPriority(1.05f);
+    update(shadows, lights);
+    CHECK_EQUAL(shadows.getSlot(lights[0].get()), 1);
+    CHECK_EQUAL(shadows.getSlot(lights[2].get()), -1);
+
+    // Past the hysteresis it takes the slot left free, the other light keeps its own
+    lights[2]->setShadowPriority(1.2f);
+    update(shadows, lights);
+    CHECK_EQUAL(shadows.getSlot(lights[1].get()), 0);
+    CHECK_EQUAL(shadows.getSlot(lights[2].get()), 1);
+    CHECK_EQUAL(shadows.getSlot(lights[0].get()), -1);
+    CHECK(shadows.getSlotData(1).position == lights[2]->getPosition());
+
+    // Without lights every slot is free
+    update(shadows, {});
+    CHECK(shadows.getSlotData(0).light == nullptr && shadows.getSlotData(1).light == nullptr);
+
+    // A budget of 1 keeps only the best one
+    shadows.setBudget(1);
+    update(shadows, lights);
+    CHECK_EQUAL(shadows.getSlot(lights[1].get()), 0);
+    CHECK_EQUAL(shadows.getSlot(lights[2].get()), -1);
+}
+
+TEST(PointShadows, FaceCaching) {
+    NullRenderDevice::Ptr device = NullRenderDevice::New();
+    RenderDevice::set(device);
+    PointShadows shadows(1, 64);
+
+    std::vector<PointLight::Ptr> lights = { createLight(glm::vec3(0.f, 0.f, -10.f), 1.f) };
+    update(shadows, lights);
+    REQUIRE(shadows.getSlot(lights[0].get()) == 0);
+
+    // Nothing rendered yet, every face
+    uint64_t signatures[6] = { 1, 2, 3, 4, 5, 6 };
+    CHECK_EQUAL(shadows.setCasters(0, signatures, 0), 0x3Fu);
+
+    // The face with a dynamic caster isn't cached, a layer cleared per face
+    shadows.bindFaces(0, 0x3F, 0x02);
+    CHECK_EQUAL(device->getCount(NullRenderDevice::CLEAR), (size_t)6);
+    CHECK_EQUAL(shadows.getSlotData(0).cachedFaces, 0x3Du);
+    CHECK_EQUAL(shadows.setCasters(0, signatures, 0x02), 0x02u);
+
+    // The faces where the static casters changed
+    signatures[4] = 50;
+    CHECK_EQUAL(shadows.setCasters(0, signatures, 0x02), 0x12u);
+    device->reset();
+    shadows.bindFaces(0, 0x12, 0x02);
+    CHECK_EQUAL(device->getCount(NullRenderDevice::CLEAR), (size_t)2);
+    CHECK_EQUAL(shadows.setCasters(0, signatures, 0), 0x02u);
+    shadows.bindFaces(0, 0x02, 0);
+    CHECK_EQUAL(shadows.setCasters(0, signatures, 0), 0u);
+
+    // The same light at the same place keeps its faces, moved it loses them
+    update(shadows, lights);
+    CHECK_EQUAL(shadows.setCasters(0, signatures, 0), 0u);
+    lights[0]->setPosition(glm::vec3(1.f, 0.f, -10.f));
+    update(shadows, lights);
+    CHECK_EQUAL(shadows.setCasters(0, signatures, 0), 0x3Fu);
+    shadows.bindFaces(0, 0x3F, 0);
+
+    // Without caching every face is rendered every frame
+    shadows.setCaching(false);
+    CHECK_EQUAL(shadows.setCasters(0, signatures, 0), 0x3Fu);
+    shadows.setCaching(true);
+    shadows.bindFaces(0, 0x3F, 0);
+    CHECK_EQUAL(shadows.setCasters(0, signatures, 0), 0u);
+
+    // A new light in the slot starts over
+    lights.push_back(createLight(glm::vec3(1.f, 0.f, -10.f), 5.f));
+    update(shadows, lights);
+    REQUIRE(shadows.getSlot(lights[1].get()) == 0);
+    CHECK_EQUAL(shadows.setCasters(0, signatures, 0), 0x3Fu);
+}
+
+TEST(PointShadows, CasterFaces) {
+    PointShadows shadows(1);
+    std::vector<PointLight::Ptr> lights = { createLight(glm::vec3(0.f, 0.f, -10.f), 1.f) };
+    update(shadows, lights);
+
+    glm::vec3 boundsMin(-0.5f), boundsMax(0.5f);
+    auto faces = [&](const glm::vec3& offset) {
+        return shadows.getCasterFaces(0, glm::translate(glm::mat4(1.f), lights[0]->getPosition() + offset), boundsMin, boundsMax);
+    };
+
+    // Along an axis, only its face
+    CHECK_EQUAL(faces(glm::vec3(5.f, 0.f, 0.f)), 0x01u);
+    CHECK_EQUAL(faces(glm::vec3(-5.f, 0.f, 0.f)), 0x02u);
+    CHECK_EQUAL(faces(glm::vec3(0.f, 0.f, -5.f)), 0x20u);
+
+    // On the edge between +X and +Y, both
+    CHECK_EQUAL(faces(glm::vec3(5.f, 5.f, 0.f)), 0x05u);
+
+    // Around the light, every face
+    CHECK_EQUAL(faces(glm::vec3(0.f)), 0x3Fu);
+
+    // Past the range of the light
+    CHECK_EQUAL(faces(glm::vec3(shadows.getSlotData(0).farPlane + 1.f, 0.f, 0.f)), 0u);
+}
\ No newline at end of file
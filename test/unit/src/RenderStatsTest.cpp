@@ -0,0 +1,58 @@
+#include <engine/renderer/RenderStats.h>
+
+#include "UnitTest.h"
+
+TEST(RenderStats, CountsOnlyWhenActive) {
+    RenderStats stats;
+    RenderStats::countDraw(GL_TRIANGLES, 3);
+    CHECK(RenderStats::getActive() == nullptr);
+
+    stats.beginFrame();
+    stats.setPass(RenderStats::SCENE);
+    RenderStats::countDraw(GL_TRIANGLES, 30, 2);
+    RenderStats::countDraw(GL_TRIANGLE_STRIP, 4);
+    stats.endFrame();
+
+    const RenderStats::Frame& frame = stats.getFrame();
+    CHECK_EQUAL(frame.total.drawCalls, 2u);
+    CHECK_EQUAL(frame.total.instances, 3u);
+    CHECK_EQUAL(frame.total.triangles, 22u);
+    CHECK_EQUAL(stats.getPassCounters(RenderStats::SCENE).drawCalls, 2u);
+    CHECK_EQUAL(stats.getPassCounters(RenderStats::SHADOW).drawCalls, 0u);
+}
+
+TEST(RenderStats, UploadsBetweenFramesGoToTheNextOne) {
+    RenderStats stats;
+
+    stats.beginFrame();
+    RenderStats::countUpload(100);
+    stats.endFrame();
+    CHECK_EQUAL(stats.getFrame().total.uploadedBytes, (size_t)100);
+
+    RenderStats::countUpload(20);
+    stats.beginFrame();
+    RenderStats::countUpload(3);
+    stats.endFrame();
+    CHECK_EQUAL(stats.getFrame().total.uploadedBytes, (size_t)23);
+    CHECK_EQUAL(stats.getPassCounters(RenderStats::OTHER).uploadedBytes, (size_t)23);
+}
+
+TEST(RenderStats, AverageIsNotTruncated) {
+    RenderStats stats(2);
+
+    for(unsigned int draws : { 5u, 1u, 2u }) {
+        stats.beginFrame();
+        for(unsigned int i = 0; i < draws; i ++) RenderStats::countDraw(GL_TRIANGLES, 3);
+        stats.endFrame();
+    }
+
+    // Only the last two frames are kept
+    CHECK_EQUAL(stats.getHistory().size(), (size_t)2);
+    RenderStats::AverageFrame average = stats.getAverage();
+    CHECK_NEAR(average.total.drawCalls, 1.5, 1e-9);
+    CHECK_NEAR(average.passes[RenderStats::OTHER].triangles, 1.5, 1e-9);
+    CHECK_NEAR(average.passes[RenderStats::SCENE].triangles, 0.0, 1e-9);
+
+    RenderStats empty;
+    CHECK_EQUAL(empty.getAverage().total.drawCalls, 0.0);
+}
\ No newline at end of file
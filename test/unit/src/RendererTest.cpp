@@ -0,0 +1,288 @@
+#include <vector>
+
+#include <engine/renderer/Renderer.h>
+#include <engine/renderer/TrackballCamera.h>
+#include <engine/lighting/PhongMaterial.h>
+#include <engine/opengl/device/NullRenderDevice.h>
+
+#include "UnitTest.h"
+
+#define CUBES 10
+
+// Every query is available and no sample passes
+class OccludedDevice : public NullRenderDevice {
+public:
+    void getQueryObjectiv(GLuint, GLenum pname, GLint* params) override {
+        *params = pname == GL_QUERY_RESULT_AVAILABLE ? 1 : 0;
+    }
+};
+
+static std::vector<Vec3f> cubeVertices() {
+    return {
+        Vec3f(-0.5, -0.5,  0.5), Vec3f( 0.5, -0.5,  0.5), Vec3f( 0.5,  0.5,  0.5), Vec3f(-0.5,  0.5,  0.5),
+        Vec3f(-0.5, -0.5, -0.5), Vec3f( 0.5, -0.5, -0.5), Vec3f( 0.5,  0.5, -0.5), Vec3f(-0.5,  0.5, -0.5)
+    };
+}
+
+static std::vector<unsigned int> cubeIndices() {
+    return {
+        0, 1, 2,  1, 5, 6,  7, 6, 5,
+        2, 3, 0,  6, 2, 1,  5, 4, 7,
+        4, 0, 3,  4, 5, 1,  3, 2, 6,
+        3, 7, 4,  1, 0, 4,  6, 7, 3
+    };
+}
+
+// A row of cubes with the same material below the camera, in one group
+static Group::Ptr addCubes(Renderer::Ptr& renderer) {
+    std::vector<Vec3f> vertices = cubeVertices();
+    std::vector<unsigned int> indices = cubeIndices();
+    Material::Ptr material = PhongMaterial::New(MATERIAL_DIFFUSE, MATERIAL_SPECULAR, MATERIAL_SHININESS);
+
+    Group::Ptr group = Group::New();
+    for(int i = 0; i < CUBES; i ++) {
+        Polytope::Ptr cube = Polytope::New(vertices, indices);
+        cube->setMaterial(material);
+        cube->translate(glm::vec3(i * 1.5f - CUBES * 0.75f, 0.f, 0.f));
+        group->add(cube);
+    }
+
+    Scene::Ptr scene = Scene::New();
+    scene->addGroup(group);
+    renderer->addScene(scene);
+
+    TrackballCamera::Ptr camera = TrackballCamera::perspectiveCamera(glm::radians(45.0f), 1.0, 0.1, 1000);
+    camera->zoom(-20.f);
+    renderer->setCamera(std::dynamic_pointer_cast<Camera>(camera));
+
+    return group;
+}
+
+TEST(Renderer, DrawPerPolytope) {
+    NullRenderDevice::Ptr device = NullRenderDevice::New();
+    RenderDevice::set(device);
+    Renderer::Ptr renderer = Renderer::New(640, 640);
+    addCubes(renderer);
+
+    renderer->render();
+    const RenderStats::Counters& scene = renderer->getStats()->getPassCounters(RenderStats::SCENE);
+    CHECK_EQUAL(scene.drawCalls, (unsigned int)CUBES);
+    CHECK_EQUAL(scene.triangles, (unsigned int)CUBES * 12);
+    CHECK_EQUAL(renderer->getStats()->getFrame().total.culledObjects, 0u);
+
+    // Without shadows nothing else draws the polytopes
+    CHECK_EQUAL(renderer->getStats()->getPassCounters(RenderStats::SHADOW).drawCalls, 0u);
+    CHECK_EQUAL(renderer->getStats()->getPassCounters(RenderStats::DEPTH_PREPASS).drawCalls, 0u);
+
+    // The depth pre-pass draws them once more
+    renderer->setDepthPrePass(true);
+    renderer->render();
+    CHECK_EQUAL(renderer->getStats()->getPassCounters(RenderStats::DEPTH_PREPASS).drawCalls, (unsigned int)CUBES);
+    CHECK_EQUAL(renderer->getStats()->getPassCounters(RenderStats::SCENE).drawCalls, (unsigned int)CUBES);
+}
+
+TEST(Renderer, HiddenGroup) {
+    RenderDevice::set(NullRenderDevice::New());
+    Renderer::Ptr renderer = Renderer::New(640, 640);
+    Group::Ptr group = addCubes(renderer);
+
+    group->setVisible(false);
+    renderer->render();
+    CHECK_EQUAL(renderer->getStats()->getPassCounters(RenderStats::SCENE).drawCalls, 0u);
+
+    group->setVisible(true);
+    group->removePolytope(0);
+    renderer->render();
+    CHECK_EQUAL(renderer->getStats()->getPassCounters(RenderStats::SCENE).drawCalls, (unsigned int)CUBES - 1);
+}
+
+TEST(Renderer, StaticBatch) {
+    RenderDevice::set(NullRenderDevice::New());
+    Renderer::Ptr renderer = Renderer::New(640, 640);
+    Group::Ptr group = addCubes(renderer);
+
+    // Same material, one polytope
+    CHECK(group->bakeStatic());
+    renderer->render();
+    const RenderStats::Counters& scene = renderer->getStats()->getPassCounters(RenderStats::SCENE);
+    CHECK_EQUAL(scene.drawCalls, 1u);
+    CHECK_EQUAL(scene.triangles, (unsigned int)CUBES * 12);
+
+    group->unbakeStatic();
+    renderer->render();
+    CHECK_EQUAL(renderer->getStats()->getPassCounters(RenderStats::SCENE).drawCalls, (unsigned int)CUBES);
+}
+
+TEST(Renderer, MultiDrawBatch) {
+    NullRenderDevice::Ptr device = NullRenderDevice::New();
+    RenderDevice::set(device);
+    Renderer::Ptr renderer = Renderer::New(640, 640);
+    renderer->setMultiDrawIndirect(true);
+    REQUIRE(renderer->isMultiDrawIndirect());
+    Group::Ptr group = addCubes(renderer);
+    renderer->getGeometryArena()->add(group);
+
+    // One multi draw, a command per cube
+    renderer->render();
+    device->reset();
+    renderer->render();
+    const RenderStats::Counters& scene = renderer->getStats()->getPassCounters(RenderStats::SCENE);
+    CHECK_EQUAL(scene.drawCalls, 1u);
+    CHECK_EQUAL(scene.instances, (unsigned int)CUBES);
+    CHECK_EQUAL(scene.triangles, (unsigned int)CUBES * 12);
+    CHECK_EQUAL(device->getCount(NullRenderDevice::MULTI_DRAW), (size_t)1);
+
+    // A different material is another batch
+    group->getPolytopes()[3]->setMaterial(PhongMaterial::New(MATERIAL_DIFFUSE, MATERIAL_SPECULAR, MATERIAL_SHININESS));
+    renderer->render();
+    CHECK_EQUAL(renderer->getStats()->getPassCounters(RenderStats::SCENE).drawCalls, 2u);
+    CHECK_EQUAL(renderer->getStats()->getPassCounters(RenderStats::SCENE).instances, (unsigned int)CUBES);
+}
+
+TEST(Renderer, HiddenGroupQueriedOnce) {
+    RenderDevice::set(std::make_shared<OccludedDevice>());
+    Renderer::Ptr renderer = Renderer::New(640, 640);
+    renderer->setOcclusionCulling(true);
+    addCubes(renderer);
+
+    // A transparent polytope keeps the scene from being hidden as a whole
+    std::vector<Vec3f> vertices = cubeVertices();
+    std::vector<unsigned int> indices = cubeIndices();
+    Polytope::Ptr glass = Polytope::New(vertices, indices);
+    glass->setTransparent(true);
+    Group::Ptr blended = Group::New();
+    blended->add(glass);
+    renderer->getScenes()[0]->addGroup(blended);
+
+    const OcclusionQueries::Ptr& queries = renderer->getOcclusionQueries();
+
+    // Drawn and queried
+    renderer->render();
+    CHECK_EQUAL(queries->getQueries(), (unsigned int)CUBES);
+    CHECK_EQUAL(renderer->getStats()->getPassCounters(RenderStats::SCENE).drawCalls, (unsigned int)CUBES + 1);
+
+    // Hidden one by one, then the group box is the only query
+    renderer->render();
+    CHECK_EQUAL(queries->getConditionalNodes(), (unsigned int)CUBES);
+    renderer->render();
+    CHECK_EQUAL(queries->getQueries(), 1u);
+    CHECK_EQUAL(queries->getConditionalNodes(), 1u);
+    CHECK_EQUAL(queries->getOccludedNodes(), (unsigned int)CUBES);
+}
+
+TEST(Renderer, SoftwareOcclusionCountedOnce) {
+    RenderDevice::set(NullRenderDevice::New());
+    Renderer::Ptr renderer = Renderer::New(640, 640);
+    renderer->setSoftwareOcclusion(true);
+    renderer->getSoftwareOcclusion()->setThreads(1);
+    addCubes(renderer);
+
+    // A wall between the camera above and the cubes
+    std::vector<Vec3f> vertices = cubeVertices();
+    std::vector<unsigned int> indices = cubeIndices();
+    Polytope::Ptr wall = Polytope::New(vertices, indices);
+    wall->translate(glm::vec3(0.f, 5.f, 0.f));
+    wall->scale(glm::vec3(100.f, 1.f, 100.f));
+    wall->setOccluder(wall->readOccluder());
+    Group::Ptr walls = Group::New();
+    walls->add(wall);
+    renderer->getScenes()[0]->addGroup(walls);
+
+    renderer->render();
+    CHECK_EQUAL(renderer->getStats()->getFrame().total.culledObjects, (unsigned int)CUBES);
+    CHECK_EQUAL(renderer->getStats()->getPassCounters(RenderStats::SCENE).drawCalls, 1u);
+
+    // Culled before the pre-pass, the scene pass doesn't test nor count them again
+    renderer->setDepthPrePass(true);
+    renderer->render();
+    CHECK_EQUAL(renderer->getStats()->getFrame().total.culledObjects, (unsigned int)CUBES);
+    CHECK_EQUAL(renderer->getStats()->getPassCounters(RenderStats::DEPTH_PREPASS).culledObjects, (unsigned int)CUBES);
+    CHECK_EQUAL(renderer->getStats()->getPassCounters(RenderStats::DEPTH_PREPASS).drawCalls, 1u);
+    CHECK_EQUAL(renderer->getStats()->getPassCounters(RenderStats::SCENE).drawCalls, 1u);
+    CHECK_EQUAL(renderer->getSoftwareOcclusion()->getTested(), (unsigned int)CUBES + 1);
+}
+
+// Framebuffer blits of the last frame
+static size_t countBlits(const NullRenderDevice::Ptr& device) {
+    size_t blits = 0;
+    for(auto& command : device->getCommands()) blits += command.type == NullRenderDevice::COPY && command.target == GL_DRAW_FRAMEBUFFER ? 1 : 0;
+    return blits;
+}
+
+TEST(Renderer, ShadowCache) {
+    NullRenderDevice::Ptr device = NullRenderDevice::New();
+    RenderDevice::set(device);
+    Renderer::Ptr renderer = Renderer::New(640, 640);
+    renderer->setShadowMapping(true);
+    renderer->setShadowLightPos(glm::vec3(-2.f, 4.f, -1.f));
+    PointLight::Ptr light = PointLight::New(glm::vec3(0.f, 5.f, 0.f), glm::vec3(1.f));
+    renderer->addLight(*light);
+    Group::Ptr group = addCubes(renderer);
+
+    // A second row, in the same scene
+    std::vector<Vec3f> vertices = cubeVertices();
+    std::vector<unsigned int> indices = cubeIndices();
+    Group::Ptr other = Group::New();
+    for(int i = 0; i < CUBES; i ++) {
+        Polytope::Ptr cube = Polytope::New(vertices, indices);
+        cube->translate(glm::vec3(i * 1.5f - CUBES * 0.75f, 0.f, 3.f));
+        other->add(cube);
+    }
+    renderer->getScenes()[0]->addGroup(other);
+
+    auto shadowDraws = [&]() {
+        device->reset();
+        renderer->render();
+        return renderer->getStats()->getPassCounters(RenderStats::SHADOW).drawCalls;
+    };
+
+    // Drawn once, then cached
+    unsigned int all = shadowDraws();
+    CHECK(all >= 2u * CUBES);
+    CHECK_EQUAL(shadowDraws(), 0u);
+
+    // A static group moved
+    group->translate(glm::vec3(0.5f, 0.f, 0.f));
+    CHECK_EQUAL(shadowDraws(), all);
+    CHECK_EQUAL(shadowDraws(), 0u);
+
+    // Hidden and shown again
+    other->setVisible(false);
+    unsigned int hidden = shadowDraws();
+    CHECK(hidden > 0u && hidden < all);
+    CHECK_EQUAL(shadowDraws(), 0u);
+    other->setVisible(true);
+    CHECK_EQUAL(shadowDraws(), all);
+
+    // The light moved, every cascade changes
+    renderer->setShadowLightPos(glm::vec3(2.f, 4.f, 1.f));
+    all = shadowDraws();
+    CHECK(all >= 2u * CUBES);
+    CHECK_EQUAL(shadowDraws(), 0u);
+    size_t blits = countBlits(device);
+
+    // A new polytope where a removed one was, even if it takes its address
+    glm::mat4 model = other->getPolytopes()[0]->getModelMatrix();
+    other->removePolytope(0);
+    Polytope::Ptr replacement = Polytope::New(vertices, indices);
+    replacement->setModelMatrix(model);
+    other->add(replacement);
+    CHECK_EQUAL(shadowDraws(), all);
+
+    // A dynamic group: the static casters are drawn once more, then the cache is blitted
+    // under the dynamic ones every frame
+    other->setDynamicShadow(true);
+    unsigned int first = shadowDraws();
+    CHECK(first > 0u);
+    unsigned int dynamicDraws = shadowDraws();
+    CHECK(dynamicDraws > 0u && dynamicDraws < first);
+    CHECK_EQUAL(countBlits(device), blits + renderer->getShadowCascades()->getCascadeCount());
+    CHECK_EQUAL(shadowDraws(), dynamicDraws);
+    CHECK_EQUAL(countBlits(device), blits + renderer->getShadowCascades()->getCascadeCount());
+
+    // Back to static, no more blits
+    other->setDynamicShadow(false);
+    CHECK_EQUAL(shadowDraws(), all);
+    CHECK_EQUAL(countBlits(device), blits);
+    CHECK_EQUAL(shadowDraws(), 0u);
+}
@@ -0,0 +1,101 @@
+#include <vector>
+#include <algorithm>
+
+#include <engine/opengl/device/NullRenderDevice.h>
+
+#include <SceneGenerator.h>
+
+#include "UnitTest.h"
+
+// Levels of scenes under scene, 1 when it only has groups
+static unsigned int hierarchyDepth(const Scene::Ptr& scene) {
+    unsigned int depth = 0;
+    for(auto& child : scene->getScenes()) depth = std::max(depth, hierarchyDepth(child));
+    return depth + 1;
+}
+
+// Model matrices of the polytopes, in the order of the tree
+static void collectModels(const Scene::Ptr& scene, std::vector<glm::mat4>& models) {
+    for(auto& group : scene->getGroups())
+        for(auto& polytope : group->getPolytopes()) models.push_back(polytope->getModelMatrix());
+    for(auto& child : scene->getScenes()) collectModels(child, models);
+}
+
+static SceneGenerator::Config nestedScatter(uint32_t seed) {
+    SceneGenerator::Config config = SceneGenerator::Config::nested(200, 3);
+    config.layout = SceneGenerator::Layout::Scatter;
+    config.seed = seed;
+    config.textures = 2;
+    config.transparentRatio = 0.25f;
+    config.lights = 4;
+    return config;
+}
+
+TEST(SceneGenerator, SameSeedSameScene) {
+    RenderDevice::set(NullRenderDevice::New());
+
+    SceneGenerator::GeneratedScene first = SceneGenerator(nestedScatter(7)).generate();
+    SceneGenerator::GeneratedScene second = SceneGenerator(nestedScatter(7)).generate();
+
+    CHECK_EQUAL(first.polytopes, 200u);
+    CHECK_EQUAL(first.groups, 13u);
+    CHECK_EQUAL(first.triangles, (size_t)200 * 12);
+    CHECK_EQUAL(hierarchyDepth(first.scene), 3u);
+    REQUIRE(first.lights.size() == 4);
+
+    CHECK_EQUAL(second.polytopes, first.polytopes);
+    CHECK_EQUAL(second.groups, first.groups);
+    CHECK_EQUAL(second.scenes, first.scenes);
+    CHECK_EQUAL(second.triangles, first.triangles);
+    CHECK_EQUAL(hierarchyDepth(second.scene), hierarchyDepth(first.scene));
+    REQUIRE(second.lights.size() == first.lights.size());
+    for(size_t i = 0; i < first.lights.size(); i ++) CHECK(second.lights[i]->getPosition() == first.lights[i]->getPosition());
+
+    std::vector<glm::mat4> firstModels, secondModels;
+    collectModels(first.scene, firstModels);
+    collectModels(second.scene, secondModels);
+    CHECK_EQUAL(firstModels.size(), (size_t)200);
+    CHECK(firstModels == secondModels);
+
+    // Another seed moves the objects, the counts stay
+    SceneGenerator::GeneratedScene other = SceneGenerator(nestedScatter(8)).generate();
+    std::vector<glm::mat4> otherModels;
+    collectModels(other.scene, otherModels);
+    CHECK_EQUAL(other.polytopes, first.polytopes);
+    CHECK_EQUAL(hierarchyDepth(other.scene), 3u);
+    CHECK(otherModels != firstModels);
+}
+
+TEST(SceneGenerator, Knobs) {
+    RenderDevice::set(NullRenderDevice::New());
+
+    // Spheres of about 100 triangles, groups of 10 in the root scene
+    SceneGenerator::Config config;
+    config.objects = 35;
+    config.trianglesPerObject = 100;
+    config.objectsPerGroup = 10;
+    config.lights = 0;
+    SceneGenerator::GeneratedScene scene = SceneGenerator(config).generate();
+    CHECK_EQUAL(scene.polytopes, 35u);
+    CHECK_EQUAL(scene.groups, 4u);
+    CHECK_EQUAL(scene.scenes, 1u);
+    CHECK_EQUAL(hierarchyDepth(scene.scene), 1u);
+    CHECK(scene.triangles / 35 > 12 && scene.triangles / 35 < 200);
+    CHECK(scene.lights.empty());
+}
+
+TEST(SceneGenerator, PointsArentRounded) {
+    RenderDevice::set(NullRenderDevice::New());
+
+    // The last cloud takes the rest
+    SceneGenerator::Config config = SceneGenerator::Config::pointCloud(250);
+    config.pointsPerCloud = 100;
+    SceneGenerator::GeneratedScene scene = SceneGenerator(config).generate();
+    CHECK_EQUAL(scene.polytopes, 3u);
+    CHECK_EQUAL(scene.points, (size_t)250);
+
+    std::vector<unsigned int> lengths;
+    for(auto& group : scene.scene->getGroups())
+        for(auto& polytope : group->getPolytopes()) lengths.push_back(polytope->getVertexLength());
+    CHECK(lengths == std::vector<unsigned int>({ 100, 100, 50 }));
+}
\ No newline at end of file
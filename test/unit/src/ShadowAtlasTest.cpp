@@ -0,0 +1,112 @@
+#include <vector>
+
+#include <engine/lighting/ShadowAtlas.h>
+
+#include "UnitTest.h"
+
+TEST(ShadowAtlas, Split) {
+    ShadowAtlas atlas(1024, GL_DEPTH_COMPONENT24, 128);
+
+    // Rounded up to the minimum tile and to powers of two
+    ShadowAtlas::Tile small = atlas.allocateTile(100);
+    REQUIRE(small.isValid());
+    CHECK_EQUAL(small.size, 128u);
+    CHECK_EQUAL(small.x, 0u);
+    CHECK_EQUAL(small.y, 0u);
+
+    // The first 256 tile holds the small one, the next in Z order is free
+    ShadowAtlas::Tile medium = atlas.allocateTile(200);
+    REQUIRE(medium.isValid());
+    CHECK_EQUAL(medium.size, 256u);
+    CHECK_EQUAL(medium.x, 256u);
+    CHECK_EQUAL(medium.y, 0u);
+
+    ShadowAtlas::Tile large = atlas.allocateTile(512);
+    REQUIRE(large.isValid());
+    CHECK_EQUAL(large.x, 512u);
+    CHECK_EQUAL(large.y, 0u);
+
+    // Filling the rest of the first 256 tile
+    ShadowAtlas::Tile next = atlas.allocateTile(128);
+    CHECK_EQUAL(next.x, 128u);
+    CHECK_EQUAL(next.y, 0u);
+
+    CHECK_EQUAL(atlas.getUsedArea(), (size_t)(2 * 128 * 128 + 256 * 256 + 512 * 512));
+
+    glm::vec4 transform = atlas.getTileTransform(medium);
+    CHECK_NEAR(transform.x, 0.25f, 1e-6f);
+    CHECK_NEAR(transform.y, 0.25f, 1e-6f);
+    CHECK_NEAR(transform.z, 0.25f, 1e-6f);
+    CHECK_NEAR(transform.w, 0.f, 1e-6f);
+}
+
+TEST(ShadowAtlas, MergeOnFree) {
+    ShadowAtlas atlas(1024, GL_DEPTH_COMPONENT24, 128);
+
+    std::vector<ShadowAtlas::Tile> tiles;
+    for(unsigned int size : { 128u, 256u, 128u, 512u, 128u }) tiles.push_back(atlas.allocateTile(size));
+    for(auto& tile : tiles) REQUIRE(tile.isValid());
+
+    // Split, the whole atlas doesn't fit
+    CHECK(!atlas.allocateTile(1024).isValid());
+
+    // Freed twice, the second one is ignored
+    atlas.freeTile(tiles[1]);
+    atlas.freeTile(tiles[1]);
+    CHECK_EQUAL(atlas.getUsedArea(), (size_t)(3 * 128 * 128 + 512 * 512));
+
+    // Back to one tile once every sibling is free
+    for(size_t i = 0; i < tiles.size(); i ++) if(i != 1) atlas.freeTile(tiles[i]);
+    CHECK_EQUAL(atlas.getUsedArea(), (size_t)0);
+    ShadowAtlas::Tile whole = atlas.allocateTile(1024);
+    REQUIRE(whole.isValid());
+    CHECK_EQUAL(whole.x, 0u);
+    CHECK_EQUAL(whole.size, 1024u);
+    CHECK_NEAR(atlas.getOccupancy(), 1.f, 1e-6f);
+}
+
+TEST(ShadowAtlas, Full) {
+    ShadowAtlas atlas(512, GL_DEPTH_COMPONENT24, 128);
+
+    std::vector<ShadowAtlas::Tile> tiles;
+    for(int i = 0; i < 16; i ++) {
+        tiles.push_back(atlas.allocateTile(128));
+        REQUIRE(tiles.back().isValid());
+    }
+    CHECK_NEAR(atlas.getOccupancy(), 1.f, 1e-6f);
+    CHECK(!atlas.allocateTile(1).isValid());
+    CHECK(!atlas.allocateTile(1024).isValid());
+
+    // The freed place is the only one
+    atlas.freeTile(tiles[5]);
+    ShadowAtlas::Tile again = atlas.allocateTile(128);
+    REQUIRE(again.isValid());
+    CHECK_EQUAL(again.x, tiles[5].x);
+    CHECK_EQUAL(again.y, tiles[5].y);
+}
+
+TEST(ShadowAtlas, SetSize) {
+    ShadowAtlas atlas(1024, GL_DEPTH_COMPONENT24, 128);
+    atlas.allocateTile(512);
+    atlas.allocateTile(128);
+
+    // Every tile is freed
+    atlas.setSize(2048);
+    CHECK_EQUAL(atlas.getSize(), 2048u);
+    CHECK_EQUAL(atlas.getUsedArea(), (size_t)0);
+    CHECK(atlas.allocateTile(2048).isValid());
+
+    // Not a power of two, nothing changes
+    atlas.setSize(1000);
+    CHECK_EQUAL(atlas.getSize(), 2048u);
+    CHECK_EQUAL(atlas.getUsedArea(), (size_t)2048 * 2048);
+
+    // Smaller than the minimum tile, then back to the configured one
+    atlas.setSize(64);
+    CHECK_EQUAL(atlas.getMinTileSize(), 64u);
+    CHECK_EQUAL(atlas.allocateTile(1).size, 64u);
+
+    atlas.setSize(1024);
+    CHECK_EQUAL(atlas.getMinTileSize(), 128u);
+    CHECK_EQUAL(atlas.allocateTile(1).size, 128u);
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include <engine/lighting/ShadowCascades.h>
+#include <engine/opengl/device/NullRenderDevice.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "UnitTest.h"
+
+TEST(ShadowCascades, ComputeSplits) {
+    float splits[SHADOW_MAX_CASCADES];
+
+    ShadowCascades::computeSplits(1.f, 101.f, 4, 0.f, splits);
+    CHECK_NEAR(splits[0], 26.f, 1e-4f);
+    CHECK_NEAR(splits[1], 51.f, 1e-4f);
+    CHECK_NEAR(splits[2], 76.f, 1e-4f);
+    CHECK_NEAR(splits[3], 101.f, 1e-4f);
+
+    ShadowCascades::computeSplits(1.f, 10000.f, 4, 1.f, splits);
+    CHECK_NEAR(splits[0], 10.f, 1e-3f);
+    CHECK_NEAR(splits[1], 100.f, 1e-2f);
+    CHECK_NEAR(splits[2], 1000.f, 1e-1f);
+    CHECK_NEAR(splits[3], 10000.f, 1.f);
+
+    // A blend lies between both, the last split is always the far plane
+    float uniform[SHADOW_MAX_CASCADES], logarithmic[SHADOW_MAX_CASCADES];
+    ShadowCascades::computeSplits(0.1f, 100.f, 3, 0.f, uniform);
+    ShadowCascades::computeSplits(0.1f, 100.f, 3, 1.f, logarithmic);
+    ShadowCascades::computeSplits(0.1f, 100.f, 3, SHADOW_SPLIT_LAMBDA, splits);
+    for(int i = 0; i < 3; i ++) {
+        CHECK(splits[i] >= logarithmic[i] - 1e-4f && splits[i] <= uniform[i] + 1e-4f);
+        if(i > 0) CHECK(splits[i] > splits[i - 1]);
+    }
+    CHECK_NEAR(splits[2], 100.f, 1e-4f);
+}
+
+TEST(ShadowCascades, Update) {
+    RenderDevice::set(NullRenderDevice::New());
+    ShadowCascades cascades(3, 1024);
+
+    glm::mat4 projection = glm::perspective(glm::radians(60.f), 1.f, 0.1f, 100.f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+    cascades.update(projection, view, glm::vec3(0.f, 1.f, 0.f), 0.1f, 100.f);
+
+    CHECK_NEAR(cascades.getCascade(0).splitNear, 0.1f, 1e-6f);
+    CHECK_NEAR(cascades.getCascade(2).splitFar, 100.f, 1e-4f);
+    for(unsigned int i = 1; i < 3; i ++) {
+        CHECK_EQUAL(cascades.getCascade(i).splitNear, cascades.getCascade(i - 1).splitFar);
+        CHECK(cascades.getCascade(i).texelSize > cascades.getCascade(i - 1).texelSize);
+    }
+}
+
+TEST(ShadowCascades, IsCaster) {
+    RenderDevice::set(NullRenderDevice::New());
+    ShadowCascades cascades(2, 1024);
+
+    // Camera looking down -z, light from above
+    glm::mat4 projection = glm::perspective(glm::radians(60.f), 1.f, 0.1f, 100.f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+    cascades.update(projection, view, glm::vec3(0.f, 1.f, 0.f), 0.1f, 100.f);
+
+    float split = cascades.getCascade(0).splitFar;
+    glm::vec3 boundsMin(-0.5f), boundsMax(0.5f);
+    auto at = [](float x, float y, float z) { return glm::translate(glm::mat4(1.f), glm::vec3(x, y, z)); };
+
+    // Inside the first slice
+    CHECK(cascades.isCaster(0, at(0.f, 0.f, -split * 0.5f), boundsMin, boundsMax));
+
+    // Far beyond it, in the second one only
+    CHECK(!cascades.isCaster(0, at(0.f, 0.f, -split - 50.f), boundsMin, boundsMax));
+    CHECK(cascades.isCaster(1, at(0.f, 0.f, -split - 50.f), boundsMin, boundsMax));
+
+    // Beside the cascade
+    CHECK(!cascades.isCaster(0, at(1000.f, 0.f, -split * 0.5f), boundsMin, boundsMax));
+
+    // Between the light and the cascade it's kept, below the receivers it isn't
+    CHECK(cascades.isCaster(0, at(0.f, 1000.f, -split * 0.5f), boundsMin, boundsMax));
+    CHECK(!cascades.isCaster(0, at(0.f, -1000.f, -split * 0.5f), boundsMin, boundsMax));
+
+    // A big box reaching into the cascade
+    CHECK(cascades.isCaster(0, at(0.f, 0.f, -split - 50.f), glm::vec3(-1.f, -1.f, -60.f), glm::vec3(1.f, 1.f, 60.f)));
+}
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include <vector>
+#include <random>
+
+#include <engine/renderer/SoftwareOcclusion.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "UnitTest.h"
+
+// Camera at z = 5 looking at the origin
+static glm::mat4 viewProjection() {
+    glm::mat4 projection = glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 100.f);
+    return projection * glm::lookAt(glm::vec3(0.f, 0.f, 5.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+}
+
+// Counter-clockwise seen from +z
+static Polytope::Occluder quad(float size, float z) {
+    Polytope::Occluder occluder;
+    occluder.positions = { { -size, -size, z }, { size, -size, z }, { size, size, z }, { -size, size, z } };
+    occluder.indices = { 0, 1, 2, 0, 2, 3 };
+    return occluder;
+}
+
+static Polytope::Occluder cube() {
+    Polytope::Occluder occluder;
+    for(int i = 0; i < 8; i++) occluder.positions.push_back(glm::vec3(i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : -1.f));
+    occluder.indices = {
+        0, 2, 1, 1, 2, 3,   4, 5, 6, 5, 7, 6,
+        0, 1, 4, 1, 5, 4,   2, 6, 3, 3, 6, 7,
+        0, 4, 2, 2, 4, 6,   1, 3, 5, 3, 7, 5
+    };
+    return occluder;
+}
+
+static bool isBoxVisible(SoftwareOcclusion& occlusion, const glm::vec3& center, float size) {
+    return occlusion.isVisible(glm::translate(glm::mat4(1.f), center), glm::vec3(-size), glm::vec3(size));
+}
+
+TEST(SoftwareOcclusion, Wall) {
+    SoftwareOcclusion occlusion;
+    occlusion.setThreads(1);
+    occlusion.begin(viewProjection());
+    occlusion.addOccluder(glm::mat4(1.f), quad(2.f, 0.f), Polytope::FaceCulling::BACK);
+    occlusion.rasterize();
+    CHECK_EQUAL(occlusion.getTriangleCount(), 2u);
+
+    CHECK(!isBoxVisible(occlusion, glm::vec3(0.f, 0.f, -3.f), 0.3f));
+    CHECK(isBoxVisible(occlusion, glm::vec3(0.f, 0.f, 1.f), 0.3f));
+    CHECK(isBoxVisible(occlusion, glm::vec3(0.f), 0.3f));
+    CHECK_EQUAL(occlusion.getTested(), 3u);
+    CHECK_EQUAL(occlusion.getCulled(), 1u);
+
+    // Seen from behind, a culled face hides nothing
+    SoftwareOcclusion back;
+    back.begin(viewProjection());
+    back.addOccluder(glm::rotate(glm::mat4(1.f), glm::radians(180.f), glm::vec3(0.f, 1.f, 0.f)), quad(2.f, 0.f), Polytope::FaceCulling::BACK);
+    back.rasterize();
+    CHECK_EQUAL(back.getTriangleCount(), 0u);
+    CHECK(isBoxVisible(back, glm::vec3(0.f, 0.f, -3.f), 0.3f));
+}
+
+TEST(SoftwareOcclusion, PartialOverlap) {
+    SoftwareOcclusion occlusion;
+    occlusion.begin(viewProjection());
+    occlusion.addOccluder(glm::mat4(1.f), quad(2.f, 0.f), Polytope::FaceCulling::BACK);
+    occlusion.rasterize();
+
+    // Behind the wall but sticking out of its side
+    CHECK(isBoxVisible(occlusion, glm::vec3(2.5f, 0.f, -1.f), 0.6f));
+
+    // Behind a corner, all inside
+    CHECK(!isBoxVisible(occlusion, glm::vec3(1.4f, 1.4f, -1.f), 0.2f));
+}
+
+TEST(SoftwareOcclusion, OutOfTheFrustum) {
+    SoftwareOcclusion occlusion;
+    occlusion.begin(viewProjection());
+    occlusion.rasterize();
+
+    // Nothing rasterized, only the frustum culls
+    CHECK(isBoxVisible(occlusion, glm::vec3(0.f), 0.3f));
+    CHECK(!isBoxVisible(occlusion, glm::vec3(30.f, 0.f, -1.f), 0.3f));
+    CHECK(!isBoxVisible(occlusion, glm::vec3(0.f, 0.f, 10.f), 0.3f));
+    CHECK(!isBoxVisible(occlusion, glm::vec3(0.f, 0.f, -200.f), 0.3f));
+
+    // Around the camera, cut by the near plane
+    CHECK(isBoxVisible(occlusion, glm::vec3(0.f, 0.f, 5.f), 0.3f));
+    CHECK_EQUAL(occlusion.getCulled(), 3u);
+}
+
+TEST(SoftwareOcclusion, NearClip) {
+    SoftwareOcclusion occlusion;
+    occlusion.begin(viewProjection());
+
+    // Floor one unit under the camera, from behind it to the far plane
+    Polytope::Occluder floor;
+    floor.positions = { { -50.f, -1.f, -50.f }, { 50.f, -1.f, -50.f }, { 50.f, -1.f, 50.f }, { -50.f, -1.f, 50.f } };
+    floor.indices = { 0, 3, 2, 0, 2, 1 };
+    occlusion.addOccluder(glm::mat4(1.f), floor, Polytope::FaceCulling::NONE);
+    occlusion.rasterize();
+    CHECK(occlusion.getTriangleCount() > 2u);
+
+    CHECK(!occlusion.isVisible(glm::mat4(1.f), glm::vec3(-0.5f, -3.f, -0.5f), glm::vec3(0.5f, -2.f, 0.5f)));
+    CHECK(occlusion.isVisible(glm::mat4(1.f), glm::vec3(-0.5f, 0.f, -0.5f), glm::vec3(0.5f, 1.f, 0.5f)));
+
+    // A wall just past the near plane hides everything
+    occlusion.begin(viewProjection());
+    occlusion.addOccluder(glm::mat4(1.f), quad(50.f, 4.85f), Polytope::FaceCulling::NONE);
+    occlusion.rasterize();
+    CHECK(!isBoxVisible(occlusion, glm::vec3(0.f), 1.f));
+    CHECK(!isBoxVisible(occlusion, glm::vec3(3.f, -1.f, -20.f), 1.f));
+}
+
+TEST(SoftwareOcclusion, Threads) {
+    // Enough triangles for every thread to get a band
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+    std::vector<glm::mat4> models;
+    for(int i = 0; i < 400; i++) {
+        glm::mat4 model = glm::translate(glm::mat4(1.f), glm::vec3(distribution(random) * 8.f, distribution(random) * 4.f, -10.f + distribution(random) * 8.f));
+        models.push_back(glm::scale(model, glm::vec3(0.2f + std::abs(distribution(random)), 0.2f + std::abs(distribution(random)), 0.2f)));
+    }
+
+    std::vector<glm::vec3> probes;
+    for(int i = 0; i < 2000; i++) probes.push_back(glm::vec3(distribution(random) * 10.f, distribution(random) * 5.f, -20.f + distribution(random) * 10.f));
+
+    Polytope::Occluder occluder = cube();
+    std::vector<bool> expected;
+    SoftwareOcclusion occlusion;
+    for(unsigned int threads : { 1u, 4u, 2u, 4u }) {
+        occlusion.setThreads(threads);
+        occlusion.begin(viewProjection());
+        for(auto& model : models) occlusion.addOccluder(model, occluder, Polytope::FaceCulling::NONE);
+        occlusion.rasterize();
+        REQUIRE(occlusion.getTriangleCount() >= (SOFTWARE_OCCLUSION_MAX_THREADS - 1) * SOFTWARE_OCCLUSION_THREAD_TRIANGLES);
+
+        std::vector<bool> visible;
+        for(auto& probe : probes) visible.push_back(isBoxVisible(occlusion, probe, 0.3f));
+        if(expected.empty()) expected = visible;
+        CHECK(visible == expected);
+    }
+
+    // Some culled and some not, the comparison means something
+    unsigned int culled = 0;
+    for(bool visible : expected) culled += visible ? 0 : 1;
+    CHECK(culled > 0 && culled < expected.size());
+}
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include <map>
+#include <random>
+
+#include <engine/opengl/buffer/TLSFAllocator.h>
+
+#include "UnitTest.h"
+
+TEST(TLSFAllocator, AllocateAndFree) {
+    TLSFAllocator allocator(1024);
+
+    unsigned int a = allocator.allocate(100);
+    unsigned int b = allocator.allocate(200);
+    unsigned int c = allocator.allocate(50);
+    CHECK_EQUAL(a, 0u);
+    CHECK_EQUAL(b, 100u);
+    CHECK_EQUAL(c, 300u);
+    CHECK_EQUAL(allocator.getUsed(), 350u);
+    CHECK_EQUAL(allocator.getAllocationsCount(), (size_t)3);
+    CHECK_EQUAL(allocator.getSize(b), 200u);
+
+    CHECK(allocator.free(b));
+    CHECK(!allocator.free(b));
+    CHECK(!allocator.free(12345));
+    CHECK_EQUAL(allocator.getSize(b), 0u);
+    CHECK_EQUAL(allocator.getUsed(), 150u);
+
+    CHECK(allocator.free(a));
+    CHECK(allocator.free(c));
+    CHECK(allocator.isEmpty());
+    CHECK_EQUAL(allocator.getLargestFreeBlock(), 1024u);
+
+    CHECK_EQUAL(allocator.allocate(0), TLSFAllocator::INVALID_OFFSET);
+}
+
+TEST(TLSFAllocator, MergesNeighbours) {
+    TLSFAllocator allocator(400);
+
+    unsigned int a = allocator.allocate(100);
+    unsigned int b = allocator.allocate(200);
+    unsigned int c = allocator.allocate(50);
+
+    // Two holes of 100 and 200 become one of 300 at the beginning, the only place it fits
+    allocator.free(a);
+    allocator.free(b);
+    CHECK_EQUAL(allocator.getLargestFreeBlock(), 300u);
+    CHECK_EQUAL(allocator.allocate(300), 0u);
+
+    // Freed in the middle, merged with the previous and the next free blocks
+    allocator.free(0);
+    allocator.free(c);
+    CHECK_EQUAL(allocator.getLargestFreeBlock(), 400u);
+    CHECK_EQUAL(allocator.allocate(400), 0u);
+}
+
+TEST(TLSFAllocator, ExhaustionAndGrow) {
+    TLSFAllocator allocator(256);
+
+    CHECK_EQUAL(allocator.allocate(200), 0u);
+    CHECK_EQUAL(allocator.allocate(100), TLSFAllocator::INVALID_OFFSET);
+    CHECK_EQUAL(allocator.allocate(56), 200u);
+    CHECK_EQUAL(allocator.getFree(), 0u);
+    CHECK_EQUAL(allocator.allocate(1), TLSFAllocator::INVALID_OFFSET);
+
+    // The new space goes after the last block
+    allocator.grow(512);
+    CHECK_EQUAL(allocator.getCapacity(), 512u);
+    CHECK_EQUAL(allocator.allocate(100), 256u);
+
+    // and merges with it when it's free
+    allocator.grow(1024);
+    CHECK_EQUAL(allocator.getLargestFreeBlock(), 668u);
+    CHECK_EQUAL(allocator.allocate(668), 356u);
+
+    // Smaller capacities are ignored
+    allocator.grow(128);
+    CHECK_EQUAL(allocator.getCapacity(), 1024u);
+
+    allocator.reset();
+    CHECK(allocator.isEmpty());
+    CHECK_EQUAL(allocator.getCapacity(), 1024u);
+    CHECK_EQUAL(allocator.getLargestFreeBlock(), 1024u);
+}
+
+TEST(TLSFAllocator, Alignment) {
+    TLSFAllocator allocator(1000, 16);
+
+    // The capacity is rounded down and the sizes up to the alignment
+    CHECK_EQUAL(allocator.getCapacity(), 992u);
+    unsigned int a = allocator.allocate(1);
+    unsigned int b = allocator.allocate(17);
+    unsigned int c = allocator.allocate(48);
+    CHECK_EQUAL(allocator.getSize(a), 16u);
+    CHECK_EQUAL(allocator.getSize(b), 32u);
+    CHECK_EQUAL(allocator.getSize(c), 48u);
+    CHECK_EQUAL(a % 16, 0u);
+    CHECK_EQUAL(b % 16, 0u);
+    CHECK_EQUAL(c % 16, 0u);
+    CHECK_EQUAL(allocator.getUsed(), 96u);
+
+    allocator.grow(1030);
+    CHECK_EQUAL(allocator.getCapacity(), 1024u);
+}
+
+TEST(TLSFAllocator, FragmentationAndLargestFreeBlock) {
+    TLSFAllocator allocator(1000);
+
+    CHECK_EQUAL(allocator.getFragmentation(), 0.f);
+
+    unsigned int offsets[10];
+    for(unsigned int& offset : offsets) offset = allocator.allocate(100);
+    CHECK_EQUAL(allocator.getLargestFreeBlock(), 0u);
+    CHECK_EQUAL(allocator.getFragmentation(), 0.f);
+
+    // Five holes of 100
+    for(int i = 0; i < 10; i += 2) allocator.free(offsets[i]);
+    CHECK_EQUAL(allocator.getFree(), 500u);
+    CHECK_EQUAL(allocator.getLargestFreeBlock(), 100u);
+    CHECK_NEAR(allocator.getFragmentation(), 0.8f, 1e-6f);
+
+    // 300 and three holes of 100
+    allocator.free(offsets[1]);
+    CHECK_EQUAL(allocator.getLargestFreeBlock(), 300u);
+    CHECK_NEAR(allocator.getFragmentation(), 0.5f, 1e-6f);
+
+    // 1210 and 1200 share a size class, the larger one isn't the first of the list
+    TLSFAllocator classes(4096);
+    unsigned int larger = classes.allocate(1210);
+    classes.allocate(64);
+    unsigned int smaller = classes.allocate(1200);
+    classes.allocate(64);
+    classes.allocate(classes.getFree());
+    classes.free(larger);
+    classes.free(smaller);
+    CHECK_EQUAL(classes.getLargestFreeBlock(), 1210u);
+}
+
+TEST(TLSFAllocator, RandomAgainstReference) {
+    const unsigned int capacity = 1 << 16;
+    TLSFAllocator allocator(capacity, 4);
+
+    std::mt19937 random(7);
+    std::map<unsigned int, unsigned int> allocations;    // offset -> size
+    unsigned int used = 0;
+
+    for(int step = 0; step < 20000; step ++) {
+        if(allocations.empty() || random() % 3 != 0) {
+            unsigned int size = 1 + random() % 700;
+            unsigned int offset = allocator.allocate(size);
+            if(offset == TLSFAllocator::INVALID_OFFSET) continue;
+
+            // Inside the capacity and not overlapping its neighbours
+            unsigned int allocated = allocator.getSize(offset);
+            REQUIRE(allocated >= size && offset + allocated <= capacity);
+            auto next = allocations.lower_bound(offset);
+            if(next != allocations.end()) REQUIRE(offset + allocated <= next->first);
+            if(next != allocations.begin()) {
+                auto prev = std::prev(next);
+                REQUIRE(prev->first + prev->second <= offset);
+            }
+            allocations[offset] = allocated;
+            used += allocated;
+        }
+        else {
+            auto it = allocations.begin();
+            std::advance(it, random() % allocations.size());
+            REQUIRE(allocator.free(it->first));
+            used -= it->second;
+            allocations.erase(it);
+        }
+        REQUIRE(allocator.getUsed() == used);
+    }
+
+    for(auto& allocation : allocations) allocator.free(allocation.first);
+    CHECK(allocator.isEmpty());
+    CHECK_EQUAL(allocator.getLargestFreeBlock(), capacity);
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+
+/**
+ * @brief Minimal test registry, no dependency.
+ *
+ * TEST registers a function in a suite, CHECK records a failure and goes on, REQUIRE records
+ * it and leaves the test. Every suite is a ctest test, renderergl_tests SUITE runs one.
+ */
+class UnitTest {
+public:
+    typedef void (*Function)();
+
+    struct Case {
+        const char* suite;
+        const char* name;
+        Function function;
+    };
+private:
+    inline static std::vector<Case>& cases() {
+        static std::vector<Case> cases;
+        return cases;
+    }
+
+    inline static unsigned int& failures() {
+        static unsigned int failures = 0;
+        return failures;
+    }
+public:
+    inline static bool add(const char* suite, const char* name, Function function) {
+        cases().push_back({ suite, name, function });
+        return true;
+    }
+
+    inline static bool fail(const char* file, int line, const std::string& message) {
+        std::cout << file << ":" << line << ": " << message << std::endl;
+        failures() ++;
+        return false;
+    }
+
+    /**
+     * @brief Runs the cases of suite, or all of them when it's empty. Returns the failed cases
+     */
+    inline static int run(const std::string& suite) {
+        unsigned int ran = 0, failed = 0;
+        for(Case& test : cases()) {
+            if(!suite.empty() && suite != test.suite) continue;
+
+            unsigned int before = failures();
+            test.function();
+            ran ++;
+
+            bool passed = failures() == before;
+            if(!passed) failed ++;
+            std::cout << (passed ? "[ OK ] " : "[FAIL] ") << test.suite << "." << test.name << std::endl;
+        }
+
+        if(ran == 0) {
+            std::cout << "No test in suite " << suite << std::endl;
+            return 1;
+        }
+        std::cout << ran - failed << " of " << ran << " passed" << std::endl;
+        return failed;
+    }
+
+    template<typename A, typename B>
+    inline static std::string describe(const char* expression, A a, B b) {
+        std::string message = expression;
+        message += " (" + std::to_string(a) + " vs " + std::to_string(b) + ")";
+        return message;
+    }
+};
+
+#define TEST(suite, name) \
+    static void suite##_##name(); \
+    static bool suite##_##name##_registered = UnitTest::add(#suite, #name, suite##_##name); \
+    static void suite##_##name()
+
+#define CHECK(condition) \
+    ((condition) ? true : UnitTest::fail(__FILE__, __LINE__, #condition))
+
+#define CHECK_EQUAL(a, b) \
+    ((a) == (b) ? true : UnitTest::fail(__FILE__, __LINE__, UnitTest::describe(#a " == " #b, (a), (b))))
+
+#define CHECK_NEAR(a, b, epsilon) \
+    (std::abs((a) - (b)) <= (epsilon) ? true : UnitTest::fail(__FILE__, __LINE__, UnitTest::describe(#a " ~ " #b, (a), (b))))
+
+#define REQUIRE(condition) \
+    do { if(!CHECK(condition)) return; } while(0)
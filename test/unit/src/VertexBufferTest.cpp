@@ -0,0 +1,52 @@
+#include <vector>
+
+#include <engine/opengl/buffer/VertexBuffer.h>
+
+#include "UnitTest.h"
+
+static Vec3f createVertex(float base) {
+    Vec3f vertex(base, base + 1.f, base + 2.f, base + 3.f, base + 4.f, base + 5.f, base + 6.f, base + 7.f, base + 8.f, base + 9.f, base + 10.f);
+    vertex.tanx = base + 11.f; vertex.tany = base + 12.f; vertex.tanz = base + 13.f;
+    vertex.bitanx = base + 14.f; vertex.bitany = base + 15.f; vertex.bitanz = base + 16.f;
+    return vertex;
+}
+
+TEST(VertexBuffer, Interleave) {
+    std::vector<Vec3f> vertices = { createVertex(0.f), createVertex(100.f), createVertex(200.f) };
+
+    // Position, color, normal, uv, tangent and bitangent, 17 floats per vertex one after the other
+    std::vector<float> data(vertices.size() * 17 + 1, -1.f);
+    VertexBuffer::interleave(vertices, data.data());
+    for(size_t i = 0; i < vertices.size(); i ++) {
+        for(size_t j = 0; j < 17; j ++) CHECK_EQUAL(data[i * 17 + j], i * 100.f + j);
+    }
+
+    // Nothing written past the last vertex
+    CHECK_EQUAL(data.back(), -1.f);
+    data[0] = -1.f;
+    VertexBuffer::interleave({}, data.data());
+    CHECK_EQUAL(data[0], -1.f);
+}
+
+TEST(VertexBuffer, Deinterleave) {
+    std::vector<float> data(3 * 17);
+    for(size_t i = 0; i < data.size(); i ++) data[i] = (float)i;
+
+    // The vector takes the length, the old vertices are dropped
+    std::vector<Vec3f> vertices(5);
+    VertexBuffer::deinterleave(data.data(), 3, vertices);
+    REQUIRE(vertices.size() == 3);
+    CHECK_EQUAL(vertices[1].x, 17.f);
+    CHECK_EQUAL(vertices[1].r, 20.f);
+    CHECK_EQUAL(vertices[1].nz, 25.f);
+    CHECK_EQUAL(vertices[1].ty, 27.f);
+    CHECK_EQUAL(vertices[2].bitanz, 50.f);
+
+    // Round trip
+    std::vector<float> again(data.size());
+    VertexBuffer::interleave(vertices, again.data());
+    CHECK(again == data);
+
+    VertexBuffer::deinterleave(data.data(), 0, vertices);
+    CHECK(vertices.empty());
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+#include <string>
+
+#include "UnitTest.h"
+
+int main(int argc, char* argv[]) {
+    std::string suite = argc > 1 ? argv[1] : "";
+    return UnitTest::run(suite) == 0 ? 0 : 1;
+}
\ No newline at end of file